@@ -68,9 +68,9 @@ struct comp_data {
 	int source_frames_max;	/* Max # of frames to process at source */
 	int sink_frames_max;	/* Max # of frames to process at sink */
 	int data_shift;		/* Optional shift by 8 to process S24_4LE */
-	uint8_t *buf;		/* Samples buffer for input and output */
-	uint8_t *ibuf[PLATFORM_MAX_CHANNELS];	/* Input channels pointers */
-	uint8_t *obuf[PLATFORM_MAX_CHANNELS];	/* Output channels pointers */
+	uint8_t *buf;		/* Channel pointers and samples buffer */
+	uint8_t **ibuf;		/* Input channels pointers */
+	uint8_t **obuf;		/* Output channels pointers */
 	bool track_drift;
 	asrc_proc_func asrc_func;		/* ASRC processing function */
 };
@@ -541,6 +541,7 @@ static int asrc_prepare(struct comp_dev *dev)
 	int sample_bytes;
 	int sample_bits;
 	int frame_bytes;
+	int ptr_bytes;
 	int fs_prim;
 	int fs_sec;
 	int ret;
@@ -610,25 +611,30 @@ static int asrc_prepare(struct comp_dev *dev)
 	}
 
 	/*
-	 * Allocate input and output data buffer for ASRC processing
+	 * Allocate input and output data buffer for ASRC processing. The
+	 * input and output pointers of the stream channels are in front of
+	 * the samples.
 	 */
 	frame_bytes = audio_stream_frame_bytes(&sourceb->stream);
+	ptr_bytes = 2 * sourceb->stream.channels * sizeof(*cd->ibuf);
 	cd->buf_size = (cd->source_frames_max + cd->sink_frames_max) *
 		frame_bytes;
 
 	cd->buf = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-			  cd->buf_size);
+			  ptr_bytes + cd->buf_size);
 	if (!cd->buf) {
-		cd->buf_size = 0;
 		comp_err(dev, "asrc_prepare(), allocation fail for size %d",
-			 cd->buf_size);
+			 ptr_bytes + cd->buf_size);
+		cd->buf_size = 0;
 		ret = -ENOMEM;
 		goto err_free_buf;
 	}
 
+	cd->ibuf = (uint8_t **)cd->buf;
+	cd->obuf = cd->ibuf + sourceb->stream.channels;
 	sample_bytes = frame_bytes / sourceb->stream.channels;
 	for (i = 0; i < sourceb->stream.channels; i++) {
-		cd->ibuf[i] = cd->buf + i * sample_bytes;
+		cd->ibuf[i] = cd->buf + ptr_bytes + i * sample_bytes;
 		cd->obuf[i] = cd->ibuf[i] + cd->source_frames_max * frame_bytes;
 	}
 
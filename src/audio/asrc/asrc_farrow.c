@@ -238,7 +238,7 @@ enum asrc_error_code asrc_get_required_size(struct comp_dev *dev,
 					    int bit_depth)
 {
 	int filter_length = 128;
-	int buffer_length = 256;
+	int buffer_length = 2 * (filter_length + ASRC_BLOCK_FRAMES);
 	int size;
 
 	/* check for parameter errors */
@@ -276,8 +276,8 @@ enum asrc_error_code asrc_get_required_size(struct comp_dev *dev,
 	size += sizeof(int32_t *) * num_channels; /* pointers the the buffers */
 	/* size of the ring buffers */
 	size += buffer_length * num_channels * (bit_depth / 8);
-	/* size of the impulse response */
-	size += filter_length * sizeof(int32_t);
+	/* size of the impulse responses of one block */
+	size += ASRC_IR_BLOCK * filter_length * sizeof(int32_t);
 
 	*required_size = size;
 
@@ -401,26 +401,6 @@ enum asrc_error_code asrc_initialise(struct comp_dev *dev,
 		return error_code;
 	}
 
-	/*
-	 * Set the pointer for the impulse response.
-	 * &m_impulse_response[0] = ring_buffers_x
-	 * + num_channels * (1 + buffer_length);
-	 * Here ring_buffer_x already points to the memory just behind
-	 * the src_obj.  The offset results from the number of pointers
-	 * pointing to each channel and each channels buffer data.
-	 */
-	if (src_obj->bit_depth == 32) {
-		src_obj->impulse_response =
-			(int32_t *)(src_obj->ring_buffers32 +
-				    src_obj->num_channels *
-				    (1 + src_obj->buffer_length));
-	} else if (src_obj->bit_depth == 16) {
-		src_obj->impulse_response =
-			(int32_t *)(src_obj->ring_buffers16 +
-				    src_obj->num_channels *
-				    (1 + src_obj->buffer_length / 2));
-	}
-
 	/* return ok, if everything worked out */
 	src_obj->is_initialised = true;
 	return ASRC_EC_OK;
@@ -493,18 +473,6 @@ enum asrc_error_code asrc_set_fs_ratio(struct comp_dev *dev,
 		return error_code;
 	}
 
-	/* Set the pointer for the impulse response */
-	if (src_obj->bit_depth == 32) {
-		src_obj->impulse_response =
-			(int32_t *)(src_obj->ring_buffers32 +
-			src_obj->num_channels * (1 + src_obj->buffer_length));
-	} else if (src_obj->bit_depth == 16) {
-		src_obj->impulse_response =
-			(int32_t *)(src_obj->ring_buffers16 +
-				    src_obj->num_channels *
-				    (1 + src_obj->buffer_length / 2));
-	}
-
 	return ASRC_EC_OK;
 }
 
@@ -564,17 +532,21 @@ static enum asrc_error_code initialise_buffer(struct asrc_farrow *src_obj)
 	if (src_obj->bit_depth == 32)
 		buffer = (uint8_t *)(src_obj->ring_buffers32 +
 			src_obj->num_channels);
-	else if (src_obj->bit_depth == 16)
+	else
 		buffer = (uint8_t *)(src_obj->ring_buffers16 +
 			src_obj->num_channels);
 
 	/*
-	 * set buffer_length to filter_length * 2 to compensate for
+	 * set buffer_length to twice the history to compensate for
 	 * missing element wise wrap around while loading but allowing
-	 * aligned loads.
+	 * aligned loads. The history holds filter_length samples for the
+	 * first output of a block plus the ASRC_BLOCK_FRAMES input frames
+	 * that are written to the ring buffer before the block is
+	 * filtered.
 	 */
-	src_obj->buffer_length = src_obj->filter_length * 2;
-	src_obj->buffer_write_position = src_obj->filter_length;
+	src_obj->buffer_length = (src_obj->filter_length +
+				  ASRC_BLOCK_FRAMES) * 2;
+	src_obj->buffer_write_position = src_obj->buffer_length >> 1;
 
 	/* set the base addresses for every channel and initialise the
 	 * buffers to zero
@@ -599,6 +571,14 @@ static enum asrc_error_code initialise_buffer(struct asrc_farrow *src_obj)
 		}
 	}
 
+	/*
+	 * The impulse responses follow the ring buffers of all channels.
+	 * The ring buffer sizes are multiples of 32 bit.
+	 */
+	src_obj->impulse_response = (int32_t *)(buffer +
+		src_obj->num_channels * src_obj->buffer_length *
+		(src_obj->bit_depth / 8));
+
 	return ASRC_EC_OK;
 }
 
@@ -889,87 +869,307 @@ enum asrc_error_code asrc_update_fs_ratio(struct comp_dev *dev,
 }
 
 void asrc_write_to_ring_buffer16(struct asrc_farrow  *src_obj,
-				 int16_t **input_buffers, int index_input_frame)
+				 int16_t **input_buffers, int index_input_frame,
+				 int num_frames)
 {
+	int16_t *in;
+	int16_t *rb;
+	int half = src_obj->buffer_length >> 1;
+	int stride;
+	int pos = src_obj->buffer_write_position;
+	int run;
 	int ch;
-	int j;
-	int k;
+	int i;
 	int m;
-
-	/* update the buffer_write_position */
-	(src_obj->buffer_write_position)++;
-
-	/* since it's a ring buffer we need a wrap around */
-	if (src_obj->buffer_write_position >= src_obj->buffer_length)
-		src_obj->buffer_write_position -= (src_obj->buffer_length >> 1);
+	int n;
 
 	/* handle input format */
 	if (src_obj->input_format == ASRC_IOF_INTERLEAVED)
-		m = src_obj->num_channels * index_input_frame;
+		stride = src_obj->num_channels;
 	else
-		m = index_input_frame; /* For SRC_IOF_DEINTERLEAVED */
-
-	/* write data to each channel */
-	j = src_obj->buffer_write_position;
-	k = j - (src_obj->buffer_length >> 1);
-	for (ch = 0; ch < src_obj->num_channels; ch++) {
-		/*
-		 * Since we want the filter function to load 64 bit of
-		 * buffer data in one cycle, this function writes each
-		 * input sample to the buffer twice, one with an
-		 * offset of half the buffer size. This way we don't
-		 * need a wrap around while loading #filter_length of
-		 * buffered samples. The upper and lower half of the
-		 * buffer are redundant. If the memory tradeoff is
-		 * critical, the buffer can be reduced to half the
-		 * size but therefore increased filter operations have
-		 * to be expected.
-		 */
-		src_obj->ring_buffers16[ch][j] = input_buffers[ch][m];
-		src_obj->ring_buffers16[ch][k] = input_buffers[ch][m];
+		stride = 1; /* For SRC_IOF_DEINTERLEAVED */
+
+	/*
+	 * Since we want the filter function to load 64 bit of buffer
+	 * data in one cycle, this function writes each input sample to
+	 * the buffer twice, one with an offset of half the buffer size.
+	 * This way we don't need a wrap around while loading
+	 * #filter_length of buffered samples. The upper and lower half
+	 * of the buffer are redundant. If the memory tradeoff is
+	 * critical, the buffer can be reduced to half the size but
+	 * therefore increased filter operations have to be expected.
+	 *
+	 * The frames are written in runs up to the end of the ring
+	 * buffer, so the wrap around is checked once per run only.
+	 */
+	for (n = 0; n < num_frames; n += run) {
+		/* update the buffer_write_position */
+		pos++;
+
+		/* since it's a ring buffer we need a wrap around */
+		if (pos >= src_obj->buffer_length)
+			pos -= half;
+
+		run = MIN(num_frames - n, src_obj->buffer_length - pos);
+		m = stride * (index_input_frame + n);
+
+		/* write data to each channel */
+		for (ch = 0; ch < src_obj->num_channels; ch++) {
+			in = &input_buffers[ch][m];
+			rb = &src_obj->ring_buffers16[ch][pos];
+			for (i = 0; i < run; i++) {
+				rb[i] = *in;
+				rb[i - half] = *in;
+				in += stride;
+			}
+		}
+
+		pos += run - 1;
 	}
+
+	src_obj->buffer_write_position = pos;
 }
 
 void asrc_write_to_ring_buffer32(struct asrc_farrow  *src_obj,
-				 int32_t **input_buffers, int index_input_frame)
+				 int32_t **input_buffers, int index_input_frame,
+				 int num_frames)
 {
+	int32_t *in;
+	int32_t *rb;
+	int half = src_obj->buffer_length >> 1;
+	int stride;
+	int pos = src_obj->buffer_write_position;
+	int run;
 	int ch;
-	int j;
-	int k;
+	int i;
 	int m;
-
-	/* update the buffer_write_position */
-	(src_obj->buffer_write_position)++;
-
-	/* since it's a ring buffer we need a wrap around */
-	if (src_obj->buffer_write_position >= src_obj->buffer_length)
-		src_obj->buffer_write_position -= (src_obj->buffer_length >> 1);
+	int n;
 
 	/* handle input format */
 	if (src_obj->input_format == ASRC_IOF_INTERLEAVED)
-		m = src_obj->num_channels * index_input_frame;
+		stride = src_obj->num_channels;
 	else
-		m = index_input_frame; /* For SRC_IOF_DEINTERLEAVED */
-
-	/* write data to each channel */
-	j = src_obj->buffer_write_position;
-	k = j - (src_obj->buffer_length >> 1);
-	for (ch = 0; ch < src_obj->num_channels; ch++) {
-		/*
-		 * Since we want the filter function to load 64 bit of
-		 * buffer data in one cycle, this function writes each
-		 * input sample to the buffer twice, one with an
-		 * offset of half the buffer size. This way we don't
-		 * need a wrap around while loading #filter_length of
-		 * buffered samples. The upper and lower half of the
-		 * buffer are redundant. If the memory tradeoff is
-		 * critical, the buffer can be reduced to half the
-		 * size but therefore increased filter operations have
-		 * to be expected.
+		stride = 1; /* For SRC_IOF_DEINTERLEAVED */
+
+	/*
+	 * Since we want the filter function to load 64 bit of buffer
+	 * data in one cycle, this function writes each input sample to
+	 * the buffer twice, one with an offset of half the buffer size.
+	 * This way we don't need a wrap around while loading
+	 * #filter_length of buffered samples. The upper and lower half
+	 * of the buffer are redundant. If the memory tradeoff is
+	 * critical, the buffer can be reduced to half the size but
+	 * therefore increased filter operations have to be expected.
+	 *
+	 * The frames are written in runs up to the end of the ring
+	 * buffer, so the wrap around is checked once per run only.
+	 */
+	for (n = 0; n < num_frames; n += run) {
+		/* update the buffer_write_position */
+		pos++;
+
+		/* since it's a ring buffer we need a wrap around */
+		if (pos >= src_obj->buffer_length)
+			pos -= half;
+
+		run = MIN(num_frames - n, src_obj->buffer_length - pos);
+		m = stride * (index_input_frame + n);
+
+		/* write data to each channel */
+		for (ch = 0; ch < src_obj->num_channels; ch++) {
+			in = &input_buffers[ch][m];
+			rb = &src_obj->ring_buffers32[ch][pos];
+			for (i = 0; i < run; i++) {
+				rb[i] = *in;
+				rb[i - half] = *in;
+				in += stride;
+			}
+		}
+
+		pos += run - 1;
+	}
+
+	src_obj->buffer_write_position = pos;
+}
+
+/*
+ * Time schedule of one processing block. The state machine is run ahead
+ * for the whole block. Each scheduled output records its time value for
+ * the impulse response and the ring buffer position of the latest input
+ * sample it is filtered from.
+ */
+struct asrc_block {
+	uint32_t time_value[ASRC_BLOCK_FRAMES];
+	int position[ASRC_BLOCK_FRAMES];
+	int num_inputs;
+	int num_outputs;
+};
+
+static inline int asrc_next_position(struct asrc_farrow *src_obj,
+				     int position)
+{
+	position++;
+
+	/* since it's a ring buffer we need a wrap around */
+	if (position >= src_obj->buffer_length)
+		position -= src_obj->buffer_length >> 1;
+
+	return position;
+}
+
+/*
+ * Push mode schedule. Stops when max_inputs are consumed or when an
+ * output is due and max_outputs are already scheduled.
+ */
+static void asrc_schedule_push(struct asrc_farrow *src_obj,
+			       struct asrc_block *blk,
+			       int max_inputs, int max_outputs)
+{
+	int position = src_obj->buffer_write_position;
+
+	blk->num_inputs = 0;
+	blk->num_outputs = 0;
+
+	while (blk->num_inputs < max_inputs) {
+		if (src_obj->time_value < TIME_VALUE_ONE) {
+			if (blk->num_outputs == max_outputs)
+				break;
+
+			/* Schedule one output sample */
+			blk->time_value[blk->num_outputs] =
+				src_obj->time_value;
+			blk->position[blk->num_outputs] = position;
+			blk->num_outputs++;
+
+			/* Update time */
+			src_obj->time_value += src_obj->fs_ratio;
+		} else {
+			/* Consume one input sample */
+			position = asrc_next_position(src_obj, position);
+			blk->num_inputs++;
+
+			/* Update time */
+			src_obj->time_value -= TIME_VALUE_ONE;
+		}
+	}
+}
+
+/*
+ * Pull mode schedule. Stops when max_outputs are scheduled or when an
+ * input is due, available and ASRC_BLOCK_FRAMES inputs are already
+ * consumed. When no input is available, the time is updated without
+ * consuming one like in the per sample state machine.
+ */
+static void asrc_schedule_pull(struct asrc_farrow *src_obj,
+			       struct asrc_block *blk,
+			       int avail_inputs, int max_outputs)
+{
+	int position = src_obj->buffer_write_position;
+
+	blk->num_inputs = 0;
+	blk->num_outputs = 0;
+
+	while (blk->num_outputs < max_outputs) {
+		if (src_obj->time_value_pull < TIME_VALUE_ONE) {
+			if (blk->num_inputs < avail_inputs) {
+				if (blk->num_inputs == ASRC_BLOCK_FRAMES)
+					break;
+
+				/* Consume one input sample */
+				position = asrc_next_position(src_obj,
+							      position);
+				blk->num_inputs++;
+			}
+
+			/* Update time as Q5.27 */
+			src_obj->time_value = (((int64_t)TIME_VALUE_ONE -
+						src_obj->time_value_pull) *
+					       src_obj->fs_ratio_inv) >> 27;
+			src_obj->time_value_pull += src_obj->fs_ratio;
+		} else {
+			/* Schedule one output sample */
+			blk->time_value[blk->num_outputs] =
+				src_obj->time_value;
+			blk->position[blk->num_outputs] = position;
+			blk->num_outputs++;
+
+			/* Update time */
+			src_obj->time_value += src_obj->fs_ratio_inv;
+			src_obj->time_value_pull -= TIME_VALUE_ONE;
+		}
+	}
+}
+
+/*
+ * Filter the scheduled outputs of a block. The impulse responses are
+ * calculated for ASRC_IR_BLOCK outputs at once and each one is applied
+ * to all channels. Returns the next output frame index.
+ */
+static int asrc_filter_block16(struct asrc_farrow *src_obj,
+			       const struct asrc_block *blk,
+			       int16_t **output_buffers,
+			       int index_output_frame, bool circular)
+{
+	const int32_t *ir;
+	int count;
+	int k;
+	int n;
+
+	for (n = 0; n < blk->num_outputs; n += count) {
+		count = MIN(blk->num_outputs - n, ASRC_IR_BLOCK);
+
+		/* Calculate impulse responses */
+		(*src_obj->calc_ir)(src_obj, &blk->time_value[n], count);
+
+		/* Filter and write one output sample for each channel to
+		 * the output_buffer
 		 */
-		src_obj->ring_buffers32[ch][j] = input_buffers[ch][m];
-		src_obj->ring_buffers32[ch][k] = input_buffers[ch][m];
+		ir = src_obj->impulse_response;
+		for (k = n; k < n + count; k++) {
+			asrc_fir_filter16(src_obj, ir, blk->position[k],
+					  output_buffers, index_output_frame);
+			ir += src_obj->filter_length;
+
+			index_output_frame++;
+			if (circular &&
+			    index_output_frame >= src_obj->io_buffer_length)
+				/* Wrap around */
+				index_output_frame = 0;
+		}
+	}
+
+	return index_output_frame;
+}
+
+static int asrc_filter_block32(struct asrc_farrow *src_obj,
+			       const struct asrc_block *blk,
+			       int32_t **output_buffers,
+			       int index_output_frame, bool circular)
+{
+	/* See 'asrc_filter_block16' for a more detailed description */
+	const int32_t *ir;
+	int count;
+	int k;
+	int n;
+
+	for (n = 0; n < blk->num_outputs; n += count) {
+		count = MIN(blk->num_outputs - n, ASRC_IR_BLOCK);
+		(*src_obj->calc_ir)(src_obj, &blk->time_value[n], count);
+
+		ir = src_obj->impulse_response;
+		for (k = n; k < n + count; k++) {
+			asrc_fir_filter32(src_obj, ir, blk->position[k],
+					  output_buffers, index_output_frame);
+			ir += src_obj->filter_length;
+
+			index_output_frame++;
+			if (circular &&
+			    index_output_frame >= src_obj->io_buffer_length)
+				index_output_frame = 0;
+		}
 	}
+
+	return index_output_frame;
 }
 
 enum asrc_error_code asrc_process_push16(struct comp_dev *dev,
@@ -981,6 +1181,7 @@ enum asrc_error_code asrc_process_push16(struct comp_dev *dev,
 					 int *write_index,
 					 int read_index)
 {
+	struct asrc_block blk;
 	int index_input_frame;
 	int max_num_free_frames;
 
@@ -1012,44 +1213,38 @@ enum asrc_error_code asrc_process_push16(struct comp_dev *dev,
 	*output_num_frames = 0;
 	index_input_frame = 0;
 
-	/* Run the state machine until all input samples are read */
+	/* Run the state machine block by block until all input samples
+	 * are read
+	 */
 	while (index_input_frame < input_num_frames) {
-		if (src_obj->time_value < TIME_VALUE_ONE) {
-			if (*output_num_frames < max_num_free_frames) {
-				/* Calculate impulse response */
-				(*src_obj->calc_ir)(src_obj);
-
-				/* Filter and write one output sample for each
-				 * channel to the output_buffer
-				 */
-				asrc_fir_filter16(src_obj, output_buffers,
-						  src_obj->io_buffer_idx);
-
-				/* Update time and buffer index */
-				src_obj->time_value += src_obj->fs_ratio;
-				src_obj->io_buffer_idx++;
-				if (src_obj->io_buffer_idx >=
-				    src_obj->io_buffer_length &&
-				    src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
-					/* Wrap around */
-					src_obj->io_buffer_idx = 0;
-
-				(*output_num_frames)++;
-			} else {
-				comp_err(dev, "error onf=%d, max=%d",
-					 *output_num_frames,
-					 max_num_free_frames);
-				break;
-			}
-		} else {
-			/* Consume one input sample */
-			asrc_write_to_ring_buffer16(src_obj, input_buffers,
-						    index_input_frame);
-			index_input_frame++;
-
-			/* Update time */
-			src_obj->time_value -= TIME_VALUE_ONE;
+		/* Schedule the inputs and outputs of one block */
+		asrc_schedule_push(src_obj, &blk,
+				   MIN(input_num_frames - index_input_frame,
+				       ASRC_BLOCK_FRAMES),
+				   MIN(max_num_free_frames - *output_num_frames,
+				       ASRC_BLOCK_FRAMES));
+
+		/* An output is due but the output buffer is full */
+		if (!blk.num_inputs && !blk.num_outputs) {
+			comp_err(dev, "error onf=%d, max=%d",
+				 *output_num_frames,
+				 max_num_free_frames);
+			break;
 		}
+
+		/* Consume the input samples of the block */
+		asrc_write_to_ring_buffer16(src_obj, input_buffers,
+					    index_input_frame,
+					    blk.num_inputs);
+		index_input_frame += blk.num_inputs;
+
+		/* Filter and write the output samples of the block */
+		src_obj->io_buffer_idx =
+			asrc_filter_block16(src_obj, &blk, output_buffers,
+					    src_obj->io_buffer_idx,
+					    src_obj->io_buffer_mode ==
+					    ASRC_BM_CIRCULAR);
+		*output_num_frames += blk.num_outputs;
 	}
 	*write_index = src_obj->io_buffer_idx;
 
@@ -1097,6 +1292,7 @@ enum asrc_error_code asrc_process_push32(struct comp_dev *dev,
 	/* See 'process_push16' for a more detailed description of the
 	 * algorithm
 	 */
+	struct asrc_block blk;
 	int index_input_frame;
 	int max_num_free_frames;
 
@@ -1125,44 +1321,30 @@ enum asrc_error_code asrc_process_push32(struct comp_dev *dev,
 	*output_num_frames = 0;
 	index_input_frame = 0;
 	while (index_input_frame < input_num_frames) {
-		if (src_obj->time_value < TIME_VALUE_ONE) {
-			if (*output_num_frames < max_num_free_frames) {
-				/* Calculate impulse response */
-				(*src_obj->calc_ir)(src_obj);
-
-				/* Filter and write output sample to
-				 * output_buffer
-				 */
-				asrc_fir_filter32(src_obj, output_buffers,
-						  src_obj->io_buffer_idx);
-
-				/* Update time and index */
-				src_obj->time_value += src_obj->fs_ratio;
-				src_obj->io_buffer_idx++;
-
-				/* Wrap around */
-				if (src_obj->io_buffer_mode ==
-				    ASRC_BM_CIRCULAR &&
-				    src_obj->io_buffer_idx >=
-				    src_obj->io_buffer_length)
-					src_obj->io_buffer_idx = 0;
-
-				(*output_num_frames)++;
-			} else {
-				comp_err(dev, "error onf=%d, max=%d",
-					 *output_num_frames,
-					 max_num_free_frames);
-				break;
-			}
-		} else {
-			/* Consume input sample */
-			asrc_write_to_ring_buffer32(src_obj, input_buffers,
-						    index_input_frame);
-			index_input_frame++;
-
-			/* Update time */
-			src_obj->time_value -= TIME_VALUE_ONE;
+		asrc_schedule_push(src_obj, &blk,
+				   MIN(input_num_frames - index_input_frame,
+				       ASRC_BLOCK_FRAMES),
+				   MIN(max_num_free_frames - *output_num_frames,
+				       ASRC_BLOCK_FRAMES));
+
+		if (!blk.num_inputs && !blk.num_outputs) {
+			comp_err(dev, "error onf=%d, max=%d",
+				 *output_num_frames,
+				 max_num_free_frames);
+			break;
 		}
+
+		asrc_write_to_ring_buffer32(src_obj, input_buffers,
+					    index_input_frame,
+					    blk.num_inputs);
+		index_input_frame += blk.num_inputs;
+
+		src_obj->io_buffer_idx =
+			asrc_filter_block32(src_obj, &blk, output_buffers,
+					    src_obj->io_buffer_idx,
+					    src_obj->io_buffer_mode ==
+					    ASRC_BM_CIRCULAR);
+		*output_num_frames += blk.num_outputs;
 	}
 
 	*write_index = src_obj->io_buffer_idx;
@@ -1208,7 +1390,11 @@ enum asrc_error_code asrc_process_pull16(struct comp_dev *dev,
 					 int write_index,
 					 int *read_index)
 {
+	struct asrc_block blk;
 	int index_output_frame = 0;
+	int num_frames;
+	int avail;
+	int run;
 
 	/* parameter error handling */
 	if (!src_obj || !input_buffers || !output_buffers ||
@@ -1227,45 +1413,49 @@ enum asrc_error_code asrc_process_pull16(struct comp_dev *dev,
 		/* linear */
 		src_obj->io_buffer_idx = 0;
 
+	/* Number of input frames between read and write index */
+	avail = write_index - src_obj->io_buffer_idx;
+	if (avail < 0 && src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
+		avail += src_obj->io_buffer_length;
+
 	*input_num_frames = 0;
 
-	/* Run state machine until number of output samples are written */
+	/* Run state machine block by block until number of output samples
+	 * are written
+	 */
 	while (index_output_frame < output_num_frames) {
-		if (src_obj->time_value_pull < TIME_VALUE_ONE) {
-			/* Consume one input sample */
-			if (src_obj->io_buffer_idx != write_index) {
-				asrc_write_to_ring_buffer16(src_obj,
-							    input_buffers,
-							    src_obj->io_buffer_idx);
-				src_obj->io_buffer_idx++;
+		/* Schedule the inputs and outputs of one block */
+		asrc_schedule_pull(src_obj, &blk, avail - *input_num_frames,
+				   MIN(output_num_frames - index_output_frame,
+				       ASRC_BLOCK_FRAMES));
 
-				/* Wrap around */
-				if (src_obj->io_buffer_idx >=
-				    src_obj->io_buffer_length &&
-				    src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
-					src_obj->io_buffer_idx = 0;
-
-				(*input_num_frames)++;
-			}
-
-			/* Update time as Q5.27 */
-			src_obj->time_value = (((int64_t)TIME_VALUE_ONE -
-						src_obj->time_value_pull) *
-					       src_obj->fs_ratio_inv) >> 27;
-			src_obj->time_value_pull += src_obj->fs_ratio;
-		} else {
-			/* Calculate impulse response */
-			(*src_obj->calc_ir)(src_obj);
-
-			/* Filter and write output sample to output_buffer */
-			asrc_fir_filter16(src_obj, output_buffers,
-					  index_output_frame);
+		/* Consume the input samples of the block, in runs up to
+		 * the end of a circular input buffer
+		 */
+		for (num_frames = 0; num_frames < blk.num_inputs;
+		     num_frames += run) {
+			run = blk.num_inputs - num_frames;
+			if (src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
+				run = MIN(run, src_obj->io_buffer_length -
+					  src_obj->io_buffer_idx);
 
-			/* Update time and index */
-			src_obj->time_value += src_obj->fs_ratio_inv;
-			src_obj->time_value_pull -= TIME_VALUE_ONE;
-			index_output_frame++;
+			asrc_write_to_ring_buffer16(src_obj, input_buffers,
+						    src_obj->io_buffer_idx,
+						    run);
+			src_obj->io_buffer_idx += run;
+
+			/* Wrap around */
+			if (src_obj->io_buffer_idx >=
+			    src_obj->io_buffer_length &&
+			    src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
+				src_obj->io_buffer_idx = 0;
 		}
+		*input_num_frames += blk.num_inputs;
+
+		/* Filter and write the output samples of the block */
+		index_output_frame =
+			asrc_filter_block16(src_obj, &blk, output_buffers,
+					    index_output_frame, false);
 	}
 	*read_index = src_obj->io_buffer_idx;
 
@@ -1310,7 +1500,11 @@ enum asrc_error_code asrc_process_pull32(struct comp_dev *dev,
 					 int write_index,
 					 int *read_index)
 {
+	struct asrc_block blk;
 	int index_output_frame = 0;
+	int num_frames;
+	int avail;
+	int run;
 
 	/* parameter error handling */
 	if (!src_obj || !input_buffers || !output_buffers ||
@@ -1332,43 +1526,39 @@ enum asrc_error_code asrc_process_pull32(struct comp_dev *dev,
 	else
 		src_obj->io_buffer_idx = 0;
 
+	avail = write_index - src_obj->io_buffer_idx;
+	if (avail < 0 && src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
+		avail += src_obj->io_buffer_length;
+
 	*input_num_frames = 0;
 	while (index_output_frame < output_num_frames) {
-		if (src_obj->time_value_pull < TIME_VALUE_ONE) {
-			/* Consume input sample */
-			if (src_obj->io_buffer_idx != write_index) {
-				asrc_write_to_ring_buffer32(src_obj,
-							    input_buffers,
-							    src_obj->io_buffer_idx);
-				src_obj->io_buffer_idx++;
-
-				/* Wrap around */
-				if (src_obj->io_buffer_idx >=
-				    src_obj->io_buffer_length &&
-				    src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
-					src_obj->io_buffer_idx = 0;
+		asrc_schedule_pull(src_obj, &blk, avail - *input_num_frames,
+				   MIN(output_num_frames - index_output_frame,
+				       ASRC_BLOCK_FRAMES));
 
-				(*input_num_frames)++;
-			}
+		for (num_frames = 0; num_frames < blk.num_inputs;
+		     num_frames += run) {
+			run = blk.num_inputs - num_frames;
+			if (src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
+				run = MIN(run, src_obj->io_buffer_length -
+					  src_obj->io_buffer_idx);
 
-			/* Update time as Q5.27 */
-			src_obj->time_value = (((int64_t)TIME_VALUE_ONE -
-						src_obj->time_value_pull) *
-					       src_obj->fs_ratio_inv) >> 27;
-			src_obj->time_value_pull += src_obj->fs_ratio;
-		} else {
-			/* Calculate impulse response */
-			(*src_obj->calc_ir)(src_obj);
-
-			/* Filter and write output sample to output_buffer */
-			asrc_fir_filter32(src_obj, output_buffers,
-					  index_output_frame);
-
-			/* Update time and index */
-			src_obj->time_value += src_obj->fs_ratio_inv;
-			src_obj->time_value_pull -= TIME_VALUE_ONE;
-			index_output_frame++;
+			asrc_write_to_ring_buffer32(src_obj, input_buffers,
+						    src_obj->io_buffer_idx,
+						    run);
+			src_obj->io_buffer_idx += run;
+
+			/* Wrap around */
+			if (src_obj->io_buffer_idx >=
+			    src_obj->io_buffer_length &&
+			    src_obj->io_buffer_mode == ASRC_BM_CIRCULAR)
+				src_obj->io_buffer_idx = 0;
 		}
+		*input_num_frames += blk.num_inputs;
+
+		index_output_frame =
+			asrc_filter_block32(src_obj, &blk, output_buffers,
+					    index_output_frame, false);
 	}
 	*read_index = src_obj->io_buffer_idx;
 
@@ -9,13 +9,14 @@
 #include <sof/audio/asrc/asrc_farrow.h>
 #include <sof/audio/format.h>
 
-void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
+void asrc_fir_filter16(struct asrc_farrow *src_obj, const int32_t *ir,
+		       int position, int16_t **output_buffers,
 		       int index_output_frame)
 {
 	int64_t prod;
 	int32_t prod32;
 	int16_t prod16;
-	int32_t *filter_p;
+	const int32_t *filter_p;
 	int16_t *buffer_p;
 	int ch;
 	int n;
@@ -29,11 +30,10 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	/* Iterate over each channel */
 	for (ch = 0; ch < src_obj->num_channels; ch++) {
 		/* Pointer to the beginning of the impulse response */
-		filter_p = &src_obj->impulse_response[0];
+		filter_p = ir;
 
 		/* Pointer to the buffered input data */
-		buffer_p = &src_obj->ring_buffers16[ch]
-			[src_obj->buffer_write_position];
+		buffer_p = &src_obj->ring_buffers16[ch][position];
 
 		/* Initialise the accumulator */
 		prod = 0;
@@ -58,7 +58,8 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	}
 }
 
-void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
+void asrc_fir_filter32(struct asrc_farrow *src_obj, const int32_t *ir,
+		       int position, int32_t **output_buffers,
 		       int index_output_frame)
 {
 	int64_t prod;
@@ -77,11 +78,10 @@ void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
 	/* Iterate over each channel */
 	for (ch = 0; ch < src_obj->num_channels; ch++) {
 		/* Pointer to the beginning of the impulse response */
-		filter_p = &src_obj->impulse_response[0];
+		filter_p = ir;
 
 		/* Pointer to the buffered input data */
-		buffer_p = &src_obj->ring_buffers32[ch]
-			[src_obj->buffer_write_position];
+		buffer_p = &src_obj->ring_buffers32[ch][position];
 
 		/* Initialise the accumulator */
 		prod = 0;
@@ -111,36 +111,45 @@ void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
 
 /* + ALGORITHM SPECIFIC FUNCTIONS */
 
-void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
+/* Highest number of polyphase filters of any conversion ratio */
+#define ASRC_MAX_NUM_FILTERS	7
+
+static inline void asrc_calc_impulse_response(struct asrc_farrow *src_obj,
+					      const uint32_t *time_values,
+					      int count, int num_filters)
 {
-	int32_t time;
-	int32_t accum20l; /* Coefficient for ^2 and ^0, l matches HiFi3 ver */
-	int32_t accum20h; /* Coefficient for ^2 and ^0, h matches HiFi3 ver */
-	int32_t accum31l; /* Coefficient for ^3 and ^1 polynomial terms */
-	int32_t accum31h; /* Coefficient for ^3 and ^1 polynomial terms */
+	int32_t time[ASRC_IR_BLOCK];
+	int32_t coef_l[ASRC_MAX_NUM_FILTERS]; /* l matches HiFi3 ver */
+	int32_t coef_h[ASRC_MAX_NUM_FILTERS]; /* h matches HiFi3 ver */
+	int32_t accum_l;
+	int32_t accum_h;
 	const int32_t *filter_P;
 	int32_t *result_P;
+	int filter_length = src_obj->filter_length;
 	int index_filter;
 	int index_limit;
+	int j;
+	int k;
 
-	/* Set the pointer tot the polyphase filters */
+	/* Set the pointer to the polyphase filters */
 	filter_P = &src_obj->polyphase_filters[0];
 
 	/*
-	 * Set the pointer to the impulse response.
-	 * This is where the result is stored.
+	 * Set the pointer to the first impulse response.
+	 * This is where the results are stored.
 	 */
 	result_P = &src_obj->impulse_response[0];
 
-	/* Get the current fractional time */
-	time = sat_int32(((int64_t)src_obj->time_value) << 4);
+	/* Get the fractional times of all outputs */
+	for (k = 0; k < count; k++)
+		time[k] = sat_int32(((int64_t)time_values[k]) << 4);
 
 	/*
 	 * Generates two impulse response bins per iterations.
 	 * 'index_limit' is therefore stored to reduce redundant
 	 * calculations.
 	 */
-	index_limit = src_obj->filter_length >> 1;
+	index_limit = filter_length >> 1;
 	for (index_filter = 0; index_filter < index_limit; index_filter++) {
 		/*
 		 * The polyphase filters lie in storage as follows
@@ -150,212 +159,67 @@ void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
 		 *
 		 * Since the polyphase filter coefficients are stored
 		 * in an appropriate order, we can just load them up,
-		 * one after another.
+		 * one after another. They are loaded once and then
+		 * used for all the outputs of the block.
 		 */
-
-		/* Load two coefficients of the 4th polyphase filter */
-		accum31l = *filter_P++;
-		accum31h = *filter_P++;
-
-		/* Load two coefficients of the 3rd polyphase filter */
-		accum20l = *filter_P++;
-		accum20h = *filter_P++;
-
-		/*
-		 * Use the 'Horner's Method' to calculate the result
-		 * in a numerically stable and efficient way:
-		 *
-		 * Example for one coefficient (N = 4):
-		 * g_out,m = ((g3,m*t + g2,m)*t + g1,m)*t + g0,m
-		 *
-		 * Q1.31 x Q1.31 -> Q2.62
-		 *
-		 */
-		accum20l += q_multsr_sat_32x32(accum31l, time, 62 - 31);
-		accum20h += q_multsr_sat_32x32(accum31h, time, 62 - 31);
-
-		/* Load two coefficients of the second polyphase filter */
-		accum31l = *filter_P++;
-		accum31h = *filter_P++;
-
-		/* Multiply and accumulate */
-		accum31l += q_multsr_sat_32x32(accum20l, time, 62 - 31);
-		accum31h += q_multsr_sat_32x32(accum20h, time, 62 - 31);
-
-		/* Load two coefficients of the first polyphase filter */
-		accum20l = *filter_P++;
-		accum20h = *filter_P++;
-
-		/* Multiply and accumulate */
-		accum20l += q_multsr_sat_32x32(accum31l, time, 62 - 31);
-		accum20h += q_multsr_sat_32x32(accum31h, time, 62 - 31);
-
-		/* Store the result */
-		*result_P++ = accum20l;
-		*result_P++ = accum20h;
+		for (j = 0; j < num_filters; j++) {
+			coef_l[j] = *filter_P++;
+			coef_h[j] = *filter_P++;
+		}
+
+		for (k = 0; k < count; k++) {
+			/*
+			 * Use the 'Horner's Method' to calculate the
+			 * result in a numerically stable and efficient
+			 * way:
+			 *
+			 * Example for one coefficient (N = 4):
+			 * g_out,m = ((g3,m*t + g2,m)*t + g1,m)*t + g0,m
+			 *
+			 * Q1.31 x Q1.31 -> Q2.62
+			 */
+			accum_l = coef_l[0];
+			accum_h = coef_h[0];
+			for (j = 1; j < num_filters; j++) {
+				accum_l = coef_l[j] +
+					q_multsr_sat_32x32(accum_l, time[k],
+							   62 - 31);
+				accum_h = coef_h[j] +
+					q_multsr_sat_32x32(accum_h, time[k],
+							   62 - 31);
+			}
+
+			/* Store the result to the k-th impulse response */
+			result_P[k * filter_length] = accum_l;
+			result_P[k * filter_length + 1] = accum_h;
+		}
+
+		result_P += 2;
 	}
 }
 
-void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
+void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
 {
-	/*
-	 * See 'calc_impulse_response_n4' for a detailed description
-	 * of the algorithm and data handling
-	 */
-	int32_t time;
-	int32_t accum31l;
-	int32_t accum31h;
-	int32_t accum420l;
-	int32_t accum420h;
-	const int32_t *filter_P;
-	int32_t *result_P;
-	int index_filter;
-	int index_limit;
-
-	filter_P = &src_obj->polyphase_filters[0];
-	result_P = &src_obj->impulse_response[0];
-	time = sat_int32(((int64_t)src_obj->time_value) << 4);
-
-	index_limit = src_obj->filter_length >> 1;
-	for (index_filter = 0; index_filter < index_limit; index_filter++) {
-		accum420l = *filter_P++;
-		accum420h = *filter_P++;
-		accum31l = *filter_P++;
-		accum31h = *filter_P++;
-		accum31l += q_multsr_sat_32x32(accum420l, time, 62 - 31);
-		accum31h += q_multsr_sat_32x32(accum420h, time, 62 - 31);
-
-		accum420l = *filter_P++;
-		accum420h = *filter_P++;
-		accum420l += q_multsr_sat_32x32(accum31l, time, 62 - 31);
-		accum420h += q_multsr_sat_32x32(accum31h, time, 62 - 31);
-
-		accum31l = *filter_P++;
-		accum31h = *filter_P++;
-		accum31l += q_multsr_sat_32x32(accum420l, time, 62 - 31);
-		accum31h += q_multsr_sat_32x32(accum420h, time, 62 - 31);
-
-		accum420l = *filter_P++;
-		accum420h = *filter_P++;
-		accum420l += q_multsr_sat_32x32(accum31l, time, 62 - 31);
-		accum420h += q_multsr_sat_32x32(accum31h, time, 62 - 31);
-
-		*result_P++ = accum420l;
-		*result_P++ = accum420h;
-	}
+	asrc_calc_impulse_response(src_obj, time_values, count, 4);
 }
 
-void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
+void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
 {
-	/*
-	 * See 'calc_impulse_response_n4' for a detailed description
-	 * of the algorithm and data handling
-	 */
-	int32_t time;
-	int32_t accum531l;
-	int32_t accum531h;
-	int32_t accum420l;
-	int32_t accum420h;
-	const int32_t *filter_P;
-	int32_t *result_P;
-	int index_filter;
-	int index_limit;
-
-	filter_P = &src_obj->polyphase_filters[0];
-	result_P = &src_obj->impulse_response[0];
-	time = sat_int32(((int64_t)src_obj->time_value) << 4);
-
-	index_limit = src_obj->filter_length >> 1;
-	for (index_filter = 0; index_filter < index_limit; index_filter++) {
-		accum531l = *filter_P++;
-		accum531h = *filter_P++;
-		accum420l = *filter_P++;
-		accum420h = *filter_P++;
-		accum420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
-		accum420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
-
-		accum531l = *filter_P++;
-		accum531h = *filter_P++;
-		accum531l += q_multsr_sat_32x32(accum420l, time, 62 - 31);
-		accum531h += q_multsr_sat_32x32(accum420h, time, 62 - 31);
-
-		accum420l = *filter_P++;
-		accum420h = *filter_P++;
-		accum420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
-		accum420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
-
-		accum531l = *filter_P++;
-		accum531h = *filter_P++;
-		accum531l += q_multsr_sat_32x32(accum420l, time, 62 - 31);
-		accum531h += q_multsr_sat_32x32(accum420h, time, 62 - 31);
-
-		accum420l = *filter_P++;
-		accum420h = *filter_P++;
-		accum420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
-		accum420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
-
-		*result_P++ = accum420l;
-		*result_P++ = accum420h;
-	}
+	asrc_calc_impulse_response(src_obj, time_values, count, 5);
 }
 
-void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
+void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
 {
-	/*
-	 * See 'calc_impulse_response_n4' for a detailed description
-	 * of the algorithm and data handling
-	 */
-	int32_t time;
-	int32_t accum6420l;
-	int32_t accum6420h;
-	int32_t accum531l;
-	int32_t accum531h;
-	const int32_t *filter_P;
-	int32_t *result_P;
-	int index_filter;
-	int index_limit;
-
-	filter_P = &src_obj->polyphase_filters[0];
-	result_P = &src_obj->impulse_response[0];
-	time = sat_int32(((int64_t)src_obj->time_value) << 4);
+	asrc_calc_impulse_response(src_obj, time_values, count, 6);
+}
 
-	index_limit = src_obj->filter_length >> 1;
-	for (index_filter = 0; index_filter < index_limit; index_filter++) {
-		accum6420l = *filter_P++;
-		accum6420h = *filter_P++;
-		accum531l = *filter_P++;
-		accum531h = *filter_P++;
-		accum531l += q_multsr_sat_32x32(accum6420l, time, 62 - 31);
-		accum531h += q_multsr_sat_32x32(accum6420h, time, 62 - 31);
-
-		accum6420l = *filter_P++;
-		accum6420h = *filter_P++;
-		accum6420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
-		accum6420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
-
-		accum531l = *filter_P++;
-		accum531h = *filter_P++;
-		accum531l += q_multsr_sat_32x32(accum6420l, time, 62 - 31);
-		accum531h += q_multsr_sat_32x32(accum6420h, time, 62 - 31);
-
-		accum6420l = *filter_P++;
-		accum6420h = *filter_P++;
-		accum6420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
-		accum6420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
-
-		accum531l = *filter_P++;
-		accum531h = *filter_P++;
-		accum531l += q_multsr_sat_32x32(accum6420l, time, 62 - 31);
-		accum531h += q_multsr_sat_32x32(accum6420h, time, 62 - 31);
-
-		accum6420l = *filter_P++;
-		accum6420h = *filter_P++;
-		accum6420l += q_multsr_sat_32x32(accum531l, time, 62 - 31);
-		accum6420h += q_multsr_sat_32x32(accum531h, time, 62 - 31);
-
-		*result_P++ = accum6420l;
-		*result_P++ = accum6420h;
-	}
+void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
+{
+	asrc_calc_impulse_response(src_obj, time_values, count, 7);
 }
 
 #endif /* ASRC_GENERIC */
@@ -9,7 +9,8 @@
 
 #include <xtensa/tie/xt_hifi3.h>
 
-void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
+void asrc_fir_filter16(struct asrc_farrow *src_obj, const int32_t *ir,
+		       int position, int16_t **output_buffers,
 		       int index_output_frame)
 {
 	ae_f32x2 prod;
@@ -37,12 +38,10 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	/* Iterate over each channel */
 	for (ch = 0; ch < src_obj->num_channels; ch++) {
 		/* Pointer to the beginning of the impulse response */
-		filter_p = (ae_f32x2 *)&src_obj->impulse_response[0];
+		filter_p = (ae_f32x2 *)ir;
 
 		/* Pointer to the buffered input data */
-		buffer_p =
-			(ae_f16x4 *)&src_obj->ring_buffers16[ch]
-			[src_obj->buffer_write_position];
+		buffer_p = (ae_f16x4 *)&src_obj->ring_buffers16[ch][position];
 
 		/* Allows unaligned load of 64 bit per cycle */
 		ae_valign align_filter = AE_LA64_PP(filter_p);
@@ -95,7 +94,8 @@ void asrc_fir_filter16(struct asrc_farrow *src_obj, int16_t **output_buffers,
 	}
 }
 
-void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
+void asrc_fir_filter32(struct asrc_farrow *src_obj, const int32_t *ir,
+		       int position, int32_t **output_buffers,
 		       int index_output_frame)
 {
 	ae_f32x2 prod;
@@ -122,12 +122,10 @@ void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
 	/* Iterate over each channel */
 	for (ch = 0; ch < src_obj->num_channels; ch++) {
 		/* Pointer to the beginning of the impulse response */
-		filter_p = (ae_f32x2 *)&src_obj->impulse_response[0];
+		filter_p = (ae_f32x2 *)ir;
 
 		/* Pointer to the buffered input data */
-		buffer_p =
-			(ae_f32x2 *)&src_obj->ring_buffers32[ch]
-			[src_obj->buffer_write_position];
+		buffer_p = (ae_f32x2 *)&src_obj->ring_buffers32[ch][position];
 
 		/* Allows unaligned load of 64 bit per cycle */
 		ae_valign align_filter = AE_LA64_PP(filter_p);
@@ -176,7 +174,8 @@ void asrc_fir_filter32(struct asrc_farrow *src_obj, int32_t **output_buffers,
 
 /* + ALGORITHM SPECIFIC FUNCTIONS */
 
-void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
+static void asrc_calc_ir_n4(struct asrc_farrow *src_obj,
+			    const uint32_t *time_value, int32_t *ir)
 {
 	ae_f32x2 time_x2;
 	ae_f32x2 accum20 = AE_ZERO32(); /* Note: Init is not needed */
@@ -195,14 +194,14 @@ void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
 	 * Set the pointer to the impulse response.
 	 * This is where the result is stored.
 	 */
-	result_P = (ae_f32x2 *)&src_obj->impulse_response[0];
+	result_P = (ae_f32x2 *)ir;
 
 	/* allow unaligned load of 64 bit of polyphase filter coefficients */
 	align_f = AE_LA64_PP(filter_P);
 	align_out = AE_ZALIGN64();
 
-	/* Get the current fractional time */
-	time_x2 = AE_L32_X((ae_f32 *)&src_obj->time_value, 0);
+	/* Get the fractional time of this output */
+	time_x2 = AE_L32_X((ae_f32 *)time_value, 0);
 	time_x2 = AE_SLAI32S(time_x2, 4);
 
 	/*
@@ -255,10 +254,11 @@ void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj)
 	AE_SA64POS_FP(align_out, result_P);
 }
 
-void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
+static void asrc_calc_ir_n5(struct asrc_farrow *src_obj,
+			    const uint32_t *time_value, int32_t *ir)
 {
 	/*
-	 * See 'calc_impulse_response_n4' for a detailed description
+	 * See 'asrc_calc_ir_n4' for a detailed description
 	 * of the algorithm and data handling
 	 */
 	ae_f32x2 time_x2;
@@ -272,12 +272,12 @@ void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
 	int index_limit;
 
 	filter_P = (ae_f32x2 *)&src_obj->polyphase_filters[0];
-	result_P = (ae_f32x2 *)&src_obj->impulse_response[0];
+	result_P = (ae_f32x2 *)ir;
 
 	align_f = AE_LA64_PP(filter_P);
 	align_out = AE_ZALIGN64();
 
-	time_x2 = AE_L32_X((ae_f32 *)&src_obj->time_value, 0);
+	time_x2 = AE_L32_X((ae_f32 *)time_value, 0);
 	time_x2 = AE_SLAI32S(time_x2, 4);
 
 	index_limit = src_obj->filter_length >> 1;
@@ -300,10 +300,11 @@ void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj)
 	AE_SA64POS_FP(align_out, result_P);
 }
 
-void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
+static void asrc_calc_ir_n6(struct asrc_farrow *src_obj,
+			    const uint32_t *time_value, int32_t *ir)
 {
 	/*
-	 * See 'calc_impulse_response_n4' for a detailed description
+	 * See 'asrc_calc_ir_n4' for a detailed description
 	 * of the algorithm and data handling
 	 */
 	ae_f32x2 time_x2;
@@ -317,12 +318,12 @@ void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
 	int index_limit;
 
 	filter_P = (ae_f32x2 *)&src_obj->polyphase_filters[0];
-	result_P = (ae_f32x2 *)&src_obj->impulse_response[0];
+	result_P = (ae_f32x2 *)ir;
 
 	align_f = AE_LA64_PP(filter_P);
 	align_out = AE_ZALIGN64();
 
-	time_x2 = AE_L32_X((ae_f32 *)&src_obj->time_value, 0);
+	time_x2 = AE_L32_X((ae_f32 *)time_value, 0);
 	time_x2 = AE_SLAI32S(time_x2, 4);
 
 	index_limit = src_obj->filter_length >> 1;
@@ -348,10 +349,11 @@ void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj)
 	AE_SA64POS_FP(align_out, result_P);
 }
 
-void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
+static void asrc_calc_ir_n7(struct asrc_farrow *src_obj,
+			    const uint32_t *time_value, int32_t *ir)
 {
 	/*
-	 * See 'calc_impulse_response_n4' for a detailed description
+	 * See 'asrc_calc_ir_n4' for a detailed description
 	 * of the algorithm and data handling
 	 */
 	ae_f32x2 time_x2;
@@ -365,12 +367,12 @@ void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
 	int index_limit;
 
 	filter_P = (ae_f32x2 *)&src_obj->polyphase_filters[0];
-	result_P = (ae_f32x2 *)&src_obj->impulse_response[0];
+	result_P = (ae_f32x2 *)ir;
 
 	align_f = AE_LA64_PP(filter_P);
 	align_out = AE_ZALIGN64();
 
-	time_x2 = AE_L32_X((ae_f32 *)&src_obj->time_value, 0);
+	time_x2 = AE_L32_X((ae_f32 *)time_value, 0);
 	time_x2 = AE_SLAI32S(time_x2, 4);
 
 	index_limit = src_obj->filter_length >> 1;
@@ -399,4 +401,45 @@ void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj)
 	AE_SA64POS_FP(align_out, result_P);
 }
 
+/*
+ * The block versions evaluate the polynomials with the SIMD kernels
+ * above, one impulse response per output of the block.
+ */
+static void asrc_calc_ir_block(struct asrc_farrow *src_obj,
+			       const uint32_t *time_values, int count,
+			       void (*calc_ir)(struct asrc_farrow *src_obj,
+					       const uint32_t *time_value,
+					       int32_t *ir))
+{
+	int k;
+
+	for (k = 0; k < count; k++)
+		calc_ir(src_obj, &time_values[k],
+			src_obj->impulse_response + k * src_obj->filter_length);
+}
+
+void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
+{
+	asrc_calc_ir_block(src_obj, time_values, count, asrc_calc_ir_n4);
+}
+
+void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
+{
+	asrc_calc_ir_block(src_obj, time_values, count, asrc_calc_ir_n5);
+}
+
+void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
+{
+	asrc_calc_ir_block(src_obj, time_values, count, asrc_calc_ir_n6);
+}
+
+void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count)
+{
+	asrc_calc_ir_block(src_obj, time_values, count, asrc_calc_ir_n7);
+}
+
 #endif /* ASRC Hifi3 */
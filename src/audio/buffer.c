@@ -6,7 +6,9 @@
 //         Keyon Jie <yang.jie@linux.intel.com>
 
 #include <sof/audio/buffer.h>
+#include <sof/audio/buffer_cache.h>
 #include <sof/audio/component.h>
+#include <sof/audio/latency.h>
 #include <sof/drivers/interrupt.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
@@ -31,6 +33,11 @@ struct comp_buffer *buffer_alloc(uint32_t size, uint32_t caps, uint32_t align)
 		return NULL;
 	}
 
+	/* a buffer freed by a closed stream comes with its memory */
+	buffer = buffer_cache_get(size, caps, align);
+	if (buffer)
+		goto init;
+
 	/* allocate new buffer */
 	buffer = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
 			 sizeof(*buffer));
@@ -50,6 +57,9 @@ struct comp_buffer *buffer_alloc(uint32_t size, uint32_t caps, uint32_t align)
 		return NULL;
 	}
 
+	buffer->alloc_size = size;
+
+init:
 	buffer_init(buffer, size, caps);
 
 	list_init(&buffer->source_list);
@@ -100,8 +110,10 @@ int buffer_set_size(struct comp_buffer *buffer, uint32_t size)
 	}
 
 	/* use bigger chunk, else just use the old chunk but set smaller */
-	if (new_ptr)
+	if (new_ptr) {
 		buffer->stream.addr = new_ptr;
+		buffer->alloc_size = size;
+	}
 
 	buffer_init(buffer, size, buffer->caps);
 
@@ -125,10 +137,94 @@ void buffer_free(struct comp_buffer *buffer)
 
 	list_item_del(&buffer->source_list);
 	list_item_del(&buffer->sink_list);
-	rfree(buffer->stream.addr);
+
+	/* the memory of an in place chain stays with its first buffer */
+	if (buffer->alias_next)
+		buffer->alias_next->alias_prev = buffer->alias_prev;
+	if (buffer->alias_prev) {
+		buffer->alias_prev->alias_next = buffer->alias_next;
+	} else if (!buffer->alias_next) {
+		/* a buffer with memory of its own is kept for reuse */
+		if (buffer_cache_put(buffer))
+			return;
+
+		rfree(buffer->stream.addr);
+	}
+
 	rfree(buffer);
 }
 
+/* points buffer and the buffers aliasing it to the memory at addr */
+static void buffer_alias_set_addr(struct comp_buffer *buffer, void *addr,
+				  uint32_t size)
+{
+	for (; buffer; buffer = buffer->alias_next) {
+		buffer->stream.addr = addr;
+		buffer_init(buffer, size, buffer->caps);
+	}
+}
+
+/* Lets the in place component between source and sink write the sink
+ * over the source data it consumes. The memory of sink is freed, both
+ * buffers must have the same size and caps.
+ */
+void buffer_alias(struct comp_buffer *source, struct comp_buffer *sink)
+{
+	assert(!source->alias_next && !sink->alias_prev);
+	assert(source->stream.size == sink->stream.size);
+
+	tracev_buffer_with_ids(sink, "buffer_alias(), source buffer %u",
+			       source->id);
+
+	rfree(sink->stream.addr);
+
+	source->alias_next = sink;
+	sink->alias_prev = source;
+	buffer_alias_set_addr(sink, source->stream.addr, source->stream.size);
+}
+
+/* gives buffer its own memory again, buffers aliasing it move along */
+int buffer_unalias(struct comp_buffer *buffer)
+{
+	void *addr;
+
+	if (!buffer->alias_prev)
+		return 0;
+
+	addr = rballoc_align(0, buffer->caps, buffer->stream.size,
+			     PLATFORM_DCACHE_ALIGN);
+	if (!addr) {
+		trace_buffer_error_with_ids(buffer, "buffer_unalias() error: can't alloc %u bytes",
+					    buffer->stream.size);
+		return -ENOMEM;
+	}
+
+	tracev_buffer_with_ids(buffer, "buffer_unalias()");
+
+	buffer->alias_prev->alias_next = NULL;
+	buffer->alias_prev = NULL;
+	buffer->alloc_size = buffer->stream.size;
+	buffer_alias_set_addr(buffer, addr, buffer->stream.size);
+
+	return 0;
+}
+
+/* Data not yet consumed from later buffers of an in place chain occupies
+ * the shared memory, it is not free for the earlier buffers.
+ */
+static void buffer_alias_update(struct comp_buffer *buffer)
+{
+	uint32_t avail = 0;
+
+	while (buffer->alias_next)
+		buffer = buffer->alias_next;
+
+	for (; buffer; buffer = buffer->alias_prev) {
+		avail = MIN(avail + buffer->stream.avail, buffer->stream.size);
+		buffer->stream.free = buffer->stream.size - avail;
+	}
+}
+
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 {
 	uint32_t flags;
@@ -152,7 +248,10 @@ void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes)
 
 	irq_local_disable(flags);
 
+	latency_produce(buffer, bytes);
 	audio_stream_produce(&buffer->stream, bytes);
+	if (buffer->alias_prev || buffer->alias_next)
+		buffer_alias_update(buffer);
 
 	notifier_event(buffer, NOTIFIER_ID_BUFFER_PRODUCE,
 		       NOTIFIER_TARGET_CORE_LOCAL, &cb_data, sizeof(cb_data));
@@ -195,7 +294,10 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 
 	irq_local_disable(flags);
 
+	latency_consume(buffer, bytes);
 	audio_stream_consume(&buffer->stream, bytes);
+	if (buffer->alias_prev || buffer->alias_next)
+		buffer_alias_update(buffer);
 
 	notifier_event(buffer, NOTIFIER_ID_BUFFER_CONSUME,
 		       NOTIFIER_TARGET_CORE_LOCAL, &cb_data, sizeof(cb_data));
@@ -212,3 +314,18 @@ void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes)
 			       ((char *)buffer->stream.r_ptr - addr) << 16 |
 			       ((char *)buffer->stream.w_ptr - addr));
 }
+
+void buffer_rewind(struct comp_buffer *buffer, uint32_t bytes)
+{
+	uint32_t flags;
+
+	tracev_buffer_with_ids(buffer, "buffer_rewind(), bytes = %u", bytes);
+
+	irq_local_disable(flags);
+
+	audio_stream_rewind(&buffer->stream, bytes);
+	if (buffer->alias_prev || buffer->alias_next)
+		buffer_alias_update(buffer);
+
+	irq_local_enable(flags);
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/buffer_cache.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/sof.h>
+#include <sof/spinlock.h>
+#include <sof/string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static SHARED_DATA struct buffer_cache cache;
+
+static inline struct buffer_cache *buffer_cache_get_cache(void)
+{
+	return sof_get()->buffer_cache;
+}
+
+static inline int buffer_cache_bucket(uint32_t size)
+{
+	uint32_t kb = size >> 10;
+	int bucket = kb ? 32 - __builtin_clz(kb) : 0;
+
+	return MIN(bucket, BUFFER_CACHE_BUCKETS - 1);
+}
+
+/* the cache links buffers through the source list, they are unconnected */
+static inline struct comp_buffer *buffer_cache_item(struct list_item *item)
+{
+	return container_of(item, struct comp_buffer, source_list);
+}
+
+struct comp_buffer *buffer_cache_get(uint32_t size, uint32_t caps,
+				     uint32_t align)
+{
+	struct buffer_cache *bc = buffer_cache_get_cache();
+	struct comp_buffer *buffer = NULL;
+	struct list_item *bucket;
+	struct list_item *item;
+	void *addr;
+	uint32_t flags;
+
+	if (!bc)
+		return NULL;
+
+	bucket = &bc->buckets[buffer_cache_bucket(size)];
+
+	spin_lock_irq(&bc->lock, flags);
+
+	/* the most recently freed buffer is the most likely still cached */
+	list_for_item(item, bucket) {
+		buffer = buffer_cache_item(item);
+		if (buffer->alloc_size == size && buffer->caps == caps &&
+		    buffer->core == cpu_get_id() &&
+		    !((uintptr_t)buffer->stream.addr % align))
+			break;
+		buffer = NULL;
+	}
+
+	if (buffer) {
+		list_item_del(&buffer->source_list);
+		bc->count--;
+		bc->bytes -= size;
+		bc->hits++;
+	} else {
+		bc->misses++;
+	}
+
+	spin_unlock_irq(&bc->lock, flags);
+
+	if (!buffer)
+		return NULL;
+
+	addr = buffer->stream.addr;
+	bzero(buffer, sizeof(*buffer));
+	buffer->stream.addr = addr;
+	buffer->alloc_size = size;
+
+	return buffer;
+}
+
+bool buffer_cache_put(struct comp_buffer *buffer)
+{
+	struct buffer_cache *bc = buffer_cache_get_cache();
+	uint32_t size = buffer->alloc_size;
+	uint32_t flags;
+	bool cached = false;
+
+	if (!bc)
+		return false;
+
+	/* the buffer is looked up on the core that frees it */
+	buffer->core = cpu_get_id();
+
+	spin_lock_irq(&bc->lock, flags);
+
+	if (bc->bytes + size <= CONFIG_BUFFER_CACHE_SIZE) {
+		list_item_prepend(&buffer->source_list,
+				  &bc->buckets[buffer_cache_bucket(size)]);
+		bc->count++;
+		bc->bytes += size;
+		bc->peak_bytes = MAX(bc->peak_bytes, bc->bytes);
+		cached = true;
+	}
+
+	spin_unlock_irq(&bc->lock, flags);
+
+	return cached;
+}
+
+uint32_t buffer_cache_trim(uint32_t bytes)
+{
+	struct buffer_cache *bc = buffer_cache_get_cache();
+	struct comp_buffer *buffer;
+	struct list_item trim;
+	struct list_item *item;
+	struct list_item *tmp;
+	uint32_t freed = 0;
+	uint32_t flags;
+	int i;
+
+	if (!bc)
+		return 0;
+
+	list_init(&trim);
+
+	spin_lock_irq(&bc->lock, flags);
+
+	/* the oldest buffers of the largest bucket go first */
+	for (i = BUFFER_CACHE_BUCKETS - 1; i >= 0 && freed < bytes; i--) {
+		while (!list_is_empty(&bc->buckets[i]) && freed < bytes) {
+			item = bc->buckets[i].prev;
+			buffer = buffer_cache_item(item);
+			list_item_del(item);
+			list_item_append(item, &trim);
+
+			freed += buffer->alloc_size;
+			bc->count--;
+			bc->bytes -= buffer->alloc_size;
+			bc->trimmed++;
+		}
+	}
+
+	spin_unlock_irq(&bc->lock, flags);
+
+	/* the heap takes its own lock */
+	list_for_item_safe(item, tmp, &trim) {
+		buffer = buffer_cache_item(item);
+		rfree(buffer->stream.addr);
+		rfree(buffer);
+	}
+
+	if (freed)
+		trace_buffer("buffer_cache_trim(), freed %u bytes", freed);
+
+	return freed;
+}
+
+void buffer_cache_trace(void)
+{
+	struct buffer_cache *bc = buffer_cache_get_cache();
+
+	if (!bc)
+		return;
+
+	trace_buffer("buffer cache: %u buffers %u bytes peak %u bytes",
+		     bc->count, bc->bytes, bc->peak_bytes);
+	trace_buffer(" hits %u misses %u trimmed %u", bc->hits, bc->misses,
+		     bc->trimmed);
+}
+
+void buffer_cache_init(struct sof *sof)
+{
+	int i;
+
+	sof->buffer_cache = platform_shared_get(&cache, sizeof(cache));
+
+	for (i = 0; i < BUFFER_CACHE_BUCKETS; i++)
+		list_init(&sof->buffer_cache->buckets[i]);
+	spinlock_init(&sof->buffer_cache->lock);
+
+	platform_shared_commit(sof->buffer_cache, sizeof(*sof->buffer_cache));
+}
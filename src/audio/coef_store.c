@@ -0,0 +1,420 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/coef_store.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/cpu.h>
+#include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/sof.h>
+#include <sof/spinlock.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <ipc/topology.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define trace_coef_store(__e, ...) \
+	trace_event(TRACE_CLASS_COMP, __e, ##__VA_ARGS__)
+#define trace_coef_store_error(__e, ...) \
+	trace_error(TRACE_CLASS_COMP, __e, ##__VA_ARGS__)
+
+static SHARED_DATA struct coef_store store;
+
+/* slots of one capacity on one core */
+struct coef_pool {
+	struct list_item list;	/* in store pools */
+	struct list_item free;	/* free slots */
+	uint32_t capacity;	/* bytes of a slot */
+	int core;		/* core that uses the slots */
+	int users;		/* components that opened the pool */
+	int slots;		/* slots allocated, free ones included */
+};
+
+struct coef_blob {
+	struct list_item list;	/* in store list or pool free list */
+	struct coef_pool *pool;	/* pool of the slot */
+	uint32_t crc;		/* crc32 of data */
+	uint32_t size;		/* bytes in data */
+	int refs;		/* number of references */
+	uint8_t data[] __aligned(8);
+};
+
+static inline struct coef_store *coef_store_get_store(void)
+{
+	return sof_get()->coef_store;
+}
+
+static inline struct coef_blob *coef_blob_get(const void *data)
+{
+	return (struct coef_blob *)((uintptr_t)data -
+				    offsetof(struct coef_blob, data));
+}
+
+static struct coef_pool *coef_store_pool(struct coef_store *cs,
+					 uint32_t capacity)
+{
+	struct coef_pool *pool;
+	struct list_item *item;
+
+	list_for_item(item, &cs->pools) {
+		pool = container_of(item, struct coef_pool, list);
+		if (pool->capacity == capacity && pool->core == cpu_get_id())
+			return pool;
+	}
+
+	return NULL;
+}
+
+/* Blobs are shared only within a pool, so that the components of one
+ * capacity always have a spare slot of it.
+ */
+static struct coef_blob *coef_store_find(struct coef_store *cs,
+					 const void *data, uint32_t size,
+					 uint32_t crc, struct coef_pool *pool)
+{
+	struct list_item *item;
+	struct coef_blob *blob;
+
+	list_for_item(item, &cs->list) {
+		blob = container_of(item, struct coef_blob, list);
+		if (blob->crc == crc && blob->size == size &&
+		    blob->pool == pool && !memcmp(blob->data, data, size))
+			return blob;
+	}
+
+	return NULL;
+}
+
+static struct coef_blob *coef_pool_alloc(struct coef_store *cs,
+					 struct coef_pool *pool)
+{
+	struct coef_blob *slot;
+	uint32_t flags;
+
+	slot = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       sizeof(*slot) + pool->capacity);
+	if (!slot) {
+		trace_coef_store_error("coef_pool_alloc() error: no memory for %u bytes",
+				       pool->capacity);
+		return NULL;
+	}
+
+	slot->pool = pool;
+
+	spin_lock_irq(&cs->lock, flags);
+	pool->slots++;
+	spin_unlock_irq(&cs->lock, flags);
+
+	return slot;
+}
+
+/* allocates a new spare when the last one was taken */
+static void coef_pool_refill(struct coef_store *cs, struct coef_pool *pool)
+{
+	struct coef_blob *slot;
+	uint32_t flags;
+	bool empty;
+
+	spin_lock_irq(&cs->lock, flags);
+	empty = list_is_empty(&pool->free);
+	spin_unlock_irq(&cs->lock, flags);
+
+	if (!empty)
+		return;
+
+	/* the next new blob allocates its slot then */
+	slot = coef_pool_alloc(cs, pool);
+	if (!slot)
+		return;
+
+	spin_lock_irq(&cs->lock, flags);
+	list_item_prepend(&slot->list, &pool->free);
+	spin_unlock_irq(&cs->lock, flags);
+}
+
+/* Gives a slot back to its pool with the lock held. The free slots but
+ * the spare move to remove, to be freed without the lock.
+ */
+static void coef_pool_trim(struct coef_pool *pool, struct coef_blob *slot,
+			   struct list_item *remove)
+{
+	list_item_prepend(&slot->list, &pool->free);
+
+	while (pool->free.next != pool->free.prev) {
+		slot = container_of(pool->free.prev, struct coef_blob, list);
+		list_item_del(&slot->list);
+		list_item_append(&slot->list, remove);
+		pool->slots--;
+	}
+}
+
+/* the heap takes its own lock */
+static void coef_store_free_slots(struct list_item *remove)
+{
+	struct list_item *item;
+	struct list_item *tmp;
+
+	list_for_item_safe(item, tmp, remove)
+		rfree(container_of(item, struct coef_blob, list));
+}
+
+int coef_store_open(uint32_t capacity)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_pool *pool;
+	struct coef_blob *slot;
+	uint32_t flags;
+
+	spin_lock_irq(&cs->lock, flags);
+	pool = coef_store_pool(cs, capacity);
+	if (pool)
+		pool->users++;
+	spin_unlock_irq(&cs->lock, flags);
+
+	if (pool)
+		return 0;
+
+	pool = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       sizeof(*pool));
+	if (!pool) {
+		trace_coef_store_error("coef_store_open() error: no memory for pool");
+		return -ENOMEM;
+	}
+
+	list_init(&pool->free);
+	pool->capacity = capacity;
+	pool->core = cpu_get_id();
+	pool->users = 1;
+
+	/* the first spare */
+	slot = coef_pool_alloc(cs, pool);
+	if (!slot) {
+		rfree(pool);
+		return -ENOMEM;
+	}
+	list_item_prepend(&slot->list, &pool->free);
+
+	spin_lock_irq(&cs->lock, flags);
+	list_item_prepend(&pool->list, &cs->pools);
+	spin_unlock_irq(&cs->lock, flags);
+
+	return 0;
+}
+
+void coef_store_close(uint32_t capacity)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_pool *pool;
+	uint32_t flags;
+
+	spin_lock_irq(&cs->lock, flags);
+	pool = coef_store_pool(cs, capacity);
+	if (pool && !--pool->users)
+		list_item_del(&pool->list);
+	else
+		pool = NULL;
+	spin_unlock_irq(&cs->lock, flags);
+
+	if (!pool)
+		return;
+
+	/* the users have put their blobs, only the spare is left */
+	assert(pool->slots <= 1);
+
+	coef_store_free_slots(&pool->free);
+	rfree(pool);
+}
+
+int coef_store_slots(uint32_t capacity)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_pool *pool;
+	uint32_t flags;
+	int slots;
+
+	spin_lock_irq(&cs->lock, flags);
+	pool = coef_store_pool(cs, capacity);
+	slots = pool ? pool->slots : 0;
+	spin_unlock_irq(&cs->lock, flags);
+
+	return slots;
+}
+
+void *coef_store_reserve(uint32_t capacity)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_blob *slot = NULL;
+	struct coef_pool *pool;
+	uint32_t flags;
+
+	spin_lock_irq(&cs->lock, flags);
+	pool = coef_store_pool(cs, capacity);
+	if (pool && !list_is_empty(&pool->free)) {
+		slot = container_of(pool->free.next, struct coef_blob, list);
+		list_item_del(&slot->list);
+	}
+	spin_unlock_irq(&cs->lock, flags);
+
+	if (!pool) {
+		trace_coef_store_error("coef_store_reserve() error: no pool of %u bytes",
+				       capacity);
+		return NULL;
+	}
+
+	/* the spare could not be allocated after the last new blob */
+	if (!slot) {
+		slot = coef_pool_alloc(cs, pool);
+		if (!slot)
+			return NULL;
+	}
+
+	coef_pool_refill(cs, pool);
+
+	return slot->data;
+}
+
+void *coef_store_commit(void *data, uint32_t size)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_blob *slot = coef_blob_get(data);
+	struct coef_blob *blob;
+	struct list_item remove;
+	uint32_t crc = crc32(0, data, size);
+	uint32_t flags;
+
+	list_init(&remove);
+
+	spin_lock_irq(&cs->lock, flags);
+	blob = coef_store_find(cs, data, size, crc, slot->pool);
+	if (blob) {
+		blob->refs++;
+		coef_pool_trim(slot->pool, slot, &remove);
+	} else {
+		slot->crc = crc;
+		slot->size = size;
+		slot->refs = 1;
+		list_item_prepend(&slot->list, &cs->list);
+	}
+	spin_unlock_irq(&cs->lock, flags);
+
+	if (blob) {
+		trace_coef_store("coef_store_commit(), shared blob crc 0x%x refs %d",
+				 crc, blob->refs);
+		coef_store_free_slots(&remove);
+		return blob->data;
+	}
+
+	trace_coef_store("coef_store_commit(), new blob crc 0x%x size %u",
+			 crc, size);
+	return slot->data;
+}
+
+void *coef_store_get(const void *data, uint32_t size, uint32_t capacity)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_blob *blob = NULL;
+	struct coef_pool *pool;
+	uint32_t flags;
+	uint32_t crc;
+	void *slot;
+	int ret;
+
+	if (size > capacity) {
+		trace_coef_store_error("coef_store_get() error: %u bytes exceed slot of %u",
+				       size, capacity);
+		return NULL;
+	}
+
+	crc = crc32(0, data, size);
+
+	/* a shared blob needs no slot */
+	spin_lock_irq(&cs->lock, flags);
+	pool = coef_store_pool(cs, capacity);
+	if (pool)
+		blob = coef_store_find(cs, data, size, crc, pool);
+	if (blob)
+		blob->refs++;
+	spin_unlock_irq(&cs->lock, flags);
+
+	if (blob) {
+		trace_coef_store("coef_store_get(), shared blob crc 0x%x refs %d",
+				 crc, blob->refs);
+		return blob->data;
+	}
+
+	slot = coef_store_reserve(capacity);
+	if (!slot)
+		return NULL;
+
+	ret = memcpy_s(slot, capacity, data, size);
+	assert(!ret);
+
+	return coef_store_commit(slot, size);
+}
+
+void coef_store_release(void *data)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_blob *slot;
+	struct list_item remove;
+	uint32_t flags;
+
+	if (!data)
+		return;
+
+	slot = coef_blob_get(data);
+	list_init(&remove);
+
+	spin_lock_irq(&cs->lock, flags);
+	coef_pool_trim(slot->pool, slot, &remove);
+	spin_unlock_irq(&cs->lock, flags);
+
+	coef_store_free_slots(&remove);
+}
+
+void coef_store_put(const void *data)
+{
+	struct coef_store *cs = coef_store_get_store();
+	struct coef_blob *blob;
+	struct list_item remove;
+	uint32_t flags;
+
+	if (!data)
+		return;
+
+	blob = coef_blob_get(data);
+	list_init(&remove);
+
+	/* the slot of the last reference becomes the spare or is freed */
+	spin_lock_irq(&cs->lock, flags);
+	if (!--blob->refs) {
+		list_item_del(&blob->list);
+		coef_pool_trim(blob->pool, blob, &remove);
+	}
+	spin_unlock_irq(&cs->lock, flags);
+
+	coef_store_free_slots(&remove);
+}
+
+int coef_store_refs(const void *data)
+{
+	return coef_blob_get(data)->refs;
+}
+
+void coef_store_init(struct sof *sof)
+{
+	sof->coef_store = platform_shared_get(&store, sizeof(store));
+
+	list_init(&sof->coef_store->list);
+	list_init(&sof->coef_store->pools);
+	spinlock_init(&sof->coef_store->lock);
+
+	platform_shared_commit(sof->coef_store, sizeof(*sof->coef_store));
+}
@@ -46,6 +46,9 @@ struct dai_data {
 	struct dma *dma;
 	enum sof_ipc_frame frame_fmt;
 	int xrun;		/* true if we are doing xrun recovery */
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	int xrun_light;		/* local buffer resynchronized in this copy */
+#endif
 
 	pcm_converter_func process;	/* processing function */
 
@@ -634,8 +637,42 @@ static void dai_report_xrun(struct comp_dev *dev, uint32_t bytes)
 	}
 }
 
-/* copy and process stream data from source to sink buffers */
-static int dai_copy(struct comp_dev *dev)
+#if CONFIG_XRUN_LIGHT_RECOVERY
+/* Resynchronizes the local buffer with the DMA after an xrun. Playback is
+ * padded with silence up to one period so that the DMA finds data again,
+ * capture drops the oldest data to make room for one period. A second
+ * xrun in the same copy needs a restart.
+ */
+static int dai_xrun_recover(struct comp_dev *dev)
+{
+	struct dai_data *dd = comp_get_drvdata(dev);
+	struct audio_stream *stream = &dd->local_buffer->stream;
+	uint32_t period_bytes = audio_stream_period_bytes(stream, dev->frames);
+	uint32_t bytes = 0;
+
+	if (dd->xrun_light)
+		return -EBUSY;
+
+	if (dev->direction == SOF_IPC_STREAM_PLAYBACK) {
+		if (stream->avail < period_bytes) {
+			bytes = MIN(period_bytes - stream->avail, stream->free);
+			audio_stream_set_zero(stream, bytes);
+			comp_update_buffer_produce(dd->local_buffer, bytes);
+		}
+	} else if (stream->free < period_bytes) {
+		bytes = MIN(period_bytes - stream->free, stream->avail);
+		comp_update_buffer_consume(dd->local_buffer, bytes);
+	}
+
+	dd->xrun_light = 1;
+
+	comp_info(dev, "dai_xrun_recover(), %u bytes", bytes);
+
+	return bytes;
+}
+#endif
+
+static int dai_copy_bytes(struct comp_dev *dev)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
 	uint32_t avail_bytes = 0;
@@ -645,8 +682,6 @@ static int dai_copy(struct comp_dev *dev)
 	uint32_t sink_samples;
 	int ret = 0;
 
-	comp_dbg(dev, "dai_copy()");
-
 	/* get data sizes from DMA */
 	ret = dma_get_data_size(dd->chan, &avail_bytes, &free_bytes);
 	if (ret < 0) {
@@ -684,6 +719,29 @@ static int dai_copy(struct comp_dev *dev)
 	return ret;
 }
 
+/* copy and process stream data from source to sink buffers */
+static int dai_copy(struct comp_dev *dev)
+{
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	struct dai_data *dd = comp_get_drvdata(dev);
+#endif
+	int ret;
+
+	comp_dbg(dev, "dai_copy()");
+
+	ret = dai_copy_bytes(dev);
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	/* copy again from the resynchronized local buffer, an xrun in
+	 * this copy goes to the host
+	 */
+	if (ret < 0 && dd->xrun_light)
+		ret = dai_copy_bytes(dev);
+	dd->xrun_light = 0;
+#endif
+
+	return ret;
+}
+
 static int dai_position(struct comp_dev *dev, struct sof_ipc_stream_posn *posn)
 {
 	struct dai_data *dd = comp_get_drvdata(dev);
@@ -877,6 +935,9 @@ static const struct comp_driver comp_dai = {
 		.dai_ts_start		= dai_ts_start,
 		.dai_ts_stop		= dai_ts_stop,
 		.dai_ts_get		= dai_ts_get,
+#if CONFIG_XRUN_LIGHT_RECOVERY
+		.xrun_recover		= dai_xrun_recover,
+#endif
 	},
 };
 
@@ -0,0 +1,509 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/detect_frontend.h>
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/lib/alloc.h>
+#include <sof/math/fft.h>
+#include <sof/math/numbers.h>
+#include <sof/math/trig.h>
+#include <ipc/topology.h>
+#include <user/detect_test.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* running mean of the log mel energies, 1 / 2^shift per frame */
+#define DETECT_FE_MEAN_SHIFT	5
+
+/* noise floor rise, 1 / 2^shift of the difference per hop */
+#define DETECT_FE_FLOOR_SHIFT	7
+
+/* bin outside of the mel bands */
+#define DETECT_FE_BAND_NONE	0xff
+
+/* log2(1 + f) ~= f + c * f * (1 - f), c = 0.3466 in Q16 */
+#define DETECT_FE_LOG2_C	22713
+
+struct detect_mlp_header {
+	uint16_t hidden;
+	uint16_t reserved;
+	int32_t out_bias;
+};
+
+/* log2(x) in Q16.16, x > 0 */
+static int32_t detect_fe_log2(uint64_t x)
+{
+	int32_t msb = 63;
+	uint32_t f;
+
+	while (!(x >> msb))
+		msb--;
+
+	/* 16 bits of mantissa below the leading one */
+	f = msb >= 16 ? (uint32_t)(x >> (msb - 16)) & 0xffff :
+			(uint32_t)(x << (16 - msb)) & 0xffff;
+
+	return (msb << 16) + f +
+	       (int32_t)(((uint64_t)DETECT_FE_LOG2_C * f * (65536 - f)) >> 32);
+}
+
+/* feature of frame i of the context, i = 0 is the oldest */
+static inline const int16_t *detect_fe_context(const struct detect_frontend *fe,
+					       uint32_t i)
+{
+	uint32_t frame = fe->feat_pos + i;
+
+	if (frame >= fe->model->context)
+		frame -= fe->model->context;
+
+	return fe->features + frame * fe->model->num_mel;
+}
+
+static int detect_linear_init(struct detect_frontend *fe, const void *params,
+			      uint32_t size)
+{
+	if (size < sizeof(int32_t) + fe->num_inputs * sizeof(int16_t))
+		return -EINVAL;
+
+	return 0;
+}
+
+/* bias + sum(w * f), Q1.15 weights and Q8.8 features */
+static int32_t detect_linear_score(const struct detect_frontend *fe)
+{
+	const int32_t *bias = fe->params;
+	const int16_t *w = (const int16_t *)(bias + 1);
+	const int16_t *f;
+	int64_t acc = 0;
+	uint32_t num_mel = fe->model->num_mel;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < fe->model->context; i++) {
+		f = detect_fe_context(fe, i);
+		for (j = 0; j < num_mel; j++)
+			acc += (int32_t)*w++ * f[j];
+	}
+
+	return sat_int32(*bias + (acc >> 7));
+}
+
+static uint32_t detect_mlp_size(const struct detect_frontend *fe,
+				uint32_t hidden)
+{
+	return sizeof(struct detect_mlp_header) + hidden * sizeof(int32_t) +
+	       ALIGN_UP(hidden * sizeof(int16_t), 4) + hidden * fe->num_inputs;
+}
+
+static int detect_mlp_init(struct detect_frontend *fe, const void *params,
+			   uint32_t size)
+{
+	const struct detect_mlp_header *hdr = params;
+
+	if (size < sizeof(*hdr) || !hdr->hidden ||
+	    size < detect_mlp_size(fe, hdr->hidden))
+		return -EINVAL;
+
+	return 0;
+}
+
+/* one ReLU hidden layer, Q1.7 input weights and Q1.15 output weights */
+static int32_t detect_mlp_score(const struct detect_frontend *fe)
+{
+	const struct detect_mlp_header *hdr = fe->params;
+	const int32_t *hidden_bias = (const int32_t *)(hdr + 1);
+	const int16_t *out_weight = (const int16_t *)(hidden_bias +
+						      hdr->hidden);
+	const int8_t *w = (const int8_t *)out_weight +
+			  ALIGN_UP(hdr->hidden * sizeof(int16_t), 4);
+	const int16_t *f;
+	uint32_t num_mel = fe->model->num_mel;
+	int64_t out = 0;
+	int64_t acc;
+	int32_t h;
+	uint32_t n;
+	uint32_t i;
+	uint32_t j;
+
+	for (n = 0; n < hdr->hidden; n++) {
+		acc = 0;
+		for (i = 0; i < fe->model->context; i++) {
+			f = detect_fe_context(fe, i);
+			for (j = 0; j < num_mel; j++)
+				acc += (int32_t)*w++ * f[j];
+		}
+
+		/* Q1.7 x Q8.8 is Q9.15, one more bit to Q16.16 */
+		h = sat_int32(hidden_bias[n] + (acc << 1));
+		if (h > 0)
+			out += (int64_t)out_weight[n] * h;
+	}
+
+	return sat_int32(hdr->out_bias + (out >> 15));
+}
+
+static const struct detect_classifier detect_classifiers[] = {
+	{
+		.type	= SOF_DETECT_CLASSIFIER_LINEAR,
+		.init	= detect_linear_init,
+		.score	= detect_linear_score,
+	},
+	{
+		.type	= SOF_DETECT_CLASSIFIER_MLP,
+		.init	= detect_mlp_init,
+		.score	= detect_mlp_score,
+	},
+};
+
+static const struct detect_classifier *detect_classifier_get(uint32_t type)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(detect_classifiers); i++)
+		if (detect_classifiers[i].type == type)
+			return &detect_classifiers[i];
+
+	return NULL;
+}
+
+static bool detect_fe_model_valid(const struct sof_detect_model *model,
+				  uint32_t size)
+{
+	if (size < sizeof(*model) || model->magic != SOF_DETECT_MODEL_MAGIC ||
+	    model->size < sizeof(*model) || model->size > size)
+		return false;
+
+	if (!model->frame_length || !model->frame_shift ||
+	    model->frame_shift > model->frame_length)
+		return false;
+
+	if (model->fft_size < model->frame_length ||
+	    model->fft_size > FFT_SIZE_MAX ||
+	    (model->fft_size & (model->fft_size - 1)))
+		return false;
+
+	return model->num_mel && model->num_mel <= DETECT_FE_MEL_MAX &&
+	       model->context && model->hold;
+}
+
+/* Triangular band b spans edges b .. b + 2 and peaks at edge b + 1, so each
+ * bin between edges r and r + 1 rises in band r and falls in band r - 1.
+ */
+static int detect_fe_mel_init(struct detect_frontend *fe,
+			      const uint16_t *edges)
+{
+	uint32_t num_mel = fe->model->num_mel;
+	uint32_t bins = fe->model->fft_size / 2 + 1;
+	uint32_t band;
+	uint32_t k;
+
+	for (band = 0; band <= num_mel; band++)
+		if (edges[band] >= edges[band + 1])
+			return -EINVAL;
+
+	if (edges[num_mel + 1] >= bins)
+		return -EINVAL;
+
+	for (k = 0; k < bins; k++) {
+		fe->mel_band[k] = DETECT_FE_BAND_NONE;
+		fe->mel_weight[k] = 0;
+	}
+
+	for (band = 0; band <= num_mel; band++) {
+		for (k = edges[band]; k < edges[band + 1]; k++) {
+			fe->mel_band[k] = band;
+			fe->mel_weight[k] = ((k - edges[band]) << 15) /
+					    (edges[band + 1] - edges[band]);
+		}
+	}
+
+	return 0;
+}
+
+/* periodic Hann window */
+static void detect_fe_window_init(struct detect_frontend *fe)
+{
+	uint32_t n = fe->model->frame_length;
+	int32_t angle;
+	int64_t w;
+	uint32_t i;
+
+	for (i = 0; i < n; i++) {
+		angle = (int32_t)(((int64_t)PI_MUL2_Q4_28 * i) / n) +
+			PI_DIV2_Q4_28;
+		if (angle >= PI_MUL2_Q4_28)
+			angle -= PI_MUL2_Q4_28;
+
+		/* (1 - cos) / 2 from Q1.31 to Q1.15 */
+		w = ((1LL << 31) - sin_fixed(angle)) >> 17;
+		fe->window[i] = MIN(w, INT16_MAX);
+	}
+}
+
+struct detect_frontend *detect_fe_new(const void *model, uint32_t size)
+{
+	const struct sof_detect_model *m = model;
+	struct detect_frontend *fe;
+	const uint8_t *params;
+	uint32_t edges_size;
+	uint32_t bins;
+
+	if (!model || !detect_fe_model_valid(m, size))
+		return NULL;
+
+	edges_size = ALIGN_UP((m->num_mel + 2) * sizeof(uint16_t), 4);
+	if (m->size < sizeof(*m) + edges_size)
+		return NULL;
+
+	fe = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*fe));
+	if (!fe)
+		return NULL;
+
+	fe->model = m;
+	fe->num_inputs = m->context * m->num_mel;
+	fe->classifier = detect_classifier_get(m->classifier);
+	params = (const uint8_t *)(m + 1) + edges_size;
+	fe->params = params;
+	if (!fe->classifier ||
+	    fe->classifier->init(fe, params,
+				 m->size - sizeof(*m) - edges_size) < 0)
+		goto err;
+
+	bins = m->fft_size / 2 + 1;
+	fe->frame = rballoc(0, SOF_MEM_CAPS_RAM,
+			    m->frame_length * sizeof(int32_t));
+	fe->window = rballoc(0, SOF_MEM_CAPS_RAM,
+			     m->frame_length * sizeof(int16_t));
+	fe->fft_in = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			     m->fft_size * sizeof(int32_t));
+	fe->spectrum = rballoc(0, SOF_MEM_CAPS_RAM,
+			       bins * sizeof(struct icomplex32));
+	fe->mel_band = rballoc(0, SOF_MEM_CAPS_RAM, bins);
+	fe->mel_weight = rballoc(0, SOF_MEM_CAPS_RAM, bins * sizeof(int16_t));
+	fe->mel_energy = rballoc(0, SOF_MEM_CAPS_RAM,
+				 m->num_mel * sizeof(uint64_t));
+	fe->mel_mean = rballoc(0, SOF_MEM_CAPS_RAM,
+			       m->num_mel * sizeof(int32_t));
+	fe->features = rballoc(0, SOF_MEM_CAPS_RAM,
+			       fe->num_inputs * sizeof(int16_t));
+	fe->fft = fft_real_plan_new(m->fft_size);
+	if (!fe->frame || !fe->window || !fe->fft_in || !fe->spectrum ||
+	    !fe->mel_band || !fe->mel_weight || !fe->mel_energy ||
+	    !fe->mel_mean || !fe->features || !fe->fft)
+		goto err;
+
+	if (detect_fe_mel_init(fe, (const uint16_t *)(m + 1)) < 0)
+		goto err;
+
+	detect_fe_window_init(fe);
+	detect_fe_reset(fe);
+
+	return fe;
+
+err:
+	detect_fe_free(fe);
+	return NULL;
+}
+
+void detect_fe_free(struct detect_frontend *fe)
+{
+	if (!fe)
+		return;
+
+	fft_real_plan_free(fe->fft);
+	rfree(fe->features);
+	rfree(fe->mel_mean);
+	rfree(fe->mel_energy);
+	rfree(fe->mel_weight);
+	rfree(fe->mel_band);
+	rfree(fe->spectrum);
+	rfree(fe->fft_in);
+	rfree(fe->window);
+	rfree(fe->frame);
+	rfree(fe);
+}
+
+void detect_fe_reset(struct detect_frontend *fe)
+{
+	uint32_t i;
+
+	fe->fill = 0;
+	fe->feat_pos = 0;
+	fe->feat_count = 0;
+	fe->hop_energy = 0;
+	fe->hop_samples = 0;
+	fe->noise_floor = UINT32_MAX;
+	fe->hangover = 0;
+	fe->hold = 0;
+	fe->score = INT32_MIN;
+	fe->frames = 0;
+	fe->frames_active = 0;
+
+	/* first active frame seeds the running means */
+	for (i = 0; i < fe->model->num_mel; i++)
+		fe->mel_mean[i] = INT32_MIN;
+}
+
+/* Energy gate on the samples of the last hop. The noise floor follows
+ * quieter hops at once and louder ones slowly so that it settles under
+ * speech. A zero vad_shift keeps the gate open.
+ */
+static bool detect_fe_gate(struct detect_frontend *fe)
+{
+	const struct sof_detect_model *m = fe->model;
+	uint32_t energy = fe->hop_energy / MAX(fe->hop_samples, 1);
+	uint32_t floor;
+
+	fe->hop_energy = 0;
+	fe->hop_samples = 0;
+
+	if (energy < fe->noise_floor)
+		fe->noise_floor = energy;
+	else
+		fe->noise_floor += (energy - fe->noise_floor) >>
+				   DETECT_FE_FLOOR_SHIFT;
+
+	if (!m->vad_shift)
+		return true;
+
+	floor = MAX(fe->noise_floor, 1);
+	if ((uint64_t)energy > ((uint64_t)floor << m->vad_shift)) {
+		fe->hangover = m->vad_hangover;
+		return true;
+	}
+
+	if (fe->hangover) {
+		fe->hangover--;
+		return true;
+	}
+
+	return false;
+}
+
+/* log mel energies of the current frame, mean removed, into the context */
+static void detect_fe_features(struct detect_frontend *fe)
+{
+	const struct sof_detect_model *m = fe->model;
+	uint32_t bins = m->fft_size / 2 + 1;
+	int16_t *feat = fe->features + fe->feat_pos * m->num_mel;
+	uint64_t power;
+	int32_t log;
+	int shift;
+	uint32_t band;
+	uint32_t i;
+
+	for (i = 0; i < m->frame_length; i++)
+		fe->fft_in[i] = ((int64_t)fe->frame[i] * fe->window[i]) >> 15;
+
+	/* use the full range of the transform, compensated in the log */
+	shift = norm_int32(find_max_abs_int32(fe->fft_in, m->frame_length));
+	for (i = 0; i < m->frame_length; i++)
+		fe->fft_in[i] <<= shift;
+
+	fft_real_execute_32(fe->fft, fe->fft_in, fe->spectrum);
+
+	for (i = 0; i < m->num_mel; i++)
+		fe->mel_energy[i] = 0;
+
+	for (i = 0; i < bins; i++) {
+		band = fe->mel_band[i];
+		if (band == DETECT_FE_BAND_NONE)
+			continue;
+
+		power = ((uint64_t)((int64_t)fe->spectrum[i].real *
+				    fe->spectrum[i].real) +
+			 (uint64_t)((int64_t)fe->spectrum[i].imag *
+				    fe->spectrum[i].imag)) >> 30;
+
+		if (band < m->num_mel)
+			fe->mel_energy[band] += power * fe->mel_weight[i];
+		if (band)
+			fe->mel_energy[band - 1] += power *
+				((1 << 15) - fe->mel_weight[i]);
+	}
+
+	for (i = 0; i < m->num_mel; i++) {
+		log = detect_fe_log2(fe->mel_energy[i] + 1) - (shift << 17);
+
+		if (fe->mel_mean[i] == INT32_MIN)
+			fe->mel_mean[i] = log;
+		else
+			fe->mel_mean[i] += (log - fe->mel_mean[i]) >>
+					   DETECT_FE_MEAN_SHIFT;
+
+		/* Q16.16 to Q8.8 */
+		feat[i] = sat_int16((log - fe->mel_mean[i]) >> 8);
+	}
+
+	fe->feat_pos++;
+	if (fe->feat_pos == m->context)
+		fe->feat_pos = 0;
+
+	if (fe->feat_count < m->context)
+		fe->feat_count++;
+}
+
+static bool detect_fe_frame(struct detect_frontend *fe)
+{
+	const struct sof_detect_model *m = fe->model;
+
+	fe->frames++;
+
+	if (!detect_fe_gate(fe)) {
+		fe->feat_count = 0;
+		fe->hold = 0;
+		return false;
+	}
+
+	fe->frames_active++;
+	detect_fe_features(fe);
+
+	if (fe->feat_count < m->context)
+		return false;
+
+	fe->score = fe->classifier->score(fe);
+	if (fe->score < m->threshold) {
+		fe->hold = 0;
+		return false;
+	}
+
+	if (++fe->hold < m->hold)
+		return false;
+
+	fe->hold = 0;
+	return true;
+}
+
+bool detect_fe_process(struct detect_frontend *fe, const int32_t *samples,
+		       uint32_t count)
+{
+	const struct sof_detect_model *m = fe->model;
+	bool detected = false;
+	int32_t s;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		s = samples[i] >> 16;
+		fe->hop_energy += s * s;
+		fe->hop_samples++;
+		fe->frame[fe->fill++] = samples[i];
+
+		if (fe->fill < m->frame_length)
+			continue;
+
+		if (detect_fe_frame(fe))
+			detected = true;
+
+		/* keep the overlap for the next frame */
+		fe->fill -= m->frame_shift;
+		memmove(fe->frame, fe->frame + m->frame_shift,
+			fe->fill * sizeof(int32_t));
+	}
+
+	return detected;
+}
@@ -6,6 +6,7 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
+#include <sof/audio/detect_frontend.h>
 #include <sof/audio/format.h>
 #include <sof/audio/kpb.h>
 #include <sof/common.h>
@@ -44,6 +45,9 @@
 
 #define INITIAL_MODEL_DATA_SIZE 64
 
+/* samples converted to Q1.31 per front end call */
+#define FRONTEND_BLOCK_SAMPLES 64
+
 /* default number of samples before detection is activated  */
 #define KEYPHRASE_DEFAULT_PREAMBLE_LENGTH 0
 
@@ -66,6 +70,9 @@ struct comp_data {
 	uint32_t history_depth; /** defines draining size in bytes. */
 
 	uint16_t sample_valid_bytes;
+#if CONFIG_COMP_KEYPHRASE_FRONTEND
+	struct detect_frontend *fe;	/**< model driven detector */
+#endif
 	struct kpb_event_data event_data;
 	struct kpb_client client_data;
 
@@ -197,6 +204,100 @@ static void default_detect_test(struct comp_dev *dev,
 	}
 }
 
+#if CONFIG_COMP_KEYPHRASE_FRONTEND
+/* runs the model driven front end, the energy gate in front of it keeps
+ * the feature extraction and the classifier idle between utterances
+ */
+static void frontend_detect_test(struct comp_dev *dev,
+				 const struct audio_stream *source,
+				 uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t block[FRONTEND_BLOCK_SAMPLES];
+	void *src;
+	uint16_t valid_bits = cd->sample_valid_bytes * 8;
+	uint32_t sample = 0;
+	uint32_t n;
+	uint32_t i;
+
+	while (sample < frames && !cd->detected) {
+		n = MIN(frames - sample, FRONTEND_BLOCK_SAMPLES);
+
+		for (i = 0; i < n; i++, sample++) {
+			if (valid_bits == 16U) {
+				src = audio_stream_read_frag_s16(source,
+								 sample);
+				block[i] = *(int16_t *)src << 16;
+			} else {
+				src = audio_stream_read_frag_s32(source,
+								 sample);
+				block[i] = *(int32_t *)src <<
+					   (32 - valid_bits);
+			}
+		}
+
+		if (detect_fe_process(cd->fe, block, n)) {
+			comp_info(dev, "frontend_detect_test(), score %d",
+				  cd->fe->score);
+			cd->history_depth = 0;
+			detect_test_notify(dev);
+			cd->detected = 1;
+		}
+	}
+}
+
+static int test_keyword_frontend_prepare(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct sof_detect_model *model = cd->model.data;
+	struct comp_buffer *sourceb;
+
+	detect_fe_free(cd->fe);
+	cd->fe = NULL;
+	cd->detect_func = default_detect_test;
+
+	if (cd->model.data_size < sizeof(*model) ||
+	    model->magic != SOF_DETECT_MODEL_MAGIC)
+		return 0;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+	if (model->rate && model->rate != sourceb->stream.rate) {
+		comp_err(dev, "test_keyword_frontend_prepare() error: model rate %u, stream rate %u",
+			 model->rate, sourceb->stream.rate);
+		return -EINVAL;
+	}
+
+	cd->fe = detect_fe_new(cd->model.data, cd->model.data_size);
+	if (!cd->fe) {
+		comp_err(dev, "test_keyword_frontend_prepare() error: invalid model");
+		return -EINVAL;
+	}
+
+	comp_info(dev, "test_keyword_frontend_prepare(), classifier %u, %u bands, %u frames",
+		  model->classifier, model->num_mel, model->context);
+
+	cd->detect_func = frontend_detect_test;
+
+	return 0;
+}
+
+static void test_keyword_frontend_free(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (!cd->fe)
+		return;
+
+	comp_info(dev, "test_keyword_frontend_free(), frames %u, active %u",
+		  cd->fe->frames, cd->fe->frames_active);
+
+	detect_fe_free(cd->fe);
+	cd->fe = NULL;
+	cd->detect_func = default_detect_test;
+}
+#endif /* CONFIG_COMP_KEYPHRASE_FRONTEND */
+
 static void free_mem_load(struct comp_data *cd)
 {
 	if (!cd) {
@@ -357,6 +458,9 @@ static void test_keyword_free(struct comp_dev *dev)
 
 	comp_info(dev, "test_keyword_free()");
 
+#if CONFIG_COMP_KEYPHRASE_FRONTEND
+	test_keyword_frontend_free(dev);
+#endif
 	free_mem_load(cd);
 	rfree(cd);
 	rfree(dev);
@@ -705,6 +809,10 @@ static int test_keyword_trigger(struct comp_dev *dev, int cmd)
 		cd->detect_preamble = 0;
 		cd->detected = 0;
 		cd->activation = 0;
+#if CONFIG_COMP_KEYPHRASE_FRONTEND
+		if (cd->fe)
+			detect_fe_reset(cd->fe);
+#endif
 	}
 
 	return ret;
@@ -743,6 +851,10 @@ static int test_keyword_reset(struct comp_dev *dev)
 	cd->detect_preamble = 0;
 	cd->detected = 0;
 
+#if CONFIG_COMP_KEYPHRASE_FRONTEND
+	test_keyword_frontend_free(dev);
+#endif
+
 	return comp_set_state(dev, COMP_TRIGGER_RESET);
 }
 
@@ -751,6 +863,7 @@ static int test_keyword_prepare(struct comp_dev *dev)
 	struct comp_data *cd = comp_get_drvdata(dev);
 	uint16_t valid_bits = cd->sample_valid_bytes * 8;
 	uint16_t sample_width = cd->config.sample_width;
+	int ret;
 
 	comp_info(dev, "test_keyword_prepare()");
 
@@ -762,7 +875,15 @@ static int test_keyword_prepare(struct comp_dev *dev)
 			test_keyword_get_threshold(dev, valid_bits);
 	}
 
-	return comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret)
+		return ret;
+
+#if CONFIG_COMP_KEYPHRASE_FRONTEND
+	ret = test_keyword_frontend_prepare(dev);
+#endif
+
+	return ret;
 }
 
 static const struct comp_driver comp_keyword = {
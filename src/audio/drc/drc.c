@@ -0,0 +1,891 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/drc/drc.h>
+#include <sof/audio/format.h>
+#include <sof/audio/pipeline.h>
+#include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/drivers/ipc.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/memory.h>
+#include <sof/list.h>
+#include <sof/math/decibels.h>
+#include <sof/platform.h>
+#include <sof/string.h>
+#include <sof/trace/trace.h>
+#include <ipc/control.h>
+#include <ipc/stream.h>
+#include <ipc/topology.h>
+#include <kernel/abi.h>
+#include <user/drc.h>
+#include <user/trace.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static const struct comp_driver comp_drc;
+
+#define DRC_ONE_Q31		INT32_MAX
+#define DRC_TWO_PI_Q27		Q_CONVERT_FLOAT(6.2831853072, 27)
+#define DRC_MAX_KNEE		Q_CONVERT_FLOAT(24.0, 24)
+#define DRC_MAX_MAKEUP		Q_CONVERT_FLOAT(24.0, 24)
+#define DRC_MIN_RATIO		Q_CONVERT_FLOAT(1.0, 24)
+
+/* Compressor of a band, levels and gains in dB are Q8.24 */
+struct drc_band {
+	int32_t threshold;	/**< dBFS */
+	int32_t knee;		/**< soft knee width in dB */
+	int32_t slope;		/**< Q2.30, 1 - 1 / ratio */
+	int32_t makeup;		/**< makeup gain in dB */
+	int32_t attack;		/**< Q1.31 smoothing coefficient per block */
+	int32_t release;	/**< Q1.31 smoothing coefficient per block */
+	int32_t peak;		/**< Q1.31 peak of the block, all channels */
+	int32_t gain_db;	/**< smoothed gain reduction */
+	int32_t gain;		/**< Q5.27 gain at the current frame */
+	int32_t target;		/**< Q5.27 gain at the end of the block */
+	int32_t step;		/**< Q5.27 gain increment per frame */
+	int32_t *delay;		/**< lookahead delay lines of the channels */
+};
+
+typedef void (*drc_io_func)(const struct audio_stream *stream, int32_t *x,
+			    int idx, int frames, int stride, int nch);
+
+/* DRC component private data */
+struct comp_data {
+	struct drc_band band[SOF_DRC_MAX_BANDS];
+	int32_t lp_coef[SOF_DRC_MAX_BANDS - 1];	/**< Q1.31 crossovers */
+	int32_t *lp[SOF_DRC_MAX_BANDS - 1];	/**< crossover states */
+	int32_t *x;				/**< in and out blocks */
+	int32_t *b[SOF_DRC_MAX_BANDS];		/**< band blocks */
+	struct sof_drc_config *config;		/**< pointer to setup blob */
+	struct sof_drc_config *config_new;	/**< pointer to new setup */
+	int32_t *delay_mem;			/**< channel state of setup */
+	int num_bands;				/**< bands in use */
+	int lookahead;				/**< delay in frames */
+	int delay_pos;				/**< delay lines position */
+	int block_pos;				/**< frames into the block */
+	bool config_ready;			/**< set when fully received */
+	bool active;				/**< set when configured */
+	drc_io_func load;			/**< source to Q1.31 */
+	drc_io_func store;			/**< Q1.31 to sink */
+};
+
+#if CONFIG_FORMAT_S16LE
+static void drc_load_s16(const struct audio_stream *source, int32_t *x,
+			 int idx, int frames, int stride, int nch)
+{
+	int16_t *in;
+	int c;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (c = 0; c < nch; c++) {
+			in = audio_stream_read_frag_s16(source, idx++);
+			x[c * stride + i] = (int32_t)*in << 16;
+		}
+	}
+}
+
+static void drc_store_s16(const struct audio_stream *sink, int32_t *x,
+			  int idx, int frames, int stride, int nch)
+{
+	int16_t *out;
+	int c;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (c = 0; c < nch; c++) {
+			out = audio_stream_write_frag_s16(sink, idx++);
+			*out = sat_int16(Q_SHIFT_RND(x[c * stride + i], 31,
+						     15));
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+static void drc_load_s24(const struct audio_stream *source, int32_t *x,
+			 int idx, int frames, int stride, int nch)
+{
+	int32_t *in;
+	int c;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (c = 0; c < nch; c++) {
+			in = audio_stream_read_frag_s32(source, idx++);
+			x[c * stride + i] = *in << 8;
+		}
+	}
+}
+
+static void drc_store_s24(const struct audio_stream *sink, int32_t *x,
+			  int idx, int frames, int stride, int nch)
+{
+	int32_t *out;
+	int c;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (c = 0; c < nch; c++) {
+			out = audio_stream_write_frag_s32(sink, idx++);
+			*out = sat_int24(Q_SHIFT_RND(x[c * stride + i], 31,
+						     23));
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+static void drc_load_s32(const struct audio_stream *source, int32_t *x,
+			 int idx, int frames, int stride, int nch)
+{
+	int32_t *in;
+	int c;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (c = 0; c < nch; c++) {
+			in = audio_stream_read_frag_s32(source, idx++);
+			x[c * stride + i] = *in;
+		}
+	}
+}
+
+static void drc_store_s32(const struct audio_stream *sink, int32_t *x,
+			  int idx, int frames, int stride, int nch)
+{
+	int32_t *out;
+	int c;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		for (c = 0; c < nch; c++) {
+			out = audio_stream_write_frag_s32(sink, idx++);
+			*out = x[c * stride + i];
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S32LE */
+
+static int drc_set_io_func(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sourceb;
+
+	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
+				  sink_list);
+
+	switch (sourceb->stream.frame_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+		comp_info(dev, "drc_set_io_func(), SOF_IPC_FRAME_S16_LE");
+		cd->load = drc_load_s16;
+		cd->store = drc_store_s16;
+		break;
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+		comp_info(dev, "drc_set_io_func(), SOF_IPC_FRAME_S24_4LE");
+		cd->load = drc_load_s24;
+		cd->store = drc_store_s24;
+		break;
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+		comp_info(dev, "drc_set_io_func(), SOF_IPC_FRAME_S32_LE");
+		cd->load = drc_load_s32;
+		cd->store = drc_store_s32;
+		break;
+#endif /* CONFIG_FORMAT_S32LE */
+	default:
+		comp_err(dev, "drc_set_io_func(), invalid frame_fmt");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Gain reduction in dB of the static curve for level in dBFS */
+static int32_t drc_static_curve(const struct drc_band *band, int32_t level)
+{
+	int64_t over = (int64_t)level - band->threshold;
+	int32_t half_knee = band->knee >> 1;
+
+	if (over <= -half_knee)
+		return 0;
+
+	/* Quadratic transition from slope 0 to slope over the knee */
+	if (over < half_knee) {
+		over += half_knee;
+		over = over * over / (2 * (int64_t)band->knee);
+	}
+
+	return -(int32_t)((over * band->slope) >> 30);
+}
+
+/* Block rate gain computer, sets the gain ramp for the next block */
+static void drc_gain_update(struct drc_band *band)
+{
+	int32_t target;
+	int32_t coef;
+	int32_t lin;
+
+	target = drc_static_curve(band, lin2db_fixed(band->peak));
+	coef = target < band->gain_db ? band->attack : band->release;
+	band->gain_db += (int32_t)Q_MULTSR_32X32((int64_t)target -
+						 band->gain_db, coef,
+						 24, 31, 24);
+	band->peak = 0;
+
+	/* Q12.20 to Q5.27 */
+	lin = db2lin_fast_fixed(band->gain_db + band->makeup);
+	band->gain = band->target;
+	band->target = sat_int32((int64_t)lin << (DRC_GAIN_QY - 20));
+	band->step = (band->target - band->gain) / DRC_BLOCK_FRAMES;
+}
+
+/* Block of channel c in a buffer of the channel blocks */
+static inline int32_t *drc_block(int32_t *blocks, int c)
+{
+	return blocks + c * DRC_BLOCK_FRAMES;
+}
+
+/* Swaps the samples with the lookahead delay line */
+static void drc_delay(int32_t *x, int32_t *delay, int pos, int length,
+		      int frames)
+{
+	int32_t t;
+	int i;
+
+	for (i = 0; i < frames; i++) {
+		t = delay[pos];
+		delay[pos] = x[i];
+		x[i] = t;
+		if (++pos == length)
+			pos = 0;
+	}
+}
+
+/* Splits x into the bands with complementary one pole low-pass filters */
+static void drc_split(struct comp_data *cd, int frames, int nch)
+{
+	struct drc_band *band;
+	int32_t *in;
+	int32_t *lo;
+	int32_t *hi;
+	int64_t lp;
+	int32_t a;
+	int c;
+	int i;
+	int k;
+
+	for (k = 0; k < cd->num_bands - 1; k++) {
+		a = cd->lp_coef[k];
+		for (c = 0; c < nch; c++) {
+			in = k ? drc_block(cd->b[k], c) : drc_block(cd->x, c);
+			lo = drc_block(cd->b[k], c);
+			hi = drc_block(cd->b[k + 1], c);
+			lp = cd->lp[k][c];
+			for (i = 0; i < frames; i++) {
+				lp += ((int64_t)in[i] - lp) * a >> 31;
+				hi[i] = sat_int32(in[i] - lp);
+				lo[i] = (int32_t)lp;
+			}
+
+			cd->lp[k][c] = (int32_t)lp;
+		}
+	}
+
+	for (k = 0; k < cd->num_bands; k++) {
+		band = &cd->band[k];
+		for (c = 0; c < nch; c++)
+			band->peak = MAX(band->peak,
+					 drc_peak_32(drc_block(cd->b[k], c),
+						     frames));
+	}
+}
+
+/* Processes frames in cd->x, at most up to the end of the current block */
+static void drc_process_block(struct comp_data *cd, int frames, int nch)
+{
+	struct drc_band *band;
+	int32_t *x;
+	int c;
+	int k;
+
+	if (cd->num_bands == 1) {
+		band = &cd->band[0];
+		for (c = 0; c < nch; c++) {
+			x = drc_block(cd->x, c);
+			band->peak = MAX(band->peak, drc_peak_32(x, frames));
+			drc_delay(x, band->delay + c * cd->lookahead,
+				  cd->delay_pos, cd->lookahead, frames);
+			drc_gain_ramp_32(x, x, frames, band->gain, band->step,
+					 false);
+		}
+	} else {
+		drc_split(cd, frames, nch);
+		for (k = 0; k < cd->num_bands; k++) {
+			band = &cd->band[k];
+			for (c = 0; c < nch; c++) {
+				x = drc_block(cd->b[k], c);
+				drc_delay(x, band->delay + c * cd->lookahead,
+					  cd->delay_pos, cd->lookahead,
+					  frames);
+				drc_gain_ramp_32(drc_block(cd->x, c), x,
+						 frames, band->gain,
+						 band->step, k > 0);
+			}
+		}
+	}
+
+	cd->delay_pos += frames;
+	if (cd->delay_pos >= cd->lookahead)
+		cd->delay_pos -= cd->lookahead;
+
+	cd->block_pos += frames;
+	for (k = 0; k < cd->num_bands; k++) {
+		band = &cd->band[k];
+		band->gain += band->step * frames;
+		if (cd->block_pos == DRC_BLOCK_FRAMES)
+			drc_gain_update(band);
+	}
+
+	if (cd->block_pos == DRC_BLOCK_FRAMES)
+		cd->block_pos = 0;
+}
+
+static void drc_process(struct comp_data *cd,
+			const struct audio_stream *source,
+			struct audio_stream *sink, int frames, int nch)
+{
+	int idx = 0;
+	int n;
+
+	while (frames) {
+		n = MIN(frames, DRC_BLOCK_FRAMES - cd->block_pos);
+		cd->load(source, cd->x, idx, n, DRC_BLOCK_FRAMES, nch);
+		drc_process_block(cd, n, nch);
+		cd->store(sink, cd->x, idx, n, DRC_BLOCK_FRAMES, nch);
+		idx += n * nch;
+		frames -= n;
+	}
+}
+
+/* Without configuration the DRC does not change the stream */
+static void drc_passthrough(const struct audio_stream *source,
+			    struct audio_stream *sink, int samples)
+{
+#if CONFIG_FORMAT_S16LE
+	if (source->frame_fmt == SOF_IPC_FRAME_S16_LE) {
+		audio_stream_copy_s16(source, 0, sink, 0, samples);
+		return;
+	}
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+	audio_stream_copy_s32(source, 0, sink, 0, samples);
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+}
+
+/* 1 - exp(-x) as Q1.31 for x as Q5.27 */
+static int32_t drc_one_minus_exp(int64_t x)
+{
+	if (x >= Q_CONVERT_FLOAT(11.5, 27))
+		return DRC_ONE_Q31;
+
+	return sat_int32((int64_t)(Q_CONVERT_FLOAT(1.0, 20) -
+				   exp_fixed((int32_t)-x)) << 11);
+}
+
+/* Smoothing coefficient per block for a time constant */
+static int32_t drc_time_coef(uint32_t time_us, uint32_t rate)
+{
+	if (!time_us)
+		return DRC_ONE_Q31;
+
+	return drc_one_minus_exp(((int64_t)DRC_BLOCK_FRAMES * 1000000 << 27) /
+				 ((int64_t)time_us * rate));
+}
+
+static void drc_free_delaylines(struct comp_data *cd)
+{
+	int i;
+
+	rfree(cd->delay_mem);
+	cd->delay_mem = NULL;
+	cd->active = false;
+	cd->x = NULL;
+	for (i = 0; i < SOF_DRC_MAX_BANDS; i++) {
+		cd->band[i].delay = NULL;
+		cd->b[i] = NULL;
+	}
+
+	for (i = 0; i < SOF_DRC_MAX_BANDS - 1; i++)
+		cd->lp[i] = NULL;
+}
+
+static int drc_validate(struct sof_drc_config *config)
+{
+	struct sof_drc_band *b;
+	int i;
+
+	if (config->num_bands < 1 || config->num_bands > SOF_DRC_MAX_BANDS ||
+	    config->size != sizeof(*config) +
+			    config->num_bands * sizeof(config->band[0]) ||
+	    config->lookahead_us > SOF_DRC_MAX_LOOKAHEAD_US) {
+		comp_cl_err(&comp_drc, "drc_validate(), invalid bands %u or size %u",
+			    config->num_bands, config->size);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < config->num_bands; i++) {
+		b = &config->band[i];
+		if (b->knee < 0 || b->knee > DRC_MAX_KNEE ||
+		    (b->ratio && b->ratio < DRC_MIN_RATIO) ||
+		    b->makeup_gain > DRC_MAX_MAKEUP || b->threshold > 0) {
+			comp_cl_err(&comp_drc, "drc_validate(), invalid band %d",
+				    i);
+			return -EINVAL;
+		}
+
+		if (i && config->crossover_hz[i - 1] <=
+			 (i > 1 ? config->crossover_hz[i - 2] : 0)) {
+			comp_cl_err(&comp_drc, "drc_validate(), invalid crossover %d",
+				    i - 1);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int drc_setup(struct comp_data *cd, int nch, uint32_t rate)
+{
+	struct sof_drc_config *config = cd->config;
+	struct sof_drc_band *b;
+	struct drc_band *band;
+	int32_t *mem;
+	int32_t gain;
+	int bands;
+	int ret;
+	int i;
+
+	drc_free_delaylines(cd);
+
+	ret = drc_validate(config);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < config->num_bands - 1; i++) {
+		if (config->crossover_hz[i] >= rate / 2) {
+			comp_cl_err(&comp_drc, "drc_setup(), crossover %u Hz above Nyquist",
+				    config->crossover_hz[i]);
+			return -EINVAL;
+		}
+
+		cd->lp_coef[i] = drc_one_minus_exp((int64_t)DRC_TWO_PI_Q27 *
+						   config->crossover_hz[i] /
+						   rate);
+	}
+
+	/* The gain ramp of a block ends when the next block has been
+	 * detected so two blocks are the shortest lookahead.
+	 */
+	cd->lookahead = MAX((uint64_t)config->lookahead_us * rate / 1000000,
+			    2 * DRC_BLOCK_FRAMES);
+	cd->num_bands = config->num_bands;
+
+	/* The delay lines, the in and out blocks and with several bands the
+	 * band blocks and the crossover states are sized for the channels
+	 * of the stream.
+	 */
+	bands = cd->num_bands > 1 ? cd->num_bands : 0;
+	cd->delay_mem = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				nch * (cd->num_bands * cd->lookahead +
+				       (1 + bands) * DRC_BLOCK_FRAMES +
+				       cd->num_bands - 1) * sizeof(int32_t));
+	if (!cd->delay_mem) {
+		comp_cl_err(&comp_drc, "drc_setup(), delay allocation failed for %d frames",
+			    cd->lookahead);
+		return -ENOMEM;
+	}
+
+	mem = cd->delay_mem;
+	cd->x = mem;
+	mem += nch * DRC_BLOCK_FRAMES;
+	for (i = 0; i < bands; i++) {
+		cd->b[i] = mem;
+		mem += nch * DRC_BLOCK_FRAMES;
+	}
+
+	for (i = 0; i < cd->num_bands - 1; i++) {
+		cd->lp[i] = mem;
+		mem += nch;
+	}
+
+	for (i = 0; i < cd->num_bands; i++) {
+		b = &config->band[i];
+		band = &cd->band[i];
+		band->threshold = b->threshold;
+		band->knee = b->knee;
+		band->slope = 1 << 30;
+		if (b->ratio)
+			band->slope -= ((int64_t)1 << 54) / b->ratio;
+
+		band->makeup = b->makeup_gain;
+		band->attack = drc_time_coef(b->attack_us, rate);
+		band->release = drc_time_coef(b->release_us, rate);
+		band->peak = 0;
+		band->gain_db = 0;
+		gain = db2lin_fast_fixed(band->makeup);
+		band->target = sat_int32((int64_t)gain << (DRC_GAIN_QY - 20));
+		band->gain = band->target;
+		band->step = 0;
+		band->delay = mem;
+		mem += nch * cd->lookahead;
+	}
+
+	cd->delay_pos = 0;
+	cd->block_pos = 0;
+	cd->active = true;
+	return 0;
+}
+
+static struct comp_dev *drc_new(const struct comp_driver *drv,
+				struct sof_ipc_comp *comp)
+{
+	struct comp_dev *dev;
+	struct comp_data *cd;
+	struct sof_ipc_comp_process *drc;
+	struct sof_ipc_comp_process *ipc_drc =
+		(struct sof_ipc_comp_process *)comp;
+	size_t bs = ipc_drc->size;
+	int ret;
+
+	comp_cl_info(&comp_drc, "drc_new()");
+
+	if (bs > SOF_DRC_MAX_SIZE) {
+		comp_cl_err(&comp_drc, "drc_new() error: configuration blob size = %u > SOF_DRC_MAX_SIZE",
+			    bs);
+		return NULL;
+	}
+
+	dev = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		      COMP_SIZE(struct sof_ipc_comp_process));
+	if (!dev)
+		return NULL;
+	dev->drv = drv;
+
+	drc = COMP_GET_IPC(dev, sof_ipc_comp_process);
+	ret = memcpy_s(drc, sizeof(*drc), ipc_drc,
+		       sizeof(struct sof_ipc_comp_process));
+	assert(!ret);
+
+	cd = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM, sizeof(*cd));
+	if (!cd) {
+		rfree(dev);
+		return NULL;
+	}
+
+	comp_set_drvdata(dev, cd);
+
+	/* The configuration may also be set later in run-time */
+	if (bs) {
+		cd->config = rballoc(0, SOF_MEM_CAPS_RAM, bs);
+		if (!cd->config) {
+			rfree(dev);
+			rfree(cd);
+			return NULL;
+		}
+
+		ret = memcpy_s(cd->config, bs, ipc_drc->data, bs);
+		assert(!ret);
+		cd->config_ready = true;
+	}
+
+	dev->state = COMP_STATE_READY;
+	return dev;
+}
+
+static void drc_free(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "drc_free()");
+
+	drc_free_delaylines(cd);
+	rfree(cd->config);
+	rfree(cd->config_new);
+	rfree(cd);
+	rfree(dev);
+}
+
+static int drc_params(struct comp_dev *dev,
+		      struct sof_ipc_stream_params *params)
+{
+	int ret;
+
+	comp_info(dev, "drc_params()");
+
+	ret = comp_verify_params(dev, BUFF_PARAMS_FRAME_FMT, params);
+	if (ret < 0) {
+		comp_err(dev, "drc_params(): pcm params verification failed.");
+		return -EINVAL;
+	}
+
+	/* All configuration work is postponed to prepare(). */
+	return 0;
+}
+
+static int drc_cmd_get_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata, int max_size)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	size_t bs;
+	int ret;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		comp_err(dev, "drc_cmd_get_data() error: invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	if (!cd->config) {
+		comp_err(dev, "drc_cmd_get_data() error: no configuration");
+		return -EINVAL;
+	}
+
+	/* The blob is small enough for a single message */
+	bs = cd->config->size;
+	max_size -= sizeof(struct sof_ipc_ctrl_data) +
+		sizeof(struct sof_abi_hdr);
+	if (bs > max_size) {
+		comp_err(dev, "drc_cmd_get_data() error: blob size %zu exceeds %d",
+			 bs, max_size);
+		return -EINVAL;
+	}
+
+	ret = memcpy_s(cdata->data->data, max_size, cd->config, bs);
+	assert(!ret);
+
+	cdata->data->abi = SOF_ABI_VERSION;
+	cdata->data->size = bs;
+	cdata->num_elems = bs;
+	cdata->elems_remaining = 0;
+	return 0;
+}
+
+static int drc_cmd_set_data(struct comp_dev *dev,
+			    struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	size_t bs = cdata->num_elems;
+	int ret;
+
+	if (cdata->cmd != SOF_CTRL_CMD_BINARY) {
+		comp_err(dev, "drc_cmd_set_data() error: invalid cdata->cmd");
+		return -EINVAL;
+	}
+
+	comp_info(dev, "drc_cmd_set_data(), blob size %zu", bs);
+
+	if (cdata->elems_remaining || cdata->msg_index ||
+	    bs > SOF_DRC_MAX_SIZE || bs < sizeof(struct sof_drc_config)) {
+		comp_err(dev, "drc_cmd_set_data() error: invalid blob");
+		return -EINVAL;
+	}
+
+	/* Check that there is no work-in-progress previous request */
+	if (cd->config_new) {
+		comp_err(dev, "drc_cmd_set_data(), busy with previous request");
+		return -EBUSY;
+	}
+
+	cd->config_new = rballoc(0, SOF_MEM_CAPS_RAM, bs);
+	if (!cd->config_new) {
+		comp_err(dev, "drc_cmd_set_data() error: buffer allocation failed");
+		return -ENOMEM;
+	}
+
+	ret = memcpy_s(cd->config_new, bs, cdata->data->data, bs);
+	assert(!ret);
+
+	if (drc_validate(cd->config_new) < 0) {
+		rfree(cd->config_new);
+		cd->config_new = NULL;
+		return -EINVAL;
+	}
+
+	/* Applied in prepare() when not streaming, otherwise in copy() */
+	cd->config_ready = true;
+	if (dev->state == COMP_STATE_READY || !cd->config) {
+		rfree(cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
+
+	return 0;
+}
+
+/* used to pass standard and bespoke commands (with data) to component */
+static int drc_cmd(struct comp_dev *dev, int cmd, void *data,
+		   int max_data_size)
+{
+	struct sof_ipc_ctrl_data *cdata = data;
+
+	comp_info(dev, "drc_cmd()");
+
+	switch (cmd) {
+	case COMP_CMD_SET_DATA:
+		return drc_cmd_set_data(dev, cdata);
+	case COMP_CMD_GET_DATA:
+		return drc_cmd_get_data(dev, cdata, max_data_size);
+	default:
+		comp_err(dev, "drc_cmd() error: invalid command");
+		return -EINVAL;
+	}
+}
+
+static int drc_trigger(struct comp_dev *dev, int cmd)
+{
+	comp_info(dev, "drc_trigger()");
+
+	return comp_set_state(dev, cmd);
+}
+
+/* copy and process stream data from source to sink buffers */
+static int drc_copy(struct comp_dev *dev)
+{
+	struct comp_copy_limits cl;
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int nch;
+	int ret;
+
+	comp_dbg(dev, "drc_copy()");
+
+	comp_get_copy_limits(dev, &cl);
+	nch = cl.source->stream.channels;
+
+	/* Check for changed configuration */
+	if (cd->config_new && cd->config_ready) {
+		rfree(cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+		ret = drc_setup(cd, nch, cl.source->stream.rate);
+		if (ret < 0) {
+			comp_err(dev, "drc_copy(), failed DRC setup");
+			return ret;
+		}
+	}
+
+	if (!cl.frames)
+		return 0;
+
+	if (cd->active)
+		drc_process(cd, &cl.source->stream, &cl.sink->stream,
+			    cl.frames, nch);
+	else
+		drc_passthrough(&cl.source->stream, &cl.sink->stream,
+				cl.frames * nch);
+
+	comp_update_buffer_consume(cl.source, cl.source_bytes);
+	comp_update_buffer_produce(cl.sink, cl.sink_bytes);
+	return 0;
+}
+
+static int drc_prepare(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_comp_config *config = dev_comp_config(dev);
+	struct comp_buffer *sourceb;
+	struct comp_buffer *sinkb;
+	uint32_t sink_period_bytes;
+	int ret;
+
+	comp_info(dev, "drc_prepare()");
+
+	ret = comp_set_state(dev, COMP_TRIGGER_PREPARE);
+	if (ret < 0)
+		return ret;
+
+	if (ret == COMP_STATUS_STATE_ALREADY_SET)
+		return PPL_STATUS_PATH_STOP;
+
+	/* DRC component will only ever have 1 source and 1 sink buffer */
+	sourceb = list_first_item(&dev->bsource_list,
+				  struct comp_buffer, sink_list);
+	sinkb = list_first_item(&dev->bsink_list,
+				struct comp_buffer, source_list);
+
+	sink_period_bytes = audio_stream_period_bytes(&sinkb->stream,
+						      dev->frames);
+	if (sinkb->stream.size < config->periods_sink * sink_period_bytes) {
+		comp_err(dev, "drc_prepare() error: sink buffer size is insufficient");
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	ret = drc_set_io_func(dev);
+	if (ret < 0)
+		goto err;
+
+	/* Without configuration the stream is passed through */
+	if (cd->config && cd->config_ready) {
+		ret = drc_setup(cd, sourceb->stream.channels,
+				sourceb->stream.rate);
+		if (ret < 0) {
+			comp_err(dev, "drc_prepare() error: drc_setup failed.");
+			goto err;
+		}
+	}
+
+	return 0;
+
+err:
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return ret;
+}
+
+static int drc_reset(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	comp_info(dev, "drc_reset()");
+
+	drc_free_delaylines(cd);
+	cd->load = NULL;
+	cd->store = NULL;
+
+	comp_set_state(dev, COMP_TRIGGER_RESET);
+	return 0;
+}
+
+static const struct comp_driver comp_drc = {
+	.type = SOF_COMP_DRC,
+	.ops = {
+		.new = drc_new,
+		.free = drc_free,
+		.params = drc_params,
+		.cmd = drc_cmd,
+		.trigger = drc_trigger,
+		.copy = drc_copy,
+		.prepare = drc_prepare,
+		.reset = drc_reset,
+	},
+};
+
+static SHARED_DATA struct comp_driver_info comp_drc_info = {
+	.drv = &comp_drc,
+};
+
+static void sys_comp_drc_init(void)
+{
+	comp_register(platform_shared_get(&comp_drc_info,
+					  sizeof(comp_drc_info)));
+}
+
+DECLARE_MODULE(sys_comp_drc_init);
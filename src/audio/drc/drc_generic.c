@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/drc/drc_config.h>
+
+#if DRC_GENERIC
+
+#include <sof/audio/drc/drc.h>
+#include <sof/audio/format.h>
+#include <sof/math/numbers.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+int32_t drc_peak_32(const int32_t *x, int n)
+{
+	int32_t peak = 0;
+	int32_t a;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		/* -1.0 is saturated to the max positive value */
+		a = x[i] < 0 ? sat_int32(-(int64_t)x[i]) : x[i];
+		peak = MAX(peak, a);
+	}
+
+	return peak;
+}
+
+void drc_gain_ramp_32(int32_t *y, const int32_t *x, int n, int32_t gain,
+		      int32_t step, bool add)
+{
+	int64_t p;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		/* Q1.31 x Q5.27 -> Q1.31 */
+		p = ((int64_t)x[i] * gain + (1 << (DRC_GAIN_QY - 1))) >>
+			DRC_GAIN_QY;
+		if (add)
+			p += y[i];
+
+		y[i] = sat_int32(p);
+		gain += step;
+	}
+}
+
+#endif
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/drc/drc_config.h>
+
+#if DRC_HIFI3
+
+#include <sof/audio/drc/drc.h>
+#include <xtensa/tie/xt_hifi3.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+int32_t drc_peak_32(const int32_t *x, int n)
+{
+	const ae_int32 *in = (const ae_int32 *)x;
+	ae_int32x2 peak = AE_ZERO32();
+	ae_int32x2 sample;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		AE_L32_IP(sample, in, sizeof(ae_int32));
+		peak = AE_MAX32(peak, AE_ABS32S(sample));
+	}
+
+	return AE_MOVAD32_L(peak);
+}
+
+void drc_gain_ramp_32(int32_t *y, const int32_t *x, int n, int32_t gain,
+		      int32_t step, bool add)
+{
+	const ae_int32 *in = (const ae_int32 *)x;
+	ae_int32 *out = (ae_int32 *)y;
+	ae_f32x2 g = AE_MOVDA32(gain);
+	ae_f32x2 d = AE_MOVDA32(step);
+	ae_f32x2 sample;
+	ae_f32x2 acc;
+	ae_f64 mult;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		AE_L32_IP(sample, in, sizeof(ae_int32));
+
+		/* Q1.31 x Q5.27 is Q6.58 as Q1.63, shift left by 4 with
+		 * saturation and round to Q1.31
+		 */
+		mult = AE_MULF32S_LL(sample, g);
+		sample = AE_ROUND32F64SSYM(AE_SLAI64S(mult, 31 - DRC_GAIN_QY));
+		if (add) {
+			acc = AE_L32_I((const ae_int32 *)out, 0);
+			sample = AE_ADD32S(sample, acc);
+		}
+
+		AE_S32_L_IP(sample, out, sizeof(ae_int32));
+		g = AE_ADD32S(g, d);
+	}
+}
+
+#endif
@@ -7,11 +7,14 @@
 //         Keyon Jie <yang.jie@linux.intel.com>
 
 #include <sof/audio/buffer.h>
+#include <sof/audio/coef_store.h>
 #include <sof/audio/component.h>
 #include <sof/audio/eq_fir/fir_config.h>
 #include <sof/audio/pipeline.h>
+#include <sof/audio/xfade.h>
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/memory.h>
@@ -41,22 +44,39 @@
 #include <sof/audio/eq_fir/fir_hifi3.h>
 #endif
 
+#if CONFIG_COMP_FIR_FFT
+#include <sof/audio/eq_fir/fir_fft.h>
+#endif
+
 static const struct comp_driver comp_eq_fir;
 
 /* src component private data */
 struct comp_data {
-	struct fir_state_32x16 fir[PLATFORM_MAX_CHANNELS]; /**< filters state */
+	struct fir_state_32x16 *fir;		/**< filters state */
+	struct fir_state_32x16 *fir_old;	/**< faded out filters */
+	struct sof_eq_fir_coef_data **channel_eq; /**< responses in setup */
+	int channels;				/**< channels with state */
 	struct sof_eq_fir_config *config;	/**< pointer to setup blob */
 	struct sof_eq_fir_config *config_new;	/**< pointer to new setup */
+	struct sof_eq_fir_config *config_old;	/**< previous, put in IPC */
+	void *recv;				/**< slot of blob in parts */
 	enum sof_ipc_frame source_format;	/**< source frame format */
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
-	int32_t *fir_delay;			/**< pointer to allocated RAM */
+	int32_t *fir_delay;			/**< delay lines of two sets */
 	size_t fir_delay_size;			/**< allocated size */
-	bool config_ready;			/**< set when fully received */
+	int delay_set;				/**< set used by fir[] */
+	struct xfade xfade;			/**< old to new crossfade */
 	void (*eq_fir_func)(struct fir_state_32x16 fir[],
 			    const struct audio_stream *source,
 			    struct audio_stream *sink,
 			    int frames, int nch);
+#if CONFIG_COMP_FIR_FFT
+	struct fir_fft *fft;			/**< set for long responses */
+	void (*eq_fir_fft_func)(struct fir_fft *fft,
+				const struct audio_stream *source,
+				struct audio_stream *sink,
+				int frames, int nch);
+#endif
 };
 
 /*
@@ -125,6 +145,33 @@ static inline void set_s32_fir(struct comp_data *cd)
 #endif /* CONFIG_FORMAT_S32LE */
 #endif
 
+#if CONFIG_COMP_FIR_FFT
+static inline void set_fft_func(struct comp_data *cd,
+				enum sof_ipc_frame frame_fmt)
+{
+	switch (frame_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+		cd->eq_fir_fft_func = eq_fir_fft_s16;
+		break;
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+		cd->eq_fir_fft_func = eq_fir_fft_s24;
+		break;
+#endif /* CONFIG_FORMAT_S24LE */
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+		cd->eq_fir_fft_func = eq_fir_fft_s32;
+		break;
+#endif /* CONFIG_FORMAT_S32LE */
+	default:
+		cd->eq_fir_fft_func = NULL;
+		break;
+	}
+}
+#endif /* CONFIG_COMP_FIR_FFT */
+
 static inline int set_fir_func(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
@@ -133,6 +180,10 @@ static inline int set_fir_func(struct comp_dev *dev)
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
 				  sink_list);
 
+#if CONFIG_COMP_FIR_FFT
+	set_fft_func(cd, sourceb->stream.frame_fmt);
+#endif
+
 	switch (sourceb->stream.frame_fmt) {
 #if CONFIG_FORMAT_S16LE
 	case SOF_IPC_FRAME_S16_LE:
@@ -218,10 +269,18 @@ static inline int set_pass_func(struct comp_dev *dev)
  * EQ control code is next. The processing is in fir_ C modules.
  */
 
-static void eq_fir_free_parameters(struct sof_eq_fir_config **config)
+/* Withdraws the pending blob so that copy() does not switch to it */
+static struct sof_eq_fir_config *eq_fir_withdraw_new(struct comp_data *cd)
 {
-	rfree(*config);
-	*config = NULL;
+	struct sof_eq_fir_config *config;
+	uint32_t flags;
+
+	irq_local_disable(flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	irq_local_enable(flags);
+
+	return config;
 }
 
 static void eq_fir_free_delaylines(struct comp_data *cd)
@@ -235,12 +294,79 @@ static void eq_fir_free_delaylines(struct comp_data *cd)
 	rfree(cd->fir_delay);
 	cd->fir_delay = NULL;
 	cd->fir_delay_size = 0;
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+	for (i = 0; i < cd->channels; i++)
 		fir[i].delay = NULL;
+
+#if CONFIG_COMP_FIR_FFT
+	fir_fft_free(cd->fft);
+	cd->fft = NULL;
+#endif
+}
+
+static void eq_fir_free_channels(struct comp_data *cd)
+{
+	rfree(cd->fir);
+	cd->fir = NULL;
+	cd->fir_old = NULL;
+	cd->channel_eq = NULL;
+	cd->channels = 0;
+}
+
+/* The filters state is allocated for the stream channels count, there is
+ * no limit for it other than the memory.
+ */
+static int eq_fir_alloc_channels(struct comp_data *cd, int nch)
+{
+	eq_fir_free_channels(cd);
+
+	cd->fir = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			  nch * (2 * sizeof(*cd->fir) +
+				 sizeof(*cd->channel_eq)));
+	if (!cd->fir) {
+		comp_cl_err(&comp_eq_fir, "eq_fir_alloc_channels(), state allocation failed for %d channels",
+			    nch);
+		return -ENOMEM;
+	}
+
+	cd->fir_old = cd->fir + nch;
+	cd->channel_eq = (struct sof_eq_fir_coef_data **)(cd->fir_old + nch);
+	cd->channels = nch;
+	return 0;
+}
+
+static int eq_fir_alloc_delaylines(struct comp_data *cd, int nch)
+{
+	struct sof_eq_fir_coef_data longest = {
+		.length = SOF_EQ_FIR_MAX_LENGTH,
+	};
+	size_t size;
+
+#if defined FIR_MAX_LENGTH_BUILD_SPECIFIC
+	longest.length = MIN(longest.length,
+			     ALIGN_UP(FIR_MAX_LENGTH_BUILD_SPECIFIC / nch, 4));
+#endif
+
+	/* Delay lines for the longest responses twice, for the running
+	 * filters and for the filters faded in after a blob update.
+	 */
+	size = 2 * nch * fir_delay_size(&longest);
+
+	eq_fir_free_delaylines(cd);
+
+	cd->fir_delay = rballoc(0, SOF_MEM_CAPS_RAM, size);
+	if (!cd->fir_delay) {
+		comp_cl_err(&comp_eq_fir, "eq_fir_alloc_delaylines(), delay allocation failed for size %d",
+			    size);
+		return -ENOMEM;
+	}
+
+	cd->fir_delay_size = size;
+	return 0;
 }
 
 static int eq_fir_init_coef(struct sof_eq_fir_config *config,
-			    struct fir_state_32x16 *fir, int nch)
+			    struct fir_state_32x16 *fir,
+			    struct sof_eq_fir_coef_data **channel_eq, int nch)
 {
 	struct sof_eq_fir_coef_data *lookup[SOF_EQ_FIR_MAX_RESPONSES];
 	struct sof_eq_fir_coef_data *eq;
@@ -257,9 +383,9 @@ static int eq_fir_init_coef(struct sof_eq_fir_config *config,
 		     config->number_of_responses);
 
 	/* Sanity checks */
-	if (nch > PLATFORM_MAX_CHANNELS ||
-	    config->channels_in_config > PLATFORM_MAX_CHANNELS ||
-	    !config->channels_in_config) {
+	if (!nch || !config->channels_in_config ||
+	    config->channels_in_config > (config->size - sizeof(*config)) /
+	    sizeof(int16_t)) {
 		comp_cl_err(&comp_eq_fir, "eq_fir_init_coef(), invalid channels count");
 		return -EINVAL;
 	}
@@ -301,6 +427,7 @@ static int eq_fir_init_coef(struct sof_eq_fir_config *config,
 			comp_cl_info(&comp_eq_fir, "eq_fir_init_coef(), ch %d is set to bypass",
 				     i);
 			fir_reset(&fir[i]);
+			channel_eq[i] = NULL;
 			continue;
 		}
 
@@ -312,7 +439,14 @@ static int eq_fir_init_coef(struct sof_eq_fir_config *config,
 
 		/* Initialize EQ coefficients. */
 		eq = lookup[resp];
-		s = fir_delay_size(eq);
+#if CONFIG_COMP_FIR_FFT
+		/* responses too long for the direct form run with the FFT */
+		if (eq->length > SOF_EQ_FIR_MAX_LENGTH &&
+		    eq->length <= FIR_FFT_MAX_LENGTH)
+			s = eq->length * sizeof(int32_t);
+		else
+#endif
+			s = fir_delay_size(eq);
 		if (s > 0) {
 			size_sum += s;
 		} else {
@@ -330,6 +464,7 @@ static int eq_fir_init_coef(struct sof_eq_fir_config *config,
 #endif
 
 		fir_init_coef(&fir[i], eq);
+		channel_eq[i] = eq;
 		comp_cl_info(&comp_eq_fir, "eq_fir_init_coef(), ch %d is set to response = %d",
 			     i, resp);
 	}
@@ -350,37 +485,92 @@ static void eq_fir_init_delay(struct fir_state_32x16 *fir,
 	}
 }
 
+#if CONFIG_COMP_FIR_FFT
+/* Long responses are run with the partitioned FFT convolution. A bypass
+ * channel is then delayed as much as the filtered channels.
+ */
+static int eq_fir_setup_fft(struct comp_data *cd,
+			    struct sof_eq_fir_coef_data **channel_eq, int nch)
+{
+	bool use_fft = false;
+	int i;
+
+	for (i = 0; i < nch; i++) {
+		if (!channel_eq[i])
+			continue;
+
+		if (channel_eq[i]->length > FIR_FFT_MAX_LENGTH)
+			return 0;
+
+		if (channel_eq[i]->length > CONFIG_COMP_FIR_FFT_THRESHOLD ||
+		    channel_eq[i]->length > SOF_EQ_FIR_MAX_LENGTH)
+			use_fft = true;
+	}
+
+	if (!use_fft)
+		return 0;
+
+	cd->fft = fir_fft_new(channel_eq, nch, CONFIG_COMP_FIR_FFT_BLOCK);
+	if (!cd->fft) {
+		comp_cl_err(&comp_eq_fir, "eq_fir_setup_fft(), FFT convolution allocation failed");
+		return -ENOMEM;
+	}
+
+	comp_cl_info(&comp_eq_fir, "eq_fir_setup_fft(), block %d",
+		     CONFIG_COMP_FIR_FFT_BLOCK);
+	return 1;
+}
+#endif /* CONFIG_COMP_FIR_FFT */
+
 static int eq_fir_setup(struct comp_data *cd, int nch)
 {
+	struct sof_eq_fir_coef_data **channel_eq = cd->channel_eq;
+	int32_t *delay;
 	int delay_size;
 
-	/* Free existing FIR channels data if it was allocated */
-	eq_fir_free_delaylines(cd);
+#if CONFIG_COMP_FIR_FFT
+	/* Free existing FFT convolution if it was allocated */
+	fir_fft_free(cd->fft);
+	cd->fft = NULL;
+#endif
 
 	/* Set coefficients for each channel EQ from coefficient blob */
-	delay_size = eq_fir_init_coef(cd->config, cd->fir, nch);
+	delay_size = eq_fir_init_coef(cd->config, cd->fir, channel_eq, nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
-	/* If all channels were set to bypass there's no need to
-	 * allocate delay. Just return with success.
+#if CONFIG_COMP_FIR_FFT
+	/* The direct form delay lines are not needed with FFT */
+	if (delay_size) {
+		int ret = eq_fir_setup_fft(cd, channel_eq, nch);
+
+		if (ret)
+			return ret < 0 ? ret : 0;
+	}
+#endif
+
+	/* If all channels were set to bypass there's no need for
+	 * delay. Just return with success.
 	 */
 	if (!delay_size)
 		return 0;
 
-	/* Allocate all FIR channels data in a big chunk and clear it */
-	cd->fir_delay = rballoc(0, SOF_MEM_CAPS_RAM, delay_size);
-	if (!cd->fir_delay) {
-		comp_cl_err(&comp_eq_fir, "eq_fir_setup(), delay allocation failed for size %d",
+	if (delay_size > cd->fir_delay_size / 2) {
+		comp_cl_err(&comp_eq_fir, "eq_fir_setup(), delay size %d exceeds allocated",
 			    delay_size);
-		return -ENOMEM;
+		return -EINVAL;
 	}
 
-	memset(cd->fir_delay, 0, delay_size);
-	cd->fir_delay_size = delay_size;
+	/* Take the set of delay lines the previous filters did not use,
+	 * they may still run for the crossfade.
+	 */
+	cd->delay_set ^= 1;
+	delay = cd->fir_delay + cd->delay_set * cd->fir_delay_size /
+		(2 * sizeof(int32_t));
+	memset(delay, 0, delay_size);
 
 	/* Assign delay line to each channel EQ */
-	eq_fir_init_delay(cd->fir, cd->fir_delay, nch);
+	eq_fir_init_delay(cd->fir, delay, nch);
 	return 0;
 }
 
@@ -397,7 +587,6 @@ static struct comp_dev *eq_fir_new(const struct comp_driver *drv,
 	struct sof_ipc_comp_process *ipc_fir
 		= (struct sof_ipc_comp_process *)comp;
 	size_t bs = ipc_fir->size;
-	int i;
 	int ret;
 
 	comp_cl_info(&comp_eq_fir, "eq_fir_new()");
@@ -433,29 +622,35 @@ static struct comp_dev *eq_fir_new(const struct comp_driver *drv,
 	cd->eq_fir_func = NULL;
 	cd->config = NULL;
 	cd->config_new = NULL;
-	cd->config_ready = false;
+	cd->config_old = NULL;
+	cd->recv = NULL;
 	cd->fir_delay = NULL;
 	cd->fir_delay_size = 0;
 
-	/* Allocate and make a copy of the coefficients blob and reset FIR. If
-	 * the EQ is configured later in run-time the size is zero.
+	/* The blobs are received in slots of the store, an update takes the
+	 * spare slot of the pool.
+	 */
+	if (coef_store_open(SOF_EQ_FIR_MAX_SIZE) < 0) {
+		rfree(dev);
+		rfree(cd);
+		return NULL;
+	}
+
+	/* Get the coefficients blob from the store, instances with the same
+	 * blob share it. If the EQ is configured later in run-time the size
+	 * is zero.
 	 */
 	if (bs) {
-		cd->config = rballoc(0, SOF_MEM_CAPS_RAM, bs);
+		cd->config = coef_store_get(ipc_fir->data, bs,
+					    SOF_EQ_FIR_MAX_SIZE);
 		if (!cd->config) {
+			coef_store_close(SOF_EQ_FIR_MAX_SIZE);
 			rfree(dev);
 			rfree(cd);
 			return NULL;
 		}
-
-		ret = memcpy_s(cd->config, bs, ipc_fir->data, bs);
-		assert(!ret);
-		cd->config_ready = true;
 	}
 
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		fir_reset(&cd->fir[i]);
-
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -467,8 +662,13 @@ static void eq_fir_free(struct comp_dev *dev)
 	comp_info(dev, "eq_fir_free()");
 
 	eq_fir_free_delaylines(cd);
-	eq_fir_free_parameters(&cd->config);
-	eq_fir_free_parameters(&cd->config_new);
+	eq_fir_free_channels(cd);
+	xfade_free(&cd->xfade);
+	coef_store_release(cd->recv);
+	coef_store_put(cd->config);
+	coef_store_put(cd->config_new);
+	coef_store_put(cd->config_old);
+	coef_store_close(SOF_EQ_FIR_MAX_SIZE);
 
 	rfree(cd);
 	rfree(dev);
@@ -566,6 +766,7 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 			    struct sof_ipc_ctrl_data *cdata)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_fir_config *config;
 	unsigned char *dst, *src;
 	uint32_t offset;
 	int ret = 0;
@@ -574,12 +775,6 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 	case SOF_CTRL_CMD_BINARY:
 		comp_info(dev, "fir_cmd_set_data(), SOF_CTRL_CMD_BINARY");
 
-		/* Check that there is no work-in-progress previous request */
-		if (cd->config_new && cdata->msg_index == 0) {
-			comp_err(dev, "fir_cmd_set_data(), busy with previous request");
-			return -EBUSY;
-		}
-
 		/* Copy new config, find size from header */
 		comp_info(dev, "fir_cmd_set_data(): blob size: %u msg_index %u",
 			  cdata->num_elems + cdata->elems_remaining,
@@ -589,55 +784,91 @@ static int fir_cmd_set_data(struct comp_dev *dev,
 			return -EINVAL;
 
 		if (cdata->msg_index == 0) {
-			/* Allocate buffer for copy of the blob. */
-			cd->config_new = rballoc(0, SOF_MEM_CAPS_RAM,
-						 cdata->num_elems +
-						 cdata->elems_remaining);
+			/* A pending blob is replaced by the newer one.
+			 * Withdraw it first so that copy() does not switch
+			 * to it meanwhile.
+			 */
+			coef_store_put(eq_fir_withdraw_new(cd));
+			coef_store_release(cd->recv);
+			cd->recv = NULL;
+
+			/* The old filters use the previous blob until faded */
+			if (xfade_active(&cd->xfade)) {
+				comp_err(dev, "fir_cmd_set_data(), busy with crossfade");
+				return -EBUSY;
+			}
 
-			if (!cd->config_new) {
-				comp_err(dev, "fir_cmd_set_data() error: buffer allocation failed");
-				return -EINVAL;
+			coef_store_put(cd->config_old);
+			cd->config_old = NULL;
+
+			/* The new blob is applied in copy() */
+			dev->identity = false;
+
+			/* A blob in one part goes to the store directly */
+			if (cdata->elems_remaining == 0) {
+				config = coef_store_get(cdata->data->data,
+							cdata->num_elems,
+							SOF_EQ_FIR_MAX_SIZE);
+				goto done;
+			}
+
+			/* The parts are copied to a slot of the store */
+			cd->recv = coef_store_reserve(SOF_EQ_FIR_MAX_SIZE);
+			if (!cd->recv) {
+				comp_err(dev, "fir_cmd_set_data() error: no memory for blob");
+				return -ENOMEM;
 			}
 
-			cd->config_ready = false;
 			offset = 0;
 		} else {
-			assert(cd->config_new);
-			offset = cd->config_new->size - cdata->elems_remaining -
-				cdata->num_elems;
+			if (!cd->recv) {
+				comp_err(dev, "fir_cmd_set_data() error: no first part");
+				return -EINVAL;
+			}
+
+			offset = ((struct sof_eq_fir_config *)cd->recv)->size -
+				cdata->elems_remaining - cdata->num_elems;
+			if (offset > SOF_EQ_FIR_MAX_SIZE - cdata->num_elems) {
+				comp_err(dev, "fir_cmd_set_data() error: invalid part offset %u",
+					 offset);
+				return -EINVAL;
+			}
 		}
 
-		dst = (unsigned char *)cd->config_new;
+		dst = (unsigned char *)cd->recv;
 		src = (unsigned char *)cdata->data->data;
 
-		/* Just copy the configuration. The EQ will be initialized in
-		 * prepare().
+		/* Just copy the part. The EQ will be initialized when the
+		 * blob is complete.
 		 */
-		ret = memcpy_s(dst + offset, cdata->num_elems +
-			       cdata->elems_remaining - offset, src,
+		ret = memcpy_s(dst + offset, SOF_EQ_FIR_MAX_SIZE - offset, src,
 			       cdata->num_elems);
 		assert(!ret);
 
-		/* we can check data when elems_remaining == 0 */
-		if (cdata->elems_remaining == 0) {
-			/* The new configuration is OK to be applied */
-			cd->config_ready = true;
+		if (cdata->elems_remaining)
+			break;
 
-			/* If component state is READY we can omit old
-			 * configuration immediately. When in playback/capture
-			 * the new configuration presence is checked in copy().
-			 */
-			if (dev->state ==  COMP_STATE_READY)
-				eq_fir_free_parameters(&cd->config);
+		/* Share the complete blob or keep it in the slot */
+		config = coef_store_commit(cd->recv,
+					   offset + cdata->num_elems);
+		cd->recv = NULL;
 
-			/* If there is no existing configuration the received
-			 * can be set to current immediately. It will be
-			 * applied in prepare() when streaming starts.
-			 */
-			if (!cd->config) {
-				cd->config = cd->config_new;
-				cd->config_new = NULL;
-			}
+done:
+		if (!config) {
+			comp_err(dev, "fir_cmd_set_data() error: no memory for blob");
+			return -ENOMEM;
+		}
+
+		/* If component state is READY the received configuration is
+		 * set to current immediately. It will be applied in prepare()
+		 * when streaming starts. When prepared or streaming the new
+		 * configuration presence is checked in copy().
+		 */
+		if (dev->state == COMP_STATE_READY) {
+			coef_store_put(cd->config);
+			cd->config = config;
+		} else {
+			cd->config_new = config;
 		}
 		break;
 	default:
@@ -685,6 +916,105 @@ static int eq_fir_trigger(struct comp_dev *dev, int cmd)
 	return comp_set_state(dev, cmd);
 }
 
+/* Runs the current filters */
+static void eq_fir_run(struct comp_data *cd, const struct audio_stream *source,
+		       struct audio_stream *sink, int frames)
+{
+#if CONFIG_COMP_FIR_FFT
+	if (cd->fft && cd->eq_fir_fft_func)
+		cd->eq_fir_fft_func(cd->fft, source, sink, frames,
+				    source->channels);
+	else
+#endif
+		cd->eq_fir_func(cd->fir, source, sink, frames,
+				source->channels);
+}
+
+/* Switches to the pending blob while streaming. The running filters are
+ * kept for the crossfade to the new ones and stay in use if the new blob
+ * fails. A running FFT convolution is replaced without crossfade since
+ * there is memory only for one. Returns an error only when no filters
+ * are left to run. The blob that is no longer used is put with the next
+ * blob update, the old filters run with it until faded out.
+ */
+static int eq_fir_update(struct comp_dev *dev, int nch)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_fir_config *config = cd->config;
+	int ret;
+
+	cd->config = cd->config_new;
+	cd->config_new = NULL;
+	cd->config_old = config;
+
+#if CONFIG_COMP_FIR_FFT
+	if (cd->fft) {
+		ret = eq_fir_setup(cd, nch);
+		if (ret < 0) {
+			comp_err(dev, "eq_fir_update(), failed FIR setup");
+			return ret;
+		}
+
+		return set_fir_func(dev);
+	}
+#endif
+
+	ret = memcpy_s(cd->fir_old, nch * sizeof(*cd->fir_old), cd->fir,
+		       nch * sizeof(*cd->fir));
+	assert(!ret);
+
+	ret = eq_fir_setup(cd, nch);
+	if (ret < 0) {
+		comp_err(dev, "eq_fir_update(), failed FIR setup");
+		cd->config_old = cd->config;
+		cd->config = config;
+		ret = memcpy_s(cd->fir, nch * sizeof(*cd->fir), cd->fir_old,
+			       nch * sizeof(*cd->fir_old));
+		assert(!ret);
+		return 0;
+	}
+
+	/* The old filters keep running with the function of the new ones,
+	 * a pass-through is the same as filters in bypass.
+	 */
+	ret = set_fir_func(dev);
+	if (ret < 0)
+		return ret;
+
+	xfade_start(&cd->xfade);
+	return 0;
+}
+
+/* Runs the old and the new filters side by side and fades from the old
+ * output to the new one.
+ */
+static void eq_fir_process_xfade(struct comp_data *cd,
+				 const struct audio_stream *source,
+				 struct audio_stream *sink, int frames)
+{
+	struct audio_stream src = *source;
+	struct audio_stream snk = *sink;
+	int src_bytes = audio_stream_frame_bytes(source);
+	int snk_bytes = audio_stream_frame_bytes(sink);
+	int n;
+
+	while (frames && xfade_active(&cd->xfade)) {
+		n = xfade_chunk(&cd->xfade, frames);
+		eq_fir_run(cd, &src, &cd->xfade.scratch, n);
+		cd->eq_fir_func(cd->fir_old, &src, &snk, n, src.channels);
+		xfade_mix(&cd->xfade, &snk, n);
+
+		src.r_ptr = audio_stream_wrap(&src, (char *)src.r_ptr +
+					      n * src_bytes);
+		snk.w_ptr = audio_stream_wrap(&snk, (char *)snk.w_ptr +
+					      n * snk_bytes);
+		frames -= n;
+	}
+
+	if (frames)
+		eq_fir_run(cd, &src, &snk, frames);
+}
+
 /* copy and process stream data from source to sink buffers */
 static int eq_fir_copy(struct comp_dev *dev)
 {
@@ -700,15 +1030,10 @@ static int eq_fir_copy(struct comp_dev *dev)
 				  sink_list);
 
 	/* Check for changed configuration */
-	if (cd->config_new && cd->config_ready) {
-		eq_fir_free_parameters(&cd->config);
-		cd->config = cd->config_new;
-		cd->config_new = NULL;
-		ret = eq_fir_setup(cd, sourceb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "eq_fir_copy(), failed FIR setup");
+	if (cd->config_new) {
+		ret = eq_fir_update(dev, sourceb->stream.channels);
+		if (ret < 0)
 			return ret;
-		}
 	}
 
 	/* Get source, sink, number of frames etc. to process. */
@@ -726,8 +1051,12 @@ static int eq_fir_copy(struct comp_dev *dev)
 		n = (cl.frames >> 1) << 1;
 
 		/* Run EQ function */
-		cd->eq_fir_func(cd->fir, &cl.source->stream, &cl.sink->stream,
-				n, cl.source->stream.channels);
+		if (xfade_active(&cd->xfade))
+			eq_fir_process_xfade(cd, &cl.source->stream,
+					     &cl.sink->stream, n);
+		else
+			eq_fir_run(cd, &cl.source->stream, &cl.sink->stream,
+				   n);
 
 		/* calc new free and available */
 		comp_update_buffer_consume(cl.source,
@@ -782,8 +1111,26 @@ static int eq_fir_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
+	/* Allocate the filters state, the delay lines and the crossfade
+	 * scratch for blob updates while streaming.
+	 */
+	ret = eq_fir_alloc_channels(cd, sourceb->stream.channels);
+	if (ret < 0)
+		goto err;
+
+	ret = eq_fir_alloc_delaylines(cd, sourceb->stream.channels);
+	if (ret < 0)
+		goto err;
+
+	ret = xfade_init(&cd->xfade, &sinkb->stream, dev->frames);
+	if (ret < 0) {
+		comp_err(dev, "eq_fir_prepare() error: crossfade allocation failed");
+		goto err;
+	}
+
 	/* Initialize EQ */
-	if (cd->config && cd->config_ready) {
+	dev->identity = false;
+	if (cd->config) {
 		ret = eq_fir_setup(cd, sourceb->stream.channels);
 		if (ret < 0) {
 			comp_err(dev, "eq_fir_prepare() error: eq_fir_setup failed.");
@@ -795,7 +1142,12 @@ static int eq_fir_prepare(struct comp_dev *dev)
 	}
 
 	ret = set_pass_func(dev);
-	return ret;
+	if (ret < 0)
+		return ret;
+
+	/* same format pass-through can be bypassed */
+	dev->identity = cd->source_format == cd->sink_format;
+	return 0;
 
 err:
 	comp_set_state(dev, COMP_TRIGGER_RESET);
@@ -804,16 +1156,29 @@ err:
 
 static int eq_fir_reset(struct comp_dev *dev)
 {
-	int i;
 	struct comp_data *cd = comp_get_drvdata(dev);
 
 	comp_info(dev, "eq_fir_reset()");
 
 	eq_fir_free_delaylines(cd);
+	eq_fir_free_channels(cd);
+	xfade_free(&cd->xfade);
+
+	coef_store_put(cd->config_old);
+	cd->config_old = NULL;
+
+	/* A blob received after the last copy() is used in next prepare() */
+	if (cd->config_new) {
+		coef_store_put(cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
 
 	cd->eq_fir_func = NULL;
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		fir_reset(&cd->fir[i]);
+#if CONFIG_COMP_FIR_FFT
+	cd->eq_fir_fft_func = NULL;
+#endif
+	dev->identity = false;
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
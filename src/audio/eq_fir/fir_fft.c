@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/buffer.h>
+#include <sof/audio/eq_fir/fir_fft.h>
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/lib/alloc.h>
+#include <sof/math/fft.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#include <sof/string.h>
+#include <ipc/topology.h>
+#include <user/eq.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Partition products are accumulated with this right shift, enough for
+ * FIR_FFT_MAX_LENGTH / 16 partitions without 64 bit overflow.
+ */
+#define FIR_FFT_ACC_SHIFT	8
+
+/* Spectra of the zero padded partitions of a Q1.15 response, normalized
+ * to the full Q1.31 range. Returns the normalization shift.
+ */
+static int fir_fft_coef_init(struct fir_fft *fft, struct icomplex32 *coef,
+			     const struct sof_eq_fir_coef_data *eq,
+			     int partitions)
+{
+	struct icomplex32 *h;
+	int32_t *t = fft->time;
+	int32_t max = 0;
+	int shift;
+	int p;
+	int i;
+	int n;
+
+	for (p = 0; p < partitions; p++) {
+		for (i = 0; i < 2 * fft->block; i++) {
+			n = p * fft->block + i;
+			t[i] = i < fft->block && n < eq->length ?
+				(int32_t)eq->coef[n] << 16 : 0;
+		}
+
+		h = coef + p * fft->bins;
+		fft_real_execute_32(fft->plan, t, h);
+		for (i = 0; i < fft->bins; i++) {
+			max = MAX(max, ABS(h[i].real));
+			max = MAX(max, ABS(h[i].imag));
+		}
+	}
+
+	shift = max ? norm_int32(max) : 0;
+	for (i = 0; i < partitions * fft->bins; i++) {
+		coef[i].real <<= shift;
+		coef[i].imag <<= shift;
+	}
+
+	return shift;
+}
+
+struct fir_fft *fir_fft_new(struct sof_eq_fir_coef_data **eq, int nch,
+			    int block)
+{
+	struct fir_fft_channel *ch;
+	struct fir_fft *fft;
+	struct icomplex32 *coef;
+	uint8_t *state;
+	size_t coef_size = 0;
+	size_t state_size = 0;
+	int coef_shift;
+	int len;
+	int i;
+	int j;
+
+	if (nch < 1 || block < 4 || (block & (block - 1)) ||
+	    2 * block > FFT_SIZE_MAX)
+		return NULL;
+
+	fft = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		      sizeof(*fft) + nch * sizeof(fft->ch[0]));
+	if (!fft)
+		return NULL;
+
+	fft->block = block;
+	fft->bins = block + 1;
+
+	/* Sizes of the spectra, shared by channels with the same response,
+	 * and of the channel states.
+	 */
+	for (i = 0; i < nch; i++) {
+		ch = &fft->ch[i];
+		state_size += 3 * block * sizeof(int32_t);
+		if (!eq[i])
+			continue;
+
+		if (eq[i]->length < 1 || eq[i]->length > FIR_FFT_MAX_LENGTH)
+			goto err;
+
+		ch->partitions = ceil_divide(eq[i]->length, block);
+		state_size += ch->partitions * fft->bins * sizeof(*ch->fdl);
+		for (j = 0; j < i; j++)
+			if (eq[j] == eq[i])
+				break;
+
+		if (j == i)
+			coef_size += ch->partitions * fft->bins * sizeof(*coef);
+	}
+
+	fft->plan = fft_real_plan_new(2 * block);
+	fft->spectrum = rballoc(0, SOF_MEM_CAPS_RAM,
+				fft->bins * sizeof(*fft->spectrum));
+	fft->acc = rballoc(0, SOF_MEM_CAPS_RAM,
+			   2 * fft->bins * sizeof(*fft->acc));
+	fft->time = rballoc(0, SOF_MEM_CAPS_RAM,
+			    2 * block * sizeof(*fft->time));
+	fft->state_mem = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				 state_size);
+	if (coef_size)
+		fft->coef_mem = rballoc(0, SOF_MEM_CAPS_RAM, coef_size);
+	if (!fft->plan || !fft->spectrum || !fft->acc || !fft->time ||
+	    !fft->state_mem || (coef_size && !fft->coef_mem))
+		goto err;
+
+	len = ffs(2 * block) - 1;
+	coef = fft->coef_mem;
+	state = fft->state_mem;
+	for (i = 0; i < nch; i++) {
+		ch = &fft->ch[i];
+		ch->in = (int32_t *)state;
+		ch->out = ch->in + 2 * block;
+		state += 3 * block * sizeof(int32_t);
+		if (!eq[i])
+			continue;
+
+		ch->fdl = (struct icomplex32 *)state;
+		state += ch->partitions * fft->bins * sizeof(*ch->fdl);
+
+		for (j = 0; j < i; j++)
+			if (eq[j] == eq[i])
+				break;
+
+		/* The same response has the same spectra and shift */
+		if (j < i) {
+			ch->coef = fft->ch[j].coef;
+			ch->shift = fft->ch[j].shift;
+			continue;
+		}
+
+		ch->coef = coef;
+		coef_shift = fir_fft_coef_init(fft, coef, eq[i],
+					       ch->partitions);
+		coef += ch->partitions * fft->bins;
+
+		/* Products of the 1/2B scaled transforms lose 2 * len bits
+		 * and the accumulation 8 more, the output is Q1.31 shifted
+		 * right by out_shift like with the direct form filter.
+		 */
+		ch->shift = 2 * len - coef_shift + FIR_FFT_ACC_SHIFT -
+			    31 - eq[i]->out_shift;
+	}
+
+	return fft;
+
+err:
+	fir_fft_free(fft);
+	return NULL;
+}
+
+void fir_fft_free(struct fir_fft *fft)
+{
+	if (!fft)
+		return;
+
+	fft_real_plan_free(fft->plan);
+	rfree(fft->spectrum);
+	rfree(fft->acc);
+	rfree(fft->time);
+	rfree(fft->coef_mem);
+	rfree(fft->state_mem);
+	rfree(fft);
+}
+
+static inline int32_t fir_fft_scale(int32_t x, int shift)
+{
+	if (shift >= 0)
+		return sat_int32((int64_t)x << MIN(shift, 32));
+
+	if (shift < -31)
+		return 0;
+
+	return ((int64_t)x + (1LL << (-shift - 1))) >> -shift;
+}
+
+void fir_fft_block(struct fir_fft *fft, struct fir_fft_channel *ch)
+{
+	const struct icomplex32 *h;
+	const struct icomplex32 *x;
+	int32_t *time = fft->time;
+	int64_t *acc = fft->acc;
+	uint64_t max = 0;
+	int block = fft->block;
+	int bins = fft->bins;
+	int shift = 0;
+	int idx;
+	int p;
+	int i;
+
+	/* Bypass is a delay of one block */
+	if (!ch->coef) {
+		memcpy_s(ch->out, block * sizeof(int32_t), ch->in + block,
+			 block * sizeof(int32_t));
+		memcpy_s(ch->in, block * sizeof(int32_t), ch->in + block,
+			 block * sizeof(int32_t));
+		return;
+	}
+
+	fft_real_execute_32(fft->plan, ch->in, ch->fdl + ch->fdl_pos * bins);
+
+	/* The current block is the previous one for the next transform */
+	memcpy_s(ch->in, block * sizeof(int32_t), ch->in + block,
+		 block * sizeof(int32_t));
+
+	memset(acc, 0, 2 * bins * sizeof(*acc));
+	idx = ch->fdl_pos;
+	for (p = 0; p < ch->partitions; p++) {
+		x = ch->fdl + idx * bins;
+		h = ch->coef + p * bins;
+		for (i = 0; i < bins; i++) {
+			acc[2 * i] += (((int64_t)x[i].real * h[i].real) >>
+				       FIR_FFT_ACC_SHIFT) -
+				      (((int64_t)x[i].imag * h[i].imag) >>
+				       FIR_FFT_ACC_SHIFT);
+			acc[2 * i + 1] += (((int64_t)x[i].real * h[i].imag) >>
+					   FIR_FFT_ACC_SHIFT) +
+					  (((int64_t)x[i].imag * h[i].real) >>
+					   FIR_FFT_ACC_SHIFT);
+		}
+
+		/* older input blocks pair with later partitions */
+		idx = idx ? idx - 1 : ch->partitions - 1;
+	}
+
+	if (++ch->fdl_pos == ch->partitions)
+		ch->fdl_pos = 0;
+
+	/* Block floating point, the largest product sum to Q3.29 to leave
+	 * headroom for the sums of the real inverse transform split.
+	 */
+	for (i = 0; i < 2 * bins; i++)
+		max |= acc[i] < 0 ? ~acc[i] : acc[i];
+
+	while (max >> (shift + 29))
+		shift++;
+
+	for (i = 0; i < bins; i++) {
+		fft->spectrum[i].real = acc[2 * i] >> shift;
+		fft->spectrum[i].imag = acc[2 * i + 1] >> shift;
+	}
+
+	fft_real_inverse_32(fft->plan, fft->spectrum, time);
+
+	/* Overlap-save, the second half is the linear convolution */
+	shift += ch->shift;
+	for (i = 0; i < block; i++)
+		ch->out[i] = fir_fft_scale(time[block + i], shift);
+}
+
+#if CONFIG_FORMAT_S16LE
+void eq_fir_fft_s16(struct fir_fft *fft, const struct audio_stream *source,
+		    struct audio_stream *sink, int frames, int nch)
+{
+	struct fir_fft_channel *ch;
+	int16_t *x;
+	int16_t *y;
+	int32_t z;
+	int idx;
+	int c;
+	int i;
+
+	for (c = 0; c < nch; c++) {
+		ch = &fft->ch[c];
+		idx = c;
+		for (i = 0; i < frames; i++) {
+			x = audio_stream_read_frag_s16(source, idx);
+			y = audio_stream_write_frag_s16(sink, idx);
+			z = fir_fft_32(fft, ch, *x << 16);
+			*y = sat_int16(Q_SHIFT_RND(z, 31, 15));
+			idx += nch;
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+void eq_fir_fft_s24(struct fir_fft *fft, const struct audio_stream *source,
+		    struct audio_stream *sink, int frames, int nch)
+{
+	struct fir_fft_channel *ch;
+	int32_t *x;
+	int32_t *y;
+	int32_t z;
+	int idx;
+	int c;
+	int i;
+
+	for (c = 0; c < nch; c++) {
+		ch = &fft->ch[c];
+		idx = c;
+		for (i = 0; i < frames; i++) {
+			x = audio_stream_read_frag_s32(source, idx);
+			y = audio_stream_write_frag_s32(sink, idx);
+			z = fir_fft_32(fft, ch, *x << 8);
+			*y = sat_int24(Q_SHIFT_RND(z, 31, 23));
+			idx += nch;
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+void eq_fir_fft_s32(struct fir_fft *fft, const struct audio_stream *source,
+		    struct audio_stream *sink, int frames, int nch)
+{
+	struct fir_fft_channel *ch;
+	int32_t *x;
+	int32_t *y;
+	int idx;
+	int c;
+	int i;
+
+	for (c = 0; c < nch; c++) {
+		ch = &fft->ch[c];
+		idx = c;
+		for (i = 0; i < frames; i++) {
+			x = audio_stream_read_frag_s32(source, idx);
+			y = audio_stream_write_frag_s32(sink, idx);
+			*y = fir_fft_32(fft, ch, *x);
+			idx += nch;
+		}
+	}
+}
+#endif /* CONFIG_FORMAT_S32LE */
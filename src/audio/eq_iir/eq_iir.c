@@ -6,14 +6,17 @@
 //         Liam Girdwood <liam.r.girdwood@linux.intel.com>
 //         Keyon Jie <yang.jie@linux.intel.com>
 
+#include <sof/audio/coef_store.h>
 #include <sof/audio/component.h>
 #include <sof/audio/buffer.h>
 #include <sof/audio/eq_iir/eq_iir.h>
 #include <sof/audio/eq_iir/iir.h>
 #include <sof/audio/format.h>
 #include <sof/audio/pipeline.h>
+#include <sof/audio/xfade.h>
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/memory.h>
@@ -34,13 +37,18 @@ static const struct comp_driver comp_eq_iir;
 
 /* IIR component private data */
 struct comp_data {
-	struct iir_state_df2t iir[PLATFORM_MAX_CHANNELS]; /**< filters state */
+	struct iir_state_df2t *iir;		/**< filters state */
+	struct iir_state_df2t *iir_old;		/**< faded out filters */
+	int channels;				/**< channels with state */
 	struct sof_eq_iir_config *config;	/**< pointer to setup blob */
 	struct sof_eq_iir_config *config_new;	/**< pointer to new setup */
+	struct sof_eq_iir_config *config_old;	/**< previous, put in IPC */
 	enum sof_ipc_frame source_format;	/**< source frame format */
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
-	int64_t *iir_delay;			/**< pointer to allocated RAM */
+	int64_t *iir_delay;			/**< delay lines of two sets */
 	size_t iir_delay_size;			/**< allocated size */
+	int delay_set;				/**< set used by iir[] */
+	struct xfade xfade;			/**< old to new crossfade */
 	eq_iir_func eq_iir_func;		/**< processing function */
 };
 
@@ -49,13 +57,12 @@ struct comp_data {
  * EQ IIR algorithm code
  */
 
-static void eq_iir_s16_default(const struct comp_dev *dev,
+static void eq_iir_s16_default(struct iir_state_df2t iir[],
 			       const struct audio_stream *source,
 			       struct audio_stream *sink,
 			       uint32_t frames)
 
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
 	int16_t *x;
 	int16_t *y;
@@ -66,7 +73,7 @@ static void eq_iir_s16_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s16(source, idx);
@@ -80,13 +87,12 @@ static void eq_iir_s16_default(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE
-static void eq_iir_s24_default(const struct comp_dev *dev,
+static void eq_iir_s24_default(struct iir_state_df2t iir[],
 			       const struct audio_stream *source,
 			       struct audio_stream *sink,
 			       uint32_t frames)
 
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
 	int32_t *x;
 	int32_t *y;
@@ -97,7 +103,7 @@ static void eq_iir_s24_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -111,13 +117,12 @@ static void eq_iir_s24_default(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
-static void eq_iir_s32_default(const struct comp_dev *dev,
+static void eq_iir_s32_default(struct iir_state_df2t iir[],
 			       const struct audio_stream *source,
 			       struct audio_stream *sink,
 			       uint32_t frames)
 
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
 	int32_t *x;
 	int32_t *y;
@@ -127,7 +132,7 @@ static void eq_iir_s32_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -140,13 +145,12 @@ static void eq_iir_s32_default(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S32LE */
 
 #if CONFIG_FORMAT_S32LE && CONFIG_FORMAT_S16LE
-static void eq_iir_s32_16_default(const struct comp_dev *dev,
+static void eq_iir_s32_16_default(struct iir_state_df2t iir[],
 				  const struct audio_stream *source,
 				  struct audio_stream *sink,
 				  uint32_t frames)
 
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
 	int32_t *x;
 	int16_t *y;
@@ -157,7 +161,7 @@ static void eq_iir_s32_16_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -171,13 +175,12 @@ static void eq_iir_s32_16_default(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S32LE && CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S32LE && CONFIG_FORMAT_S24LE
-static void eq_iir_s32_24_default(const struct comp_dev *dev,
+static void eq_iir_s32_24_default(struct iir_state_df2t iir[],
 				  const struct audio_stream *source,
 				  struct audio_stream *sink,
 				  uint32_t frames)
 
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	struct iir_state_df2t *filter;
 	int32_t *x;
 	int32_t *y;
@@ -188,7 +191,7 @@ static void eq_iir_s32_24_default(const struct comp_dev *dev,
 	int nch = source->channels;
 
 	for (ch = 0; ch < nch; ch++) {
-		filter = &cd->iir[ch];
+		filter = &iir[ch];
 		idx = ch;
 		for (i = 0; i < frames; i++) {
 			x = audio_stream_read_frag_s32(source, idx);
@@ -202,7 +205,7 @@ static void eq_iir_s32_24_default(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S32LE && CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S16LE
-static void eq_iir_s16_pass(const struct comp_dev *dev,
+static void eq_iir_s16_pass(struct iir_state_df2t iir[],
 			    const struct audio_stream *source,
 			    struct audio_stream *sink,
 			    uint32_t frames)
@@ -212,7 +215,7 @@ static void eq_iir_s16_pass(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
-static void eq_iir_s32_pass(const struct comp_dev *dev,
+static void eq_iir_s32_pass(struct iir_state_df2t iir[],
 			    const struct audio_stream *source,
 			    struct audio_stream *sink,
 			    uint32_t frames)
@@ -222,7 +225,7 @@ static void eq_iir_s32_pass(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 
 #if CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE
-static void eq_iir_s32_s16_pass(const struct comp_dev *dev,
+static void eq_iir_s32_s16_pass(struct iir_state_df2t iir[],
 				const struct audio_stream *source,
 				struct audio_stream *sink,
 				uint32_t frames)
@@ -241,7 +244,7 @@ static void eq_iir_s32_s16_pass(const struct comp_dev *dev,
 #endif /* CONFIG_FORMAT_S16LE && CONFIG_FORMAT_S32LE */
 
 #if CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE
-static void eq_iir_s32_s24_pass(const struct comp_dev *dev,
+static void eq_iir_s32_s24_pass(struct iir_state_df2t iir[],
 				const struct audio_stream *source,
 				struct audio_stream *sink,
 				uint32_t frames)
@@ -328,10 +331,46 @@ static eq_iir_func eq_iir_find_func(struct comp_data *cd,
 	return NULL;
 }
 
-static void eq_iir_free_parameters(struct sof_eq_iir_config **config)
+/* Withdraws the pending blob so that copy() does not switch to it */
+static struct sof_eq_iir_config *eq_iir_withdraw_new(struct comp_data *cd)
+{
+	struct sof_eq_iir_config *config;
+	uint32_t flags;
+
+	irq_local_disable(flags);
+	config = cd->config_new;
+	cd->config_new = NULL;
+	irq_local_enable(flags);
+
+	return config;
+}
+
+static void eq_iir_free_channels(struct comp_data *cd)
+{
+	rfree(cd->iir);
+	cd->iir = NULL;
+	cd->iir_old = NULL;
+	cd->channels = 0;
+}
+
+/* The filters state is allocated for the stream channels count, there is
+ * no limit for it other than the memory.
+ */
+static int eq_iir_alloc_channels(struct comp_data *cd, int nch)
 {
-	rfree(*config);
-	*config = NULL;
+	eq_iir_free_channels(cd);
+
+	cd->iir = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			  2 * nch * sizeof(*cd->iir));
+	if (!cd->iir) {
+		comp_cl_err(&comp_eq_iir, "eq_iir_alloc_channels(), state allocation fail for %d channels",
+			    nch);
+		return -ENOMEM;
+	}
+
+	cd->iir_old = cd->iir + nch;
+	cd->channels = nch;
+	return 0;
 }
 
 static void eq_iir_free_delaylines(struct comp_data *cd)
@@ -345,10 +384,31 @@ static void eq_iir_free_delaylines(struct comp_data *cd)
 	rfree(cd->iir_delay);
 	cd->iir_delay = NULL;
 	cd->iir_delay_size = 0;
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+	for (i = 0; i < cd->channels; i++)
 		iir[i].delay = NULL;
 }
 
+static int eq_iir_alloc_delaylines(struct comp_data *cd, int nch)
+{
+	/* Delay lines for the longest responses twice, for the running
+	 * filters and for the filters faded in after a blob update.
+	 */
+	size_t size = 2 * nch * IIR_DF2T_NUM_DELAYS *
+		      SOF_EQ_IIR_DF2T_BIQUADS_MAX * sizeof(int64_t);
+
+	eq_iir_free_delaylines(cd);
+
+	cd->iir_delay = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				size);
+	if (!cd->iir_delay) {
+		comp_cl_err(&comp_eq_iir, "eq_iir_alloc_delaylines(), delay allocation fail");
+		return -ENOMEM;
+	}
+
+	cd->iir_delay_size = size;
+	return 0;
+}
+
 static int eq_iir_init_coef(struct sof_eq_iir_config *config,
 			    struct iir_state_df2t *iir, int nch)
 {
@@ -367,9 +427,9 @@ static int eq_iir_init_coef(struct sof_eq_iir_config *config,
 		     config->number_of_responses);
 
 	/* Sanity checks */
-	if (nch > PLATFORM_MAX_CHANNELS ||
-	    config->channels_in_config > PLATFORM_MAX_CHANNELS ||
-	    !config->channels_in_config) {
+	if (!nch || !config->channels_in_config ||
+	    config->channels_in_config > (config->size - sizeof(*config)) /
+	    sizeof(int32_t)) {
 		comp_cl_err(&comp_eq_iir, "eq_iir_init_coef(), invalid channels count");
 		return -EINVAL;
 	}
@@ -457,38 +517,113 @@ static void eq_iir_init_delay(struct iir_state_df2t *iir,
 
 static int eq_iir_setup(struct comp_data *cd, int nch)
 {
+	int64_t *delay;
 	int delay_size;
 
-	/* Free existing IIR channels data if it was allocated */
-	eq_iir_free_delaylines(cd);
-
 	/* Set coefficients for each channel EQ from coefficient blob */
 	delay_size = eq_iir_init_coef(cd->config, cd->iir, nch);
 	if (delay_size < 0)
 		return delay_size; /* Contains error code */
 
-	/* If all channels were set to bypass there's no need to
-	 * allocate delay. Just return with success.
+	/* If all channels were set to bypass there's no need for
+	 * delay. Just return with success.
 	 */
 	if (!delay_size)
 		return 0;
 
-	/* Allocate all IIR channels data in a big chunk and clear it */
-	cd->iir_delay = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-				delay_size);
-	if (!cd->iir_delay) {
-		comp_cl_err(&comp_eq_iir, "eq_iir_setup(), delay allocation fail");
-		return -ENOMEM;
+	if (delay_size > cd->iir_delay_size / 2) {
+		comp_cl_err(&comp_eq_iir, "eq_iir_setup(), delay size %d exceeds allocated",
+			    delay_size);
+		return -EINVAL;
 	}
 
-	memset(cd->iir_delay, 0, delay_size);
-	cd->iir_delay_size = delay_size;
+	/* Take the set of delay lines the previous filters did not use,
+	 * they may still run for the crossfade.
+	 */
+	cd->delay_set ^= 1;
+	delay = cd->iir_delay + cd->delay_set * cd->iir_delay_size /
+		(2 * sizeof(int64_t));
+	memset(delay, 0, delay_size);
 
 	/* Assign delay line to each channel EQ */
-	eq_iir_init_delay(cd->iir, cd->iir_delay, nch);
+	eq_iir_init_delay(cd->iir, delay, nch);
 	return 0;
 }
 
+/* Switches to the pending blob while streaming. The running filters are
+ * kept for the crossfade to the new ones and stay in use if the new blob
+ * fails. The blob that is no longer used is put with the next blob
+ * update, the old filters run with it until faded out.
+ */
+static void eq_iir_update(struct comp_dev *dev, int nch)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_eq_iir_config *config = cd->config;
+	eq_iir_func func;
+	int ret;
+
+	cd->config = cd->config_new;
+	cd->config_new = NULL;
+
+	func = eq_iir_find_func(cd, fm_configured, ARRAY_SIZE(fm_configured));
+	if (!func) {
+		comp_err(dev, "eq_iir_update(), No proc func");
+		cd->config_old = cd->config;
+		cd->config = config;
+		return;
+	}
+
+	ret = memcpy_s(cd->iir_old, nch * sizeof(*cd->iir_old), cd->iir,
+		       nch * sizeof(*cd->iir));
+	assert(!ret);
+
+	ret = eq_iir_setup(cd, nch);
+	if (ret < 0) {
+		comp_err(dev, "eq_iir_update(), failed IIR setup");
+		cd->config_old = cd->config;
+		cd->config = config;
+		ret = memcpy_s(cd->iir, nch * sizeof(*cd->iir), cd->iir_old,
+			       nch * sizeof(*cd->iir_old));
+		assert(!ret);
+		return;
+	}
+
+	cd->config_old = config;
+	cd->eq_iir_func = func;
+	xfade_start(&cd->xfade);
+}
+
+/* Runs the old and the new filters side by side and fades from the old
+ * output to the new one. The new filters run first since with in place
+ * buffers the old ones overwrite the source.
+ */
+static void eq_iir_process_xfade(struct comp_data *cd,
+				 const struct audio_stream *source,
+				 struct audio_stream *sink, int frames)
+{
+	struct audio_stream src = *source;
+	struct audio_stream snk = *sink;
+	int src_bytes = audio_stream_frame_bytes(source);
+	int snk_bytes = audio_stream_frame_bytes(sink);
+	int n;
+
+	while (frames && xfade_active(&cd->xfade)) {
+		n = xfade_chunk(&cd->xfade, frames);
+		cd->eq_iir_func(cd->iir, &src, &cd->xfade.scratch, n);
+		cd->eq_iir_func(cd->iir_old, &src, &snk, n);
+		xfade_mix(&cd->xfade, &snk, n);
+
+		src.r_ptr = audio_stream_wrap(&src, (char *)src.r_ptr +
+					      n * src_bytes);
+		snk.w_ptr = audio_stream_wrap(&snk, (char *)snk.w_ptr +
+					      n * snk_bytes);
+		frames -= n;
+	}
+
+	if (frames)
+		cd->eq_iir_func(cd->iir, &src, &snk, frames);
+}
+
 /*
  * End of EQ setup code. Next the standard component methods.
  */
@@ -502,7 +637,6 @@ static struct comp_dev *eq_iir_new(const struct comp_driver *drv,
 	struct sof_ipc_comp_process *ipc_iir =
 		(struct sof_ipc_comp_process *)comp;
 	size_t bs = ipc_iir->size;
-	int i;
 	int ret;
 
 	comp_cl_info(&comp_eq_iir, "eq_iir_new()");
@@ -540,26 +674,32 @@ static struct comp_dev *eq_iir_new(const struct comp_driver *drv,
 	cd->iir_delay_size = 0;
 	cd->config = NULL;
 	cd->config_new = NULL;
+	cd->config_old = NULL;
 
-	/* Allocate and make a copy of the coefficients blob and reset IIR. If
-	 * the EQ is configured later in run-time the size is zero.
+	/* The blobs are received in slots of the store, an update takes the
+	 * spare slot of the pool.
+	 */
+	if (coef_store_open(SOF_EQ_IIR_MAX_SIZE) < 0) {
+		rfree(dev);
+		rfree(cd);
+		return NULL;
+	}
+
+	/* Get the coefficients blob from the store, instances with the same
+	 * blob share it. If the EQ is configured later in run-time the size
+	 * is zero.
 	 */
 	if (bs) {
-		cd->config = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
-				     bs);
+		cd->config = coef_store_get(ipc_iir->data, bs,
+					    SOF_EQ_IIR_MAX_SIZE);
 		if (!cd->config) {
+			coef_store_close(SOF_EQ_IIR_MAX_SIZE);
 			rfree(dev);
 			rfree(cd);
 			return NULL;
 		}
-
-		ret = memcpy_s(cd->config, bs, ipc_iir->data, bs);
-		assert(!ret);
 	}
 
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		iir_reset_df2t(&cd->iir[i]);
-
 	dev->state = COMP_STATE_READY;
 	return dev;
 }
@@ -571,8 +711,12 @@ static void eq_iir_free(struct comp_dev *dev)
 	comp_info(dev, "eq_iir_free()");
 
 	eq_iir_free_delaylines(cd);
-	eq_iir_free_parameters(&cd->config);
-	eq_iir_free_parameters(&cd->config_new);
+	eq_iir_free_channels(cd);
+	xfade_free(&cd->xfade);
+	coef_store_put(cd->config);
+	coef_store_put(cd->config_new);
+	coef_store_put(cd->config_old);
+	coef_store_close(SOF_EQ_IIR_MAX_SIZE);
 
 	rfree(cd);
 	rfree(dev);
@@ -673,40 +817,40 @@ static int iir_cmd_set_data(struct comp_dev *dev,
 			return -EINVAL;
 		}
 
-		/* Check that there is no work-in-progress previous request */
-		if (cd->config_new) {
-			comp_err(dev, "iir_cmd_set_data(), busy with previous");
+		/* A pending blob is replaced by the newer one. Withdraw it
+		 * first so that copy() does not switch to it meanwhile.
+		 */
+		coef_store_put(eq_iir_withdraw_new(cd));
+
+		/* The old filters use the previous blob until faded out */
+		if (xfade_active(&cd->xfade)) {
+			comp_err(dev, "iir_cmd_set_data(), busy with crossfade");
 			return -EBUSY;
 		}
 
-		/* Allocate and make a copy of the blob and setup IIR */
-		cd->config_new = rzalloc(SOF_MEM_ZONE_RUNTIME, 0,
-					 SOF_MEM_CAPS_RAM, bs);
-		if (!cd->config_new) {
-			comp_err(dev, "iir_cmd_set_data(), alloc fail");
-			return -EINVAL;
-		}
+		coef_store_put(cd->config_old);
+		cd->config_old = NULL;
 
-		/* Copy the configuration. If the component state is ready
-		 * the EQ will initialize in prepare().
-		 */
-		ret = memcpy_s(cd->config_new, bs, cdata->data->data, bs);
-		assert(!ret);
+		/* The new blob is applied in copy() */
+		dev->identity = false;
 
-		/* If component state is READY we can omit old configuration
-		 * immediately. When in playback/capture the new configuration
-		 * presence is checked in copy().
-		 */
-		if (dev->state ==  COMP_STATE_READY)
-			eq_iir_free_parameters(&cd->config);
+		/* Get a shared copy of the configuration */
+		request = coef_store_get(cdata->data->data, bs,
+					 SOF_EQ_IIR_MAX_SIZE);
+		if (!request) {
+			comp_err(dev, "iir_cmd_set_data(), no memory for blob");
+			return -ENOMEM;
+		}
 
-		/* If there is no existing configuration the received can
-		 * be set to current immediately. It will be applied in
-		 * prepare() when streaming starts.
+		/* If component state is READY the EQ will initialize in
+		 * prepare(). When prepared or streaming the new configuration
+		 * presence is checked in copy().
 		 */
-		if (!cd->config) {
-			cd->config = cd->config_new;
-			cd->config_new = NULL;
+		if (dev->state == COMP_STATE_READY) {
+			coef_store_put(cd->config);
+			cd->config = request;
+		} else {
+			cd->config_new = request;
 		}
 
 		break;
@@ -768,17 +912,11 @@ static int eq_iir_copy(struct comp_dev *dev)
 	sourceb = list_first_item(&dev->bsource_list, struct comp_buffer,
 				  sink_list);
 
-	/* Check for changed configuration */
-	if (cd->config_new) {
-		eq_iir_free_parameters(&cd->config);
-		cd->config = cd->config_new;
-		cd->config_new = NULL;
-		ret = eq_iir_setup(cd, sourceb->stream.channels);
-		if (ret < 0) {
-			comp_err(dev, "eq_iir_copy(), failed IIR setup");
-			return ret;
-		}
-	}
+	/* Check for changed configuration, the current filters are kept
+	 * running if the new one can't be used.
+	 */
+	if (cd->config_new)
+		eq_iir_update(dev, sourceb->stream.channels);
 
 	/* Get source, sink, number of frames etc. to process. */
 	ret = comp_get_copy_limits(dev, &cl);
@@ -788,7 +926,12 @@ static int eq_iir_copy(struct comp_dev *dev)
 	}
 
 	/* Run EQ function */
-	cd->eq_iir_func(dev, &cl.source->stream, &cl.sink->stream, cl.frames);
+	if (xfade_active(&cd->xfade))
+		eq_iir_process_xfade(cd, &cl.source->stream, &cl.sink->stream,
+				     cl.frames);
+	else
+		cd->eq_iir_func(cd->iir, &cl.source->stream,
+				&cl.sink->stream, cl.frames);
 
 	/* calc new free and available */
 	comp_update_buffer_consume(cl.source, cl.source_bytes);
@@ -843,8 +986,26 @@ static int eq_iir_prepare(struct comp_dev *dev)
 	}
 
 	/* Initialize EQ */
+	/* Allocate the filters state, the delay lines and the crossfade
+	 * scratch for blob updates while streaming.
+	 */
+	ret = eq_iir_alloc_channels(cd, sourceb->stream.channels);
+	if (ret < 0)
+		goto err;
+
+	ret = eq_iir_alloc_delaylines(cd, sourceb->stream.channels);
+	if (ret < 0)
+		goto err;
+
+	ret = xfade_init(&cd->xfade, &sinkb->stream, dev->frames);
+	if (ret < 0) {
+		comp_err(dev, "eq_iir_prepare(), crossfade allocation failed");
+		goto err;
+	}
+
 	comp_info(dev, "eq_iir_prepare(), source_format=%d, sink_format=%d",
 		  cd->source_format, cd->sink_format);
+	dev->identity = false;
 	if (cd->config) {
 		ret = eq_iir_setup(cd, sourceb->stream.channels);
 		if (ret < 0) {
@@ -868,6 +1029,9 @@ static int eq_iir_prepare(struct comp_dev *dev)
 			goto err;
 		}
 		comp_info(dev, "eq_iir_prepare(), pass-through mode.");
+
+		/* same format pass-through can be bypassed */
+		dev->identity = cd->source_format == cd->sink_format;
 	}
 	return 0;
 
@@ -878,16 +1042,25 @@ err:
 
 static int eq_iir_reset(struct comp_dev *dev)
 {
-	int i;
 	struct comp_data *cd = comp_get_drvdata(dev);
 
 	comp_info(dev, "eq_iir_reset()");
 
 	eq_iir_free_delaylines(cd);
+	eq_iir_free_channels(cd);
+	xfade_free(&cd->xfade);
+	coef_store_put(cd->config_old);
+	cd->config_old = NULL;
+
+	/* A blob received after the last copy() is used in next prepare() */
+	if (cd->config_new) {
+		coef_store_put(cd->config);
+		cd->config = cd->config_new;
+		cd->config_new = NULL;
+	}
 
 	cd->eq_iir_func = NULL;
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		iir_reset_df2t(&cd->iir[i]);
+	dev->identity = false;
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
@@ -895,6 +1068,7 @@ static int eq_iir_reset(struct comp_dev *dev)
 
 static const struct comp_driver comp_eq_iir = {
 	.type = SOF_COMP_EQ_IIR,
+	.flags = COMP_DRV_INPLACE,
 	.ops = {
 		.new = eq_iir_new,
 		.free = eq_iir_free,
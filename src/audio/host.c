@@ -139,6 +139,12 @@ static void host_update_position(struct comp_dev *dev, uint32_t bytes)
 	if (hd->local_pos >= hd->host_size)
 		hd->local_pos = 0;
 
+#if CONFIG_IPC_POSN_BATCH
+	/* keep the polled position slot current between notifications */
+	hd->posn.host_posn = hd->local_pos;
+	ipc_stream_update_position(dev, &hd->posn);
+#endif
+
 	/* Don't send stream position if no_stream_position == 1 */
 	if (!hd->no_stream_position) {
 		hd->report_pos += bytes;
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/latency.h>
+#include <sof/audio/pipeline.h>
+#include <sof/drivers/timer.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <sof/string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* the graph starts at components without source buffers */
+static inline bool latency_is_source(struct comp_dev *dev)
+{
+	return dev && list_is_empty(&dev->bsource_list);
+}
+
+/* and ends at components without sink buffers */
+static inline bool latency_is_sink(struct comp_dev *dev)
+{
+	return list_is_empty(&dev->bsink_list);
+}
+
+static void latency_lost(struct pipeline *p, uint32_t seq)
+{
+	struct pipeline_latency *lat = &p->latency;
+
+	if (lat->in_flight && lat->seq == seq) {
+		lat->in_flight = false;
+		lat->lost++;
+	}
+}
+
+static void latency_done(struct pipeline *p, uint32_t seq)
+{
+	struct pipeline_latency *lat = &p->latency;
+	uint64_t delay;
+
+	/* other copies of a marker split to several sinks are ignored */
+	if (!lat->in_flight || lat->seq != seq)
+		return;
+
+	delay = platform_timer_get(timer_get()) - lat->start;
+
+	lat->in_flight = false;
+	lat->last = delay;
+	lat->min = lat->count ? MIN(lat->min, delay) : delay;
+	lat->max = MAX(lat->max, delay);
+	lat->total += delay;
+	lat->count++;
+}
+
+void latency_produce(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct buffer_marker *bm = &buffer->marker;
+	struct pipeline *p;
+
+	if (!latency_is_source(buffer->source))
+		return;
+
+	p = buffer->source->pipeline;
+	if (!p || p->latency.in_flight)
+		return;
+
+	if (bm->p)
+		latency_lost(bm->p, bm->seq);
+
+	/* the first frame of the data being produced */
+	p->latency.seq++;
+	p->latency.in_flight = true;
+	p->latency.start = platform_timer_get(timer_get());
+
+	bm->p = p;
+	bm->seq = p->latency.seq;
+	bm->offset = buffer->stream.avail;
+}
+
+void latency_consume(struct comp_buffer *buffer, uint32_t bytes)
+{
+	struct buffer_marker *bm = &buffer->marker;
+	struct comp_dev *dev = buffer->sink;
+	struct comp_marker *cm;
+	uint32_t frame_bytes = audio_stream_frame_bytes(&buffer->stream);
+
+	if (!bm->p)
+		return;
+
+	if (bm->offset >= bytes) {
+		bm->offset -= bytes;
+		return;
+	}
+
+	if (!dev || !frame_bytes) {
+		latency_lost(bm->p, bm->seq);
+	} else if (latency_is_sink(dev)) {
+		latency_done(bm->p, bm->seq);
+	} else {
+		/* moved to the sinks at the end of the copy */
+		cm = &dev->marker;
+		if (cm->p)
+			latency_lost(cm->p, cm->seq);
+
+		cm->p = bm->p;
+		cm->seq = bm->seq;
+		cm->frame = bm->offset / frame_bytes;
+		cm->frames = bytes / frame_bytes;
+	}
+
+	bm->p = NULL;
+}
+
+void latency_copy_begin(struct comp_dev *dev)
+{
+	struct comp_buffer *sink;
+	struct list_item *clist;
+
+	list_for_item(clist, &dev->bsink_list) {
+		sink = container_of(clist, struct comp_buffer, source_list);
+		sink->marker.avail = sink->stream.avail;
+	}
+}
+
+void latency_copy_end(struct comp_dev *dev)
+{
+	struct comp_marker *cm = &dev->marker;
+	struct buffer_marker *bm;
+	struct comp_buffer *sink;
+	struct list_item *clist;
+	uint32_t frame_bytes;
+	uint32_t frames;
+	uint32_t frame;
+	bool moved = false;
+
+	if (!cm->p)
+		return;
+
+	list_for_item(clist, &dev->bsink_list) {
+		sink = container_of(clist, struct comp_buffer, source_list);
+		bm = &sink->marker;
+		frame_bytes = audio_stream_frame_bytes(&sink->stream);
+		if (!frame_bytes || sink->stream.avail <= bm->avail)
+			continue;
+
+		/* the same position in the produced frames */
+		frames = (sink->stream.avail - bm->avail) / frame_bytes;
+		frame = (uint64_t)cm->frame * frames / MAX(cm->frames, 1);
+
+		if (bm->p)
+			latency_lost(bm->p, bm->seq);
+
+		bm->p = cm->p;
+		bm->seq = cm->seq;
+		bm->offset = bm->avail + frame * frame_bytes;
+		moved = true;
+	}
+
+	if (!moved)
+		latency_lost(cm->p, cm->seq);
+
+	cm->p = NULL;
+}
+
+void latency_reset(struct pipeline *p)
+{
+	p->latency.in_flight = false;
+}
+
+void latency_clear(struct pipeline *p)
+{
+	struct pipeline_latency *lat = &p->latency;
+
+	lat->count = 0;
+	lat->lost = 0;
+	lat->last = 0;
+	lat->min = 0;
+	lat->max = 0;
+	lat->total = 0;
+}
+
+/* markers only move downstream, so all markers set by a pipeline are
+ * downstream of its source component, including in connected pipelines
+ */
+static void latency_drop(struct comp_dev *dev, struct pipeline *p)
+{
+	struct comp_buffer *sink;
+	struct list_item *clist;
+
+	if (dev->marker.p == p)
+		dev->marker.p = NULL;
+
+	list_for_item(clist, &dev->bsink_list) {
+		sink = container_of(clist, struct comp_buffer, source_list);
+		if (sink->marker.p == p)
+			sink->marker.p = NULL;
+		if (sink->sink)
+			latency_drop(sink->sink, p);
+	}
+}
+
+void latency_free(struct pipeline *p)
+{
+	if (p->source_comp)
+		latency_drop(p->source_comp, p);
+}
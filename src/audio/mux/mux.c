@@ -26,6 +26,7 @@
 #include <ipc/topology.h>
 #include <user/trace.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -55,28 +56,224 @@ static int mux_set_values(struct comp_data *cd, struct sof_mux_config *cfg)
 		}
 	}
 
-	/* check if number of channels per stream doesn't exceed maximum */
-	for (i = 0; i < cfg->num_streams; i++) {
-		if (cfg->streams[i].num_channels > PLATFORM_MAX_CHANNELS) {
-			comp_cl_err(&comp_mux, "mux_set_values() error: configured number of channels for stream %u exceeds platform maximum = "
-				    META_QUOTE(PLATFORM_MAX_CHANNELS), i);
-			return -EINVAL;
-		}
-	}
-
 	cd->config.num_channels = cfg->num_channels;
 	cd->config.frame_format = cfg->frame_format;
 
 	for (i = 0; i < cfg->num_streams; i++) {
 		cd->config.streams[i].num_channels = cfg->streams[i].num_channels;
 		cd->config.streams[i].pipeline_id = cfg->streams[i].pipeline_id;
-		for (j = 0; j < cfg->streams[i].num_channels; j++)
+		for (j = 0; j < MIN(cfg->streams[i].num_channels,
+				    MUX_MASK_CHANNELS); j++)
 			cd->config.streams[i].mask[j] = cfg->streams[i].mask[j];
 	}
 
 	return 0;
 }
 
+/* classify the routing for the specialized kernels */
+static enum mux_kernel mux_select_kernel(const struct mux_look_up *lookup)
+{
+	const struct mux_route *route = lookup->routes;
+	uint16_t routes;
+	uint16_t max_routes = 0;
+	uint16_t min_routes = UINT16_MAX;
+	bool fan_out = true;
+	uint8_t ch;
+
+	for (ch = 0; ch < lookup->num_channels; ch++) {
+		routes = lookup->first[ch + 1] - lookup->first[ch];
+		max_routes = MAX(max_routes, routes);
+		min_routes = MIN(min_routes, routes);
+
+		if (routes != 1 ||
+		    route[lookup->first[ch]].stream != route->stream ||
+		    route[lookup->first[ch]].channel != route->channel)
+			fan_out = false;
+	}
+
+	if (max_routes <= 1)
+		return fan_out && lookup->num_channels > 1 ?
+			MUX_KERNEL_FAN_OUT : MUX_KERNEL_COPY;
+
+	if (min_routes == 2 && max_routes == 2)
+		return MUX_KERNEL_DOWNMIX;
+
+	return MUX_KERNEL_MIX;
+}
+
+/* store a route unless only the routes are being counted */
+static void mux_add_route(struct mux_look_up *lookup, uint16_t *n,
+			  uint8_t stream, uint8_t channel)
+{
+	if (lookup->routes) {
+		lookup->routes[*n].stream = stream;
+		lookup->routes[*n].channel = channel;
+	}
+
+	(*n)++;
+}
+
+static void mux_set_first(struct mux_look_up *lookup, uint8_t ch, uint16_t n)
+{
+	if (lookup->first)
+		lookup->first[ch] = n;
+}
+
+/* output channels of the mux sink are mixed from all streams */
+static uint16_t mux_build_look_up(struct comp_data *cd,
+				  struct mux_look_up *lookup)
+{
+	struct mux_stream_data *stream;
+	uint16_t n = 0;
+	uint8_t out_ch;
+	uint8_t in_ch;
+	uint8_t i;
+
+	lookup->num_channels = cd->config.num_channels;
+	lookup->stream_mask = 0;
+
+	for (i = 0; i < MUX_MAX_STREAMS; i++)
+		lookup->src_channels[i] = cd->config.streams[i].num_channels;
+
+	for (out_ch = 0; out_ch < lookup->num_channels; out_ch++) {
+		mux_set_first(lookup, out_ch, n);
+		for (i = 0; i < MUX_MAX_STREAMS; i++) {
+			stream = &cd->config.streams[i];
+
+			/* the first stream this wide passes the channel */
+			if (out_ch >= MUX_MASK_CHANNELS) {
+				if (out_ch >= stream->num_channels)
+					continue;
+
+				mux_add_route(lookup, &n, i, out_ch);
+				lookup->stream_mask |= BIT(i);
+				break;
+			}
+
+			for (in_ch = 0; in_ch < MIN(stream->num_channels,
+						    MUX_MASK_SOURCE_CHANNELS);
+			     in_ch++) {
+				if (!(stream->mask[out_ch] & BIT(in_ch)))
+					continue;
+
+				mux_add_route(lookup, &n, i, in_ch);
+				lookup->stream_mask |= BIT(i);
+			}
+		}
+	}
+
+	mux_set_first(lookup, lookup->num_channels, n);
+
+	return n;
+}
+
+/* output channels of a demux sink stream come from the single source */
+static uint16_t demux_build_look_up(struct comp_data *cd,
+				    struct mux_stream_data *stream,
+				    struct mux_look_up *lookup)
+{
+	uint16_t n = 0;
+	uint8_t out_ch;
+	uint8_t in_ch;
+
+	lookup->num_channels = stream->num_channels;
+	lookup->stream_mask = BIT(0);
+	lookup->src_channels[0] = cd->config.num_channels;
+
+	for (out_ch = 0; out_ch < lookup->num_channels; out_ch++) {
+		mux_set_first(lookup, out_ch, n);
+
+		if (out_ch >= MUX_MASK_CHANNELS) {
+			if (out_ch < cd->config.num_channels)
+				mux_add_route(lookup, &n, 0, out_ch);
+			continue;
+		}
+
+		for (in_ch = 0; in_ch < MIN(cd->config.num_channels,
+					    MUX_MASK_SOURCE_CHANNELS);
+		     in_ch++) {
+			if (!(stream->mask[out_ch] & BIT(in_ch)))
+				continue;
+
+			mux_add_route(lookup, &n, 0, in_ch);
+		}
+	}
+
+	mux_set_first(lookup, lookup->num_channels, n);
+
+	return n;
+}
+
+static uint16_t mux_build_table(struct comp_dev *dev, int table,
+				struct mux_look_up *lookup)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (dev->drv->type == SOF_COMP_MUX)
+		return mux_build_look_up(cd, lookup);
+
+	return demux_build_look_up(cd, &cd->config.streams[table], lookup);
+}
+
+/* compile the routing masks into look up tables and pick the kernels */
+UT_STATIC int mux_update_look_up_tables(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct mux_look_up count = { 0 };
+	struct mux_look_up *lookup;
+	struct mux_route *routes;
+	uint16_t *first;
+	size_t num_first = 0;
+	size_t num_routes = 0;
+	void *tables;
+	int num_tables;
+	int i;
+
+	num_tables = dev->drv->type == SOF_COMP_MUX ? 1 : MUX_MAX_STREAMS;
+
+	/* size the tables from the channels of the streams */
+	for (i = 0; i < num_tables; i++) {
+		num_routes += mux_build_table(dev, i, &count);
+		num_first += count.num_channels + 1;
+	}
+
+	tables = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			 num_first * sizeof(*first) +
+			 num_routes * sizeof(*routes));
+	if (!tables) {
+		comp_err(dev, "mux_update_look_up_tables() error: no memory for %u routes",
+			 (uint32_t)num_routes);
+		return -ENOMEM;
+	}
+
+	rfree(cd->tables);
+	cd->tables = tables;
+	first = tables;
+	routes = (struct mux_route *)(first + num_first);
+
+	for (i = 0; i < num_tables; i++) {
+		lookup = &cd->lookup[i];
+		lookup->first = first;
+		lookup->routes = routes;
+
+		routes += mux_build_table(dev, i, lookup);
+		first += lookup->num_channels + 1;
+
+		lookup->kernel = mux_select_kernel(lookup);
+		lookup->func = mux_get_processing_function(dev,
+							   lookup->kernel);
+		if (!lookup->func) {
+			comp_err(dev, "mux_update_look_up_tables() error: couldn't find appropriate processing function for component.");
+			return -EINVAL;
+		}
+
+		comp_dbg(dev, "mux_update_look_up_tables() table %d kernel %d",
+			 i, lookup->kernel);
+	}
+
+	return 0;
+}
+
 static struct comp_dev *mux_new(const struct comp_driver *drv,
 				struct sof_ipc_comp *comp)
 {
@@ -131,6 +328,7 @@ static void mux_free(struct comp_dev *dev)
 
 	comp_info(dev, "mux_free()");
 
+	rfree(cd->tables);
 	rfree(cd);
 	rfree(dev);
 }
@@ -206,6 +404,8 @@ static int mux_ctrl_set_cmd(struct comp_dev *dev,
 		      ASSUME_ALIGNED(cdata->data->data, 4);
 
 		ret = mux_set_values(cd, cfg);
+		if (!ret && dev->state >= COMP_STATE_PREPARE)
+			ret = mux_update_look_up_tables(dev);
 		break;
 	default:
 		comp_err(dev, "mux_ctrl_set_cmd() error: invalid cdata->cmd = 0x%08x",
@@ -276,6 +476,7 @@ static int demux_copy(struct comp_dev *dev)
 	struct comp_buffer *source;
 	struct comp_buffer *sink;
 	struct comp_buffer *sinks[MUX_MAX_STREAMS] = { NULL };
+	const struct audio_stream *sources_stream[1];
 	struct list_item *clist;
 	uint32_t num_sinks = 0;
 	uint32_t i = 0;
@@ -328,8 +529,9 @@ static int demux_copy(struct comp_dev *dev)
 		if (!sinks[i])
 			continue;
 
-		cd->demux(dev, &sinks[i]->stream, &source->stream, frames,
-			  &cd->config.streams[i]);
+		sources_stream[0] = &source->stream;
+		cd->lookup[i].func(dev, &sinks[i]->stream, sources_stream,
+				   frames, &cd->lookup[i]);
 	}
 
 	/* update components */
@@ -352,6 +554,8 @@ static int mux_copy(struct comp_dev *dev)
 	struct comp_buffer *sources[MUX_MAX_STREAMS] = { NULL };
 	const struct audio_stream *sources_stream[MUX_MAX_STREAMS] = { NULL };
 	struct list_item *clist;
+	mux_func func = cd->lookup[0].func;
+	uint32_t active_mask = 0;
 	uint32_t num_sources = 0;
 	uint32_t i = 0;
 	uint32_t frames = -1;
@@ -368,6 +572,7 @@ static int mux_copy(struct comp_dev *dev)
 			i = get_stream_index(cd, source->pipeline_id);
 			sources[i] = source;
 			sources_stream[i] = &source->stream;
+			active_mask |= BIT(i);
 		}
 	}
 
@@ -398,9 +603,12 @@ static int mux_copy(struct comp_dev *dev)
 	}
 	sink_bytes = frames * audio_stream_frame_bytes(&sink->stream);
 
+	/* only the mixing kernel copes with inactive routed streams */
+	if (cd->lookup[0].stream_mask & ~active_mask)
+		func = mux_get_processing_function(dev, MUX_KERNEL_MIX);
+
 	/* produce output */
-	cd->mux(dev, &sink->stream, &sources_stream[0], frames,
-		&cd->config.streams[0]);
+	func(dev, &sink->stream, sources_stream, frames, &cd->lookup[0]);
 
 	/* update components */
 	comp_update_buffer_produce(sink, sink_bytes);
@@ -415,14 +623,24 @@ static int mux_copy(struct comp_dev *dev)
 
 static int mux_reset(struct comp_dev *dev)
 {
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int i;
+
 	comp_info(dev, "mux_reset()");
 
+	/* the tables are sized again for the stream in prepare */
+	for (i = 0; i < MUX_MAX_STREAMS; i++) {
+		cd->lookup[i].first = NULL;
+		cd->lookup[i].routes = NULL;
+	}
+	rfree(cd->tables);
+	cd->tables = NULL;
+
 	return comp_set_state(dev, COMP_TRIGGER_RESET);
 }
 
 static int mux_prepare(struct comp_dev *dev)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	int ret;
 
 	comp_info(dev, "mux_prepare()");
@@ -433,12 +651,9 @@ static int mux_prepare(struct comp_dev *dev)
 		return ret;
 	}
 
-	cd->mux = mux_get_processing_function(dev);
-	if (!cd->mux) {
-		comp_err(dev, "mux_prepare() error: couldn't find appropriate mux processing function for component.");
-		ret = -EINVAL;
+	ret = mux_update_look_up_tables(dev);
+	if (ret < 0)
 		goto err;
-	}
 
 	return 0;
 
@@ -449,7 +664,6 @@ err:
 
 static int demux_prepare(struct comp_dev *dev)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
 	int ret;
 
 	comp_info(dev, "demux_prepare()");
@@ -460,12 +674,9 @@ static int demux_prepare(struct comp_dev *dev)
 		return ret;
 	}
 
-	cd->demux = demux_get_processing_function(dev);
-	if (!cd->demux) {
-		comp_err(dev, "demux_prepare() error: couldn't find appropriate demux processing function for component.");
-		ret = -EINVAL;
+	ret = mux_update_look_up_tables(dev);
+	if (ret < 0)
 		goto err;
-	}
 
 	return 0;
 
@@ -18,392 +18,463 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#if CONFIG_FORMAT_S16LE
-/*
- * \brief Fetch 16b samples from source buffer and perform routing operations
- *	  based on mask provided.
- * \param[in,out] source Source buffer.
- * \param[in] num_ch Number of channels in source buffer.
- * \param[in] offset Offset in source buffer.
- * \param[in] mask Routing bitmask for calculating output sample.
- */
-UT_STATIC inline int32_t calc_sample_s16le(const struct audio_stream *source,
-					   uint8_t num_ch, uint32_t offset,
-					   uint8_t mask)
+/* frame pointers of the source streams used by the routes */
+struct mux_frames {
+	char *src[MUX_MAX_STREAMS];
+	uint32_t frame_bytes[MUX_MAX_STREAMS];
+};
+
+static inline void mux_frames_init(struct mux_frames *f,
+				   const struct audio_stream **sources,
+				   const struct mux_look_up *lookup,
+				   uint32_t sample_bytes)
 {
-	int32_t sample = 0;
-	int16_t *src;
-	int8_t in_ch;
-
-	if (mask == 0)
-		return 0;
-
-	for (in_ch = 0; in_ch < num_ch; in_ch++) {
-		if (mask & BIT(in_ch)) {
-			src = audio_stream_read_frag_s16(source,
-							 offset + in_ch);
-			sample += *src;
+	uint8_t i;
+
+	for (i = 0; i < MUX_MAX_STREAMS; i++) {
+		/* demux passes a single source, check the routes first */
+		if (!(lookup->stream_mask & BIT(i)) || !sources[i]) {
+			f->src[i] = NULL;
+			continue;
 		}
-	}
 
-	return sample;
+		f->src[i] = sources[i]->r_ptr;
+		f->frame_bytes[i] = lookup->src_channels[i] * sample_bytes;
+	}
 }
 
-/* \brief Demuxing 16 bit streams.
- *
- * Source stream is routed to sink with regard to routing bitmasks from
- * mux_stream_data structure. Each bitmask describes composition of single
- * output channel.
- *
- * \param[in,out] dev Demux base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- * \param[in] frames Number of frames to process.
- * \param[in] data Parameters describing channel count and routing.
- */
-static void demux_s16le(const struct comp_dev *dev, struct audio_stream *sink,
-			const struct audio_stream *source, uint32_t frames,
-			struct mux_stream_data *data)
+/* frames never straddle the end of a buffer, wrap once per frame */
+static inline void mux_frames_next(struct mux_frames *f,
+				   const struct audio_stream **sources)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t sample;
-	int16_t *dst;
-	uint32_t dst_idx;
 	uint8_t i;
-	uint8_t out_ch;
 
-	for (i = 0; i < frames; i++) {
-		for (out_ch = 0; out_ch < data->num_channels; out_ch++) {
-			sample = calc_sample_s16le(source,
-						   cd->config.num_channels,
-						   i * cd->config.num_channels,
-						   data->mask[out_ch]);
-
-			/* saturate to 16 bits */
-			dst_idx = i * data->num_channels + out_ch;
-			dst = audio_stream_write_frag_s16(sink, dst_idx);
-			*dst = sat_int16(sample);
-		}
-	}
+	for (i = 0; i < MUX_MAX_STREAMS; i++)
+		if (f->src[i])
+			f->src[i] = audio_stream_wrap(sources[i], f->src[i] +
+						      f->frame_bytes[i]);
 }
 
-/* \brief Muxing 16 bit streams.
+#if CONFIG_FORMAT_S16LE
+/* \brief Reads a 16 bit sample of a route from the current frames. */
+static inline int32_t mux_route_s16le(const struct mux_frames *f,
+				      const struct mux_route *route)
+{
+	const int16_t *src = (const int16_t *)f->src[route->stream];
+
+	return src[route->channel];
+}
+
+/* \brief Routes 16 bit streams summing every route of each output.
  *
- * Source streams are routed to sink with regard to routing bitmasks from
- * mux_stream_data structures array. Each source stream has bitmask for each
- * of it's channels describing to which channels of output stream it
- * contributes.
+ * Used for arbitrary masks and when a routed source stream is inactive,
+ * routes of missing streams contribute nothing.
  *
- * \param[in,out] dev Demux base component device.
+ * \param[in,out] dev Mux base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] sources Array of source buffers.
  * \param[in] frames Number of frames to process.
- * \param[in] data Array of parameters describing channel count and routing for
- *		   each stream.
+ * \param[in] lookup Routing table of the output stream.
  */
-static void mux_s16le(const struct comp_dev *dev, struct audio_stream *sink,
-		      const struct audio_stream **sources, uint32_t frames,
-		      struct mux_stream_data *data)
+static void mux_mix_s16le(const struct comp_dev *dev, struct audio_stream *sink,
+			  const struct audio_stream **sources, uint32_t frames,
+			  const struct mux_look_up *lookup)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	const struct audio_stream *source;
-	uint8_t i;
-	uint8_t j;
-	uint8_t out_ch;
-	int16_t *dst;
-	uint32_t dst_idx;
+	const struct mux_route *route;
+	const struct mux_route *last;
+	struct mux_frames f;
+	int16_t *dst = sink->w_ptr;
 	int32_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int16_t));
 
 	for (i = 0; i < frames; i++) {
-		for (out_ch = 0; out_ch < cd->config.num_channels; out_ch++) {
+		for (ch = 0; ch < lookup->num_channels; ch++) {
 			sample = 0;
+			route = lookup->routes + lookup->first[ch];
+			last = lookup->routes + lookup->first[ch + 1];
+			for (; route < last; route++)
+				if (f.src[route->stream])
+					sample += mux_route_s16le(&f, route);
 
-			for (j = 0; j < MUX_MAX_STREAMS; j++) {
-				source = sources[j];
-				if (!source)
-					continue;
-
-				sample += calc_sample_s16le(source,
-						data[j].num_channels,
-						i * data[j].num_channels,
-						data[j].mask[out_ch]);
-			}
-			dst_idx = i * data->num_channels + out_ch;
-			dst = audio_stream_write_frag_s16(sink, dst_idx);
-			*dst = sat_int16(sample);
+			dst[ch] = sat_int16(sample);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
 }
-#endif /* CONFIG_FORMAT_S16LE */
 
-#if CONFIG_FORMAT_S24LE
-/*
- * \brief Fetch 24b samples from source buffer and perform routing operations
- *	  based on mask provided.
- * \param[in,out] source Source buffer.
- * \param[in] num_ch Number of channels in source buffer.
- * \param[in] offset Offset in source buffer.
- * \param[in] mask Routing bitmask for calculating output sample.
- */
-UT_STATIC inline int32_t calc_sample_s24le(const struct audio_stream *source,
-					   uint8_t num_ch, uint32_t offset,
-					   uint8_t mask)
+/* \brief Copies or reorders 16 bit channels without summing. */
+static void mux_copy_s16le(const struct comp_dev *dev,
+			   struct audio_stream *sink,
+			   const struct audio_stream **sources, uint32_t frames,
+			   const struct mux_look_up *lookup)
 {
-	int32_t sample = 0;
-	int32_t *src;
-	int8_t in_ch;
-
-	if (mask == 0)
-		return 0;
-
-	for (in_ch = 0; in_ch < num_ch; in_ch++) {
-		if (mask & BIT(in_ch)) {
-			src = audio_stream_read_frag_s32(source,
-							 offset + in_ch);
-			sample += sign_extend_s24(*src);
+	const struct mux_route *route;
+	struct mux_frames f;
+	int16_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int16_t));
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < lookup->num_channels; ch++) {
+			route = lookup->routes + lookup->first[ch];
+			dst[ch] = lookup->first[ch] == lookup->first[ch + 1] ?
+				0 : mux_route_s16le(&f, route);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
+}
+
+/* \brief Writes one 16 bit source channel to every output channel. */
+static void mux_fan_out_s16le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream **sources,
+			      uint32_t frames, const struct mux_look_up *lookup)
+{
+	const struct mux_route *route = lookup->routes;
+	struct mux_frames f;
+	int16_t *dst = sink->w_ptr;
+	int16_t sample;
+	uint32_t i;
+	uint8_t ch;
 
-	return sample;
+	mux_frames_init(&f, sources, lookup, sizeof(int16_t));
+
+	for (i = 0; i < frames; i++) {
+		sample = mux_route_s16le(&f, route);
+		for (ch = 0; ch < lookup->num_channels; ch++)
+			dst[ch] = sample;
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
+	}
 }
 
-/* \brief Demuxing 24 bit streams.
- *
- * Source stream is routed to sink with regard to routing bitmasks from
- * mux_stream_data structure. Each bitmask describes composition of single
- * output channel.
- *
- * \param[in,out] dev Demux base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- * \param[in] frames Number of frames to process.
- * \param[in] data Parameters describing channel count and routing.
- */
-static void demux_s24le(const struct comp_dev *dev, struct audio_stream *sink,
-			const struct audio_stream *source, uint32_t frames,
-			struct mux_stream_data *data)
+/* \brief Sums two 16 bit source channels into each output channel. */
+static void mux_downmix_s16le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream **sources,
+			      uint32_t frames, const struct mux_look_up *lookup)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
+	const struct mux_route *route;
+	struct mux_frames f;
+	int16_t *dst = sink->w_ptr;
 	int32_t sample;
-	int32_t *dst;
-	uint32_t dst_idx;
-	uint8_t i;
-	uint8_t out_ch;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int16_t));
 
 	for (i = 0; i < frames; i++) {
-		for (out_ch = 0; out_ch < data->num_channels; out_ch++) {
-			sample = calc_sample_s24le(source,
-						   cd->config.num_channels,
-						   i * cd->config.num_channels,
-						   data->mask[out_ch]);
-
-			/* saturate to 24 bits */
-			dst_idx = i * data->num_channels + out_ch;
-			dst = audio_stream_write_frag_s32(sink, dst_idx);
-			*dst = sat_int24(sample);
+		route = lookup->routes;
+		for (ch = 0; ch < lookup->num_channels; ch++) {
+			sample = mux_route_s16le(&f, route++);
+			sample += mux_route_s16le(&f, route++);
+			dst[ch] = sat_int16(sample);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
 }
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+/* \brief Reads a 24 bit sample of a route from the current frames. */
+static inline int32_t mux_route_s24le(const struct mux_frames *f,
+				      const struct mux_route *route)
+{
+	const int32_t *src = (const int32_t *)f->src[route->stream];
+
+	return sign_extend_s24(src[route->channel]);
+}
 
-/* \brief Muxing 24 bit streams.
+/* \brief Routes 24 bit streams summing every route of each output.
  *
- * Source streams are routed to sink with regard to routing bitmasks from
- * mux_stream_data structures array. Each source stream has bitmask for each
- * of it's channels describing to which channels of output stream it
- * contributes.
+ * Used for arbitrary masks and when a routed source stream is inactive,
+ * routes of missing streams contribute nothing.
  *
- * \param[in,out] dev Demux base component device.
+ * \param[in,out] dev Mux base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] sources Array of source buffers.
  * \param[in] frames Number of frames to process.
- * \param[in] data Array of parameters describing channel count and routing for
- *		   each stream.
+ * \param[in] lookup Routing table of the output stream.
  */
-static void mux_s24le(const struct comp_dev *dev, struct audio_stream *sink,
-		      const struct audio_stream **sources, uint32_t frames,
-		      struct mux_stream_data *data)
+static void mux_mix_s24le(const struct comp_dev *dev, struct audio_stream *sink,
+			  const struct audio_stream **sources, uint32_t frames,
+			  const struct mux_look_up *lookup)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	const struct audio_stream *source;
-	uint8_t i;
-	uint8_t j;
-	uint8_t out_ch;
-	int32_t *dst;
-	uint32_t dst_idx;
+	const struct mux_route *route;
+	const struct mux_route *last;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
 	int32_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
 
 	for (i = 0; i < frames; i++) {
-		for (out_ch = 0; out_ch < cd->config.num_channels; out_ch++) {
+		for (ch = 0; ch < lookup->num_channels; ch++) {
 			sample = 0;
-			for (j = 0; j < MUX_MAX_STREAMS; j++) {
-				source = sources[j];
-				if (!source)
-					continue;
-
-				sample += calc_sample_s24le(source,
-						data[j].num_channels,
-						i * data[j].num_channels,
-						data[j].mask[out_ch]);
-			}
-			dst_idx = i * data->num_channels + out_ch;
-			dst = audio_stream_write_frag_s32(sink, dst_idx);
-			*dst = sat_int24(sample);
+			route = lookup->routes + lookup->first[ch];
+			last = lookup->routes + lookup->first[ch + 1];
+			for (; route < last; route++)
+				if (f.src[route->stream])
+					sample += mux_route_s24le(&f, route);
+
+			dst[ch] = sat_int24(sample);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
 }
-#endif /* CONFIG_FORMAT_S24LE */
 
-#if CONFIG_FORMAT_S32LE
-/*
- * \brief Fetch 32b samples from source buffer and perform routing operations
- *	  based on mask provided.
- * \param[in,out] source Source buffer.
- * \param[in] num_ch Number of channels in source buffer.
- * \param[in] offset Offset in source buffer.
- * \param[in] mask Routing bitmask for calculating output sample.
- */
-UT_STATIC inline int64_t calc_sample_s32le(const struct audio_stream *source,
-					   uint8_t num_ch, uint32_t offset,
-					   uint8_t mask)
+/* \brief Copies or reorders 24 bit channels without summing. */
+static void mux_copy_s24le(const struct comp_dev *dev,
+			   struct audio_stream *sink,
+			   const struct audio_stream **sources, uint32_t frames,
+			   const struct mux_look_up *lookup)
 {
-	int64_t sample = 0;
-	int32_t *src;
-	int8_t in_ch;
-
-	if (mask == 0)
-		return 0;
-
-	for (in_ch = 0; in_ch < num_ch; in_ch++) {
-		if (mask & BIT(in_ch)) {
-			src = audio_stream_read_frag_s32(source,
-							 offset + in_ch);
-			sample += *src;
+	const struct mux_route *route;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < lookup->num_channels; ch++) {
+			route = lookup->routes + lookup->first[ch];
+			dst[ch] = lookup->first[ch] == lookup->first[ch + 1] ?
+				0 : mux_route_s24le(&f, route);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
+}
+
+/* \brief Writes one 24 bit source channel to every output channel. */
+static void mux_fan_out_s24le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream **sources,
+			      uint32_t frames, const struct mux_look_up *lookup)
+{
+	const struct mux_route *route = lookup->routes;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
+	int32_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
 
-	return sample;
+	for (i = 0; i < frames; i++) {
+		sample = mux_route_s24le(&f, route);
+		for (ch = 0; ch < lookup->num_channels; ch++)
+			dst[ch] = sample;
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
+	}
 }
 
-/* \brief Demuxing 32 bit streams.
- *
- * Source stream is routed to sink with regard to routing bitmasks from
- * mux_stream_data structure. Each bitmask describes composition of single
- * output channel.
- *
- * \param[in,out] dev Demux base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
- * \param[in] frames Number of frames to process.
- * \param[in] data Parameters describing channel count and routing.
- */
-static void demux_s32le(const struct comp_dev *dev, struct audio_stream *sink,
-			const struct audio_stream *source, uint32_t frames,
-			struct mux_stream_data *data)
+/* \brief Sums two 24 bit source channels into each output channel. */
+static void mux_downmix_s24le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream **sources,
+			      uint32_t frames, const struct mux_look_up *lookup)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int64_t sample;
-	int32_t *dst;
-	uint32_t dst_idx;
-	uint8_t i;
-	uint8_t out_ch;
+	const struct mux_route *route;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
+	int32_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
 
 	for (i = 0; i < frames; i++) {
-		for (out_ch = 0; out_ch < data->num_channels; out_ch++) {
-			sample = calc_sample_s32le(source,
-						   cd->config.num_channels,
-						   i * cd->config.num_channels,
-						   data->mask[out_ch]);
-
-			/* saturate to 32 bits */
-			dst_idx = i * data->num_channels + out_ch;
-			dst = audio_stream_write_frag_s32(sink, dst_idx);
-			*dst = sat_int32(sample);
+		route = lookup->routes;
+		for (ch = 0; ch < lookup->num_channels; ch++) {
+			sample = mux_route_s24le(&f, route++);
+			sample += mux_route_s24le(&f, route++);
+			dst[ch] = sat_int24(sample);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
 }
+#endif /* CONFIG_FORMAT_S24LE */
 
-/* \brief Muxing 32 bit streams.
+#if CONFIG_FORMAT_S32LE
+/* \brief Reads a 32 bit sample of a route from the current frames. */
+static inline int64_t mux_route_s32le(const struct mux_frames *f,
+				      const struct mux_route *route)
+{
+	const int32_t *src = (const int32_t *)f->src[route->stream];
+
+	return src[route->channel];
+}
+
+/* \brief Routes 32 bit streams summing every route of each output.
  *
- * Source streams are routed to sink with regard to routing bitmasks from
- * mux_stream_data structures array. Each source stream has bitmask for each
- * of it's channels describing to which channels of output stream it
- * contributes.
+ * Used for arbitrary masks and when a routed source stream is inactive,
+ * routes of missing streams contribute nothing.
  *
- * \param[in,out] dev Demux base component device.
+ * \param[in,out] dev Mux base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] sources Array of source buffers.
  * \param[in] frames Number of frames to process.
- * \param[in] data Array of parameters describing channel count and routing for
- *		   each stream.
+ * \param[in] lookup Routing table of the output stream.
  */
-static void mux_s32le(const struct comp_dev *dev, struct audio_stream *sink,
-		      const struct audio_stream **sources, uint32_t frames,
-		      struct mux_stream_data *data)
+static void mux_mix_s32le(const struct comp_dev *dev, struct audio_stream *sink,
+			  const struct audio_stream **sources, uint32_t frames,
+			  const struct mux_look_up *lookup)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	const struct audio_stream *source;
-	uint8_t i;
-	uint8_t j;
-	uint8_t out_ch;
-	int32_t *dst;
-	uint32_t dst_idx;
+	const struct mux_route *route;
+	const struct mux_route *last;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
 	int64_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
 
 	for (i = 0; i < frames; i++) {
-		for (out_ch = 0; out_ch < cd->config.num_channels; out_ch++) {
+		for (ch = 0; ch < lookup->num_channels; ch++) {
 			sample = 0;
-			for (j = 0; j < MUX_MAX_STREAMS; j++) {
-				source = sources[j];
-				if (!source)
-					continue;
-
-				sample += calc_sample_s32le(source,
-						data[j].num_channels,
-						i * data[j].num_channels,
-						data[j].mask[out_ch]);
-			}
-			dst_idx = i * data->num_channels + out_ch;
-			dst = audio_stream_write_frag_s32(sink, dst_idx);
-			*dst = sat_int32(sample);
+			route = lookup->routes + lookup->first[ch];
+			last = lookup->routes + lookup->first[ch + 1];
+			for (; route < last; route++)
+				if (f.src[route->stream])
+					sample += mux_route_s32le(&f, route);
+
+			dst[ch] = sat_int32(sample);
+		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
+	}
+}
+
+/* \brief Copies or reorders 32 bit channels without summing. */
+static void mux_copy_s32le(const struct comp_dev *dev,
+			   struct audio_stream *sink,
+			   const struct audio_stream **sources, uint32_t frames,
+			   const struct mux_look_up *lookup)
+{
+	const struct mux_route *route;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < lookup->num_channels; ch++) {
+			route = lookup->routes + lookup->first[ch];
+			dst[ch] = lookup->first[ch] == lookup->first[ch + 1] ?
+				0 : mux_route_s32le(&f, route);
 		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
 	}
 }
 
+/* \brief Writes one 32 bit source channel to every output channel. */
+static void mux_fan_out_s32le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream **sources,
+			      uint32_t frames, const struct mux_look_up *lookup)
+{
+	const struct mux_route *route = lookup->routes;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
+	int32_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
+
+	for (i = 0; i < frames; i++) {
+		sample = mux_route_s32le(&f, route);
+		for (ch = 0; ch < lookup->num_channels; ch++)
+			dst[ch] = sample;
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
+	}
+}
+
+/* \brief Sums two 32 bit source channels into each output channel. */
+static void mux_downmix_s32le(const struct comp_dev *dev,
+			      struct audio_stream *sink,
+			      const struct audio_stream **sources,
+			      uint32_t frames, const struct mux_look_up *lookup)
+{
+	const struct mux_route *route;
+	struct mux_frames f;
+	int32_t *dst = sink->w_ptr;
+	int64_t sample;
+	uint32_t i;
+	uint8_t ch;
+
+	mux_frames_init(&f, sources, lookup, sizeof(int32_t));
+
+	for (i = 0; i < frames; i++) {
+		route = lookup->routes;
+		for (ch = 0; ch < lookup->num_channels; ch++) {
+			sample = mux_route_s32le(&f, route++);
+			sample += mux_route_s32le(&f, route++);
+			dst[ch] = sat_int32(sample);
+		}
+
+		dst = audio_stream_wrap(sink, dst + lookup->num_channels);
+		mux_frames_next(&f, sources);
+	}
+}
 #endif /* CONFIG_FORMAT_S32LE */
 
 const struct comp_func_map mux_func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, &mux_s16le, &demux_s16le },
+	{ SOF_IPC_FRAME_S16_LE, { &mux_mix_s16le, &mux_copy_s16le,
+				  &mux_fan_out_s16le, &mux_downmix_s16le } },
 #endif
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, &mux_s24le, &demux_s24le },
+	{ SOF_IPC_FRAME_S24_4LE, { &mux_mix_s24le, &mux_copy_s24le,
+				   &mux_fan_out_s24le, &mux_downmix_s24le } },
 #endif
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, &mux_s32le, &demux_s32le },
+	{ SOF_IPC_FRAME_S32_LE, { &mux_mix_s32le, &mux_copy_s32le,
+				  &mux_fan_out_s32le, &mux_downmix_s32le } },
 #endif
 };
 
-mux_func mux_get_processing_function(struct comp_dev *dev)
-{
-	struct comp_data *cd = comp_get_drvdata(dev);
-	uint8_t i;
-
-	for (i = 0; i < ARRAY_SIZE(mux_func_map); i++) {
-		if (cd->config.frame_format == mux_func_map[i].frame_format)
-			return mux_func_map[i].mux_proc_func;
-	}
-
-	return NULL;
-}
-
-demux_func demux_get_processing_function(struct comp_dev *dev)
+mux_func mux_get_processing_function(struct comp_dev *dev,
+				     enum mux_kernel kernel)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	uint8_t i;
 
 	for (i = 0; i < ARRAY_SIZE(mux_func_map); i++) {
 		if (cd->config.frame_format == mux_func_map[i].frame_format)
-			return mux_func_map[i].demux_proc_func;
+			return mux_func_map[i].func[kernel];
 	}
 
 	return NULL;
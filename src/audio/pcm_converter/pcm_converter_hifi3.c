@@ -603,6 +603,6 @@ const struct pcm_func_map pcm_func_map[] = {
 #endif /* CONFIG_FORMAT_S24LE && CONFIG_FORMAT_S32LE */
 };
 
-const size_t pcm_func_count = ARRAY_SIZE(pcm_func_map);
+const uint32_t pcm_func_count = ARRAY_SIZE(pcm_func_map);
 
 #endif
@@ -7,14 +7,17 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
+#include <sof/audio/latency.h>
 #include <sof/audio/pipeline.h>
 #include <sof/debug/panic.h>
 #include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
+#include <sof/lib/clk.h>
 #include <sof/list.h>
 #include <sof/math/numbers.h>
+#include <sof/platform.h>
 #include <sof/schedule/ll_schedule.h>
 #include <sof/schedule/schedule.h>
 #include <sof/schedule/task.h>
@@ -83,6 +86,20 @@ int pipeline_connect(struct comp_dev *comp, struct comp_buffer *buffer,
 	return 0;
 }
 
+void pipeline_disconnect(struct comp_dev *comp, struct comp_buffer *buffer,
+			 int dir)
+{
+	uint32_t flags;
+
+	pipe_cl_info("pipeline: disconnect comp %d and buffer %d",
+		     dev_comp_id(comp), buffer->id);
+
+	irq_local_disable(flags);
+	list_item_del(buffer_comp_list(buffer, dir));
+	buffer_set_comp(buffer, NULL, dir);
+	irq_local_enable(flags);
+}
+
 /* Generic method for walking the graph upstream or downstream.
  * It requires function pointer for recursion.
  */
@@ -226,6 +243,9 @@ int pipeline_free(struct pipeline *p)
 			return -EBUSY;
 		}
 
+		/* markers in other pipelines must not point to this one */
+		latency_free(p);
+
 		data.start = p->source_comp;
 
 		/* disconnect components */
@@ -438,6 +458,69 @@ static int pipeline_comp_task_init(struct pipeline *p)
 	return 0;
 }
 
+#if CONFIG_COMP_INPLACE || CONFIG_COMP_BYPASS
+/* returns the only buffer of current in dir, NULL for none or several */
+static struct comp_buffer *pipeline_comp_single_buffer(struct comp_dev *current,
+						       int dir)
+{
+	struct list_item *buffer_list = comp_buffer_list(current, dir);
+
+	if (list_is_empty(buffer_list) ||
+	    !list_item_is_last(buffer_list->next, buffer_list))
+		return NULL;
+
+	return buffer_from_list(buffer_list->next, struct comp_buffer, dir);
+}
+#endif
+
+#if CONFIG_COMP_INPLACE
+/* Lets an in place component write its sink over the source when both
+ * buffers carry the same stream in the same pipeline. Sinks that don't
+ * qualify anymore get their own memory back.
+ */
+static int pipeline_comp_inplace(struct comp_dev *current)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	int ret;
+
+	sink = pipeline_comp_single_buffer(current, PPL_DIR_DOWNSTREAM);
+	if (!sink)
+		return 0;
+
+	source = pipeline_comp_single_buffer(current, PPL_DIR_UPSTREAM);
+	if (!source || !(current->drv->flags & COMP_DRV_INPLACE) ||
+	    source->pipeline_id != current->comp.pipeline_id ||
+	    sink->pipeline_id != current->comp.pipeline_id ||
+	    source->core != sink->core || source->caps != sink->caps ||
+	    source->stream.size != sink->stream.size ||
+	    source->stream.frame_fmt != sink->stream.frame_fmt ||
+	    source->stream.channels != sink->stream.channels ||
+	    source->stream.rate != sink->stream.rate)
+		return buffer_unalias(sink);
+
+	if (sink->alias_prev == source)
+		return 0;
+
+	ret = buffer_unalias(sink);
+	if (ret < 0)
+		return ret;
+
+	if (source->alias_next) {
+		ret = buffer_unalias(source->alias_next);
+		if (ret < 0)
+			return ret;
+	}
+
+	pipe_cl_info("pipeline: comp %d in place, buffer %d uses buffer %d",
+		     dev_comp_id(current), sink->id, source->id);
+
+	buffer_alias(source, sink);
+
+	return 0;
+}
+#endif
+
 static int pipeline_comp_prepare(struct comp_dev *current,
 				 struct comp_buffer *calling_buf, void *data,
 				 int dir)
@@ -479,6 +562,12 @@ static int pipeline_comp_prepare(struct comp_dev *current,
 	if (err < 0 || err == PPL_STATUS_PATH_STOP)
 		return err;
 
+#if CONFIG_COMP_INPLACE
+	err = pipeline_comp_inplace(current);
+	if (err < 0)
+		return err;
+#endif
+
 	return pipeline_for_each_comp(current, &pipeline_comp_prepare, data,
 				      &buffer_reset_pos, NULL, dir);
 }
@@ -501,6 +590,13 @@ int pipeline_prepare(struct pipeline *p, struct comp_dev *dev)
 	}
 
 	p->status = COMP_STATE_PREPARE;
+	latency_reset(p);
+#if CONFIG_PIPELINE_EDIT
+	pipeline_edit_cancel(p);
+#endif
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	p->xrun_stats.start = 0;
+#endif
 
 	return ret;
 }
@@ -690,6 +786,10 @@ int pipeline_reset(struct pipeline *p, struct comp_dev *host)
 
 	pipe_info(p, "pipeline_reset()");
 
+#if CONFIG_PIPELINE_EDIT
+	pipeline_edit_cancel(p);
+#endif
+
 	ret = pipeline_comp_reset(host, NULL, p, host->direction);
 	if (ret < 0) {
 		pipe_cl_err("pipeline_reset() error: ret = %d, host->comp.id = %u",
@@ -699,6 +799,58 @@ int pipeline_reset(struct pipeline *p, struct comp_dev *host)
 	return ret;
 }
 
+#if CONFIG_COMP_BYPASS
+/* Forwards the source data of an identity component to its sink instead
+ * of calling copy(). With in place buffers the data is already there and
+ * only the pointers move.
+ */
+static int pipeline_comp_bypass(struct comp_dev *current)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	uint32_t frames;
+	uint32_t bytes;
+
+	source = pipeline_comp_single_buffer(current, PPL_DIR_UPSTREAM);
+	sink = pipeline_comp_single_buffer(current, PPL_DIR_DOWNSTREAM);
+	if (!source || !sink ||
+	    source->stream.frame_fmt != sink->stream.frame_fmt ||
+	    source->stream.channels != sink->stream.channels)
+		return comp_copy(current);
+
+	frames = audio_stream_avail_frames(&source->stream, &sink->stream);
+	bytes = frames * audio_stream_frame_bytes(&source->stream);
+
+	audio_stream_copy(&source->stream, 0, &sink->stream, 0, bytes);
+
+	comp_update_buffer_produce(sink, bytes);
+	comp_update_buffer_consume(source, bytes);
+
+	return 0;
+}
+#endif
+
+static int pipeline_comp_run(struct comp_dev *current)
+{
+	int ret;
+
+	latency_copy_begin(current);
+#if CONFIG_PIPELINE_EDIT
+	if (current->pipeline->edit.comp == current)
+		ret = pipeline_edit_copy(current);
+	else
+#endif
+#if CONFIG_COMP_BYPASS
+	ret = current->identity ? pipeline_comp_bypass(current) :
+		comp_copy(current);
+#else
+	ret = comp_copy(current);
+#endif
+	latency_copy_end(current);
+
+	return ret;
+}
+
 static int pipeline_comp_copy(struct comp_dev *current,
 			      struct comp_buffer *calling_buf, void *data,
 			      int dir)
@@ -722,7 +874,7 @@ static int pipeline_comp_copy(struct comp_dev *current,
 
 	/* copy to downstream immediately */
 	if (dir == PPL_DIR_DOWNSTREAM) {
-		err = comp_copy(current);
+		err = pipeline_comp_run(current);
 		if (err < 0 || err == PPL_STATUS_PATH_STOP)
 			return err;
 	}
@@ -733,7 +885,7 @@ static int pipeline_comp_copy(struct comp_dev *current,
 		return err;
 
 	if (dir == PPL_DIR_UPSTREAM)
-		err = comp_copy(current);
+		err = pipeline_comp_run(current);
 
 	return err;
 }
@@ -830,6 +982,84 @@ static int pipeline_comp_xrun(struct comp_dev *current,
 				      NULL, dir);
 }
 
+#if CONFIG_XRUN_LIGHT_RECOVERY
+static int pipeline_comp_xrun_recover(struct comp_dev *current,
+				      struct comp_buffer *calling_buf,
+				      void *data, int dir)
+{
+	struct pipeline_data *ppl_data = data;
+	int ret;
+
+	/* the recovery is local to the pipeline in xrun */
+	if (current->pipeline != ppl_data->p)
+		return 0;
+
+	ret = comp_xrun_recover(current);
+	if (ret < 0 && ret != -ENOTSUP)
+		comp_err(current, "pipeline_comp_xrun_recover() error: ret = %d",
+			 ret);
+
+	return pipeline_for_each_comp(current, &pipeline_comp_xrun_recover,
+				      data, NULL, NULL, dir);
+}
+
+/* Recovers from an xrun while the pipeline keeps running. The component
+ * that detected it resynchronizes its buffer first, with silence or by
+ * dropping stale data, then the other components of the pipeline are
+ * told with their optional hook and keep their processing state.
+ */
+static int pipeline_xrun_light_recover(struct pipeline *p,
+				       struct comp_dev *dev)
+{
+	struct pipeline_xrun_stats *stats = &p->xrun_stats;
+	struct pipeline_data data;
+	uint64_t now = platform_timer_get(timer_get());
+	int dir;
+	int ret;
+
+	ret = comp_xrun_recover(dev);
+	if (ret < 0) {
+		pipe_info(p, "pipeline_xrun_light_recover(), comp %u needs a restart, ret = %d",
+			  dev_comp_id(dev), ret);
+		return ret;
+	}
+
+	stats->light++;
+	stats->silence_bytes += ret;
+
+	/* a recovery that has not completed yet keeps its start */
+	if (!stats->start)
+		stats->start = now;
+
+	/* from the endpoint towards the host */
+	dir = dev->direction == SOF_IPC_STREAM_PLAYBACK ?
+		PPL_DIR_UPSTREAM : PPL_DIR_DOWNSTREAM;
+	data.p = p;
+
+	pipeline_for_each_comp(dev, &pipeline_comp_xrun_recover, &data,
+			       NULL, NULL, dir);
+
+	pipe_info(p, "pipeline_xrun_light_recover(), comp %u %u bytes",
+		  dev_comp_id(dev), ret);
+
+	return 0;
+}
+
+/* called after a successful copy of a pipeline in recovery */
+static void pipeline_xrun_recovered(struct pipeline *p)
+{
+	struct pipeline_xrun_stats *stats = &p->xrun_stats;
+	uint64_t ticks = platform_timer_get(timer_get()) - stats->start;
+	uint32_t us = ticks * 1000 /
+		clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+
+	stats->last_us = us;
+	stats->max_us = MAX(stats->max_us, us);
+	stats->total_us += us;
+	stats->start = 0;
+}
+#endif
+
 /* Send an XRUN to each host for this component. */
 void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 		   int32_t bytes)
@@ -846,6 +1076,14 @@ void pipeline_xrun(struct pipeline *p, struct comp_dev *dev,
 	if (dev->state != COMP_STATE_ACTIVE)
 		return;
 
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	if (!pipeline_xrun_light_recover(p, dev))
+		return;
+
+	p->xrun_stats.full++;
+	p->xrun_stats.start = 0;
+#endif
+
 	/* notify all pipeline comps we are in XRUN, and stop copying */
 	ret = pipeline_trigger(p, p->source_comp, COMP_TRIGGER_XRUN);
 	if (ret < 0)
@@ -926,7 +1164,19 @@ static enum task_state pipeline_task(void *arg)
 			return SOF_TASK_STATE_COMPLETED;
 	}
 
+#if CONFIG_PIPELINE_EDIT
+	pipeline_edit_period_begin(p);
+#endif
+
 	err = pipeline_copy(p);
+#if CONFIG_PIPELINE_EDIT
+	pipeline_edit_period_end(p);
+#endif
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	/* a light recovery ends with the first successful copy */
+	if (err >= 0 && p->xrun_stats.start)
+		pipeline_xrun_recovered(p);
+#endif
 	if (err < 0) {
 		/* try to recover */
 		err = pipeline_xrun_recover(p);
@@ -0,0 +1,517 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Live edits of the pipeline graph.
+ *
+ * A component is inserted between a buffer and the component reading it,
+ * or removed from between its source and sink buffers, while the pipeline
+ * keeps running. The edited component must keep the stream format, so
+ * that its output can be crossfaded with its input:
+ *  - insert connects the component at the start of the next period, then
+ *    prepares and starts it. Its first output is faded in from its input
+ *    over one period.
+ *  - remove fades the next output of the component out to its input over
+ *    one period. The component then copies its input unprocessed until
+ *    the sink buffer holds only such data. The read pointer of the source
+ *    buffer is moved back over the same data, which is still in memory,
+ *    and the source buffer is connected to the reader of the sink buffer
+ *    at the end of the period.
+ * The input of the crossfaded copy is kept in a scratch buffer, so that
+ * in place components can be removed too. While the sink holds more data
+ * than fits back into the source, the input is held and the reader runs
+ * the sink down. Pipelines that are not running are edited immediately.
+ */
+
+#include <sof/audio/audio_stream.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/component.h>
+#include <sof/audio/latency.h>
+#include <sof/audio/pipeline.h>
+#include <sof/drivers/interrupt.h>
+#include <sof/lib/alloc.h>
+#include <sof/list.h>
+#include <sof/math/numbers.h>
+#include <ipc/stream.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+static bool pipeline_edit_running(struct pipeline *p)
+{
+	return p->source_comp->state == COMP_STATE_ACTIVE ||
+		p->source_comp->state == COMP_STATE_PAUSED;
+}
+
+static bool pipeline_edit_format_valid(struct comp_buffer *source,
+				       struct comp_buffer *sink)
+{
+	switch (source->stream.frame_fmt) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+#endif
+#if CONFIG_FORMAT_S24LE
+	case SOF_IPC_FRAME_S24_4LE:
+#endif
+#if CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S32_LE:
+#endif
+		break;
+	default:
+		return false;
+	}
+
+	return source->stream.frame_fmt == sink->stream.frame_fmt &&
+		source->stream.channels == sink->stream.channels &&
+		source->stream.rate == sink->stream.rate;
+}
+
+/* host and DAI endpoints keep a pointer to their buffer, the buffer read
+ * by them can't be changed
+ */
+static bool pipeline_edit_reader_valid(struct comp_dev *reader)
+{
+	return reader && !list_is_empty(&reader->bsink_list);
+}
+
+static void pipeline_edit_params(struct comp_buffer *buffer,
+				 struct sof_ipc_stream_params *params,
+				 uint32_t direction)
+{
+	int i;
+
+	bzero(params, sizeof(*params));
+	params->direction = direction;
+	params->buffer_fmt = buffer->buffer_fmt;
+	params->frame_fmt = buffer->stream.frame_fmt;
+	params->rate = buffer->stream.rate;
+	params->channels = buffer->stream.channels;
+	for (i = 0; i < SOF_IPC_MAX_CHANNELS; i++)
+		params->chmap[i] = buffer->chmap[i];
+}
+
+static void pipeline_edit_link(struct comp_dev *comp,
+			       struct comp_buffer *source,
+			       struct comp_buffer *sink)
+{
+	struct comp_dev *reader = source->sink;
+
+	pipeline_disconnect(reader, source, PPL_CONN_DIR_BUFFER_TO_COMP);
+	pipeline_connect(comp, source, PPL_CONN_DIR_BUFFER_TO_COMP);
+	pipeline_connect(comp, sink, PPL_CONN_DIR_COMP_TO_BUFFER);
+	pipeline_connect(reader, sink, PPL_CONN_DIR_BUFFER_TO_COMP);
+	comp->pipeline = reader->pipeline;
+}
+
+static void pipeline_edit_unlink(struct comp_dev *comp,
+				 struct comp_buffer *source,
+				 struct comp_buffer *sink)
+{
+	struct comp_dev *reader = sink->sink;
+
+	pipeline_disconnect(reader, sink, PPL_CONN_DIR_BUFFER_TO_COMP);
+	pipeline_disconnect(comp, sink, PPL_CONN_DIR_COMP_TO_BUFFER);
+	pipeline_disconnect(comp, source, PPL_CONN_DIR_BUFFER_TO_COMP);
+	pipeline_connect(reader, source, PPL_CONN_DIR_BUFFER_TO_COMP);
+	comp->pipeline = NULL;
+}
+
+static int pipeline_edit_queue(struct pipeline *p, struct comp_dev *comp,
+			       struct comp_buffer *source,
+			       struct comp_buffer *sink, uint32_t state)
+{
+	uint32_t flags;
+	void *scratch;
+
+	scratch = rballoc(0, SOF_MEM_CAPS_RAM, source->stream.size);
+	if (!scratch)
+		return -ENOMEM;
+
+	irq_local_disable(flags);
+	p->edit.comp = comp;
+	p->edit.source = source;
+	p->edit.sink = sink;
+	p->edit.scratch = scratch;
+	p->edit.state = state;
+	irq_local_enable(flags);
+
+	return 0;
+}
+
+static void pipeline_edit_done(struct pipeline *p)
+{
+	rfree(p->edit.scratch);
+	p->edit.scratch = NULL;
+	p->edit.state = PIPELINE_EDIT_NONE;
+	p->edit.comp = NULL;
+	latency_reset(p);
+}
+
+/* connects, prepares and starts the inserted component */
+static int pipeline_edit_start(struct pipeline *p)
+{
+	struct pipeline_edit *edit = &p->edit;
+	struct sof_ipc_stream_params params;
+	struct comp_dev *comp = edit->comp;
+	int ret;
+
+	pipeline_edit_params(edit->source, &params,
+			     edit->source->sink->direction);
+	pipeline_edit_link(comp, edit->source, edit->sink);
+	comp->direction = params.direction;
+
+	buffer_set_params(edit->sink, &params, BUFFER_UPDATE_FORCE);
+	buffer_reset_pos(edit->sink, NULL);
+
+	ret = comp_params(comp, &params);
+	if (ret < 0)
+		goto err;
+
+	if (!pipeline_edit_format_valid(edit->source, edit->sink)) {
+		comp_err(comp, "pipeline_edit_start() error: format changed");
+		ret = -EINVAL;
+		goto err;
+	}
+
+	ret = comp_prepare(comp);
+	if (ret < 0)
+		goto err;
+
+	ret = comp_trigger(comp, COMP_TRIGGER_START);
+	if (ret < 0)
+		goto err;
+
+	edit->state = PIPELINE_EDIT_FADE_IN;
+	return 0;
+
+err:
+	pipe_err(p, "pipeline_edit_start() error: comp %d not inserted, ret = %d",
+		 dev_comp_id(comp), ret);
+	pipeline_edit_unlink(comp, edit->source, edit->sink);
+	comp_reset(comp);
+	pipeline_edit_done(p);
+	return ret;
+}
+
+/* disconnects the removed component, the source is read again from the
+ * position of the reader in the sink
+ */
+static void pipeline_edit_stop(struct pipeline *p, uint32_t bytes)
+{
+	struct pipeline_edit *edit = &p->edit;
+	struct comp_dev *comp = edit->comp;
+
+	pipeline_edit_unlink(comp, edit->source, edit->sink);
+
+	/* the sink data of an in place component must not count any more */
+	if (edit->sink->alias_prev && buffer_unalias(edit->sink) < 0)
+		audio_stream_reset(&edit->sink->stream);
+
+	buffer_rewind(edit->source, bytes);
+
+	comp_trigger(comp, COMP_TRIGGER_STOP);
+	comp_reset(comp);
+	comp_info(comp, "pipeline_edit_stop(), removed");
+	pipeline_edit_done(p);
+}
+
+int pipeline_edit_insert(struct comp_dev *comp, struct comp_buffer *source,
+			 struct comp_buffer *sink)
+{
+	struct comp_dev *reader = source->sink;
+	struct pipeline *p;
+
+	if (!pipeline_edit_reader_valid(reader) || !source->source ||
+	    !reader->pipeline ||
+	    !reader->pipeline->source_comp ||
+	    source->source->pipeline != reader->pipeline) {
+		comp_err(comp, "pipeline_edit_insert() error: buffer %d not in a pipeline",
+			 source->id);
+		return -EINVAL;
+	}
+
+	p = reader->pipeline;
+	if (p->edit.state != PIPELINE_EDIT_NONE)
+		return -EBUSY;
+
+	/* the reader of source must not write in place over it */
+	if (comp->state != COMP_STATE_READY ||
+	    dev_comp_pipe_id(comp) != p->ipc_pipe.pipeline_id ||
+	    !list_is_empty(&comp->bsource_list) ||
+	    !list_is_empty(&comp->bsink_list) ||
+	    source->pipeline_id != p->ipc_pipe.pipeline_id ||
+	    source->alias_next ||
+	    sink->pipeline_id != p->ipc_pipe.pipeline_id ||
+	    sink->source || sink->sink ||
+	    sink->alias_prev || sink->alias_next) {
+		comp_err(comp, "pipeline_edit_insert() error: can't insert between buffers %d and %d",
+			 source->id, sink->id);
+		return -EINVAL;
+	}
+
+	comp_info(comp, "pipeline_edit_insert(), buffers %d and %d",
+		  source->id, sink->id);
+
+	if (!pipeline_edit_running(p)) {
+		/* prepared pipelines need the whole stream set up again */
+		if (p->source_comp->state != COMP_STATE_READY)
+			return -EBUSY;
+
+		pipeline_edit_link(comp, source, sink);
+		return 0;
+	}
+
+	/* the crossfade needs a linear PCM format */
+	if (!pipeline_edit_format_valid(source, source))
+		return -EINVAL;
+
+	return pipeline_edit_queue(p, comp, source, sink,
+				   PIPELINE_EDIT_INSERT);
+}
+
+int pipeline_edit_remove(struct comp_dev *comp)
+{
+	struct comp_buffer *source;
+	struct comp_buffer *sink;
+	struct pipeline *p = comp->pipeline;
+
+	if (!p || !p->source_comp || comp == p->sched_comp ||
+	    list_is_empty(&comp->bsource_list) ||
+	    list_is_empty(&comp->bsink_list) ||
+	    !list_item_is_last(comp->bsource_list.next, &comp->bsource_list) ||
+	    !list_item_is_last(comp->bsink_list.next, &comp->bsink_list)) {
+		comp_err(comp, "pipeline_edit_remove() error: needs one source and one sink");
+		return -EINVAL;
+	}
+
+	if (p->edit.state != PIPELINE_EDIT_NONE)
+		return -EBUSY;
+
+	source = list_first_item(&comp->bsource_list, struct comp_buffer,
+				 sink_list);
+	sink = list_first_item(&comp->bsink_list, struct comp_buffer,
+			       source_list);
+
+	/* only comp itself may process in place between the buffers, and
+	 * the data left in the sink must fit back into the source
+	 */
+	if (sink->stream.size > source->stream.size ||
+	    !source->source || source->source->pipeline != p ||
+	    !pipeline_edit_reader_valid(sink->sink) ||
+	    sink->sink->pipeline != p ||
+	    source->pipeline_id != p->ipc_pipe.pipeline_id ||
+	    sink->pipeline_id != p->ipc_pipe.pipeline_id ||
+	    sink->alias_next ||
+	    (sink->alias_prev && sink->alias_prev != source) ||
+	    source->alias_next != (sink->alias_prev ? sink : NULL)) {
+		comp_err(comp, "pipeline_edit_remove() error: can't remove from between buffers %d and %d",
+			 source->id, sink->id);
+		return -EINVAL;
+	}
+
+	comp_info(comp, "pipeline_edit_remove(), buffers %d and %d",
+		  source->id, sink->id);
+
+	if (!pipeline_edit_running(p)) {
+		if (p->source_comp->state != COMP_STATE_READY)
+			return -EBUSY;
+
+		pipeline_edit_unlink(comp, source, sink);
+		return 0;
+	}
+
+	if (!pipeline_edit_format_valid(source, sink))
+		return -EINVAL;
+
+	return pipeline_edit_queue(p, comp, source, sink,
+				   PIPELINE_EDIT_FADE_OUT);
+}
+
+void pipeline_edit_period_begin(struct pipeline *p)
+{
+	if (p->edit.state == PIPELINE_EDIT_INSERT)
+		pipeline_edit_start(p);
+}
+
+void pipeline_edit_period_end(struct pipeline *p)
+{
+	struct pipeline_edit *edit = &p->edit;
+	uint32_t bytes;
+
+	if (edit->state != PIPELINE_EDIT_DRAIN)
+		return;
+
+	/* the rest of the sink must be the input last consumed, which is
+	 * still in the free part of the source, or shared with the sink
+	 * when comp is in place
+	 */
+	bytes = edit->sink->stream.avail;
+	if (bytes > edit->dry_bytes ||
+	    (edit->sink->alias_prev != edit->source &&
+	     bytes > edit->source->stream.free))
+		return;
+
+	pipeline_edit_stop(p, bytes);
+}
+
+/* The faded samples are in between the input and output ones so they do
+ * not need saturation. The gain is applied with 16 bits.
+ */
+#if CONFIG_FORMAT_S16LE
+static void pipeline_edit_fade_s16(const int16_t *x, struct audio_stream *sink,
+				   void *out, int frames, bool fade_in)
+{
+	int32_t step = INT32_MAX / frames;
+	int32_t gain = fade_in ? 0 : INT32_MAX;
+	int16_t *y;
+	int nch = sink->channels;
+	int i;
+
+	if (!fade_in)
+		step = -step;
+
+	for (i = 0; i < frames * nch; i++) {
+		if (!(i % nch))
+			gain += step;
+
+		y = audio_stream_get_frag(sink, out, i, sizeof(int16_t));
+		*y = x[i] + (((int32_t)(*y - x[i]) * (gain >> 16)) >> 15);
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+static void pipeline_edit_fade_s32(const int32_t *x, struct audio_stream *sink,
+				   void *out, int frames, bool fade_in)
+{
+	int32_t step = INT32_MAX / frames;
+	int32_t gain = fade_in ? 0 : INT32_MAX;
+	int32_t *y;
+	int nch = sink->channels;
+	int i;
+
+	if (!fade_in)
+		step = -step;
+
+	for (i = 0; i < frames * nch; i++) {
+		if (!(i % nch))
+			gain += step;
+
+		y = audio_stream_get_frag(sink, out, i, sizeof(int32_t));
+		*y = x[i] + ((((int64_t)*y - x[i]) * (gain >> 16)) >> 15);
+	}
+}
+
+/* Crossfades the output of the component, starting at out, with the
+ * input it consumed
+ */
+static void pipeline_edit_fade(const void *in, struct audio_stream *sink,
+			       void *out, int frames, bool fade_in)
+{
+#if CONFIG_FORMAT_S16LE
+	if (sink->frame_fmt == SOF_IPC_FRAME_S16_LE)
+		pipeline_edit_fade_s16(in, sink, out, frames, fade_in);
+	else
+#endif /* CONFIG_FORMAT_S16LE */
+		pipeline_edit_fade_s32(in, sink, out, frames, fade_in);
+}
+
+/* copies the input unprocessed */
+static int pipeline_edit_drain(struct pipeline_edit *edit)
+{
+	struct audio_stream *source = &edit->source->stream;
+	struct audio_stream *sink = &edit->sink->stream;
+	uint32_t bytes;
+
+	/* the input is held while the sink has more data than the source
+	 * can take back, the reader runs the sink down meanwhile
+	 */
+	if (edit->sink->alias_prev != edit->source &&
+	    sink->avail > source->free)
+		return 0;
+
+	bytes = audio_stream_avail_frames(source, sink) *
+		audio_stream_frame_bytes(source);
+
+	audio_stream_copy(source, 0, sink, 0, bytes);
+
+	comp_update_buffer_produce(edit->sink, bytes);
+	comp_update_buffer_consume(edit->source, bytes);
+
+	edit->dry_bytes = MIN(edit->dry_bytes + bytes, sink->size);
+
+	return 0;
+}
+
+int pipeline_edit_copy(struct comp_dev *dev)
+{
+	struct pipeline *p = dev->pipeline;
+	struct pipeline_edit *edit = &p->edit;
+	struct audio_stream *source = &edit->source->stream;
+	struct audio_stream *sink = &edit->sink->stream;
+	struct audio_stream in;
+	void *out = sink->w_ptr;
+	uint32_t avail = source->avail;
+	uint32_t filled = sink->avail;
+	uint32_t frame_bytes = audio_stream_frame_bytes(sink);
+	uint32_t consumed;
+	uint32_t produced;
+	uint32_t bytes;
+	uint32_t frames;
+	int ret;
+
+	if (edit->state == PIPELINE_EDIT_DRAIN)
+		return pipeline_edit_drain(edit);
+
+	/* keep the input, in place components write over it */
+	audio_stream_init(&in, edit->scratch, source->size);
+	audio_stream_copy(source, 0, &in, 0, avail);
+
+	ret = comp_copy(dev);
+	if (ret < 0)
+		return ret;
+
+	consumed = avail - source->avail;
+	produced = sink->avail - filled;
+	bytes = MIN(consumed, produced);
+	frames = bytes / frame_bytes;
+	if (dev->frames)
+		frames = MIN(frames, dev->frames);
+
+	/* fade the first data the component processes */
+	if (!frames)
+		return ret;
+
+	pipeline_edit_fade(in.addr, sink, out, frames,
+			   edit->state == PIPELINE_EDIT_FADE_IN);
+
+	if (edit->state == PIPELINE_EDIT_FADE_IN) {
+		comp_info(dev, "pipeline_edit_copy(), inserted");
+		pipeline_edit_done(p);
+		return ret;
+	}
+
+	/* after the fade the output is the input */
+	audio_stream_copy(&in, frames * frame_bytes, sink,
+			  sink->size - produced + frames * frame_bytes,
+			  bytes - frames * frame_bytes);
+
+	/* output without matching input, e.g. delayed in the component,
+	 * has to be consumed by the reader first
+	 */
+	edit->dry_bytes = consumed == produced ?
+		produced - frames * frame_bytes : 0;
+	edit->state = PIPELINE_EDIT_DRAIN;
+
+	return ret;
+}
+
+void pipeline_edit_cancel(struct pipeline *p)
+{
+	if (p->edit.state == PIPELINE_EDIT_NONE)
+		return;
+
+	pipe_info(p, "pipeline_edit_cancel(), comp %d state %d",
+		  dev_comp_id(p->edit.comp), p->edit.state);
+
+	pipeline_edit_done(p);
+}
@@ -9,10 +9,12 @@
  * \brief Audio channel selection component. In case 1 output channel is
  * \brief selected in topology the component provides the selected channel on
  * \brief output. In case 2 or 4 channels are selected on output the component
- * \brief works in a passthrough mode.
+ * \brief works in a passthrough mode. A channel map set through the binary
+ * \brief control selects and reorders any source channels into the sink.
  * \authors Lech Betlej <lech.betlej@linux.intel.com>
  */
 
+#include <sof/audio/channel_map.h>
 #include <sof/audio/component.h>
 #include <sof/audio/pipeline.h>
 #include <sof/audio/selector.h>
@@ -24,6 +26,7 @@
 #include <sof/list.h>
 #include <sof/string.h>
 #include <sof/trace/trace.h>
+#include <ipc/channel_map.h>
 #include <ipc/control.h>
 #include <ipc/stream.h>
 #include <ipc/topology.h>
@@ -35,6 +38,9 @@
 
 static const struct comp_driver comp_selector;
 
+/** \brief Q2.30 unity coefficient of a channel map entry. */
+#define SEL_CHMAP_COEF_ONE	(1 << 30)
+
 /**
  * \brief Creates selector component.
  * \param[in,out] data Selector base component device.
@@ -88,6 +94,9 @@ static void selector_free(struct comp_dev *dev)
 
 	comp_info(dev, "selector_free()");
 
+	rfree(cd->stream_map);
+	rfree(cd->ch_map);
+	rfree(cd->frame);
 	rfree(cd);
 	rfree(dev);
 }
@@ -158,36 +167,30 @@ static int selector_verify_params(struct comp_dev *dev,
 	/* set component period frames */
 	component_set_period_frames(dev, sinkb->stream.rate);
 
-	/* verify input channels */
-	switch (in_channels) {
-	case SEL_SOURCE_2CH:
-	case SEL_SOURCE_4CH:
-		break;
-	default:
+	/* verify input and output channels */
+	if (!in_channels) {
 		comp_err(dev, "selector_verify_params() error: in_channels = %u"
 			 , in_channels);
 		return -EINVAL;
 	}
 
-	/* verify output channels */
-	switch (out_channels) {
-	case SEL_SINK_1CH:
-		break;
-	case SEL_SINK_2CH:
-	case SEL_SINK_4CH:
-		/* verify proper channels for passthrough mode */
-		if (in_channels != out_channels) {
-			comp_err(dev, "selector_verify_params() error: in_channels = %u, out_channels = %u"
-				 , in_channels, out_channels);
-			return -EINVAL;
-		}
-		break;
-	default:
+	if (!out_channels) {
 		comp_err(dev, "selector_verify_params() error: out_channels = %u"
 			 , out_channels);
 		return -EINVAL;
 	}
 
+	/* the channel map is checked against the channels in prepare */
+	if (cd->stream_map)
+		return 0;
+
+	/* without a channel map one channel is selected or all passed */
+	if (out_channels != SEL_SINK_1CH && in_channels != out_channels) {
+		comp_err(dev, "selector_verify_params() error: in_channels = %u, out_channels = %u"
+			 , in_channels, out_channels);
+		return -EINVAL;
+	}
+
 	if (cd->config.sel_channel > (SEL_SOURCE_4CH - 1)) {
 		comp_err(dev, "selector_verify_params() error: ch_idx = %u"
 			 , cd->config.sel_channel);
@@ -226,24 +229,105 @@ static int selector_params(struct comp_dev *dev,
  * \param[in,out] cdata Control command data.
  * \return Error code.
  */
-static int selector_ctrl_set_data(struct comp_dev *dev,
-				  struct sof_ipc_ctrl_data *cdata)
+static int selector_ctrl_set_config(struct comp_dev *dev,
+				    struct sof_ipc_ctrl_data *cdata)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
 	struct sof_sel_config *cfg;
+
+	cfg = (struct sof_sel_config *)ASSUME_ALIGNED(cdata->data->data, 4);
+
+	/* Just set the configuration */
+	cd->config.in_channels_count = cfg->in_channels_count;
+	cd->config.out_channels_count = cfg->out_channels_count;
+	cd->config.sel_channel = cfg->sel_channel;
+
+	return 0;
+}
+
+/**
+ * \brief Stores a channel map, applied in the next prepare.
+ * \param[in,out] dev Selector base component device.
+ * \param[in] cdata Control command data carrying struct sof_ipc_stream_map.
+ * \return Error code.
+ */
+static int selector_ctrl_set_channel_map(struct comp_dev *dev,
+					 struct sof_ipc_ctrl_data *cdata)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_stream_map *smap;
+	struct sof_ipc_channel_map *chmap;
+	uint32_t size = cdata->data->size;
+	uint32_t bytes = sizeof(*smap);
+	uint32_t i;
+	int ret;
+
+	smap = (struct sof_ipc_stream_map *)
+	       ASSUME_ALIGNED(cdata->data->data, 4);
+
+	if (size < sizeof(*smap)) {
+		comp_err(dev, "selector_ctrl_set_channel_map() error: invalid map size %u",
+			 size);
+		return -EINVAL;
+	}
+
+	/* walk the variable size entries within the received data */
+	for (i = 0; i < smap->num_ch_map; i++) {
+		if (bytes + sizeof(*chmap) > size) {
+			comp_err(dev, "selector_ctrl_set_channel_map() error: map %u truncated",
+				 i);
+			return -EINVAL;
+		}
+
+		chmap = (struct sof_ipc_channel_map *)((char *)smap + bytes);
+		bytes += chmap_get_size(chmap);
+		if (bytes > size) {
+			comp_err(dev, "selector_ctrl_set_channel_map() error: map %u truncated",
+				 i);
+			return -EINVAL;
+		}
+	}
+
+	rfree(cd->stream_map);
+	cd->stream_map = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				 bytes);
+	if (!cd->stream_map)
+		return -ENOMEM;
+
+	ret = memcpy_s(cd->stream_map, bytes, smap, bytes);
+	assert(!ret);
+
+	return 0;
+}
+
+/**
+ * \brief Sets selector control command.
+ * \param[in,out] dev Selector base component device.
+ * \param[in,out] cdata Control command data.
+ * \return Error code.
+ */
+static int selector_ctrl_set_data(struct comp_dev *dev,
+				  struct sof_ipc_ctrl_data *cdata)
+{
 	int ret = 0;
 
 	switch (cdata->cmd) {
 	case SOF_CTRL_CMD_BINARY:
 		comp_info(dev, "selector_ctrl_set_data(), SOF_CTRL_CMD_BINARY");
 
-		cfg = (struct sof_sel_config *)
-		      ASSUME_ALIGNED(cdata->data->data, 4);
-
-		/* Just set the configuration */
-		cd->config.in_channels_count = cfg->in_channels_count;
-		cd->config.out_channels_count = cfg->out_channels_count;
-		cd->config.sel_channel = cfg->sel_channel;
+		switch (cdata->data->type) {
+		case SOF_SEL_CTRL_CONFIG:
+			ret = selector_ctrl_set_config(dev, cdata);
+			break;
+		case SOF_SEL_CTRL_CHANNEL_MAP:
+			ret = selector_ctrl_set_channel_map(dev, cdata);
+			break;
+		default:
+			comp_err(dev, "selector_ctrl_set_data() error: unknown binary data type %u",
+				 cdata->data->type);
+			ret = -EINVAL;
+			break;
+		}
 		break;
 	default:
 		comp_err(dev, "selector_ctrl_set_cmd() error: invalid cdata->cmd = %u",
@@ -394,6 +478,94 @@ static int selector_copy(struct comp_dev *dev)
 	return 0;
 }
 
+/**
+ * \brief Allocates the channel map and bounce frame for the stream channels.
+ * \param[in,out] dev Selector base component device.
+ * \return Error code.
+ */
+static int selector_alloc_channels(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+
+	if (!cd->in_channels || !cd->out_channels) {
+		comp_err(dev, "selector_alloc_channels() error: in_channels = %u, out_channels = %u",
+			 cd->in_channels, cd->out_channels);
+		return -EINVAL;
+	}
+
+	rfree(cd->ch_map);
+	rfree(cd->frame);
+
+	cd->ch_map = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			     cd->out_channels * sizeof(*cd->ch_map));
+	cd->frame = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			    (cd->in_channels + cd->out_channels) *
+			    sizeof(*cd->frame));
+	if (!cd->ch_map || !cd->frame) {
+		comp_err(dev, "selector_alloc_channels() error: no memory for %u channels",
+			 cd->in_channels + cd->out_channels);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/**
+ * \brief Compiles the source channel of each sink channel.
+ * \param[in,out] dev Selector base component device.
+ * \return Error code.
+ *
+ * Channel map entries select one source channel per sink channel, sink
+ * channels without an entry are silent. Without a channel map the configured
+ * channel is selected for a mono sink, otherwise all channels are passed.
+ */
+static int selector_build_channel_map(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct sof_ipc_channel_map *chmap;
+	uint32_t in_ch;
+	uint32_t i;
+
+	if (!cd->stream_map) {
+		if (cd->out_channels == SEL_SINK_1CH) {
+			if (cd->config.sel_channel >= cd->in_channels) {
+				comp_err(dev, "selector_build_channel_map() error: sel_channel = %u, in_channels = %u",
+					 cd->config.sel_channel,
+					 cd->in_channels);
+				return -EINVAL;
+			}
+			cd->ch_map[0] = cd->config.sel_channel;
+			return 0;
+		}
+
+		for (i = 0; i < cd->out_channels; i++)
+			cd->ch_map[i] = i;
+		return 0;
+	}
+
+	for (i = 0; i < cd->out_channels; i++)
+		cd->ch_map[i] = SEL_CHANNEL_NONE;
+
+	for (i = 0; i < cd->stream_map->num_ch_map; i++) {
+		chmap = chmap_get(cd->stream_map, i);
+		in_ch = ffs(chmap->ch_mask) - 1;
+
+		/* a selection takes exactly one unscaled source channel */
+		if (chmap->ch_index >= cd->out_channels ||
+		    popcount(chmap->ch_mask) != 1 ||
+		    in_ch >= cd->in_channels ||
+		    chmap->ch_coeffs[0] != SEL_CHMAP_COEF_ONE) {
+			comp_err(dev, "selector_build_channel_map() error: invalid map %u, ch_index = %u, ch_mask = 0x%x",
+				 i, chmap->ch_index, chmap->ch_mask);
+			return -EINVAL;
+		}
+
+		cd->ch_map[chmap->ch_index] = in_ch;
+	}
+
+	return 0;
+}
+
 /**
  * \brief Prepares selector component for processing.
  * \param[in,out] dev Selector base component device.
@@ -462,15 +634,30 @@ static int selector_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
+	cd->in_channels = sourceb->stream.channels;
+	cd->out_channels = sinkb->stream.channels;
+
+	ret = selector_alloc_channels(dev);
+	if (ret < 0)
+		goto err;
+
+	ret = selector_build_channel_map(dev);
+	if (ret < 0)
+		goto err;
+
 	cd->sel_func = sel_get_processing_function(dev);
 	if (!cd->sel_func) {
-		comp_err(dev, "selector_prepare() error: invalid cd->sel_func, cd->source_format = %u, cd->sink_format = %u, cd->out_channels_count = %u",
+		comp_err(dev, "selector_prepare() error: invalid cd->sel_func, cd->source_format = %u, cd->sink_format = %u, cd->out_channels = %u",
 			 cd->source_format, cd->sink_format,
-			 cd->config.out_channels_count);
+			 cd->out_channels);
 		ret = -EINVAL;
 		goto err;
 	}
 
+	/* copying all channels unchanged can be bypassed */
+	dev->identity = cd->source_format == cd->sink_format &&
+			sel_map_is_identity(cd);
+
 	return 0;
 
 err:
@@ -485,10 +672,17 @@ err:
  */
 static int selector_reset(struct comp_dev *dev)
 {
+	struct comp_data *cd = comp_get_drvdata(dev);
 	int ret;
 
 	comp_info(dev, "selector_reset()");
 
+	rfree(cd->ch_map);
+	rfree(cd->frame);
+	cd->ch_map = NULL;
+	cd->frame = NULL;
+
+	dev->identity = false;
 	ret = comp_set_state(dev, COMP_TRIGGER_RESET);
 
 	return ret;
@@ -497,6 +691,7 @@ static int selector_reset(struct comp_dev *dev)
 /** \brief Selector component definition. */
 static const struct comp_driver comp_selector = {
 	.type	= SOF_COMP_SELECTOR,
+	.flags	= COMP_DRV_INPLACE,
 	.ops	= {
 		.new		= selector_new,
 		.free		= selector_free,
@@ -14,149 +14,427 @@
 #include <sof/audio/component.h>
 #include <sof/audio/selector.h>
 #include <sof/common.h>
+#include <sof/debug/panic.h>
+#include <sof/string.h>
 #include <ipc/stream.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#if CONFIG_FORMAT_S16LE
 /**
- * \brief Channel selection for 16 bit, 1 channel data format.
- * \param[in,out] dev Selector base component device.
- * \param[in,out] sink Destination buffer.
- * \param[in,out] source Source buffer.
+ * \brief Selection kernel for a span of frames that don't wrap.
+ * \param[out] dst First sink frame.
+ * \param[in] src First source frame.
  * \param[in] frames Number of frames to process.
+ * \param[in] cd Selector component private data.
  */
-static void sel_s16le_1ch(struct comp_dev *dev, struct audio_stream *sink,
-			  const struct audio_stream *source, uint32_t frames)
+typedef void (*sel_span_func)(void *dst, const void *src, uint32_t frames,
+			      const struct comp_data *cd);
+
+/* copy one frame between a wrapping stream and a linear bounce frame */
+static void sel_bounce(const struct audio_stream *stream, char *ptr,
+		       char *frame, uint32_t bytes, bool read)
 {
-	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src;
-	int16_t *dest;
+	char *p;
 	uint32_t i;
-	uint32_t j = 0;
-	uint32_t nch = cd->config.in_channels_count;
 
-	for (i = cd->config.sel_channel; i < frames * nch; i += nch) {
-		src = audio_stream_read_frag_s16(source, i);
-		dest = audio_stream_write_frag_s16(sink, j++);
-		*dest = *src;
+	for (i = 0; i < bytes; i++) {
+		p = audio_stream_wrap(stream, ptr + i);
+		if (read)
+			frame[i] = *p;
+		else
+			*p = frame[i];
 	}
 }
 
 /**
- * \brief Channel selection for 16 bit, at least 2 channels data format.
+ * \brief Runs a span kernel over the largest spans that don't wrap.
  * \param[in,out] dev Selector base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  * \param[in] frames Number of frames to process.
+ * \param[in] span Span kernel.
  */
-static void sel_s16le_nch(struct comp_dev *dev, struct audio_stream *sink,
-			  const struct audio_stream *source, uint32_t frames)
+static void sel_process(struct comp_dev *dev, struct audio_stream *sink,
+			const struct audio_stream *source, uint32_t frames,
+			sel_span_func span)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int16_t *src;
-	int16_t *dest;
+	uint32_t sample = audio_stream_sample_bytes(source);
+	uint32_t src_frame = cd->in_channels * sample;
+	uint32_t dst_frame = cd->out_channels * sample;
+	int32_t *in = cd->frame;
+	int32_t *out = cd->frame + cd->in_channels;
+	char *src = source->r_ptr;
+	char *dst = sink->w_ptr;
+	uint32_t n;
+	int ret;
+
+	while (frames) {
+		n = MIN((uint32_t)((char *)source->end_addr - src) / src_frame,
+			(uint32_t)((char *)sink->end_addr - dst) / dst_frame);
+		n = MIN(n, frames);
+
+		if (n && src == dst) {
+			/* in place, a frame is read before it is written */
+			n = 1;
+			span(out, src, n, cd);
+			ret = memcpy_s(dst, dst_frame, out, dst_frame);
+			assert(!ret);
+		} else if (n) {
+			span(dst, src, n, cd);
+		} else {
+			/* the frame straddles the end of a buffer */
+			n = 1;
+			sel_bounce(source, src, (char *)in, src_frame, true);
+			span(out, in, n, cd);
+			sel_bounce(sink, dst, (char *)out, dst_frame, false);
+		}
+
+		src = audio_stream_wrap(source, src + n * src_frame);
+		dst = audio_stream_wrap(sink, dst + n * dst_frame);
+		frames -= n;
+	}
+}
+
+/* true when every sink channel takes the same channel of the source */
+bool sel_map_is_identity(const struct comp_data *cd)
+{
+	uint32_t ch;
+
+	if (cd->in_channels != cd->out_channels)
+		return false;
+
+	for (ch = 0; ch < cd->out_channels; ch++)
+		if (cd->ch_map[ch] != ch)
+			return false;
+
+	return true;
+}
+
+/* true when no sink channel is left silent */
+static bool sel_map_is_complete(const struct comp_data *cd)
+{
+	uint32_t ch;
+
+	for (ch = 0; ch < cd->out_channels; ch++)
+		if (cd->ch_map[ch] == SEL_CHANNEL_NONE)
+			return false;
+
+	return true;
+}
+
+#if CONFIG_FORMAT_S16LE
+static void sel_span_s16le_2to1(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int16_t *s = (const int16_t *)src + cd->ch_map[0];
+	int16_t *d = dst;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++)
+		d[i] = s[2 * i];
+}
+
+static void sel_span_s16le_4to2(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int16_t *s = src;
+	int16_t *d = dst;
+	uint16_t ch0 = cd->ch_map[0];
+	uint16_t ch1 = cd->ch_map[1];
 	uint32_t i;
-	uint32_t j = 0;
-	uint32_t channel;
 
 	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < cd->config.in_channels_count;
-		     channel++) {
-			src = audio_stream_read_frag_s16(source, j);
-			dest = audio_stream_write_frag_s16(sink, j);
-			*dest = *src;
-			j++;
-		}
+		d[0] = s[ch0];
+		d[1] = s[ch1];
+		d += 2;
+		s += 4;
+	}
+}
+
+static void sel_span_s16le_8to2(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int16_t *s = src;
+	int16_t *d = dst;
+	uint16_t ch0 = cd->ch_map[0];
+	uint16_t ch1 = cd->ch_map[1];
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		d[0] = s[ch0];
+		d[1] = s[ch1];
+		d += 2;
+		s += 8;
+	}
+}
+
+static void sel_span_s16le_nto1(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int16_t *s = (const int16_t *)src + cd->ch_map[0];
+	int16_t *d = dst;
+	uint32_t nch = cd->in_channels;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		d[i] = *s;
+		s += nch;
+	}
+}
+
+static void sel_span_s16le_ntom(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int16_t *s = src;
+	int16_t *d = dst;
+	uint32_t i;
+	uint32_t ch;
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < cd->out_channels; ch++)
+			d[ch] = cd->ch_map[ch] == SEL_CHANNEL_NONE ?
+				0 : s[cd->ch_map[ch]];
+		d += cd->out_channels;
+		s += cd->in_channels;
 	}
 }
-#endif /* CONFIG_FORMAT_S16LE */
 
-#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
 /**
- * \brief Channel selection for 32 bit, 1 channel data format.
+ * \brief Channel passthrough for 16 bit data format.
  * \param[in,out] dev Selector base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  * \param[in] frames Number of frames to process.
  */
-static void sel_s32le_1ch(struct comp_dev *dev, struct audio_stream *sink,
-			  const struct audio_stream *source, uint32_t frames)
+static void sel_s16le_copy(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src;
-	int32_t *dest;
+
+	audio_stream_copy_s16(source, 0, sink, 0, frames * cd->in_channels);
+}
+
+static void sel_s16le_2to1(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s16le_2to1);
+}
+
+static void sel_s16le_4to2(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s16le_4to2);
+}
+
+static void sel_s16le_8to2(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s16le_8to2);
+}
+
+static void sel_s16le_nto1(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s16le_nto1);
+}
+
+static void sel_s16le_ntom(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s16le_ntom);
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+static void sel_span_s32le_2to1(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int32_t *s = (const int32_t *)src + cd->ch_map[0];
+	int32_t *d = dst;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++)
+		d[i] = s[2 * i];
+}
+
+static void sel_span_s32le_4to2(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int32_t *s = src;
+	int32_t *d = dst;
+	uint16_t ch0 = cd->ch_map[0];
+	uint16_t ch1 = cd->ch_map[1];
 	uint32_t i;
-	uint32_t j = 0;
-	uint32_t nch = cd->config.in_channels_count;
 
-	for (i = cd->config.sel_channel; i < frames * nch; i += nch) {
-		src = audio_stream_read_frag_s32(source, i);
-		dest = audio_stream_write_frag_s32(sink, j++);
-		*dest = *src;
+	for (i = 0; i < frames; i++) {
+		d[0] = s[ch0];
+		d[1] = s[ch1];
+		d += 2;
+		s += 4;
+	}
+}
+
+static void sel_span_s32le_8to2(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int32_t *s = src;
+	int32_t *d = dst;
+	uint16_t ch0 = cd->ch_map[0];
+	uint16_t ch1 = cd->ch_map[1];
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		d[0] = s[ch0];
+		d[1] = s[ch1];
+		d += 2;
+		s += 8;
+	}
+}
+
+static void sel_span_s32le_nto1(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int32_t *s = (const int32_t *)src + cd->ch_map[0];
+	int32_t *d = dst;
+	uint32_t nch = cd->in_channels;
+	uint32_t i;
+
+	for (i = 0; i < frames; i++) {
+		d[i] = *s;
+		s += nch;
+	}
+}
+
+static void sel_span_s32le_ntom(void *dst, const void *src, uint32_t frames,
+				const struct comp_data *cd)
+{
+	const int32_t *s = src;
+	int32_t *d = dst;
+	uint32_t i;
+	uint32_t ch;
+
+	for (i = 0; i < frames; i++) {
+		for (ch = 0; ch < cd->out_channels; ch++)
+			d[ch] = cd->ch_map[ch] == SEL_CHANNEL_NONE ?
+				0 : s[cd->ch_map[ch]];
+		d += cd->out_channels;
+		s += cd->in_channels;
 	}
 }
 
 /**
- * \brief Channel selection for 32 bit, at least 2 channels data format.
+ * \brief Channel passthrough for 32 bit data format.
  * \param[in,out] dev Selector base component device.
  * \param[in,out] sink Destination buffer.
  * \param[in,out] source Source buffer.
  * \param[in] frames Number of frames to process.
  */
-static void sel_s32le_nch(struct comp_dev *dev, struct audio_stream *sink,
-			  const struct audio_stream *source, uint32_t frames)
+static void sel_s32le_copy(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
-	int32_t *src;
-	int32_t *dest;
-	uint32_t i;
-	uint32_t j = 0;
-	uint32_t channel;
 
-	for (i = 0; i < frames; i++) {
-		for (channel = 0; channel < cd->config.in_channels_count;
-		     channel++) {
-			src = audio_stream_read_frag_s32(source, j);
-			dest = audio_stream_write_frag_s32(sink, j);
-			*dest = *src;
-			j++;
-		}
-	}
+	audio_stream_copy_s32(source, 0, sink, 0, frames * cd->in_channels);
+}
+
+static void sel_s32le_2to1(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s32le_2to1);
+}
+
+static void sel_s32le_4to2(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s32le_4to2);
+}
+
+static void sel_s32le_8to2(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s32le_8to2);
+}
+
+static void sel_s32le_nto1(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s32le_nto1);
+}
+
+static void sel_s32le_ntom(struct comp_dev *dev, struct audio_stream *sink,
+			   const struct audio_stream *source, uint32_t frames)
+{
+	sel_process(dev, sink, source, frames, sel_span_s32le_ntom);
 }
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 
+/* specialized kernels first, 0 channels matches any channel count */
 const struct comp_func_map func_table[] = {
 #if CONFIG_FORMAT_S16LE
-	{SOF_IPC_FRAME_S16_LE, 1, sel_s16le_1ch},
-	{SOF_IPC_FRAME_S16_LE, 2, sel_s16le_nch},
-	{SOF_IPC_FRAME_S16_LE, 4, sel_s16le_nch},
+	{SOF_IPC_FRAME_S16_LE, 2, 1, sel_s16le_2to1},
+	{SOF_IPC_FRAME_S16_LE, 4, 2, sel_s16le_4to2},
+	{SOF_IPC_FRAME_S16_LE, 8, 2, sel_s16le_8to2},
+	{SOF_IPC_FRAME_S16_LE, 0, 1, sel_s16le_nto1},
+	{SOF_IPC_FRAME_S16_LE, 0, 0, sel_s16le_ntom},
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-	{SOF_IPC_FRAME_S24_4LE, 1, sel_s32le_1ch},
-	{SOF_IPC_FRAME_S24_4LE, 2, sel_s32le_nch},
-	{SOF_IPC_FRAME_S24_4LE, 4, sel_s32le_nch},
+	{SOF_IPC_FRAME_S24_4LE, 2, 1, sel_s32le_2to1},
+	{SOF_IPC_FRAME_S24_4LE, 4, 2, sel_s32le_4to2},
+	{SOF_IPC_FRAME_S24_4LE, 8, 2, sel_s32le_8to2},
+	{SOF_IPC_FRAME_S24_4LE, 0, 1, sel_s32le_nto1},
+	{SOF_IPC_FRAME_S24_4LE, 0, 0, sel_s32le_ntom},
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-	{SOF_IPC_FRAME_S32_LE, 1, sel_s32le_1ch},
-	{SOF_IPC_FRAME_S32_LE, 2, sel_s32le_nch},
-	{SOF_IPC_FRAME_S32_LE, 4, sel_s32le_nch},
+	{SOF_IPC_FRAME_S32_LE, 2, 1, sel_s32le_2to1},
+	{SOF_IPC_FRAME_S32_LE, 4, 2, sel_s32le_4to2},
+	{SOF_IPC_FRAME_S32_LE, 8, 2, sel_s32le_8to2},
+	{SOF_IPC_FRAME_S32_LE, 0, 1, sel_s32le_nto1},
+	{SOF_IPC_FRAME_S32_LE, 0, 0, sel_s32le_ntom},
 #endif /* CONFIG_FORMAT_S32LE */
 };
 
 sel_func sel_get_processing_function(struct comp_dev *dev)
 {
 	struct comp_data *cd = comp_get_drvdata(dev);
+	bool complete;
 	int i;
 
+	switch (cd->source_format) {
+#if CONFIG_FORMAT_S16LE
+	case SOF_IPC_FRAME_S16_LE:
+		if (sel_map_is_identity(cd))
+			return sel_s16le_copy;
+		break;
+#endif /* CONFIG_FORMAT_S16LE */
+#if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
+	case SOF_IPC_FRAME_S24_4LE:
+	case SOF_IPC_FRAME_S32_LE:
+		if (sel_map_is_identity(cd))
+			return sel_s32le_copy;
+		break;
+#endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
+	default:
+		break;
+	}
+
+	complete = sel_map_is_complete(cd);
+
 	/* map the channel selection function for source and sink buffers */
 	for (i = 0; i < ARRAY_SIZE(func_table); i++) {
 		if (cd->source_format != func_table[i].source)
 			continue;
-		if (cd->config.out_channels_count != func_table[i].out_channels)
+		/* kernels for a given sink size don't fill silent channels */
+		if (func_table[i].out_channels && !complete)
+			continue;
+		if (func_table[i].in_channels &&
+		    cd->in_channels != func_table[i].in_channels)
+			continue;
+		if (func_table[i].out_channels &&
+		    cd->out_channels != func_table[i].out_channels)
 			continue;
 
-		/* TODO: add additional criteria as needed */
 		return func_table[i].sel_func;
 	}
 
@@ -37,10 +37,6 @@
 #include <sof/audio/coefficients/src/src_std_int32_table.h>
 #endif
 
-/* The FIR maximum lengths are per channel so need to multiply them */
-#define MAX_FIR_DELAY_SIZE_XNCH (PLATFORM_MAX_CHANNELS * MAX_FIR_DELAY_SIZE)
-#define MAX_OUT_DELAY_SIZE_XNCH (PLATFORM_MAX_CHANNELS * MAX_OUT_DELAY_SIZE)
-
 static const struct comp_driver comp_src;
 
 /* src component private data */
@@ -100,9 +96,10 @@ int src_buffer_lengths(struct src_param *a, int fs_in, int fs_out, int nch,
 	struct src_stage *stage2;
 	int r1;
 
-	if (nch > PLATFORM_MAX_CHANNELS) {
+	/* The delay lines are sized for the stream channels count */
+	if (nch < 1) {
 		/* TODO: should be device, not class */
-		comp_cl_err(&comp_src, "src_buffer_lengths() error: nch = %u > PLATFORM_MAX_CHANNELS",
+		comp_cl_err(&comp_src, "src_buffer_lengths() error: nch = %u",
 			    nch);
 		return -EINVAL;
 	}
@@ -224,11 +221,13 @@ static int init_stages(struct src_stage *stage1, struct src_stage *stage2,
 		src->state2.out_delay = NULL;
 	}
 
-	/* Check the sizes are less than MAX */
-	if (src->state1.fir_delay_size > MAX_FIR_DELAY_SIZE_XNCH ||
-	    src->state1.out_delay_size > MAX_OUT_DELAY_SIZE_XNCH ||
-	    src->state2.fir_delay_size > MAX_FIR_DELAY_SIZE_XNCH ||
-	    src->state2.out_delay_size > MAX_OUT_DELAY_SIZE_XNCH) {
+	/* Check the sizes are less than MAX, the FIR maximum lengths are
+	 * per channel so need to multiply them.
+	 */
+	if (src->state1.fir_delay_size > p->nch * MAX_FIR_DELAY_SIZE ||
+	    src->state1.out_delay_size > p->nch * MAX_OUT_DELAY_SIZE ||
+	    src->state2.fir_delay_size > p->nch * MAX_FIR_DELAY_SIZE ||
+	    src->state2.out_delay_size > p->nch * MAX_OUT_DELAY_SIZE) {
 		src->state1.fir_delay = NULL;
 		src->state1.out_delay = NULL;
 		src->state2.fir_delay = NULL;
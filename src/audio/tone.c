@@ -82,7 +82,8 @@ struct comp_data {
 	uint32_t channels;
 	uint32_t frame_bytes;
 	uint32_t rate;
-	struct tone_state sg[PLATFORM_MAX_CHANNELS];
+	uint32_t max_channels; /* Channels with tone state */
+	struct tone_state *sg;
 	void (*tone_func)(struct comp_dev *dev, struct audio_stream *sink,
 			  uint32_t frames);
 };
@@ -366,6 +367,38 @@ static int tonegen_init(struct tone_state *sg, int32_t fs, int32_t f, int32_t a)
  * End of algorithm code. Next the standard component methods.
  */
 
+/* Grow the tone state to channels, the existing channels are kept */
+static int tone_alloc_channels(struct comp_dev *dev, uint32_t channels)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct tone_state *sg;
+	int i;
+
+	if (channels <= cd->max_channels)
+		return 0;
+
+	sg = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		     channels * sizeof(*sg));
+	if (!sg) {
+		comp_err(dev, "tone_alloc_channels() error: no memory for %u channels",
+			 channels);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < channels; i++) {
+		if (i < cd->max_channels)
+			sg[i] = cd->sg[i];
+		else
+			tonegen_reset(&sg[i]);
+	}
+
+	rfree(cd->sg);
+	cd->sg = sg;
+	cd->max_channels = channels;
+
+	return 0;
+}
+
 static struct comp_dev *tone_new(const struct comp_driver *drv,
 				 struct sof_ipc_comp *comp)
 {
@@ -373,7 +406,6 @@ static struct comp_dev *tone_new(const struct comp_driver *drv,
 	struct sof_ipc_comp_tone *tone;
 	struct sof_ipc_comp_tone *ipc_tone = (struct sof_ipc_comp_tone *)comp;
 	struct comp_data *cd;
-	int i;
 	int ret;
 
 	comp_cl_info(&comp_tone, "tone_new()");
@@ -400,9 +432,14 @@ static struct comp_dev *tone_new(const struct comp_driver *drv,
 
 	cd->rate = ipc_tone->sample_rate;
 
-	/* Reset tone generator and set channels volumes to default */
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
-		tonegen_reset(&cd->sg[i]);
+	/* Reset tone generator for the channels of the controls, streams
+	 * with more channels get more in prepare().
+	 */
+	if (tone_alloc_channels(dev, SOF_IPC_MAX_CHANNELS) < 0) {
+		rfree(cd);
+		rfree(dev);
+		return NULL;
+	}
 
 	dev->state = COMP_STATE_READY;
 	return dev;
@@ -410,11 +447,12 @@ static struct comp_dev *tone_new(const struct comp_driver *drv,
 
 static void tone_free(struct comp_dev *dev)
 {
-	struct tone_data *td = comp_get_drvdata(dev);
+	struct comp_data *cd = comp_get_drvdata(dev);
 
 	comp_info(dev, "tone_free()");
 
-	rfree(td);
+	rfree(cd->sg);
+	rfree(cd);
 	rfree(dev);
 }
 
@@ -459,7 +497,7 @@ static int tone_cmd_get_value(struct comp_dev *dev,
 	comp_info(dev, "tone_cmd_get_value()");
 
 	if (cdata->cmd == SOF_CTRL_CMD_SWITCH) {
-		for (j = 0; j < cdata->num_elems; j++) {
+		for (j = 0; j < MIN(cdata->num_elems, cd->max_channels); j++) {
 			cdata->chanv[j].channel = j;
 			cdata->chanv[j].value = !cd->sg[j].mute;
 			comp_info(dev, "tone_cmd_get_value(), j = %u, cd->sg[j].mute = %u",
@@ -484,8 +522,9 @@ static int tone_cmd_set_value(struct comp_dev *dev,
 			val = cdata->chanv[j].value;
 			comp_info(dev, "tone_cmd_set_value(), SOF_CTRL_CMD_SWITCH, ch = %u, val = %u",
 				  ch, val);
-			if (ch >= PLATFORM_MAX_CHANNELS) {
-				comp_err(dev, "tone_cmd_set_value() error: ch >= PLATFORM_MAX_CHANNELS");
+			if (ch >= cd->max_channels) {
+				comp_err(dev, "tone_cmd_set_value() error: ch = %u, max_channels = %u",
+					 ch, cd->max_channels);
 				return -EINVAL;
 			}
 
@@ -524,6 +563,11 @@ static int tone_cmd_set_data(struct comp_dev *dev,
 			val = compv[i].svalue;
 			comp_info(dev, "tone_cmd_set_data(), SOF_CTRL_CMD_ENUM, ch = %u, val = %u",
 				  ch, val);
+			if (ch >= cd->max_channels) {
+				comp_err(dev, "tone_cmd_set_data() error: ch = %u, max_channels = %u",
+					 ch, cd->max_channels);
+				return -EINVAL;
+			}
 			switch (cdata->index) {
 			case SOF_TONE_IDX_FREQUENCY:
 				comp_info(dev, "tone_cmd_set_data(), SOF_TONE_IDX_FREQUENCY");
@@ -655,6 +699,12 @@ static int tone_prepare(struct comp_dev *dev)
 	comp_info(dev, "tone_prepare(), cd->channels = %u, cd->rate = %u",
 		  cd->channels, cd->rate);
 
+	ret = tone_alloc_channels(dev, cd->channels);
+	if (ret < 0) {
+		comp_set_state(dev, COMP_TRIGGER_RESET);
+		return ret;
+	}
+
 	for (i = 0; i < cd->channels; i++) {
 		f = tonegen_get_f(&cd->sg[i]);
 		a = tonegen_get_a(&cd->sg[i]);
@@ -676,7 +726,7 @@ static int tone_reset(struct comp_dev *dev)
 	comp_info(dev, "tone_reset()");
 
 	/* Initialize with the defaults */
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+	for (i = 0; i < cd->max_channels; i++)
 		tonegen_reset(&cd->sg[i]);
 
 	comp_set_state(dev, COMP_TRIGGER_RESET);
@@ -20,6 +20,7 @@
 #include <sof/audio/volume.h>
 #include <sof/common.h>
 #include <sof/debug/panic.h>
+#include <sof/drivers/interrupt.h>
 #include <sof/drivers/ipc.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cpu.h>
@@ -69,6 +70,99 @@ static void vol_sync_host(struct comp_dev *dev, unsigned int num_channels)
 	}
 }
 
+/**
+ * \brief Allocates per channel volume state.
+ * \param[in,out] dev Volume base component device.
+ * \param[in] channels Number of channels.
+ * \return Error code.
+ *
+ * The state of the existing channels is kept and the added channels get
+ * the initial volume. The state is not shrunk so that the control values
+ * the host has set for all channels are kept.
+ */
+static int vol_alloc_channels(struct comp_dev *dev, unsigned int channels)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	unsigned int old = cd->max_channels;
+	int32_t *mem;
+	bool *muted;
+	uint32_t flags;
+	int32_t vol;
+	int i;
+
+	if (channels <= old)
+		return 0;
+
+	mem = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		      channels * (4 * sizeof(int32_t) + sizeof(bool)));
+	if (!mem) {
+		comp_err(dev, "vol_alloc_channels() error: no memory for %u channels",
+			 channels);
+		return -ENOMEM;
+	}
+
+	muted = (bool *)(mem + 4 * channels);
+	vol = MAX(MIN(cd->vol_max, VOL_ZERO_DB), cd->vol_min);
+	for (i = 0; i < channels; i++) {
+		if (i < old) {
+			mem[i] = cd->volume[i];
+			mem[channels + i] = cd->tvolume[i];
+			mem[2 * channels + i] = cd->mvolume[i];
+			mem[3 * channels + i] = cd->ramp_increment[i];
+			muted[i] = cd->muted[i];
+		} else {
+			mem[i] = vol;
+			mem[channels + i] = vol;
+			mem[2 * channels + i] = vol;
+		}
+	}
+
+	/* the ramp work may run meanwhile */
+	irq_local_disable(flags);
+	rfree(cd->volume);
+	cd->volume = mem;
+	cd->tvolume = mem + channels;
+	cd->mvolume = mem + 2 * channels;
+	cd->ramp_increment = mem + 3 * channels;
+	cd->muted = muted;
+	cd->max_channels = channels;
+	irq_local_enable(flags);
+
+	return 0;
+}
+
+/**
+ * \brief Updates identity state of volume component.
+ * \param[in,out] dev Volume base component device.
+ *
+ * Unity gain on all channels without an ongoing ramp leaves the samples
+ * unchanged so the pipeline can bypass copy(). S24_4LE is excluded since
+ * the processing sign extends the samples in the 32 bit container.
+ */
+static void vol_update_identity(struct comp_dev *dev)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	struct comp_buffer *sinkb;
+	int i;
+
+	dev->identity = false;
+
+	if (cd->vol_ramp_active || !cd->ramp_started)
+		return;
+
+	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
+				source_list);
+	if (sinkb->stream.frame_fmt == SOF_IPC_FRAME_S24_4LE)
+		return;
+
+	for (i = 0; i < cd->channels; i++)
+		if (cd->volume[i] != VOL_ZERO_DB ||
+		    cd->tvolume[i] != VOL_ZERO_DB)
+			return;
+
+	dev->identity = true;
+}
+
 /**
  * \brief Ramps volume changes over time.
  * \param[in,out] data Volume base component device.
@@ -85,10 +179,10 @@ static enum task_state vol_work(void *data)
 
 	/* No need to ramp in idle state, jump volume to request. */
 	if (dev->state == COMP_STATE_READY) {
-		for (i = 0; i < PLATFORM_MAX_CHANNELS; i++)
+		for (i = 0; i < cd->max_channels; i++)
 			cd->volume[i] = cd->tvolume[i];
 
-		vol_sync_host(dev, PLATFORM_MAX_CHANNELS);
+		vol_sync_host(dev, cd->max_channels);
 		return SOF_TASK_STATE_COMPLETED;
 	}
 
@@ -148,6 +242,7 @@ static enum task_state vol_work(void *data)
 		return SOF_TASK_STATE_RESCHEDULE;
 
 	cd->vol_ramp_active = 0;
+	vol_update_identity(dev);
 	return SOF_TASK_STATE_COMPLETED;
 }
 
@@ -195,7 +290,6 @@ static struct comp_dev *volume_new(const struct comp_driver *drv,
 	struct sof_ipc_comp_volume *ipc_vol =
 		(struct sof_ipc_comp_volume *)comp;
 	struct comp_data *cd;
-	int i;
 	int ret;
 
 	comp_cl_info(&comp_volume, "volume_new()");
@@ -254,12 +348,13 @@ static struct comp_dev *volume_new(const struct comp_driver *drv,
 		cd->vol_ramp_range = 0;
 	}
 
-	for (i = 0; i < PLATFORM_MAX_CHANNELS; i++) {
-		cd->volume[i]  =  MAX(MIN(cd->vol_max, VOL_ZERO_DB),
-				      cd->vol_min);
-		cd->tvolume[i] = cd->volume[i];
-		cd->mvolume[i] = cd->volume[i];
-		cd->muted[i] = false;
+	/* State for the channels of the controls, streams with more
+	 * channels get more in prepare().
+	 */
+	if (vol_alloc_channels(dev, SOF_IPC_MAX_CHANNELS) < 0) {
+		rfree(cd);
+		rfree(dev);
+		return NULL;
 	}
 
 	cd->vol_ramp_active = false;
@@ -289,6 +384,7 @@ static void volume_free(struct comp_dev *dev)
 		rfree(cd->volwork);
 	}
 
+	rfree(cd->volume);
 	rfree(cd);
 	rfree(dev);
 }
@@ -479,11 +575,14 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 	int ret = 0;
 
 	/* validate */
-	if (cdata->num_elems == 0 || cdata->num_elems > SOF_IPC_MAX_CHANNELS) {
+	if (cdata->num_elems == 0 || cdata->num_elems > cd->max_channels) {
 		comp_err(dev, "volume_ctrl_set_cmd() error: invalid cdata->num_elems");
 		return -EINVAL;
 	}
 
+	/* process again until the ramp task has reached the targets */
+	dev->identity = false;
+
 	switch (cdata->cmd) {
 	case SOF_CTRL_CMD_VOLUME:
 		comp_info(dev, "volume_ctrl_set_cmd(), SOF_CTRL_CMD_VOLUME, cdata->comp_id = %u",
@@ -493,7 +592,7 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 			val = cdata->chanv[j].value;
 			comp_info(dev, "volume_ctrl_set_cmd(), channel = %d, value = %u",
 				  ch, val);
-			if (ch < 0 || ch >= SOF_IPC_MAX_CHANNELS) {
+			if (ch < 0 || ch >= cd->max_channels) {
 				comp_err(dev, "volume_ctrl_set_cmd(), illegal channel = %d",
 					 ch);
 				return -EINVAL;
@@ -526,7 +625,7 @@ static int volume_ctrl_set_cmd(struct comp_dev *dev,
 			val = cdata->chanv[j].value;
 			comp_info(dev, "volume_ctrl_set_cmd(), channel = %d, value = %u",
 				  ch, val);
-			if (ch < 0 || ch >= SOF_IPC_MAX_CHANNELS) {
+			if (ch < 0 || ch >= cd->max_channels) {
 				comp_err(dev, "volume_ctrl_set_cmd(), illegal channel = %d",
 					 ch);
 				return -EINVAL;
@@ -569,7 +668,7 @@ static int volume_ctrl_get_cmd(struct comp_dev *dev,
 	int j;
 
 	/* validate */
-	if (cdata->num_elems == 0 || cdata->num_elems > SOF_IPC_MAX_CHANNELS) {
+	if (cdata->num_elems == 0 || cdata->num_elems > cd->max_channels) {
 		comp_err(dev, "volume_ctrl_get_cmd() error: invalid cdata->num_elems %u",
 			 cdata->num_elems);
 		return -EINVAL;
@@ -716,7 +815,11 @@ static int volume_prepare(struct comp_dev *dev)
 		goto err;
 	}
 
-	vol_sync_host(dev, PLATFORM_MAX_CHANNELS);
+	ret = vol_alloc_channels(dev, sinkb->stream.channels);
+	if (ret < 0)
+		goto err;
+
+	vol_sync_host(dev, cd->max_channels);
 
 	/* Set current volume to min to ensure ramp starts from minimum
 	 * to previous volume request. Copy() checks for ramp started
@@ -725,6 +828,7 @@ static int volume_prepare(struct comp_dev *dev)
 	 * for entire topology specified time.
 	 */
 	cd->ramp_started = false;
+	dev->identity = false;
 	cd->channels = sinkb->stream.channels;
 	for (i = 0; i < cd->channels; i++) {
 		cd->volume[i] = cd->vol_min;
@@ -751,6 +855,7 @@ static int volume_reset(struct comp_dev *dev)
 {
 	comp_info(dev, "volume_reset()");
 
+	dev->identity = false;
 	comp_set_state(dev, COMP_TRIGGER_RESET);
 	return 0;
 }
@@ -758,6 +863,7 @@ static int volume_reset(struct comp_dev *dev)
 /** \brief Volume component definition. */
 static const struct comp_driver comp_volume = {
 	.type	= SOF_COMP_VOLUME,
+	.flags	= COMP_DRV_INPLACE,
 	.ops	= {
 		.new		= volume_new,
 		.free		= volume_free,
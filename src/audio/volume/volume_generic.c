@@ -26,6 +26,24 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * \brief Returns the number of whole frames before source or sink wraps.
+ * \param[in] sink Destination buffer.
+ * \param[in] source Source buffer.
+ * \param[in] dest Current sink sample.
+ * \param[in] src Current source sample.
+ * \param[in] frame_bytes Size of a frame in bytes.
+ */
+static inline uint32_t vol_frames_to_wrap(const struct audio_stream *sink,
+					  const struct audio_stream *source,
+					  const void *dest, const void *src,
+					  uint32_t frame_bytes)
+{
+	return MIN((uint32_t)((char *)source->end_addr - (char *)src),
+		   (uint32_t)((char *)sink->end_addr - (char *)dest)) /
+	       frame_bytes;
+}
+
 #if CONFIG_FORMAT_S24LE
 /**
  * \brief Volume s24 to s24 multiply function
@@ -73,9 +91,69 @@ static void vol_s24_to_s24(struct comp_dev *dev, struct audio_stream *sink,
 		}
 	}
 }
+
+/**
+ * \brief Stereo volume processing from 24/32 bit to 24/32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Processes the frames between buffer wraps with the gains of both
+ * channels held in registers.
+ */
+static void vol_s24_to_s24_2ch(struct comp_dev *dev, struct audio_stream *sink,
+			       const struct audio_stream *source,
+			       uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol0 = cd->volume[0];
+	int32_t vol1 = cd->volume[1];
+	int32_t *src = source->r_ptr;
+	int32_t *dest = sink->w_ptr;
+	uint32_t n;
+	uint32_t i;
+
+	while (frames) {
+		n = vol_frames_to_wrap(sink, source, dest, src,
+				       2 * sizeof(int32_t));
+		n = MIN(n, frames);
+
+		if (n) {
+			for (i = 0; i < n; i++) {
+				dest[0] = vol_mult_s24_to_s24(src[0], vol0);
+				dest[1] = vol_mult_s24_to_s24(src[1], vol1);
+				src += 2;
+				dest += 2;
+			}
+		} else {
+			/* the frame straddles the end of a buffer */
+			*dest = vol_mult_s24_to_s24(*src, vol0);
+			src = audio_stream_wrap(source, src + 1);
+			dest = audio_stream_wrap(sink, dest + 1);
+			*dest++ = vol_mult_s24_to_s24(*src++, vol1);
+			n = 1;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dest = audio_stream_wrap(sink, dest);
+		frames -= n;
+	}
+}
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
+/**
+ * \brief Volume s32 to s32 multiply function
+ * \param[in] x   input sample.
+ * \param[in] vol gain.
+ * \return output sample.
+ */
+static inline int32_t vol_mult_s32_to_s32(int32_t x, int32_t vol)
+{
+	return q_multsr_sat_32x32(x, vol, Q_SHIFT_BITS_64(31, 16, 31));
+}
+
 /**
  * \brief Volume processing from 32 bit to 32 bit.
  * \param[in,out] dev Volume base component device.
@@ -102,17 +180,75 @@ static void vol_s32_to_s32(struct comp_dev *dev, struct audio_stream *sink,
 			src = audio_stream_read_frag_s32(source, buff_frag);
 			dest = audio_stream_write_frag_s32(sink, buff_frag);
 
-			*dest = q_multsr_sat_32x32
-				(*src, cd->volume[channel],
-				 Q_SHIFT_BITS_64(31, 16, 31));
+			*dest = vol_mult_s32_to_s32(*src, cd->volume[channel]);
 
 			buff_frag++;
 		}
 	}
 }
+
+/**
+ * \brief Stereo volume processing from 32 bit to 32 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Processes the frames between buffer wraps with the gains of both
+ * channels held in registers.
+ */
+static void vol_s32_to_s32_2ch(struct comp_dev *dev, struct audio_stream *sink,
+			       const struct audio_stream *source,
+			       uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol0 = cd->volume[0];
+	int32_t vol1 = cd->volume[1];
+	int32_t *src = source->r_ptr;
+	int32_t *dest = sink->w_ptr;
+	uint32_t n;
+	uint32_t i;
+
+	while (frames) {
+		n = vol_frames_to_wrap(sink, source, dest, src,
+				       2 * sizeof(int32_t));
+		n = MIN(n, frames);
+
+		if (n) {
+			for (i = 0; i < n; i++) {
+				dest[0] = vol_mult_s32_to_s32(src[0], vol0);
+				dest[1] = vol_mult_s32_to_s32(src[1], vol1);
+				src += 2;
+				dest += 2;
+			}
+		} else {
+			/* the frame straddles the end of a buffer */
+			*dest = vol_mult_s32_to_s32(*src, vol0);
+			src = audio_stream_wrap(source, src + 1);
+			dest = audio_stream_wrap(sink, dest + 1);
+			*dest++ = vol_mult_s32_to_s32(*src++, vol1);
+			n = 1;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dest = audio_stream_wrap(sink, dest);
+		frames -= n;
+	}
+}
 #endif /* CONFIG_FORMAT_S32LE */
 
 #if CONFIG_FORMAT_S16LE
+/**
+ * \brief Volume s16 to s16 multiply function
+ * \param[in] x   input sample.
+ * \param[in] vol gain.
+ * \return output sample.
+ */
+static inline int16_t vol_mult_s16_to_s16(int16_t x, int32_t vol)
+{
+	return q_multsr_sat_32x32_16(x, vol, Q_SHIFT_BITS_32(15, 16, 15));
+}
+
 /**
  * \brief Volume processing from 16 bit to 16 bit.
  * \param[in,out] dev Volume base component device.
@@ -139,25 +275,76 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 			src = audio_stream_read_frag_s16(source, buff_frag);
 			dest = audio_stream_write_frag_s16(sink, buff_frag);
 
-			*dest = q_multsr_sat_32x32_16
-				(*src, cd->volume[channel],
-				 Q_SHIFT_BITS_32(15, 16, 15));
+			*dest = vol_mult_s16_to_s16(*src, cd->volume[channel]);
 
 			buff_frag++;
 		}
 	}
 }
+
+/**
+ * \brief Stereo volume processing from 16 bit to 16 bit.
+ * \param[in,out] dev Volume base component device.
+ * \param[in,out] sink Destination buffer.
+ * \param[in,out] source Source buffer.
+ * \param[in] frames Number of frames to process.
+ *
+ * Processes the frames between buffer wraps with the gains of both
+ * channels held in registers.
+ */
+static void vol_s16_to_s16_2ch(struct comp_dev *dev, struct audio_stream *sink,
+			       const struct audio_stream *source,
+			       uint32_t frames)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	int32_t vol0 = cd->volume[0];
+	int32_t vol1 = cd->volume[1];
+	int16_t *src = source->r_ptr;
+	int16_t *dest = sink->w_ptr;
+	uint32_t n;
+	uint32_t i;
+
+	while (frames) {
+		n = vol_frames_to_wrap(sink, source, dest, src,
+				       2 * sizeof(int16_t));
+		n = MIN(n, frames);
+
+		if (n) {
+			for (i = 0; i < n; i++) {
+				dest[0] = vol_mult_s16_to_s16(src[0], vol0);
+				dest[1] = vol_mult_s16_to_s16(src[1], vol1);
+				src += 2;
+				dest += 2;
+			}
+		} else {
+			/* the frame straddles the end of a buffer */
+			*dest = vol_mult_s16_to_s16(*src, vol0);
+			src = audio_stream_wrap(source, src + 1);
+			dest = audio_stream_wrap(sink, dest + 1);
+			*dest++ = vol_mult_s16_to_s16(*src++, vol1);
+			n = 1;
+		}
+
+		src = audio_stream_wrap(source, src);
+		dest = audio_stream_wrap(sink, dest);
+		frames -= n;
+	}
+}
 #endif /* CONFIG_FORMAT_S16LE */
 
+/* specialized kernels first, 0 channels matches any channel count */
 const struct comp_func_map func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16 },
+	{ SOF_IPC_FRAME_S16_LE, 2, vol_s16_to_s16_2ch },
+	{ SOF_IPC_FRAME_S16_LE, 0, vol_s16_to_s16 },
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24 },
+	{ SOF_IPC_FRAME_S24_4LE, 2, vol_s24_to_s24_2ch },
+	{ SOF_IPC_FRAME_S24_4LE, 0, vol_s24_to_s24 },
 #endif /* CONFIG_FORMAT_S24LE */
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s32 },
+	{ SOF_IPC_FRAME_S32_LE, 2, vol_s32_to_s32_2ch },
+	{ SOF_IPC_FRAME_S32_LE, 0, vol_s32_to_s32 },
 #endif /* CONFIG_FORMAT_S32LE */
 };
 
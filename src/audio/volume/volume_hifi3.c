@@ -210,13 +210,13 @@ static void vol_s16_to_s16(struct comp_dev *dev, struct audio_stream *sink,
 
 const struct comp_func_map func_map[] = {
 #if CONFIG_FORMAT_S16LE
-	{ SOF_IPC_FRAME_S16_LE, vol_s16_to_s16 },
+	{ SOF_IPC_FRAME_S16_LE, 0, vol_s16_to_s16 },
 #endif
 #if CONFIG_FORMAT_S24LE
-	{ SOF_IPC_FRAME_S24_4LE, vol_s24_to_s24_s32 },
+	{ SOF_IPC_FRAME_S24_4LE, 0, vol_s24_to_s24_s32 },
 #endif
 #if CONFIG_FORMAT_S32LE
-	{ SOF_IPC_FRAME_S32_LE, vol_s32_to_s24_s32 },
+	{ SOF_IPC_FRAME_S32_LE, 0, vol_s32_to_s24_s32 },
 #endif
 };
 
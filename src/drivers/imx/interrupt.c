@@ -244,45 +244,21 @@ static int get_first_irq(uint64_t ints)
 static inline void handle_irq_batch(struct irq_cascade_desc *cascade,
 				    uint32_t line_index, uint64_t status)
 {
-	int core = cpu_get_id();
-	struct list_item *clist;
-	struct irq_desc *child = NULL;
+	uint64_t unhandled;
 	int bit;
-	bool handled;
 
-	while (status) {
-		bit = get_first_irq(status);
-		handled = false;
-		status &= ~(1ull << bit); /* Release interrupt */
-
-		spin_lock(&cascade->lock);
-
-		/* Get child if any and run handler */
-		list_for_item(clist, &cascade->child[bit].list) {
-			child = container_of(clist, struct irq_desc, irq_list);
+	/* Get children if any and run handlers, one status word at a time */
+	unhandled = interrupt_cascade_dispatch(cascade, 0, (uint32_t)status);
+	unhandled |= (uint64_t)interrupt_cascade_dispatch(cascade, 1,
+							  status >> 32) << 32;
 
-			if (child->handler && (child->cpu_mask & 1 << core)) {
-				/* run handler in non atomic context */
-				spin_unlock(&cascade->lock);
-				child->handler(child->handler_arg);
-				spin_lock(&cascade->lock);
+	while (unhandled) {
+		bit = get_first_irq(unhandled);
+		unhandled &= ~(1ull << bit);
 
-				handled = true;
-			}
-
-			platform_shared_commit(child, sizeof(*child));
-		}
-
-		platform_shared_commit(cascade, sizeof(*cascade));
-
-		spin_unlock(&cascade->lock);
-
-		if (!handled) {
-			trace_irq_error("irq_handler(): nobody cared, bit %d",
-					bit);
-			/* Mask this interrupt so it won't happen again */
-			irqstr_mask_int(line_index * IRQSTR_IRQS_PER_LINE + bit);
-		}
+		trace_irq_error("irq_handler(): nobody cared, bit %d", bit);
+		/* Mask this interrupt so it won't happen again */
+		irqstr_mask_int(line_index * IRQSTR_IRQS_PER_LINE + bit);
 	}
 }
 
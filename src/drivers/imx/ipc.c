@@ -132,7 +132,7 @@ void ipc_platform_send_msg(void)
 	/* now interrupt host to tell it we have sent a message */
 	imx_mu_xcr_rmw(IMX_MU_xCR_GIRn(1), 0);
 
-	list_item_append(&msg->list, &ipc->empty_list);
+	ipc_msg_sent(ipc, msg);
 
 	platform_shared_commit(msg, sizeof(*msg));
 
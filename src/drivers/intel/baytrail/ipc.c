@@ -121,7 +121,7 @@ void ipc_platform_send_msg(void)
 	shim_write(SHIM_IPCDL, msg->header);
 	shim_write(SHIM_IPCDH, SHIM_IPCDH_BUSY);
 
-	list_item_append(&msg->list, &ipc->empty_list);
+	ipc_msg_sent(ipc, msg);
 
 	platform_shared_commit(msg, sizeof(*msg));
 
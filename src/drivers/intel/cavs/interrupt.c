@@ -50,11 +50,10 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 	struct irq_desc *parent = data;
 	struct irq_cascade_desc *cascade = container_of(parent,
 						struct irq_cascade_desc, desc);
-	struct irq_desc *child = NULL;
-	int core = cpu_get_id();
-	struct list_item *clist;
 	uint32_t status;
+	uint32_t unhandled;
 	uint32_t tries = LVL2_MAX_TRIES;
+	unsigned int bit;
 
 	platform_shared_commit(parent, sizeof(*parent));
 
@@ -63,36 +62,14 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 	if (!status)
 		return;
 
-	/* handle each child */
 	for (;;) {
-		unsigned int bit = ffs(status) - 1;
-		bool handled = false;
-
-		status &= ~(1 << bit);
-
-		spin_lock(&cascade->lock);
-
-		/* get child if any and run handler */
-		list_for_item(clist, &cascade->child[bit].list) {
-			child = container_of(clist, struct irq_desc, irq_list);
-
-			if (child->handler && (child->cpu_mask & 1 << core)) {
-				/* run handler in non atomic context */
-				spin_unlock(&cascade->lock);
-				child->handler(child->handler_arg);
-				spin_lock(&cascade->lock);
+		/* handle each child */
+		unhandled = interrupt_cascade_dispatch(cascade, 0, status);
 
-				handled = true;
-			}
+		while (unhandled) {
+			bit = ffs(unhandled) - 1;
+			unhandled &= ~(1 << bit);
 
-			platform_shared_commit(child, sizeof(*child));
-		}
-
-		platform_shared_commit(cascade, sizeof(*cascade));
-
-		spin_unlock(&cascade->lock);
-
-		if (!handled) {
 			/* nobody cared ? */
 			trace_irq_error("irq_lvl2_handler() error: "
 					"nobody cared level %d bit %d",
@@ -101,11 +78,9 @@ static inline void irq_lvl2_handler(void *data, int level, uint32_t ilxsd,
 			irq_write(ilxmsd, 0x1 << bit);
 		}
 
-		/* are all IRQs serviced from last status ? */
-		if (status)
-			continue;
-
-		/* yes, so reload the new status and service again */
+		/* all IRQs serviced from last status, reload the new status
+		 * and service again
+		 */
 		status = irq_read(ilxsd);
 		if (!status)
 			break;
@@ -276,7 +276,7 @@ void ipc_platform_send_msg(void)
 	ipc_write(IPC_DIPCIDR, 0x80000000 | msg->header);
 #endif
 
-	list_item_append(&msg->list, &ipc->empty_list);
+	ipc_msg_sent(ipc, msg);
 
 	platform_shared_commit(msg, sizeof(*msg));
 
@@ -72,7 +72,7 @@ void ipc_platform_send_msg(void)
 
 	/* now interrupt host to tell it we have message sent */
 
-	list_item_append(&msg->list, &ipc->empty_list);
+	ipc_msg_sent(ipc, msg);
 
 out:
 	platform_shared_commit(ipc, sizeof(*ipc));
@@ -122,7 +122,7 @@ void ipc_platform_send_msg(void)
 	/* now interrupt host to tell it we have message sent */
 	shim_write(SHIM_IPCD, SHIM_IPCD_BUSY);
 
-	list_item_append(&msg->list, &ipc->empty_list);
+	ipc_msg_sent(ipc, msg);
 
 	platform_shared_commit(msg, sizeof(*msg));
 
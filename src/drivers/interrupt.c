@@ -6,7 +6,9 @@
 //         Liam Girdwood <liam.r.girdwood@linux.intel.com>
 
 #include <sof/common.h>
+#include <sof/debug/hist.h>
 #include <sof/drivers/interrupt.h>
+#include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/memory.h>
@@ -15,9 +17,11 @@
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <ipc/topology.h>
+#include <ipc/trace.h>
 #include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 static SHARED_DATA struct cascade_root cascade_root;
 
@@ -158,6 +162,51 @@ void interrupt_init(struct sof *sof)
 	spinlock_init(&sof->cascade_root->lock);
 }
 
+/*
+ * Updates the dispatch state of a child interrupt: the per core bitmaps of
+ * children with an enabled handler, the bitmap of children shared by more
+ * than one descriptor and the only descriptor of the others. Called with
+ * the cascade lock held whenever descriptors or their CPU masks change.
+ */
+static void irq_child_update(struct irq_cascade_desc *cascade, int hw_irq)
+{
+	struct irq_child *child = cascade->child + hw_irq;
+	unsigned int word = hw_irq / 32;
+	uint32_t bit = 1u << (hw_irq % 32);
+	uint32_t cpu_mask = 0;
+	unsigned int count = 0;
+	struct list_item *list;
+	struct irq_desc *d;
+	int core;
+
+	child->single = NULL;
+
+	list_for_item(list, &child->list) {
+		d = container_of(list, struct irq_desc, irq_list);
+
+		if (d->handler)
+			cpu_mask |= d->cpu_mask;
+		child->single = d;
+		count++;
+
+		platform_shared_commit(d, sizeof(*d));
+	}
+
+	if (count > 1) {
+		child->single = NULL;
+		cascade->shared[word] |= bit;
+	} else {
+		cascade->shared[word] &= ~bit;
+	}
+
+	for (core = 0; core < PLATFORM_CORE_COUNT; core++) {
+		if (cpu_mask & (1 << core))
+			cascade->enabled[core][word] |= bit;
+		else
+			cascade->enabled[core][word] &= ~bit;
+	}
+}
+
 static int irq_register_child(struct irq_cascade_desc *cascade, int irq,
 			      void (*handler)(void *arg), void *arg,
 			      struct irq_desc *desc)
@@ -212,6 +261,7 @@ static int irq_register_child(struct irq_cascade_desc *cascade, int irq,
 	}
 
 	list_item_append(&child->irq_list, head);
+	irq_child_update(cascade, hw_irq);
 
 	/* do we need to register parent on this CPU? */
 	if (!cascade->num_children[core])
@@ -243,6 +293,7 @@ static void irq_unregister_child(struct irq_cascade_desc *cascade, int irq,
 
 		if (child->handler_arg == arg) {
 			list_item_del(&child->irq_list);
+			irq_child_update(cascade, hw_irq);
 			cascade->num_children[core]--;
 			if (!desc)
 				rfree(child);
@@ -299,6 +350,8 @@ static uint32_t irq_enable_child(struct irq_cascade_desc *cascade, int irq,
 		platform_shared_commit(d, sizeof(*d));
 	}
 
+	irq_child_update(cascade, hw_irq);
+
 	if (!child->enable_count[child_idx]++) {
 		/* enable the parent interrupt */
 		if (!cascade->enable_count[core]++)
@@ -344,6 +397,8 @@ static uint32_t irq_disable_child(struct irq_cascade_desc *cascade, int irq,
 		platform_shared_commit(d, sizeof(*d));
 	}
 
+	irq_child_update(cascade, hw_irq);
+
 	if (!child->enable_count[child_idx]) {
 		trace_error(TRACE_CLASS_IRQ,
 			    "error: IRQ %x unbalanced interrupt_disable()",
@@ -365,6 +420,222 @@ static uint32_t irq_disable_child(struct irq_cascade_desc *cascade, int irq,
 	return 0;
 }
 
+#if CONFIG_INTERRUPT_STATS
+static inline uint64_t irq_stats_time(void)
+{
+	return platform_timer_get(timer_get());
+}
+
+/* Checks that a handler did not unregister its descriptor */
+static bool irq_child_has(struct irq_child *line, struct irq_desc *child)
+{
+	struct list_item *list;
+
+	list_for_item(list, &line->list)
+		if (container_of(list, struct irq_desc, irq_list) == child)
+			return true;
+
+	return false;
+}
+#endif
+
+/*
+ * Runs a child handler with the cascade lock released, the lock is held
+ * again on return. With statistics enabled the handler latency from the
+ * status read and its duration are recorded for the handler and summed
+ * to *line_time, which holds the start of the first handler of the line.
+ */
+static void irq_run_handler(struct irq_cascade_desc *cascade,
+			    struct irq_child *line, struct irq_desc *child,
+			    uint64_t status_time, uint64_t *line_time)
+{
+#if CONFIG_INTERRUPT_STATS
+	uint64_t start = irq_stats_time();
+	uint64_t end;
+
+	if (!line_time[0])
+		line_time[0] = start;
+#endif
+
+	spin_unlock(&cascade->lock);
+	child->handler(child->handler_arg);
+	spin_lock(&cascade->lock);
+
+#if CONFIG_INTERRUPT_STATS
+	end = irq_stats_time();
+	line_time[1] += end - start;
+
+	if (line->single != child && !irq_child_has(line, child))
+		return;
+
+	hist_add(&child->stats.latency, start - status_time);
+	hist_add(&child->stats.duration, end - start);
+#endif
+}
+
+/*
+ * Runs the handlers of the child interrupts set in status, which is the
+ * 32 bit status word 'word' of the cascading controller. The children are
+ * resolved with the dispatch bitmaps, only children shared by several
+ * descriptors walk their list. Returns the children nobody handled on
+ * this core, to be masked by the caller.
+ */
+uint32_t interrupt_cascade_dispatch(struct irq_cascade_desc *cascade,
+				    unsigned int word, uint32_t status)
+{
+	unsigned int core = cpu_get_id();
+	struct irq_child *line;
+	struct irq_desc *child;
+	struct list_item *clist;
+	uint64_t status_time = 0;
+	uint64_t line_time[2];
+	uint32_t unhandled;
+	uint32_t mask;
+	unsigned int bit;
+	bool handled;
+
+#if CONFIG_INTERRUPT_STATS
+	status_time = irq_stats_time();
+#endif
+
+	spin_lock(&cascade->lock);
+
+	/* no handler enabled on this core */
+	unhandled = status & ~cascade->enabled[core][word];
+	status &= cascade->enabled[core][word];
+
+	while (status) {
+		bit = ffs(status) - 1;
+		mask = 1u << bit;
+		status &= ~mask;
+
+		line = cascade->child + word * 32 + bit;
+		line_time[0] = 0;
+		line_time[1] = 0;
+		handled = false;
+
+		/* handlers may have changed while the lock was released */
+		if (!(cascade->shared[word] & mask)) {
+			child = line->single;
+			if (child && child->handler &&
+			    (child->cpu_mask & (1 << core))) {
+				irq_run_handler(cascade, line, child,
+						status_time, line_time);
+				handled = true;
+			}
+		} else {
+			list_for_item(clist, &line->list) {
+				child = container_of(clist, struct irq_desc,
+						     irq_list);
+
+				if (child->handler &&
+				    (child->cpu_mask & (1 << core))) {
+					irq_run_handler(cascade, line, child,
+							status_time,
+							line_time);
+					handled = true;
+				}
+
+				platform_shared_commit(child, sizeof(*child));
+			}
+		}
+
+		if (!handled) {
+			unhandled |= mask;
+			continue;
+		}
+
+#if CONFIG_INTERRUPT_STATS
+		hist_add(&line->stats.latency, line_time[0] - status_time);
+		hist_add(&line->stats.duration, line_time[1]);
+#endif
+	}
+
+	platform_shared_commit(cascade, sizeof(*cascade));
+
+	spin_unlock(&cascade->lock);
+
+	return unhandled;
+}
+
+#if CONFIG_INTERRUPT_STATS
+/* Adds a record to the reply if it is in the requested range */
+static void irq_stats_rec(struct sof_ipc_irq_stats *stats, uint32_t max_recs,
+			  int irq, void (*handler)(void *arg),
+			  struct irq_stats *s)
+{
+	struct sof_ipc_irq_stats_rec *rec;
+
+	if (stats->total >= stats->first && stats->num_recs < max_recs) {
+		rec = &stats->rec[stats->num_recs++];
+		rec->irq = irq;
+		rec->handler = (uint32_t)(uintptr_t)handler;
+		rec->latency = s->latency;
+		rec->duration = s->duration;
+	}
+
+	stats->total++;
+
+	if (stats->flags & SOF_IPC_STATS_CLEAR)
+		memset(s, 0, sizeof(*s));
+}
+
+int interrupt_stats_info(struct sof_ipc_irq_stats *stats, uint32_t size)
+{
+	struct cascade_root *root = cascade_root_get();
+	uint32_t max_recs = (size - sizeof(*stats)) / sizeof(stats->rec[0]);
+	struct irq_cascade_desc *cascade;
+	struct irq_child *line;
+	struct list_item *list;
+	struct irq_desc *d;
+	unsigned long flags;
+	int i;
+
+	stats->num_recs = 0;
+	stats->total = 0;
+
+	/* Controllers are never removed and their list only grows, so it is
+	 * walked without the root lock, which is taken inside cascade locks.
+	 */
+	spin_lock_irq(&root->lock, flags);
+	cascade = root->list;
+	platform_shared_commit(root, sizeof(*root));
+	spin_unlock_irq(&root->lock, flags);
+
+	for (; cascade; cascade = cascade->next) {
+		spin_lock_irq(&cascade->lock, flags);
+
+		for (i = 0; i < PLATFORM_IRQ_CHILDREN; i++) {
+			line = cascade->child + i;
+			if (!line->stats.latency.count)
+				continue;
+
+			irq_stats_rec(stats, max_recs, cascade->irq_base + i,
+				      NULL, &line->stats);
+
+			list_for_item(list, &line->list) {
+				d = container_of(list, struct irq_desc,
+						 irq_list);
+				if (d->stats.latency.count)
+					irq_stats_rec(stats, max_recs, d->irq,
+						      d->handler, &d->stats);
+
+				platform_shared_commit(d, sizeof(*d));
+			}
+		}
+
+		platform_shared_commit(cascade, sizeof(*cascade));
+
+		spin_unlock_irq(&cascade->lock, flags);
+	}
+
+	stats->rhdr.hdr.size = sizeof(*stats) +
+			       stats->num_recs * sizeof(stats->rec[0]);
+
+	return 0;
+}
+#endif
+
 int interrupt_register(uint32_t irq, void (*handler)(void *arg), void *arg)
 {
 	return interrupt_register_internal(irq, handler, arg, NULL);
@@ -83,6 +83,7 @@
 #define SOF_IPC_TPLG_COMP_NEW			SOF_CMD_TYPE(0x001)
 #define SOF_IPC_TPLG_COMP_FREE			SOF_CMD_TYPE(0x002)
 #define SOF_IPC_TPLG_COMP_CONNECT		SOF_CMD_TYPE(0x003)
+#define SOF_IPC_TPLG_COMP_EDIT			SOF_CMD_TYPE(0x004)
 #define SOF_IPC_TPLG_PIPE_NEW			SOF_CMD_TYPE(0x010)
 #define SOF_IPC_TPLG_PIPE_FREE			SOF_CMD_TYPE(0x011)
 #define SOF_IPC_TPLG_PIPE_CONNECT		SOF_CMD_TYPE(0x012)
@@ -140,6 +141,9 @@
 #define SOF_IPC_STREAM_TRIG_DRAIN		SOF_CMD_TYPE(0x008)
 #define SOF_IPC_STREAM_TRIG_XRUN		SOF_CMD_TYPE(0x009)
 #define SOF_IPC_STREAM_POSITION			SOF_CMD_TYPE(0x00a)
+#define SOF_IPC_STREAM_POSITION_BATCH		SOF_CMD_TYPE(0x00b)
+#define SOF_IPC_STREAM_XRUN_STATS		SOF_CMD_TYPE(0x00c)
+#define SOF_IPC_STREAM_LATENCY			SOF_CMD_TYPE(0x00d)
 #define SOF_IPC_STREAM_VORBIS_PARAMS		SOF_CMD_TYPE(0x010)
 #define SOF_IPC_STREAM_VORBIS_FREE		SOF_CMD_TYPE(0x011)
 
@@ -152,6 +156,8 @@
 #define SOF_IPC_TRACE_DMA_PARAMS		SOF_CMD_TYPE(0x001)
 #define SOF_IPC_TRACE_DMA_POSITION		SOF_CMD_TYPE(0x002)
 #define SOF_IPC_TRACE_DMA_PARAMS_EXT		SOF_CMD_TYPE(0x003)
+#define SOF_IPC_TRACE_IRQ_STATS			SOF_CMD_TYPE(0x004)
+#define SOF_IPC_TRACE_IPC_STATS			SOF_CMD_TYPE(0x005)
 
 /** @} */
 
@@ -32,7 +32,7 @@
  * Audio format from extraction probes is encoded as 32 bit value. Following
  * graphic explains encoding.
  *
- * A|BBBB|CCCC|DDDD|EEEEE|FF|GG|H|I|J|XXXXXXX
+ * A|BBBB|CCCC|DDDD|EEEEE|FF|GG|H|I|J|K|XXXXXX
  * A - 1 bit - Specifies Type Encoding - 1 for Standard encoding
  * B - 4 bits - Specify Standard Type - 0 for Audio
  * C - 4 bits - Specify Audio format - 0 for PCM
@@ -59,6 +59,8 @@
  * H - 1 bit - Specifies Sample Format - 0 for Integer, 1 for Floating point
  * I - 1 bit - Specifies Sample Endianness - 0 for LE
  * J - 1 bit - Specifies Interleaving - 1 for Sample Interleaving
+ * K - 1 bit - Specifies Compression - 1 for delta + bit-packed payload,
+ *	       see sof/probe/compress.h
  */
 #define PROBE_SHIFT_FMT_TYPE		31
 #define PROBE_SHIFT_STANDARD_TYPE	27
@@ -70,6 +72,7 @@
 #define PROBE_SHIFT_SAMPLE_FMT		9
 #define PROBE_SHIFT_SAMPLE_END		8
 #define PROBE_SHIFT_INTERLEAVING_ST	7
+#define PROBE_SHIFT_COMPRESSED		6
 
 #define PROBE_MASK_FMT_TYPE		MASK(31, 31)
 #define PROBE_MASK_STANDARD_TYPE	MASK(30, 27)
@@ -81,6 +84,7 @@
 #define PROBE_MASK_SAMPLE_FMT		MASK(9, 9)
 #define PROBE_MASK_SAMPLE_END		MASK(8, 8)
 #define PROBE_MASK_INTERLEAVING_ST	MASK(7, 7)
+#define PROBE_MASK_COMPRESSED		MASK(6, 6)
 
 /**
  * Header for data packets sent via compressed PCM from extraction probes
@@ -153,4 +153,82 @@ struct sof_ipc_stream_posn {
 	int32_t xrun_size;	/**< XRUN size in bytes */
 } __attribute__((packed));
 
+/* stream events carried by a batched position notification */
+#define SOF_IPC_STREAM_EVENT_POSITION	(1 << 0) /**< new position */
+#define SOF_IPC_STREAM_EVENT_XRUN	(1 << 1) /**< XRUN occurred */
+
+/*
+ * Batched stream notification - SOF_IPC_STREAM_POSITION_BATCH.
+ *
+ * Lists the streams whose position slot has been updated since the last
+ * notification. The host reads struct sof_ipc_stream_posn for each of them
+ * from the stream region at the posn_offset returned on PCM params.
+ */
+struct sof_ipc_stream_posn_batch_elem {
+	uint32_t comp_id;	/**< host component ID */
+	uint32_t events;	/**< SOF_IPC_STREAM_EVENT_ */
+} __attribute__((packed));
+
+struct sof_ipc_stream_posn_batch {
+	struct sof_ipc_reply rhdr;
+	uint32_t num_elems;	/**< number of elems */
+	uint32_t reserved[3];
+	struct sof_ipc_stream_posn_batch_elem elems[];
+} __attribute__((packed));
+
+/* max streams notified by a single batched notification */
+#define SOF_IPC_STREAM_POSN_BATCH_MAX					\
+	((SOF_IPC_MSG_MAX_SIZE - sizeof(struct sof_ipc_stream_posn_batch)) / \
+	 sizeof(struct sof_ipc_stream_posn_batch_elem))
+
+/*
+ * XRUN recovery statistics - SOF_IPC_STREAM_XRUN_STATS.
+ *
+ * The host sets comp_id of the host component and flags. Light recoveries
+ * keep the stream running with silence or dropped data, full ones are
+ * notified with an XRUN and need a restart by the host. Recovery times
+ * are from the detection to the end of the next successful copy.
+ */
+
+/* clear the statistics after reading them */
+#define SOF_IPC_STREAM_XRUN_STATS_CLEAR	(1 << 0)
+
+struct sof_ipc_stream_xrun_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t comp_id;	/**< host component ID */
+	uint32_t flags;		/**< SOF_IPC_STREAM_XRUN_STATS_ */
+	uint32_t light;		/**< xruns recovered in firmware */
+	uint32_t full;		/**< xruns reported to the host */
+	uint32_t silence_bytes;	/**< silence inserted or data dropped */
+	uint32_t last_us;	/**< last light recovery time */
+	uint32_t max_us;	/**< longest light recovery time */
+	uint32_t total_us;	/**< sum of light recovery times */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+/*
+ * Graph latency - SOF_IPC_STREAM_LATENCY.
+ *
+ * The host sets comp_id of any component of the pipeline and flags. The
+ * delays are of frames from the source endpoint of that pipeline, e.g.
+ * the host for playback or the DAI for capture, until they are consumed
+ * by a sink endpoint, possibly in another pipeline.
+ */
+
+/* clear the statistics after reading them */
+#define SOF_IPC_STREAM_LATENCY_CLEAR	(1 << 0)
+
+struct sof_ipc_stream_latency {
+	struct sof_ipc_reply rhdr;
+	uint32_t comp_id;	/**< component ID */
+	uint32_t flags;		/**< SOF_IPC_STREAM_LATENCY_ */
+	uint32_t count;		/**< frames measured */
+	uint32_t lost;		/**< markers dropped by components */
+	uint32_t last_us;	/**< delay of the last frame */
+	uint32_t min_us;	/**< shortest delay */
+	uint32_t max_us;	/**< longest delay */
+	uint32_t avg_us;	/**< average delay */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
 #endif /* __IPC_STREAM_H__ */
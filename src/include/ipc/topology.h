@@ -45,6 +45,7 @@ enum sof_comp_type {
 	SOF_COMP_SELECTOR,		/**< channel selector component */
 	SOF_COMP_DEMUX,
 	SOF_COMP_ASRC,		/**< Asynchronous sample rate converter */
+	SOF_COMP_DRC,		/**< Dynamic range compressor */
 	/* keep FILEREAD/FILEWRITE as the last ones */
 	SOF_COMP_FILEREAD = 10000,	/**< host test based file IO */
 	SOF_COMP_FILEWRITE = 10001,	/**< host test based file IO */
@@ -274,4 +275,30 @@ struct sof_ipc_pipe_comp_connect {
 	uint32_t sink_id;
 } __attribute__((packed));
 
+/* live edit operations */
+#define SOF_IPC_COMP_EDIT_INSERT	0
+#define SOF_IPC_COMP_EDIT_REMOVE	1
+
+/*
+ * Insert or remove a component on a pipeline - SOF_IPC_TPLG_COMP_EDIT
+ *
+ * Insert puts a new, unconnected component between the buffer source_id
+ * and the component reading it. The component reads source_id and writes
+ * the new, unconnected buffer sink_id, which feeds the former reader.
+ * Remove takes out a component with one source and one sink buffer, its
+ * source buffer feeds the reader of its sink buffer again. The removed
+ * component and its sink buffer are left unconnected and can be freed.
+ * Both buffers must carry the same format. The reader of the buffers
+ * can't be a host or DAI endpoint, and on remove the sink buffer can't
+ * be larger than the source buffer.
+ */
+struct sof_ipc_pipe_comp_edit {
+	struct sof_ipc_cmd_hdr hdr;
+	uint32_t comp_id;
+	uint32_t source_id;	/**< insert: buffer read by the component */
+	uint32_t sink_id;	/**< insert: buffer written by the component */
+	uint32_t op;		/**< SOF_IPC_COMP_EDIT_ */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
 #endif /* __IPC_TOPOLOGY_H__ */
@@ -51,6 +51,58 @@ struct sof_ipc_dma_trace_posn {
 	uint32_t messages;	/* total trace messages */
 } __attribute__((packed));
 
+/*
+ * Latency statistics - SOF_IPC_TRACE_IRQ_STATS and SOF_IPC_TRACE_IPC_STATS
+ *
+ * Histograms have log2 bins of platform timer ticks, bin n counts the
+ * samples in [2^n, 2^(n + 1)) with bin 0 also counting 0 and the last
+ * bin all larger samples.
+ */
+
+#define SOF_IPC_HIST_BINS		16
+
+/* clear all statistics after reading them, set on the last page */
+#define SOF_IPC_STATS_CLEAR		(1 << 0)
+
+struct sof_ipc_hist {
+	uint32_t count;				/* number of samples */
+	uint32_t max;				/* largest sample */
+	uint32_t bin[SOF_IPC_HIST_BINS];
+} __attribute__((packed));
+
+struct sof_ipc_irq_stats_rec {
+	uint32_t irq;		/* virtual IRQ number */
+	uint32_t handler;	/* handler address, 0 for the IRQ line */
+	uint32_t reserved[2];
+	struct sof_ipc_hist latency;	/* status read to handler */
+	struct sof_ipc_hist duration;	/* handler run time */
+} __attribute__((packed));
+
+/* The host sets first and flags, the reply holds the records from first
+ * that fit into the message and the total number of records.
+ */
+struct sof_ipc_irq_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t first;		/* index of the first record */
+	uint32_t flags;		/* SOF_IPC_STATS_ */
+	uint32_t num_recs;	/* records in this message */
+	uint32_t total;		/* records available */
+	uint32_t reserved[2];
+	struct sof_ipc_irq_stats_rec rec[];
+} __attribute__((packed));
+
+/* The host sets glb_type, one of SOF_IPC_GLB_ or 0 for all messages, and
+ * flags. The histogram is the time from reading a message from the mailbox
+ * to writing its reply.
+ */
+struct sof_ipc_ipc_stats {
+	struct sof_ipc_reply rhdr;
+	uint32_t glb_type;	/* message type */
+	uint32_t flags;		/* SOF_IPC_STATS_ */
+	uint32_t reserved[2];
+	struct sof_ipc_hist time;	/* processing time */
+} __attribute__((packed));
+
 /*
  * Commom debug
  */
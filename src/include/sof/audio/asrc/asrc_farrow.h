@@ -98,6 +98,15 @@ enum asrc_operation_mode {
 			/*!< process_pull16() or process_pull32() */
 };
 
+/*
+ * Block processing. The processing functions consume at most
+ * ASRC_BLOCK_FRAMES input frames into the ring buffer and schedule at
+ * most ASRC_BLOCK_FRAMES output frames per block. The impulse responses
+ * of a block are evaluated ASRC_IR_BLOCK outputs at a time.
+ */
+#define ASRC_BLOCK_FRAMES	16
+#define ASRC_IR_BLOCK		4
+
 /*
  * @brief Error code
  */
@@ -173,8 +182,8 @@ struct asrc_farrow {
 	/* + filter coefficients */
 	const int32_t *polyphase_filters; /*!< Pointer to the filter */
 					  /*!< coefficients */
-	int32_t *impulse_response; /*!< Pointer to the impulse response */
-				   /*!< for generating one output sample */
+	int32_t *impulse_response; /*!< Pointer to ASRC_IR_BLOCK impulse */
+				   /*!< responses of filter_length each */
 
 	/* PROGRAM + general */
 	bool is_initialised;	/*!< Flag is set to true after */
@@ -216,8 +225,9 @@ struct asrc_farrow {
 					/*!< control loop */
 
 	/* + function pointer */
-	void (*calc_ir)(struct asrc_farrow *src_obj);	/*!< Pointer */
-	/*!< to the function which calculates the impulse response */
+	void (*calc_ir)(struct asrc_farrow *src_obj,
+			const uint32_t *time_values, int count); /*!< Pointer */
+	/*!< to the function which calculates the impulse responses */
 };
 
 /*
@@ -617,43 +627,53 @@ enum asrc_error_code asrc_set_output_format(struct comp_dev *dev,
 					    enum asrc_io_format output_format);
 
 /*
- * Write value of 16 bit input buffers to the channels of the ring buffer
+ * Write num_frames consecutive frames of the 16 bit input buffers,
+ * starting at index_input_frame, to the channels of the ring buffer
  */
 void asrc_write_to_ring_buffer16(struct asrc_farrow *src_obj,
 				 int16_t **input_buffers,
-				 int index_input_frame);
+				 int index_input_frame, int num_frames);
 
 /*
- * Write value of 32 bit input buffers to the channels of the ring buffer
+ * Write num_frames consecutive frames of the 32 bit input buffers,
+ * starting at index_input_frame, to the channels of the ring buffer
  */
 void asrc_write_to_ring_buffer32(struct asrc_farrow *src_obj,
 				 int32_t **input_buffers,
-				 int index_input_frame);
+				 int index_input_frame, int num_frames);
 
 /*
- * Filter the 32 bit ring buffer values with impulse_response
+ * Filter the 16 bit ring buffer values ending at position with the
+ * impulse response ir
  */
-void asrc_fir_filter16(struct asrc_farrow *src_obj,
-		       int16_t **output_buffers,
+void asrc_fir_filter16(struct asrc_farrow *src_obj, const int32_t *ir,
+		       int position, int16_t **output_buffers,
 		       int index_output_frame);
 
 /*
- * Filter the 32 bit ring buffer values with impulse_response
+ * Filter the 32 bit ring buffer values ending at position with the
+ * impulse response ir
  */
-void asrc_fir_filter32(struct asrc_farrow *src_obj,
-		       int32_t **output_buffers,
+void asrc_fir_filter32(struct asrc_farrow *src_obj, const int32_t *ir,
+		       int position, int32_t **output_buffers,
 		       int index_output_frame);
 
 /*
- * Calculates the impulse response. This impulse response is then
- * applied to the buffered signal, in order to generate the output.
- * There are four versions, from whom one is pointed to by the
- * ias_src_farrow struct.  This depends on the number of polyphase
- * filters given for the current conversion ratio.
+ * Calculates the impulse responses for count (at most ASRC_IR_BLOCK)
+ * time values. The impulse responses are stored one after the other
+ * to impulse_response and then applied to the buffered signal, in
+ * order to generate the outputs. There are four versions, from whom
+ * one is pointed to by the ias_src_farrow struct.  This depends on
+ * the number of polyphase filters given for the current conversion
+ * ratio.
  */
-void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj);
-void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj);
-void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj);
-void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj);
+void asrc_calc_impulse_response_n4(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count);
+void asrc_calc_impulse_response_n5(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count);
+void asrc_calc_impulse_response_n6(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count);
+void asrc_calc_impulse_response_n7(struct asrc_farrow *src_obj,
+				   const uint32_t *time_values, int count);
 
 #endif /* IAS_SRC_FARROW_H */
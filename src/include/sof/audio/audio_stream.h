@@ -198,6 +198,40 @@ static inline void audio_stream_consume(struct audio_stream *buffer,
 	buffer->free = buffer->size - buffer->avail;
 }
 
+/* called only by a comp_buffer procedures, gives back the bytes last
+ * consumed, they must still be in memory
+ */
+static inline void audio_stream_rewind(struct audio_stream *buffer,
+				       uint32_t bytes)
+{
+	char *r_ptr = (char *)buffer->r_ptr - bytes;
+
+	assert(buffer->avail + bytes <= buffer->size);
+
+	if (r_ptr < (char *)buffer->addr)
+		r_ptr += buffer->size;
+
+	buffer->r_ptr = r_ptr;
+	buffer->avail += bytes;
+	buffer->free = buffer->size - buffer->avail;
+}
+
+/* writes bytes of silence from the write pointer, the caller produces them */
+static inline void audio_stream_set_zero(struct audio_stream *buffer,
+					 uint32_t bytes)
+{
+	uint32_t head = (char *)buffer->end_addr - (char *)buffer->w_ptr;
+
+	assert(bytes <= buffer->free);
+
+	if (bytes > head) {
+		bzero(buffer->w_ptr, head);
+		bzero(buffer->addr, bytes - head);
+	} else {
+		bzero(buffer->w_ptr, bytes);
+	}
+}
+
 static inline void audio_stream_reset(struct audio_stream *buffer)
 {
 	/* reset read and write pointer to buffer bas */
@@ -234,6 +268,10 @@ static inline void audio_stream_copy(const struct audio_stream *source,
 	uint32_t bytes_copied;
 	int ret;
 
+	/* in place streams, the data is already in the sink */
+	if (src == snk)
+		return;
+
 	while (bytes) {
 		bytes_src = (char *)source->end_addr - (char *)src;
 		bytes_snk = (char *)sink->end_addr - (char *)snk;
@@ -9,6 +9,7 @@
 #define __SOF_AUDIO_BUFFER_H__
 
 #include <sof/audio/audio_stream.h>
+#include <sof/audio/latency.h>
 #include <sof/audio/pipeline.h>
 #include <sof/math/numbers.h>
 #include <sof/common.h>
@@ -73,6 +74,7 @@ struct comp_buffer {
 	uint32_t pipeline_id;
 	uint32_t caps;
 	uint32_t core;
+	uint32_t alloc_size;	/* bytes of memory at stream.addr */
 
 	/* connected components */
 	struct comp_dev *source;	/* source component */
@@ -87,6 +89,14 @@ struct comp_buffer {
 	uint16_t chmap[SOF_IPC_MAX_CHANNELS];	/**< channel map - SOF_CHMAP_ */
 
 	bool hw_params_configured; /**< indicates whether hw params were set */
+
+	/* in place chain, the first buffer owns the shared memory */
+	struct comp_buffer *alias_prev;	/**< buffer whose memory is used */
+	struct comp_buffer *alias_next;	/**< buffer using this memory */
+
+#if CONFIG_LATENCY_MARKERS
+	struct buffer_marker marker;	/**< latency marker in the stream */
+#endif
 };
 
 struct buffer_cb_transact {
@@ -134,12 +144,19 @@ struct comp_buffer *buffer_new(struct sof_ipc_buffer *desc);
 int buffer_set_size(struct comp_buffer *buffer, uint32_t size);
 void buffer_free(struct comp_buffer *buffer);
 
+/* in place processing, sink shares the memory of source */
+void buffer_alias(struct comp_buffer *source, struct comp_buffer *sink);
+int buffer_unalias(struct comp_buffer *buffer);
+
 /* called by a component after producing data into this buffer */
 void comp_update_buffer_produce(struct comp_buffer *buffer, uint32_t bytes);
 
 /* called by a component after consuming data from this buffer */
 void comp_update_buffer_consume(struct comp_buffer *buffer, uint32_t bytes);
 
+/* reads the bytes last consumed from this buffer again */
+void buffer_rewind(struct comp_buffer *buffer, uint32_t bytes);
+
 static inline void buffer_zero(struct comp_buffer *buffer)
 {
 	tracev_buffer_with_ids(buffer, "stream_zero()");
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_BUFFER_CACHE_H__
+#define __SOF_AUDIO_BUFFER_CACHE_H__
+
+#include <sof/list.h>
+#include <sof/sof.h>
+#include <sof/spinlock.h>
+#include <config.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct comp_buffer;
+
+/* buckets of 1 kB and smaller, 2 kB, 4 kB ... and 64 kB and larger */
+#define BUFFER_CACHE_BUCKETS	8
+
+/*
+ * Cache of freed buffers. Streams opened and closed often allocate the
+ * same buffers each time, a freed buffer is kept with its memory and
+ * given back by the next allocation of the same size and caps on the
+ * same core. This saves the heap walks on stream open and keeps the
+ * buffer heap from fragmenting. The buffers are bucketed by size, the
+ * cache keeps at most CONFIG_BUFFER_CACHE_SIZE bytes and gives the
+ * largest buffers back to the heap first when a buffer allocation fails.
+ */
+struct buffer_cache {
+	struct list_item buckets[BUFFER_CACHE_BUCKETS];
+	spinlock_t lock;	/* protects the buckets and the counters */
+	uint32_t count;		/* buffers in the cache */
+	uint32_t bytes;		/* memory of the buffers in the cache */
+	uint32_t peak_bytes;	/* high water mark of bytes */
+	uint32_t hits;		/* allocations served from the cache */
+	uint32_t misses;	/* allocations that went to the heap */
+	uint32_t trimmed;	/* buffers given back to the heap */
+};
+
+#if CONFIG_BUFFER_CACHE
+
+/* Returns a cached buffer with size bytes of memory aligned to align, or
+ * NULL if there is none. The buffer fields other than the memory are
+ * zeroed.
+ */
+struct comp_buffer *buffer_cache_get(uint32_t size, uint32_t caps,
+				     uint32_t align);
+
+/* Keeps a freed buffer and its memory, returns false if the caller has
+ * to free them
+ */
+bool buffer_cache_put(struct comp_buffer *buffer);
+
+/* Gives cached buffers back to the heap, largest first, until at least
+ * bytes are freed or the cache is empty. Returns the bytes freed.
+ */
+uint32_t buffer_cache_trim(uint32_t bytes);
+
+void buffer_cache_trace(void);
+
+void buffer_cache_init(struct sof *sof);
+
+#else
+
+static inline struct comp_buffer *buffer_cache_get(uint32_t size,
+						   uint32_t caps,
+						   uint32_t align)
+{
+	return NULL;
+}
+
+static inline bool buffer_cache_put(struct comp_buffer *buffer)
+{
+	return false;
+}
+
+static inline uint32_t buffer_cache_trim(uint32_t bytes) { return 0; }
+static inline void buffer_cache_trace(void) { }
+static inline void buffer_cache_init(struct sof *sof) { }
+
+#endif
+
+#endif /* __SOF_AUDIO_BUFFER_CACHE_H__ */
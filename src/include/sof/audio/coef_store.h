@@ -0,0 +1,76 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_COEF_STORE_H__
+#define __SOF_AUDIO_COEF_STORE_H__
+
+#include <sof/list.h>
+#include <sof/sof.h>
+#include <sof/spinlock.h>
+#include <stdint.h>
+
+/*
+ * Firmware wide store of coefficient blobs. Components that get the same
+ * blob, e.g. the same EQ tuning for several speakers, hold references to
+ * one copy instead of a copy each. The blobs are looked up by the crc32
+ * of the content and are read only. An update is a copy on write, the
+ * component gets a reference to the new content and puts the old one.
+ * A blob is shared by the components of one core so that it stays in
+ * cached memory.
+ *
+ * The blobs are kept in slots of a fixed capacity, in a pool per core and
+ * capacity that the components open when they are created. The pool has
+ * a slot for each blob in use and one spare slot. A new blob goes to the
+ * spare slot, so an update does not wait for the heap and does not fail
+ * while the heap is short. A new spare is then allocated, and the slots
+ * of blobs no longer in use are freed but the spare.
+ */
+struct coef_store {
+	struct list_item list;	/* list of blobs */
+	struct list_item pools;	/* list of slot pools */
+	spinlock_t lock;	/* protects the lists and the references */
+};
+
+/* Opens the pool of slots of capacity bytes for the current core, a
+ * component opens it once while it uses blobs of that capacity.
+ */
+int coef_store_open(uint32_t capacity);
+
+/* Closes the pool, the last user frees it */
+void coef_store_close(uint32_t capacity);
+
+/* Slots allocated in the pool of capacity bytes for the current core */
+int coef_store_slots(uint32_t capacity);
+
+/* Returns a reference to a blob with the content of data in a slot of
+ * capacity bytes, NULL if there is no memory for a slot.
+ */
+void *coef_store_get(const void *data, uint32_t size, uint32_t capacity);
+
+/* Reserves a slot of capacity bytes to receive a blob in parts. Returns
+ * the slot data or NULL if there is no memory for a slot.
+ */
+void *coef_store_reserve(uint32_t capacity);
+
+/* Adds the size bytes received in a reserved slot to the store. Returns
+ * a reference to the blob, the slot is freed if the content is already
+ * in the store.
+ */
+void *coef_store_commit(void *slot, uint32_t size);
+
+/* Gives back a reserved slot, NULL is ignored */
+void coef_store_release(void *slot);
+
+/* Puts a reference got with coef_store_get() or coef_store_commit(),
+ * NULL is ignored
+ */
+void coef_store_put(const void *blob);
+
+/* Number of references to blob */
+int coef_store_refs(const void *blob);
+
+void coef_store_init(struct sof *sof);
+
+#endif /* __SOF_AUDIO_COEF_STORE_H__ */
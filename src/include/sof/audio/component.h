@@ -18,6 +18,7 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/format.h>
+#include <sof/audio/latency.h>
 #include <sof/audio/pipeline.h>
 #include <sof/debug/panic.h>
 #include <sof/list.h>
@@ -142,6 +143,15 @@ struct dai_hw_params;
 #define COMP_ATTR_HOST_BUFFER	1	/**< Comp host buffer attribute */
 /** @}*/
 
+/** \name Component driver capabilities
+ *  @{
+ */
+/** Sink frames can be written over the source frames they are made from,
+ *  sink and source buffers with the same format can share memory.
+ */
+#define COMP_DRV_INPLACE	BIT(0)
+/** @}*/
+
 /** \name Trace macros
  *  @{
  */
@@ -253,6 +263,9 @@ struct comp_ops {
 	/* Get timestamp */
 	int (*dai_ts_get)(struct comp_dev *dev,
 			  struct timestamp_data *tsd);
+
+	/** resynchronize after an xrun without a restart, optional */
+	int (*xrun_recover)(struct comp_dev *dev);
 };
 
 
@@ -262,6 +275,7 @@ struct comp_ops {
  */
 struct comp_driver {
 	uint32_t type;		/**< SOF_COMP_ for driver */
+	uint32_t flags;		/**< COMP_DRV_ capabilities */
 	struct comp_ops ops;	/**< component operations */
 };
 
@@ -287,7 +301,13 @@ struct comp_dev {
 	uint64_t position;	   /**< component rendering position */
 	uint32_t frames;	   /**< number of frames we copy to sink */
 	uint32_t output_rate;      /**< 0 means all output rates are fine */
+	bool identity;		   /**< sink data equals source data, copy()
+				     *  can be bypassed by the pipeline
+				     */
 	struct pipeline *pipeline; /**< pipeline we belong to */
+#if CONFIG_LATENCY_MARKERS
+	struct comp_marker marker; /**< latency marker consumed in copy */
+#endif
 
 	uint32_t min_sink_bytes;   /**< min free sink buffer size measured in
 				     *  bytes required to run component's
@@ -622,6 +642,19 @@ static inline int comp_position(struct comp_dev *dev,
 	return 0;
 }
 
+/**
+ * Resynchronizes component after an xrun while the pipeline keeps running.
+ * @param dev Component device.
+ * @return Bytes of silence inserted or of data dropped, negative error code
+ *	   if the component needs a pipeline restart.
+ */
+static inline int comp_xrun_recover(struct comp_dev *dev)
+{
+	if (dev->drv->ops.xrun_recover)
+		return dev->drv->ops.xrun_recover(dev);
+	return -ENOTSUP;
+}
+
 /**
  * Sets component attribute.
  * @param dev Component device.
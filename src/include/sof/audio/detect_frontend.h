@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/**
+ * \file audio/detect_frontend.h
+ * \brief Keyword detection front end
+ *
+ * Streaming detection in stages of increasing cost: an energy gate tracks
+ * the noise floor once per hop and only when it is open the frame is
+ * windowed, transformed with a real FFT and reduced to log mel energies
+ * that feed a classifier loaded with the model blob.
+ */
+
+#ifndef __SOF_AUDIO_DETECT_FRONTEND_H__
+#define __SOF_AUDIO_DETECT_FRONTEND_H__
+
+#include <sof/math/fft.h>
+#include <user/detect_test.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** \brief Maximum number of mel bands. */
+#define DETECT_FE_MEL_MAX	64
+
+struct detect_frontend;
+
+/** \brief Classifier of the feature context. */
+struct detect_classifier {
+	uint32_t type;		/**< SOF_DETECT_CLASSIFIER_ type */
+
+	/** validates and maps the parameters of the model */
+	int (*init)(struct detect_frontend *fe, const void *params,
+		    uint32_t size);
+
+	/** score of the feature context in Q16.16 */
+	int32_t (*score)(const struct detect_frontend *fe);
+};
+
+/** \brief Front end state, created from a model blob. */
+struct detect_frontend {
+	const struct sof_detect_model *model;
+	const struct detect_classifier *classifier;
+	const void *params;		/**< classifier data in the model */
+	uint32_t num_inputs;		/**< context * num_mel */
+
+	/* framing */
+	int32_t *frame;			/**< last frame_length samples, Q1.31 */
+	uint32_t fill;			/**< samples in frame */
+	int16_t *window;		/**< Hann window, Q1.15 */
+
+	/* log mel energies */
+	struct fft_real_plan *fft;
+	int32_t *fft_in;		/**< windowed frame, zero padded */
+	struct icomplex32 *spectrum;	/**< fft_size / 2 + 1 bins */
+	uint8_t *mel_band;		/**< band rising over each bin */
+	int16_t *mel_weight;		/**< rising weight of each bin, Q1.15 */
+	uint64_t *mel_energy;
+	int32_t *mel_mean;		/**< running mean, Q16.16 log2 */
+
+	/* feature context ring, oldest frame at feat_pos */
+	int16_t *features;
+	uint32_t feat_pos;
+	uint32_t feat_count;
+
+	/* energy gate */
+	uint64_t hop_energy;
+	uint32_t hop_samples;
+	uint32_t noise_floor;
+	uint32_t hangover;
+
+	uint32_t hold;			/**< frames above threshold in a row */
+	int32_t score;			/**< last classifier score */
+
+	/* statistics */
+	uint32_t frames;		/**< frames seen */
+	uint32_t frames_active;		/**< frames passed by the gate */
+};
+
+struct detect_frontend *detect_fe_new(const void *model, uint32_t size);
+void detect_fe_free(struct detect_frontend *fe);
+void detect_fe_reset(struct detect_frontend *fe);
+
+/**
+ * \brief Runs the front end over a block of samples.
+ * \param[in,out] fe Front end.
+ * \param[in] samples Mono Q1.31 samples.
+ * \param[in] count Number of samples.
+ * \return True when the keyword is detected.
+ */
+bool detect_fe_process(struct detect_frontend *fe, const int32_t *samples,
+		       uint32_t count);
+
+#endif /* __SOF_AUDIO_DETECT_FRONTEND_H__ */
@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_DRC_DRC_H__
+#define __SOF_AUDIO_DRC_DRC_H__
+
+#include <sof/audio/drc/drc_config.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Frames per gain update. The gain computed from the peak of a block is
+ * ramped in linearly over the next block, so a lookahead of two blocks
+ * lets the gain settle before the peak reaches the output.
+ */
+#define DRC_BLOCK_FRAMES	16
+
+/* Linear gains of the kernels are Q5.27, max +24 dB */
+#define DRC_GAIN_QY		27
+
+/* Largest absolute value of n Q1.31 samples */
+int32_t drc_peak_32(const int32_t *x, int n);
+
+/* y[i] = x[i] * (gain + i * step), or y[i] += when add is set. Samples
+ * are Q1.31, gain and step Q5.27, the output is saturated. x and y may
+ * be the same buffer.
+ */
+void drc_gain_ramp_32(int32_t *y, const int32_t *x, int n, int32_t gain,
+		      int32_t step, bool add);
+
+#endif /* __SOF_AUDIO_DRC_DRC_H__ */
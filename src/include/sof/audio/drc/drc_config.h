@@ -0,0 +1,41 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_DRC_DRC_CONFIG_H__
+#define __SOF_AUDIO_DRC_DRC_CONFIG_H__
+
+#include <config.h>
+
+/* If next define is set to 1 the DRC is configured automatically. Setting
+ * to zero temporarily is useful is for testing needs.
+ */
+#define DRC_AUTOARCH    1
+
+/* Select optimized code variant when xt-xcc compiler is used on HiFi3 */
+#if DRC_AUTOARCH == 1
+#if defined __XCC__
+/* For xt-xcc */
+#include <xtensa/config/core-isa.h>
+#if XCHAL_HAVE_HIFI3 == 1
+/* Version for HiFi3 */
+#define DRC_HIFI3	1
+#define DRC_GENERIC	0
+#else
+/* Version for e.g. HiFi2EP */
+#define DRC_HIFI3	0
+#define DRC_GENERIC	1
+#endif
+#else
+/* For GCC */
+#define DRC_GENERIC	1
+#define DRC_HIFI3	0
+#endif /* XCC */
+#else
+/* Applied when DRC_AUTOARCH is set to zero */
+#define DRC_GENERIC	1 /* Enable generic */
+#define DRC_HIFI3	0 /* Disable HiFi3  */
+#endif /* Autoarch */
+
+#endif /* __SOF_AUDIO_DRC_DRC_CONFIG_H__ */
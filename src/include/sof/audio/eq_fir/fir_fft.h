@@ -0,0 +1,91 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_EQ_FIR_FIR_FFT_H__
+#define __SOF_AUDIO_EQ_FIR_FIR_FFT_H__
+
+#include <sof/audio/format.h>
+#include <sof/math/fft.h>
+#include <stdint.h>
+
+struct audio_stream;
+struct sof_eq_fir_coef_data;
+
+/* Longest response for the partitioned convolution */
+#define FIR_FFT_MAX_LENGTH	1024
+
+/*
+ * Uniformly partitioned overlap-save convolution. The response is split
+ * into blocks of B taps and the spectra of the blocks are multiplied with
+ * the spectra of the last input blocks kept in a frequency domain delay
+ * line. One real FFT of 2B points, one inverse and a complex multiply per
+ * partition are done per B samples, so the cost grows with the tap count
+ * divided by B instead of the tap count. The output is delayed by B
+ * samples, also for channels in bypass to keep the channels aligned.
+ */
+struct fir_fft_channel {
+	const struct icomplex32 *coef;	/* partition spectra, NULL for bypass */
+	struct icomplex32 *fdl;		/* input block spectra */
+	int32_t *in;			/* previous and current input block */
+	int32_t *out;			/* output block */
+	int partitions;			/* number of partitions */
+	int fdl_pos;			/* newest block in fdl */
+	int pos;			/* position in the current block */
+	int shift;			/* output shift of the block */
+};
+
+struct fir_fft {
+	struct fft_real_plan *plan;	/* 2B point transform */
+	int block;			/* B, partition and hop length */
+	int bins;			/* B + 1 */
+	struct icomplex32 *spectrum;	/* scratch for the output spectrum */
+	int64_t *acc;			/* scratch for the accumulation */
+	int32_t *time;			/* scratch for the inverse transform */
+	void *coef_mem;			/* shared partition spectra */
+	void *state_mem;		/* per channel state */
+	struct fir_fft_channel ch[];	/* state of the stream channels */
+};
+
+/* Creates the convolution for nch channels with responses eq[], NULL for
+ * a channel in bypass. Channels with the same response share its spectra.
+ */
+struct fir_fft *fir_fft_new(struct sof_eq_fir_coef_data **eq, int nch,
+			    int block);
+
+void fir_fft_free(struct fir_fft *fft);
+
+void fir_fft_block(struct fir_fft *fft, struct fir_fft_channel *ch);
+
+#if CONFIG_FORMAT_S16LE
+void eq_fir_fft_s16(struct fir_fft *fft, const struct audio_stream *source,
+		    struct audio_stream *sink, int frames, int nch);
+#endif /* CONFIG_FORMAT_S16LE */
+
+#if CONFIG_FORMAT_S24LE
+void eq_fir_fft_s24(struct fir_fft *fft, const struct audio_stream *source,
+		    struct audio_stream *sink, int frames, int nch);
+#endif /* CONFIG_FORMAT_S24LE */
+
+#if CONFIG_FORMAT_S32LE
+void eq_fir_fft_s32(struct fir_fft *fft, const struct audio_stream *source,
+		    struct audio_stream *sink, int frames, int nch);
+#endif /* CONFIG_FORMAT_S32LE */
+
+/* Returns the output for sample x, processes a block when it is full */
+static inline int32_t fir_fft_32(struct fir_fft *fft,
+				 struct fir_fft_channel *ch, int32_t x)
+{
+	int32_t y = ch->out[ch->pos];
+
+	ch->in[fft->block + ch->pos] = x;
+	if (++ch->pos == fft->block) {
+		fir_fft_block(fft, ch);
+		ch->pos = 0;
+	}
+
+	return y;
+}
+
+#endif /* __SOF_AUDIO_EQ_FIR_FIR_FFT_H__ */
@@ -10,13 +10,13 @@
 #ifndef __SOF_AUDIO_EQ_IIR_EQ_IIR_H__
 #define __SOF_AUDIO_EQ_IIR_EQ_IIR_H__
 
+#include <sof/audio/eq_iir/iir.h>
 #include <stdint.h>
 
 struct audio_stream;
-struct comp_dev;
 
 /** \brief Type definition for processing function select return value. */
-typedef void (*eq_iir_func)(const struct comp_dev *dev,
+typedef void (*eq_iir_func)(struct iir_state_df2t iir[],
 			    const struct audio_stream *source,
 			    struct audio_stream *sink,
 			    uint32_t frames);
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_LATENCY_H__
+#define __SOF_AUDIO_LATENCY_H__
+
+#include <config.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct comp_buffer;
+struct comp_dev;
+struct pipeline;
+
+/*
+ * Latency markers follow one frame through the graph to measure how long
+ * it stays there. A pipeline sets a marker on the first frame produced by
+ * its source endpoint, a component without source buffers, and has one
+ * marker in flight at a time. The marker moves with the buffer read
+ * pointer. When a component consumes the marked frame the marker moves
+ * to the matching frame of the data the component produced in the same
+ * copy, scaled by the produced to consumed frames ratio so that SRC and
+ * ASRC are accounted for. The algorithmic delay inside components is not
+ * included. The delay is recorded in the pipeline that set the marker
+ * when a sink endpoint, a component without sink buffers, consumes the
+ * frame. Times are in platform timer ticks.
+ */
+
+/* marked frame in a buffer */
+struct buffer_marker {
+	struct pipeline *p;	/* pipeline that set it, NULL if none */
+	uint32_t seq;		/* marker number in the pipeline */
+	uint32_t offset;	/* bytes from the read pointer to the frame */
+	uint32_t avail;		/* avail before the copy of the source comp */
+};
+
+/* marked frame consumed by a component in the current copy */
+struct comp_marker {
+	struct pipeline *p;	/* pipeline that set it, NULL if none */
+	uint32_t seq;		/* marker number in the pipeline */
+	uint32_t frame;		/* marked frame in the consumed frames */
+	uint32_t frames;	/* frames consumed */
+};
+
+struct pipeline_latency {
+	uint32_t seq;		/* number of the last marker */
+	bool in_flight;		/* marker seq is in the graph */
+	uint64_t start;		/* time the marker was set */
+	uint32_t count;		/* markers measured */
+	uint32_t lost;		/* markers dropped by components */
+	uint64_t last;
+	uint64_t min;
+	uint64_t max;
+	uint64_t total;
+};
+
+#if CONFIG_LATENCY_MARKERS
+
+/* called before the stream pointers move */
+void latency_produce(struct comp_buffer *buffer, uint32_t bytes);
+void latency_consume(struct comp_buffer *buffer, uint32_t bytes);
+
+/* called around the copy of a component by the pipeline */
+void latency_copy_begin(struct comp_dev *dev);
+void latency_copy_end(struct comp_dev *dev);
+
+/* drops the marker in flight, e.g. on prepare */
+void latency_reset(struct pipeline *p);
+
+/* clears the statistics */
+void latency_clear(struct pipeline *p);
+
+/* drops the markers of a pipeline about to be freed */
+void latency_free(struct pipeline *p);
+
+#else
+
+static inline void latency_produce(struct comp_buffer *buffer,
+				   uint32_t bytes) { }
+static inline void latency_consume(struct comp_buffer *buffer,
+				   uint32_t bytes) { }
+static inline void latency_copy_begin(struct comp_dev *dev) { }
+static inline void latency_copy_end(struct comp_dev *dev) { }
+static inline void latency_reset(struct pipeline *p) { }
+static inline void latency_clear(struct pipeline *p) { }
+static inline void latency_free(struct pipeline *p) { }
+
+#endif
+
+#endif /* __SOF_AUDIO_LATENCY_H__ */
@@ -35,20 +35,25 @@ struct comp_dev;
 STATIC_ASSERT(MUX_MAX_STREAMS < PLATFORM_MAX_STREAMS,
 	      unsupported_amount_of_streams_for_mux);
 
+/** \brief Output channels with a routing mask in the configuration. */
+#define MUX_MASK_CHANNELS PLATFORM_MAX_CHANNELS
+
+/** \brief Source channels addressable by a routing mask. */
+#define MUX_MASK_SOURCE_CHANNELS 8
+
 struct mux_stream_data {
 	uint32_t pipeline_id;
 	uint8_t num_channels;
-	uint8_t mask[PLATFORM_MAX_CHANNELS];
+	uint8_t mask[MUX_MASK_CHANNELS];
 
-	uint8_t reserved[(20 - PLATFORM_MAX_CHANNELS - 1) % 4]; // padding to ensure proper alignment of following instances
+	uint8_t reserved[(20 - MUX_MASK_CHANNELS - 1) % 4]; // padding to ensure proper alignment of following instances
 };
 
-typedef void(*demux_func)(const struct comp_dev *dev, struct audio_stream *sink,
-			  const struct audio_stream *source, uint32_t frames,
-			  struct mux_stream_data *data);
+struct mux_look_up;
+
 typedef void(*mux_func)(const struct comp_dev *dev, struct audio_stream *sink,
 			const struct audio_stream **sources, uint32_t frames,
-			struct mux_stream_data *data);
+			const struct mux_look_up *lookup);
 
 struct sof_mux_config {
 	uint16_t frame_format;
@@ -60,44 +65,61 @@ struct sof_mux_config {
 	struct mux_stream_data streams[];
 };
 
+/** \brief Source channel contributing to an output channel. */
+struct mux_route {
+	uint8_t stream;		/**< index of the source stream */
+	uint8_t channel;	/**< channel within the source frame */
+};
+
+/** \brief Processing kernels, selected from the routing at prepare. */
+enum mux_kernel {
+	MUX_KERNEL_MIX = 0,	/**< any routing, sums all routes */
+	MUX_KERNEL_COPY,	/**< at most one route per output channel */
+	MUX_KERNEL_FAN_OUT,	/**< one source channel to every output */
+	MUX_KERNEL_DOWNMIX,	/**< two routes summed per output channel */
+	MUX_KERNEL_COUNT,
+};
+
+/**
+ * \brief Routing of one output stream compiled from the masks.
+ *
+ * Routes of output channel ch are routes[first[ch]] up to, but not
+ * including, routes[first[ch + 1]]. Both point into the tables allocated
+ * for the stream channels in prepare. Output channels past the masks take
+ * the source channel of the same index.
+ */
+struct mux_look_up {
+	mux_func func;
+	enum mux_kernel kernel;
+	uint8_t num_channels;		/**< output channels */
+	uint8_t stream_mask;		/**< source streams used by routes */
+	uint8_t src_channels[MUX_MAX_STREAMS];	/**< source frame sizes */
+	uint16_t *first;
+	struct mux_route *routes;
+};
+
 struct comp_data {
-	union {
-		mux_func mux;
-		demux_func demux;
-	};
+	/* mux uses the first table, demux one table per sink stream */
+	struct mux_look_up lookup[MUX_MAX_STREAMS];
+	void *tables;	/**< route offsets and routes of all tables */
 
 	struct sof_mux_config config;
 };
 
 struct comp_func_map {
 	uint16_t frame_format;
-	mux_func mux_proc_func;
-	demux_func demux_proc_func;
+	mux_func func[MUX_KERNEL_COUNT];
 };
 
 extern const struct comp_func_map mux_func_map[];
 
-mux_func mux_get_processing_function(struct comp_dev *dev);
-demux_func demux_get_processing_function(struct comp_dev *dev);
+mux_func mux_get_processing_function(struct comp_dev *dev,
+				     enum mux_kernel kernel);
 
 #ifdef UNIT_TEST
 void sys_comp_mux_init(void);
 
-#if CONFIG_FORMAT_S16LE
-int32_t calc_sample_s16le(const struct audio_stream *source,
-			  uint8_t num_ch, uint32_t offset,
-			  uint8_t mask);
-#endif /* CONFIG_FORMAT_S16LE */
-#if CONFIG_FORMAT_S24LE
-int32_t calc_sample_s24le(const struct audio_stream *source,
-			  uint8_t num_ch, uint32_t offset,
-			  uint8_t mask);
-#endif /* CONFIG_FORMAT_S24LE */
-#if CONFIG_FORMAT_S32LE
-int64_t calc_sample_s32le(const struct audio_stream *source,
-			  uint8_t num_ch, uint32_t offset,
-			  uint8_t mask);
-#endif /* CONFIG_FORMAT_S32LE */
+int mux_update_look_up_tables(struct comp_dev *dev);
 #endif /* UNIT_TEST */
 
 #endif /* CONFIG_COMP_MUX */
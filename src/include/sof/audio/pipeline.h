@@ -8,10 +8,12 @@
 #ifndef __SOF_AUDIO_PIPELINE_H__
 #define __SOF_AUDIO_PIPELINE_H__
 
+#include <sof/audio/latency.h>
 #include <sof/lib/cpu.h>
 #include <sof/trace/trace.h>
 #include <ipc/topology.h>
 #include <user/trace.h>
+#include <config.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -70,6 +72,40 @@ struct task;
 #define PPL_DIR_DOWNSTREAM	0
 #define PPL_DIR_UPSTREAM	1
 
+#if CONFIG_XRUN_LIGHT_RECOVERY
+/* xrun recovery statistics, times are from detection to the end of the
+ * next successful copy
+ */
+struct pipeline_xrun_stats {
+	uint32_t light;			/* xruns recovered in firmware */
+	uint32_t full;			/* xruns reported to the host */
+	uint32_t silence_bytes;		/* silence inserted or data dropped */
+	uint32_t last_us;		/* last recovery time */
+	uint32_t max_us;		/* longest recovery time */
+	uint32_t total_us;		/* sum of recovery times */
+	uint64_t start;			/* detection time, 0 when idle */
+};
+#endif
+
+#if CONFIG_PIPELINE_EDIT
+/* live edit states */
+#define PIPELINE_EDIT_NONE	0
+#define PIPELINE_EDIT_INSERT	1	/* connected at the next period */
+#define PIPELINE_EDIT_FADE_IN	2	/* next output faded from the input */
+#define PIPELINE_EDIT_FADE_OUT	3	/* next output faded to the input */
+#define PIPELINE_EDIT_DRAIN	4	/* input copied until disconnected */
+
+/* component inserted or removed while the pipeline runs */
+struct pipeline_edit {
+	uint32_t state;			/* PIPELINE_EDIT_ */
+	struct comp_dev *comp;		/* edited component */
+	struct comp_buffer *source;	/* buffer read by comp */
+	struct comp_buffer *sink;	/* buffer written by comp */
+	void *scratch;			/* input of the crossfaded copy */
+	uint32_t dry_bytes;		/* input copied to the end of sink */
+};
+#endif
+
 /*
  * Audio pipeline.
  */
@@ -79,6 +115,15 @@ struct pipeline {
 	/* runtime status */
 	int32_t xrun_bytes;		/* last xrun length */
 	uint32_t status;		/* pipeline status */
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	struct pipeline_xrun_stats xrun_stats;
+#endif
+#if CONFIG_LATENCY_MARKERS
+	struct pipeline_latency latency;	/* of frames entering here */
+#endif
+#if CONFIG_PIPELINE_EDIT
+	struct pipeline_edit edit;
+#endif
 
 	/* scheduling */
 	struct task *pipe_task;		/* pipeline processing task */
@@ -129,6 +174,27 @@ void buffer_free(struct comp_buffer *buffer);
 int pipeline_connect(struct comp_dev *comp, struct comp_buffer *buffer,
 		     int dir);
 
+/* remove component from pipeline */
+void pipeline_disconnect(struct comp_dev *comp, struct comp_buffer *buffer,
+			 int dir);
+
+#if CONFIG_PIPELINE_EDIT
+/* insert or remove a component while the pipeline runs */
+int pipeline_edit_insert(struct comp_dev *comp, struct comp_buffer *source,
+			 struct comp_buffer *sink);
+int pipeline_edit_remove(struct comp_dev *comp);
+
+/* called by the pipeline task around the copy of the pipeline */
+void pipeline_edit_period_begin(struct pipeline *p);
+void pipeline_edit_period_end(struct pipeline *p);
+
+/* copies the edited component */
+int pipeline_edit_copy(struct comp_dev *dev);
+
+/* drops an unfinished edit, the graph is left as it is */
+void pipeline_edit_cancel(struct pipeline *p);
+#endif
+
 /* complete the pipeline */
 int pipeline_complete(struct pipeline *p, struct comp_dev *source,
 		      struct comp_dev *sink);
@@ -15,9 +15,11 @@
 #define __SOF_AUDIO_SELECTOR_H__
 
 #include <sof/trace/trace.h>
+#include <ipc/channel_map.h>
 #include <ipc/stream.h>
 #include <user/selector.h>
 #include <user/trace.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 struct comp_buffer;
@@ -32,6 +34,9 @@ struct comp_dev;
 #define SEL_SINK_2CH 2
 #define SEL_SINK_4CH 4
 
+/** \brief Output channel not taken from any source channel. */
+#define SEL_CHANNEL_NONE 0xffff
+
 /** \brief selector processing function interface */
 typedef void (*sel_func)(struct comp_dev *dev, struct audio_stream *sink,
 			 const struct audio_stream *source, uint32_t frames);
@@ -43,13 +48,19 @@ struct comp_data {
 	enum sof_ipc_frame source_format;	/**< source frame format */
 	enum sof_ipc_frame sink_format;		/**< sink frame format */
 	struct sof_sel_config config;	/**< component configuration data */
+	struct sof_ipc_stream_map *stream_map;	/**< optional channel map */
+	uint32_t in_channels;	/**< source stream channels */
+	uint32_t out_channels;	/**< sink stream channels */
+	uint16_t *ch_map;	/**< source of each sink channel */
+	int32_t *frame;		/**< bounce source and sink frame */
 	sel_func sel_func;	/**< channel selector processing function */
 };
 
 /** \brief Selector processing functions map. */
 struct comp_func_map {
 	uint16_t source;	/**< source frame format */
-	uint32_t out_channels;	/**< number of output stream channels */
+	uint32_t in_channels;	/**< input stream channels, 0 for any */
+	uint32_t out_channels;	/**< output stream channels, 0 for any */
 	sel_func sel_func;	/**< selector processing function */
 };
 
@@ -63,4 +74,10 @@ extern const struct comp_func_map func_map[];
  */
 sel_func sel_get_processing_function(struct comp_dev *dev);
 
+/**
+ * \brief Checks if every sink channel takes the same source channel.
+ * \param[in] cd Selector component private data.
+ */
+bool sel_map_is_identity(const struct comp_data *cd);
+
 #endif /* __SOF_AUDIO_SELECTOR_H__ */
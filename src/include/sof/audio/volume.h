@@ -89,15 +89,16 @@ typedef void (*vol_scale_func)(struct comp_dev *dev, struct audio_stream *sink,
 struct comp_data {
 	struct task *volwork;		/**< volume scheduled work function */
 	struct sof_ipc_ctrl_value_chan *hvol;	/**< host volume readback */
-	int32_t volume[SOF_IPC_MAX_CHANNELS];	/**< current volume */
-	int32_t tvolume[SOF_IPC_MAX_CHANNELS];	/**< target volume */
-	int32_t mvolume[SOF_IPC_MAX_CHANNELS];	/**< mute volume */
-	int32_t ramp_increment[SOF_IPC_MAX_CHANNELS]; /**< for linear ramp */
+	int32_t *volume;			/**< current volume */
+	int32_t *tvolume;			/**< target volume */
+	int32_t *mvolume;			/**< mute volume */
+	int32_t *ramp_increment;		/**< for linear ramp */
 	int32_t vol_min;			/**< minimum volume */
 	int32_t vol_max;			/**< maximum volume */
 	int32_t	vol_ramp_range;			/**< max ramp transition */
 	unsigned int channels;			/**< current channels count */
-	bool muted[SOF_IPC_MAX_CHANNELS];	/**< set if channel is muted */
+	unsigned int max_channels;		/**< channels with state */
+	bool *muted;				/**< set if channel is muted */
 	bool vol_ramp_active;			/**< set if volume is ramped */
 	bool ramp_started;			/**< control ramp launch */
 	vol_scale_func scale_vol;	/**< volume processing function */
@@ -106,6 +107,7 @@ struct comp_data {
 /** \brief Volume processing functions map. */
 struct comp_func_map {
 	uint16_t frame_fmt;	/**< frame format */
+	uint32_t channels;	/**< stream channels, 0 for any */
 	vol_scale_func func;	/**< volume processing function */
 };
 
@@ -127,10 +129,15 @@ static inline vol_scale_func vol_get_processing_function(struct comp_dev *dev)
 	sinkb = list_first_item(&dev->bsink_list, struct comp_buffer,
 				source_list);
 
-	/* map the volume function for source and sink buffers */
+	/* map the volume function for source and sink buffers, kernels
+	 * specialized for the channels count come first
+	 */
 	for (i = 0; i < func_count; i++) {
 		if (sinkb->stream.frame_fmt != func_map[i].frame_fmt)
 			continue;
+		if (func_map[i].channels &&
+		    sinkb->stream.channels != func_map[i].channels)
+			continue;
 
 		return func_map[i].func;
 	}
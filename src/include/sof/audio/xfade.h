@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_AUDIO_XFADE_H__
+#define __SOF_AUDIO_XFADE_H__
+
+#include <sof/audio/audio_stream.h>
+#include <sof/lib/alloc.h>
+#include <sof/math/numbers.h>
+#include <ipc/stream.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Length of the crossfade from old to new filter coefficients */
+#define XFADE_MS	5
+
+/*
+ * Linear crossfade for switching filter coefficients while streaming.
+ * The old filters write their output to the sink and the new filters to
+ * the scratch stream, then the sink is faded from the old output to the
+ * new one. The scratch is allocated at prepare so that a coefficient
+ * update does not need to allocate.
+ */
+struct xfade {
+	struct audio_stream scratch;	/* output of the new filters */
+	int frames;			/* scratch length in frames */
+	int length;			/* crossfade length in frames */
+	int pos;			/* frames faded, length when idle */
+	int32_t step;			/* Q1.31 gain increment per frame */
+};
+
+static inline void xfade_free(struct xfade *xf)
+{
+	rfree(xf->scratch.addr);
+	xf->scratch.addr = NULL;
+	xf->frames = 0;
+	xf->length = 0;
+	xf->pos = 0;
+}
+
+/* Allocates a scratch of frames in the format of sink. The length is kept
+ * even for the FIR that processes frames in pairs.
+ */
+static inline int xfade_init(struct xfade *xf, const struct audio_stream *sink,
+			     int frames)
+{
+	uint32_t size;
+
+	xfade_free(xf);
+
+	frames = MAX(frames & ~1, 2);
+	size = frames * audio_stream_frame_bytes(sink);
+	xf->scratch.addr = rballoc(0, SOF_MEM_CAPS_RAM, size);
+	if (!xf->scratch.addr)
+		return -ENOMEM;
+
+	xf->scratch.size = size;
+	xf->scratch.end_addr = (char *)xf->scratch.addr + size;
+	xf->scratch.r_ptr = xf->scratch.addr;
+	xf->scratch.w_ptr = xf->scratch.addr;
+	xf->scratch.frame_fmt = sink->frame_fmt;
+	xf->scratch.channels = sink->channels;
+	xf->scratch.rate = sink->rate;
+	xf->frames = frames;
+	xf->length = MAX((sink->rate * XFADE_MS / 1000) & ~1, 2);
+	xf->pos = xf->length;
+	xf->step = INT32_MAX / xf->length;
+	return 0;
+}
+
+static inline bool xfade_active(const struct xfade *xf)
+{
+	return xf->pos < xf->length;
+}
+
+static inline void xfade_start(struct xfade *xf)
+{
+	xf->pos = 0;
+}
+
+/* Frames to run in the next pass, limited by the scratch and the fade */
+static inline int xfade_chunk(const struct xfade *xf, int frames)
+{
+	return MIN(MIN(frames, xf->frames), xf->length - xf->pos);
+}
+
+/* The faded samples are in between the old and the new ones so they do
+ * not need saturation. The gain is applied with 16 bits.
+ */
+#if CONFIG_FORMAT_S16LE
+static inline void xfade_mix_s16(struct xfade *xf, struct audio_stream *sink,
+				 int samples, int32_t gain)
+{
+	int16_t *x = xf->scratch.addr;
+	int16_t *y;
+	int nch = sink->channels;
+	int i;
+
+	for (i = 0; i < samples; i++) {
+		if (!(i % nch))
+			gain += xf->step;
+
+		y = audio_stream_write_frag_s16(sink, i);
+		*y += ((int32_t)(x[i] - *y) * (gain >> 16)) >> 15;
+	}
+}
+#endif /* CONFIG_FORMAT_S16LE */
+
+static inline void xfade_mix_s32(struct xfade *xf, struct audio_stream *sink,
+				 int samples, int32_t gain)
+{
+	int32_t *x = xf->scratch.addr;
+	int32_t *y;
+	int nch = sink->channels;
+	int i;
+
+	for (i = 0; i < samples; i++) {
+		if (!(i % nch))
+			gain += xf->step;
+
+		y = audio_stream_write_frag_s32(sink, i);
+		*y += (((int64_t)x[i] - *y) * (gain >> 16)) >> 15;
+	}
+}
+
+/* Fades the next frames of sink from its samples to the ones in scratch */
+static inline void xfade_mix(struct xfade *xf, struct audio_stream *sink,
+			     int frames)
+{
+	int32_t gain = xf->pos * xf->step;
+	int samples = frames * sink->channels;
+
+#if CONFIG_FORMAT_S16LE
+	if (sink->frame_fmt == SOF_IPC_FRAME_S16_LE)
+		xfade_mix_s16(xf, sink, samples, gain);
+	else
+#endif /* CONFIG_FORMAT_S16LE */
+		xfade_mix_s32(xf, sink, samples, gain);
+
+	xf->pos += frames;
+}
+
+#endif /* __SOF_AUDIO_XFADE_H__ */
@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_DEBUG_HIST_H__
+#define __SOF_DEBUG_HIST_H__
+
+#include <sof/math/numbers.h>
+#include <ipc/trace.h>
+#include <stdint.h>
+
+/* adds a sample to a log2 histogram, counters saturate */
+static inline void hist_add(struct sof_ipc_hist *hist, uint32_t value)
+{
+	int bin = value > 1 ? 31 - __builtin_clz(value) : 0;
+
+	bin = MIN(bin, SOF_IPC_HIST_BINS - 1);
+	if (hist->bin[bin] != UINT32_MAX)
+		hist->bin[bin]++;
+	if (hist->count != UINT32_MAX)
+		hist->count++;
+	hist->max = MAX(hist->max, value);
+}
+
+#endif /* __SOF_DEBUG_HIST_H__ */
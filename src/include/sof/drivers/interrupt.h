@@ -15,6 +15,7 @@
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
+#include <ipc/trace.h>
 #include <user/trace.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -23,14 +24,15 @@
 #define trace_irq_error(__e, ...) \
 	trace_error(TRACE_CLASS_IRQ,  __e, ##__VA_ARGS__)
 
+/* number of 32 bit status words of a cascading controller */
+#define IRQ_CHILD_WORDS		((PLATFORM_IRQ_CHILDREN + 31) / 32)
+
 /**
- * \brief child IRQ descriptor for cascading IRQ controllers.
+ * \brief latency and duration statistics of an interrupt.
  */
-struct irq_child {
-	int enable_count[PLATFORM_CORE_COUNT];	/**< IRQ enable counter */
-	struct list_item list;			/**< head for IRQ descriptors,
-						  * sharing this interrupt
-						  */
+struct irq_stats {
+	struct sof_ipc_hist latency;	/**< status read to handler */
+	struct sof_ipc_hist duration;	/**< handler run time */
 };
 
 /**
@@ -44,6 +46,25 @@ struct irq_desc {
 					  * interrupt is enabled
 					  */
 	struct list_item irq_list;	/**< to link to other irq_desc */
+#if CONFIG_INTERRUPT_STATS
+	struct irq_stats stats;		/**< handler statistics */
+#endif
+};
+
+/**
+ * \brief child IRQ descriptor for cascading IRQ controllers.
+ */
+struct irq_child {
+	int enable_count[PLATFORM_CORE_COUNT];	/**< IRQ enable counter */
+	struct list_item list;			/**< head for IRQ descriptors,
+						  * sharing this interrupt
+						  */
+	struct irq_desc *single;		/**< the descriptor when it is
+						  * the only one in the list
+						  */
+#if CONFIG_INTERRUPT_STATS
+	struct irq_stats stats;			/**< IRQ line statistics */
+#endif
 };
 
 /**
@@ -92,6 +113,15 @@ struct irq_cascade_desc {
 							  */
 	unsigned int num_children[PLATFORM_CORE_COUNT];	/**< number of children
 							  */
+	uint32_t enabled[PLATFORM_CORE_COUNT][IRQ_CHILD_WORDS];
+							/**< child interrupts
+							  * with a handler
+							  * enabled per core
+							  */
+	uint32_t shared[IRQ_CHILD_WORDS];		/**< child interrupts
+							  * with more than one
+							  * descriptor
+							  */
 	struct irq_child child[PLATFORM_IRQ_CHILDREN];	/**< array of child
 							  * lists - one per
 							  * multiplexed IRQ
@@ -145,6 +175,12 @@ void interrupt_init(struct sof *sof);
 int interrupt_cascade_register(const struct irq_cascade_tmpl *tmpl);
 struct irq_cascade_desc *interrupt_get_parent(uint32_t irq);
 int interrupt_get_irq(unsigned int irq, const char *cascade);
+uint32_t interrupt_cascade_dispatch(struct irq_cascade_desc *cascade,
+				    unsigned int word, uint32_t status);
+
+#if CONFIG_INTERRUPT_STATS
+int interrupt_stats_info(struct sof_ipc_irq_stats *stats, uint32_t size);
+#endif
 
 static inline void interrupt_set(int irq)
 {
@@ -16,7 +16,9 @@
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <ipc/header.h>
+#include <ipc/trace.h>
 #include <user/trace.h>
+#include <config.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -33,6 +35,7 @@ struct sof_ipc_comp_event;
 struct sof_ipc_dai_config;
 struct sof_ipc_host_buffer;
 struct sof_ipc_pipe_comp_connect;
+struct sof_ipc_pipe_comp_edit;
 struct sof_ipc_pipe_new;
 struct sof_ipc_stream_posn;
 struct ipc_msg;
@@ -83,9 +86,22 @@ struct ipc_msg {
 	struct list_item list;
 };
 
+/* processing time histograms, index 0 counts all messages */
+#define IPC_STATS_TYPES	(1 << (32 - SOF_GLB_TYPE_SHIFT))
+
 struct ipc {
 	spinlock_t lock;	/* locking mechanism */
-	void *comp_data;
+	void *comp_data;	/* writable message, also for other cores */
+
+	/* message being processed, comp_data or read in place from the
+	 * mailbox, handlers get it with ipc_msg_get()
+	 */
+	const struct sof_ipc_cmd_hdr *msg;
+
+#if CONFIG_IPC_STATS
+	uint64_t msg_start;	/* mailbox read time of the message */
+	struct sof_ipc_hist stats[IPC_STATS_TYPES];	/* by global type */
+#endif
 
 	/* PM */
 	int pm_prepare_D3;	/* do we need to prepare for D3 */
@@ -95,6 +111,11 @@ struct ipc {
 
 	struct list_item comp_list;	/* list of component devices */
 
+#if CONFIG_IPC_POSN_BATCH
+	/* queued batched stream notification, NULL if none pending */
+	struct ipc_msg *posn_batch;
+#endif
+
 	/* processing task */
 	struct task ipc_task;
 
@@ -113,6 +134,12 @@ static inline struct ipc *ipc_get(void)
 	return sof_get()->ipc;
 }
 
+/* read only view of the message being processed */
+static inline const void *ipc_msg_get(struct ipc *ipc)
+{
+	return ipc->msg;
+}
+
 static inline uint64_t ipc_task_deadline(void *data)
 {
 	/* TODO: Currently it's a workaround to execute IPC tasks ASAP.
@@ -157,11 +184,37 @@ int ipc_send_comp_notification(const struct comp_dev *cdev,
 int ipc_stream_send_xrun(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn);
 
+/**
+ * \brief Updates stream slot in the position table without notifying host.
+ * @param cdev Host component of the stream.
+ * @param posn Current stream position.
+ */
+void ipc_stream_update_position(struct comp_dev *cdev,
+				struct sof_ipc_stream_posn *posn);
+
 int ipc_queue_host_message(struct ipc *ipc, uint32_t header, void *tx_data,
 			   size_t tx_bytes, bool replace);
 
 void ipc_platform_send_msg(void);
 
+/**
+ * \brief Returns sent message to the list of empty messages.
+ * @param ipc Global IPC context.
+ * @param msg Message already copied to the DSP box.
+ *
+ * Must be called by the platform with ipc->lock held.
+ */
+static inline void ipc_msg_sent(struct ipc *ipc, struct ipc_msg *msg)
+{
+#if CONFIG_IPC_POSN_BATCH
+	/* next stream event starts a new batch */
+	if (ipc->posn_batch == msg)
+		ipc->posn_batch = NULL;
+#endif
+
+	list_item_append(&msg->list, &ipc->empty_list);
+}
+
 /**
  * \brief Data provided by the platform which use ipc...page_descriptors().
  *
@@ -223,6 +276,13 @@ int ipc_pipeline_complete(struct ipc *ipc, uint32_t comp_id);
 int ipc_comp_connect(struct ipc *ipc,
 	struct sof_ipc_pipe_comp_connect *connect);
 
+#if CONFIG_PIPELINE_EDIT
+/*
+ * Insert or remove a component on a running pipeline.
+ */
+int ipc_comp_edit(struct ipc *ipc, struct sof_ipc_pipe_comp_edit *edit);
+#endif
+
 /*
  * Get component by ID.
  */
@@ -12,6 +12,8 @@
 #include <platform/lib/clk.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
+#include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 struct timer;
@@ -41,6 +43,9 @@ struct clock_info {
 	uint32_t notification_mask;
 	spinlock_t lock;
 	int (*set_freq)(int clock, int freq_idx);
+#if CONFIG_CLOCK_GOVERNOR
+	uint32_t gov_down_count;	/* windows with load below freq */
+#endif
 };
 
 uint32_t clock_get_freq(int clock);
@@ -51,6 +56,12 @@ uint64_t clock_ms_to_ticks(int clock, uint64_t ms);
 
 void platform_timer_set_delta(struct timer *timer, uint64_t ns);
 
+#if CONFIG_CLOCK_GOVERNOR
+void clock_gov_update(int clock, uint64_t load_hz, bool immediate);
+
+void clock_gov_boost(int clock);
+#endif
+
 static inline struct clock_info *clocks_get(void)
 {
 	return sof_get()->clocks;
@@ -637,6 +637,11 @@ int dma_copy_from_host_nowait(struct dma_copy *dc,
 int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	int32_t host_offset, void *local_ptr, int32_t size);
 
+/* DMA copy data from host to DSP */
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+	struct dma_sg_config *host_sg, int32_t host_offset, void *local_ptr,
+	int32_t size);
+
 int dma_copy_set_stream_tag(struct dma_copy *dc, uint32_t stream_tag);
 
 static inline const struct dma_info *dma_info_get(void)
@@ -15,8 +15,12 @@
 #define EXP_FIXED_OUTPUT_QY 20
 #define DB2LIN_FIXED_INPUT_QY 24
 #define DB2LIN_FIXED_OUTPUT_QY 20
+#define LIN2DB_FIXED_INPUT_QY 31
+#define LIN2DB_FIXED_OUTPUT_QY 24
 
 int32_t exp_fixed(int32_t x); /* Input is Q5.27, output is Q12.20 */
 int32_t db2lin_fixed(int32_t x); /* Input is Q8.24, output is Q12.20 */
+int32_t db2lin_fast_fixed(int32_t x); /* Input is Q8.24, output is Q12.20 */
+int32_t lin2db_fixed(int32_t x); /* Input is Q1.31, output is Q8.24 */
 
 #endif /* __SOF_MATH_DECIBELS_H__ */
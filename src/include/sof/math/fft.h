@@ -0,0 +1,105 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_MATH_FFT_H__
+#define __SOF_MATH_FFT_H__
+
+#include <sof/audio/format.h>
+#include <sof/math/fft_config.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Largest supported transform, limited by the bit reverse index type */
+#define FFT_SIZE_MAX	4096
+
+struct icomplex32 {
+	int32_t real;
+	int32_t imag;
+};
+
+/* Complex FFT plan, data and twiddle factors are Q1.31 */
+struct fft_plan {
+	uint32_t size;			/* number of points, power of two */
+	uint32_t len;			/* log2 of size */
+	uint16_t *bit_reverse_idx;
+	struct icomplex32 *twiddle;	/* exp(-j*2*pi*k/size), k < size / 2 */
+};
+
+/* Real input FFT plan built on a half size complex FFT */
+struct fft_real_plan {
+	uint32_t size;			/* number of real points */
+	struct fft_plan *plan;		/* complex plan of size / 2 points */
+	struct icomplex32 *twiddle;	/* exp(-j*2*pi*k/size), k < size / 2 */
+};
+
+struct fft_plan *fft_plan_new(uint32_t size);
+void fft_plan_free(struct fft_plan *plan);
+
+/* In place transform of plan->size points. Every stage scales by 1/2, the
+ * output is the DFT divided by size. The inverse transform is scaled
+ * the same way.
+ */
+void fft_execute_32(const struct fft_plan *plan, struct icomplex32 *buf,
+		    bool ifft);
+
+struct fft_real_plan *fft_real_plan_new(uint32_t size);
+void fft_real_plan_free(struct fft_real_plan *plan);
+
+/* Transform of plan->size real points to the size / 2 + 1 non-negative
+ * frequency bins, scaled by 1/size. The output buffer holds
+ * size / 2 + 1 points.
+ */
+void fft_real_execute_32(const struct fft_real_plan *plan, const int32_t *in,
+			 struct icomplex32 *out);
+
+/* Inverse of fft_real_execute_32() from the size / 2 + 1 bins of a real
+ * sequence to plan->size points, scaled by 1/size like the complex
+ * inverse. The output buffer may not overlap the input.
+ */
+void fft_real_inverse_32(const struct fft_real_plan *plan,
+			 const struct icomplex32 *in, int32_t *out);
+
+/* Butterfly passes over bit reversed data, a radix-2 pass for odd log2
+ * sizes followed by radix-4 passes. Implemented by the generic and the
+ * HiFi3 variants.
+ */
+void fft_butterflies_32(const struct fft_plan *plan, struct icomplex32 *buf);
+
+/* Q1.31 x Q1.31 complex product, |w| <= 1 keeps the sums within 64 bits */
+static inline void fft_cmul(struct icomplex32 *out, const struct icomplex32 *w,
+			    const struct icomplex32 *x)
+{
+	int64_t re = (int64_t)w->real * x->real - (int64_t)w->imag * x->imag;
+	int64_t im = (int64_t)w->real * x->imag + (int64_t)w->imag * x->real;
+
+	out->real = sat_int32(Q_SHIFT_RND(re, 62, 31));
+	out->imag = sat_int32(Q_SHIFT_RND(im, 62, 31));
+}
+
+/* Product with the conjugate of w */
+static inline void fft_cmul_conj(struct icomplex32 *out,
+				 const struct icomplex32 *w,
+				 const struct icomplex32 *x)
+{
+	int64_t re = (int64_t)w->real * x->real + (int64_t)w->imag * x->imag;
+	int64_t im = (int64_t)w->real * x->imag - (int64_t)w->imag * x->real;
+
+	out->real = sat_int32(Q_SHIFT_RND(re, 62, 31));
+	out->imag = sat_int32(Q_SHIFT_RND(im, 62, 31));
+}
+
+/* (a + b) / 2 with rounding */
+static inline int32_t fft_half_sum(int32_t a, int32_t b)
+{
+	return sat_int32(((int64_t)a + b + 1) >> 1);
+}
+
+/* (a - b) / 2 with rounding */
+static inline int32_t fft_half_diff(int32_t a, int32_t b)
+{
+	return sat_int32(((int64_t)a - b + 1) >> 1);
+}
+
+#endif /* __SOF_MATH_FFT_H__ */
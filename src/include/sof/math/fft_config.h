@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_MATH_FFT_CONFIG_H__
+#define __SOF_MATH_FFT_CONFIG_H__
+
+/* If next define is set to 1 the FFT is configured automatically. Setting
+ * to zero temporarily is useful is for testing needs.
+ */
+#define FFT_AUTOARCH	1
+
+/* Select optimized code variant when xt-xcc compiler is used on HiFi3 */
+#if FFT_AUTOARCH == 1
+#if defined __XCC__
+/* For xt-xcc */
+#include <xtensa/config/core-isa.h>
+#if XCHAL_HAVE_HIFI3 == 1
+/* Version for HiFi3 */
+#define FFT_HIFI3	1
+#define FFT_GENERIC	0
+#else
+/* Version for e.g. HiFi2EP */
+#define FFT_HIFI3	0
+#define FFT_GENERIC	1
+#endif
+#else
+/* For GCC */
+#define FFT_GENERIC	1
+#define FFT_HIFI3	0
+#endif /* XCC */
+#else
+/* Applied when FFT_AUTOARCH is set to zero */
+#define FFT_GENERIC	1 /* Enable generic */
+#define FFT_HIFI3	0 /* Disable HiFi3  */
+#endif /* Autoarch */
+
+#endif /* __SOF_MATH_FFT_CONFIG_H__ */
@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __SOF_PROBE_COMPRESS_H__
+#define __SOF_PROBE_COMPRESS_H__
+
+#include <stdint.h>
+
+/*
+ * Lossless compression of extraction probe payloads.
+ *
+ * Every sample is replaced by its difference to the previous sample of the
+ * same channel (the first frame of a packet is coded against zero, so each
+ * packet decodes on its own). Differences are zigzag mapped to unsigned
+ * values and bit-packed in blocks of PROBE_COMPRESS_BLOCK values, each block
+ * using the width of its largest value. A block starts with a header word
+ * carrying the bit width and the number of values, followed by the packed
+ * values in little-endian 32-bit words.
+ */
+
+/** \brief Number of values sharing a bit width */
+#define PROBE_COMPRESS_BLOCK		32
+
+#define PROBE_COMPRESS_HDR_BITS(hdr)	((hdr) & 0xff)
+#define PROBE_COMPRESS_HDR_COUNT(hdr)	(((hdr) >> 8) & 0xff)
+#define PROBE_COMPRESS_HDR(bits, count)	((bits) | ((count) << 8))
+
+/*
+ * \brief Compress interleaved samples.
+ *
+ * param[out] dst - output buffer
+ * param[in] dst_bytes - size of output buffer
+ * param[in] src - interleaved samples, whole frames only
+ * param[in] src_bytes - number of bytes to compress
+ * param[in] container_bytes - sample container size, 2 or 4
+ * param[in] channels - number of interleaved channels
+ *
+ * Returns compressed size in bytes, -ENOSPC when output does not fit in
+ * dst_bytes or -EINVAL for an unsupported layout.
+ */
+int probe_compress(uint32_t *dst, uint32_t dst_bytes, const void *src,
+		   uint32_t src_bytes, uint32_t container_bytes,
+		   uint32_t channels);
+
+/*
+ * \brief Decompress data produced by probe_compress().
+ *
+ * param[out,optional] dst - output buffer, NULL to only compute the size
+ * param[in] dst_bytes - size of output buffer
+ * param[in] src - compressed data
+ * param[in] src_bytes - size of compressed data
+ * param[in] container_bytes - sample container size, 2 or 4
+ * param[in] channels - number of interleaved channels
+ *
+ * Returns decompressed size in bytes or negative error code.
+ */
+int probe_decompress(void *dst, uint32_t dst_bytes, const uint32_t *src,
+		     uint32_t src_bytes, uint32_t container_bytes,
+		     uint32_t channels);
+
+#endif /* __SOF_PROBE_COMPRESS_H__ */
@@ -13,9 +13,11 @@
 #ifndef __SOF_SCHEDULE_LL_SCHEDULE_H__
 #define __SOF_SCHEDULE_LL_SCHEDULE_H__
 
+#include <sof/math/numbers.h>
 #include <sof/schedule/task.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <config.h>
 #include <stdint.h>
 
 struct ll_schedule_domain;
@@ -37,8 +39,38 @@ struct ll_schedule_domain;
 
 struct ll_task_pdata {
 	uint64_t period;
+#if CONFIG_CLOCK_GOVERNOR
+	uint32_t cycles_last;	/* cpu cycles of the last run */
+	uint32_t cycles_peak;	/* peak cpu cycles in governor window */
+#endif
 };
 
+/*
+ * A low latency domain ticks at the greatest common divisor of the periods
+ * of its tasks and every task runs only on the ticks that are a multiple
+ * of its own period, e.g. with a 250 us and a 1 ms pipeline the domain
+ * ticks every 250 us and the 1 ms pipeline runs on every 4th tick. The
+ * tick is not shorter than CONFIG_SCHEDULE_LL_MIN_TICK, a task with a
+ * period that is not a multiple of it runs on the first tick after it is
+ * due and keeps its rate as long as the period is not shorter than the
+ * tick.
+ */
+
+/* Adds a task period in us to a domain tick, a period of 0 is ignored */
+static inline uint32_t ll_tick_add(uint32_t tick, uint32_t period)
+{
+	if (!period)
+		return tick;
+
+	return tick ? gcd(tick, period) : period;
+}
+
+/* Tick the domain runs at, 0 if there are no periodic tasks */
+static inline uint32_t ll_tick_limit(uint32_t tick)
+{
+	return tick ? MAX(tick, (uint32_t)CONFIG_SCHEDULE_LL_MIN_TICK) : 0;
+}
+
 int scheduler_init_ll(struct ll_schedule_domain *domain);
 
 int schedule_task_init_ll(struct task *task, uint16_t type, uint16_t priority,
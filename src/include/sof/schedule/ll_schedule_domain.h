@@ -14,6 +14,7 @@
 #include <sof/lib/cpu.h>
 #include <sof/lib/clk.h>
 #include <sof/lib/memory.h>
+#include <sof/schedule/ll_schedule.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
@@ -47,6 +48,8 @@ struct ll_schedule_domain {
 	atomic_t total_num_tasks;	/**< total number of registered tasks */
 	atomic_t num_clients;		/**< number of registered cores */
 	uint32_t ticks_per_ms;		/**< number of clock ticks per ms */
+	uint32_t period;		/**< tick in us, 0 when idle */
+	uint32_t core_period[PLATFORM_CORE_COUNT];	/**< tick of core tasks */
 	int type;			/**< domain type */
 	int clk;			/**< source clock */
 	bool synchronous;		/**< are tasks should be synchronous */
@@ -149,6 +152,25 @@ static inline void domain_clear(struct ll_schedule_domain *domain)
 	platform_shared_commit(domain, sizeof(*domain));
 }
 
+/* Sets the tick of the tasks of core, the domain tick divides the ticks of
+ * all cores
+ */
+static inline void domain_set_period(struct ll_schedule_domain *domain,
+				     int core, uint32_t period)
+{
+	uint32_t tick = 0;
+	int i;
+
+	domain->core_period[core] = period;
+
+	for (i = 0; i < PLATFORM_CORE_COUNT; i++)
+		tick = ll_tick_add(tick, domain->core_period[i]);
+
+	domain->period = ll_tick_limit(tick);
+
+	platform_shared_commit(domain, sizeof(*domain));
+}
+
 static inline bool domain_is_pending(struct ll_schedule_domain *domain,
 				     struct task *task)
 {
@@ -14,6 +14,8 @@
 
 struct cascade_root;
 struct clock_info;
+struct buffer_cache;
+struct coef_store;
 struct comp_driver_list;
 struct dai_info;
 struct dma_info;
@@ -88,6 +90,12 @@ struct sof {
 	/* list of registered component drivers */
 	struct comp_driver_list *comp_drivers;
 
+	/* shared coefficient blobs */
+	struct coef_store *coef_store;
+
+	/* buffers kept for reuse */
+	struct buffer_cache *buffer_cache;
+
 	/* M/N dividers */
 	struct mn *mn;
 
@@ -12,6 +12,8 @@
 #include <sof/schedule/task.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
+#include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 struct sof;
@@ -28,6 +30,7 @@ struct dma_trace_buf {
 struct dma_trace_data {
 	struct dma_sg_config config;
 	struct dma_trace_buf dmatb;
+	void *suspended_addr;	/* local buffer while tracing is suspended */
 	struct dma_copy dc;
 	uint32_t old_host_offset;
 	uint32_t host_offset;
@@ -43,6 +46,10 @@ struct dma_trace_data {
 				   */
 	uint32_t dropped_entries; /* amount of dropped entries */
 	spinlock_t lock; /* dma trace lock */
+#if CONFIG_TRACE_COMPACT
+	uint64_t compact_timestamp; /* timestamp of last record written */
+	uint32_t compact_count; /* records written since last sync record */
+#endif
 };
 
 int dma_trace_init_early(struct sof *sof);
@@ -51,6 +58,10 @@ int dma_trace_host_buffer(struct dma_trace_data *d,
 			  struct dma_sg_elem_array *elem_array,
 			  uint32_t host_size);
 int dma_trace_enable(struct dma_trace_data *d);
+int dma_trace_relocate(struct dma_trace_data *d, bool sys);
+void dma_trace_suspend(struct dma_trace_data *d);
+void dma_trace_resume(struct dma_trace_data *d);
+void dma_trace_disable(struct dma_trace_data *d);
 void dma_trace_flush(void *t);
 void dma_trace_on(void);
 void dma_trace_off(void);
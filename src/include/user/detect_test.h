@@ -42,4 +42,44 @@ struct sof_detect_test_config {
 /** used for binary blob size sanity checks */
 #define SOF_DETECT_TEST_MAX_CFG_SIZE sizeof(struct sof_detect_test_config)
 
+/** model blob for the detection front end starts with this magic */
+#define SOF_DETECT_MODEL_MAGIC	0x3144574b	/* "KWD1" */
+
+/** classifier types */
+#define SOF_DETECT_CLASSIFIER_LINEAR	0
+#define SOF_DETECT_CLASSIFIER_MLP	1
+
+/**
+ * Keyword model, sent as SOF_DETECT_TEST_MODEL data.
+ *
+ * The header is followed by uint16_t mel_edges[num_mel + 2], the FFT bins
+ * of the triangular mel band edges, padded to 4 bytes and then by the
+ * classifier parameters. Features are log2 mel energies in Q8.8 with the
+ * running mean of each band removed, ordered oldest frame first.
+ *
+ * Linear classifier: int32_t bias in Q16.16, then
+ * int16_t weight[context][num_mel] in Q1.15.
+ *
+ * MLP classifier: uint16_t hidden, uint16_t reserved, int32_t out_bias in
+ * Q16.16, int32_t hidden_bias[hidden] in Q16.16, int16_t out_weight[hidden]
+ * in Q1.15 padded to 4 bytes, then int8_t weight[hidden][context][num_mel]
+ * in Q1.7. Hidden units use ReLU.
+ */
+struct sof_detect_model {
+	uint32_t magic;
+	uint32_t size;		/**< model size in bytes including header */
+	uint32_t rate;		/**< sample rate of the model, 0 for any */
+	uint16_t frame_length;	/**< analysis frame in samples */
+	uint16_t frame_shift;	/**< hop between frames in samples */
+	uint16_t fft_size;	/**< power of two, not less than frame_length */
+	uint8_t num_mel;	/**< mel bands */
+	uint8_t context;	/**< feature frames seen by the classifier */
+	uint8_t classifier;	/**< SOF_DETECT_CLASSIFIER_ type */
+	uint8_t hold;		/**< frames above threshold for a detection */
+	uint8_t vad_shift;	/**< gate at noise floor << shift, 0 off */
+	uint8_t vad_hangover;	/**< frames the gate stays open after speech */
+	int32_t threshold;	/**< classifier score threshold in Q16.16 */
+	uint32_t reserved[2];
+} __attribute__((packed));
+
 #endif /* __USER_DETECT_TEST_H__ */
@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+#ifndef __USER_DRC_H__
+#define __USER_DRC_H__
+
+#include <stdint.h>
+
+#define SOF_DRC_MAX_BANDS	3	/* Max number of crossover bands */
+#define SOF_DRC_MAX_LOOKAHEAD_US 10000	/* Max lookahead delay */
+#define SOF_DRC_MAX_SIZE	1024	/* Max size of the blob in bytes */
+
+/*
+ * The compressor of a band. Levels above the threshold are compressed by
+ * the ratio, a ratio of zero makes the band a limiter. Around the
+ * threshold the curve is bent quadratically over knee decibels.
+ *     int32_t threshold
+ *         Threshold in dBFS as Q8.24, e.g. -6.0 dB is -100663296.
+ *     int32_t knee
+ *         Width of the soft knee in dB as Q8.24, 0 to 24 dB.
+ *     int32_t ratio
+ *         Compression ratio as Q8.24, 1.0 or more, 0 for a limiter.
+ *     int32_t makeup_gain
+ *         Gain in dB as Q8.24 applied after compression, max 24 dB.
+ *     uint32_t attack_us, release_us
+ *         Time constants of the gain smoothing, 0 is instant.
+ */
+struct sof_drc_band {
+	int32_t threshold;
+	int32_t knee;
+	int32_t ratio;
+	int32_t makeup_gain;
+	uint32_t attack_us;
+	uint32_t release_us;
+
+	/* reserved */
+	uint32_t reserved[4];
+} __attribute__((packed));
+
+/*
+ * The input is split into num_bands bands at the crossover frequencies
+ * with complementary one pole filters, so the bands sum back to the input
+ * when no band compresses. The gains are computed from the peak levels of
+ * all channels so the stereo image is kept. Detection is done lookahead_us
+ * ahead of the output, the lookahead is at least two processing blocks.
+ *     uint32_t size
+ *         Size of the blob in bytes including band[num_bands].
+ *     uint32_t num_bands
+ *         1 .. SOF_DRC_MAX_BANDS
+ *     uint32_t lookahead_us
+ *         Delay of the output in microseconds.
+ *     uint32_t crossover_hz[]
+ *         Ascending band edges, num_bands - 1 are used.
+ */
+struct sof_drc_config {
+	uint32_t size;
+	uint32_t num_bands;
+	uint32_t lookahead_us;
+	uint32_t crossover_hz[SOF_DRC_MAX_BANDS - 1];
+
+	/* reserved */
+	uint32_t reserved[4];
+
+	struct sof_drc_band band[];
+} __attribute__((packed));
+
+#endif /* __USER_DRC_H__ */
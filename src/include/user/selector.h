@@ -10,6 +10,10 @@
 
 #include <stdint.h>
 
+/** \brief Types of selector binary control data. */
+#define SOF_SEL_CTRL_CONFIG		0	/**< struct sof_sel_config */
+#define SOF_SEL_CTRL_CHANNEL_MAP	1	/**< struct sof_ipc_stream_map */
+
 /** \brief Selector component configuration data. */
 struct sof_sel_config {
 	/* selector supports 1 input and 1 output */
@@ -105,4 +105,24 @@ struct log_entry_header {
 	uint32_t log_entry_address;	/* Address of log entry in ELF */
 } __attribute__((packed));
 
+/*
+ * Compact DMA trace encoding.
+ *
+ * Records are byte aligned and start with an unsigned LEB128 varint tag.
+ *
+ * Tag 0 starts a sync record: TRACE_COMPACT_SYNC (little endian), then
+ * struct log_entry_header and its arguments as in the regular encoding.
+ * The timestamp of a sync record restarts the delta chain, so decoding can
+ * start at any sync record.
+ *
+ * Any other tag is ((entry index << TRACE_COMPACT_CORE_BITS) | core id) + 1,
+ * where entry index is the log entry offset from the dictionary base address
+ * in words. It is followed by varints of the timestamp delta to the previous
+ * record, id_0, id_1 and the zigzag coded arguments, as many as params_num
+ * of the log entry.
+ */
+#define TRACE_COMPACT_SYNC		0x5C0FC0DE
+#define TRACE_COMPACT_CORE_BITS		3
+#define TRACE_COMPACT_CORE_MASK		((1 << TRACE_COMPACT_CORE_BITS) - 1)
+
 #endif /* __USER_TRACE_H__ */
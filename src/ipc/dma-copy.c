@@ -69,6 +69,22 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	return size;
 }
 
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	int ret;
+
+	/* tell gateway to copy */
+	ret = dma_copy(dc->chan, size, 0);
+	if (ret < 0)
+		return ret;
+
+	/* bytes copied */
+	return size;
+}
+
 #else
 
 int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
@@ -123,6 +139,62 @@ int dma_copy_to_host_nowait(struct dma_copy *dc, struct dma_sg_config *host_sg,
 	return local_sg_elem.size;
 }
 
+/* Copy host memory to DSP memory.
+ * Copies host memory to DSP in a single PAGE_SIZE or smaller block. Does not
+ * waits/sleeps and can be used in IRQ context.
+ */
+int dma_copy_from_host_nowait(struct dma_copy *dc,
+			      struct dma_sg_config *host_sg,
+			      int32_t host_offset, void *local_ptr,
+			      int32_t size)
+{
+	struct dma_sg_config config;
+	struct dma_sg_elem *host_sg_elem;
+	struct dma_sg_elem local_sg_elem;
+	int32_t err;
+	int32_t offset = host_offset;
+
+	if (size <= 0)
+		return 0;
+
+	/* find host element with host_offset */
+	host_sg_elem = sg_get_elem_at(host_sg, &offset);
+	if (!host_sg_elem)
+		return -EINVAL;
+
+	/* set up DMA configuration */
+	config.direction = DMA_DIR_HMEM_TO_LMEM;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+	config.irq_disabled = false;
+	dma_sg_init(&config.elem_array);
+
+	/* configure local DMA elem */
+	local_sg_elem.src = host_sg_elem->src + offset;
+	local_sg_elem.dest = (uint32_t)local_ptr;
+	if (size >= HOST_PAGE_SIZE - offset)
+		local_sg_elem.size = HOST_PAGE_SIZE - offset;
+	else
+		local_sg_elem.size = size;
+
+	config.elem_array.elems = &local_sg_elem;
+	config.elem_array.count = 1;
+
+	/* start the DMA */
+	err = dma_set_config(dc->chan, &config);
+	if (err < 0)
+		return err;
+
+	err = dma_copy(dc->chan, local_sg_elem.size,
+		       DMA_COPY_ONE_SHOT | DMA_COPY_BLOCKING);
+	if (err < 0)
+		return err;
+
+	/* bytes copied */
+	return local_sg_elem.size;
+}
+
 #endif
 
 int dma_copy_new(struct dma_copy *dc)
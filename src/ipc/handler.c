@@ -14,9 +14,11 @@
 
 #include <sof/audio/buffer.h>
 #include <sof/audio/component.h>
+#include <sof/audio/latency.h>
 #include <sof/audio/pipeline.h>
 #include <sof/common.h>
 #include <sof/debug/gdb/gdb.h>
+#include <sof/debug/hist.h>
 #include <sof/debug/panic.h>
 #include <sof/drivers/idc.h>
 #include <sof/drivers/interrupt.h>
@@ -24,6 +26,7 @@
 #include <sof/drivers/timer.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
+#include <sof/lib/clk.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/dai.h>
 #include <sof/lib/dma.h>
@@ -58,6 +61,11 @@
 #define iGS(x) ((x) & SOF_GLB_TYPE_MASK)
 #define iCS(x) ((x) & SOF_CMD_TYPE_MASK)
 
+#if CONFIG_IPC_POSN_BATCH
+static int ipc_queue_stream_event(struct ipc *ipc, uint32_t comp_id,
+				  uint32_t event);
+#endif
+
 /*
  * IPC ABI version compatibility rules :-
  *
@@ -113,22 +121,58 @@
 			((struct sof_ipc_cmd_hdr *)tx),			\
 			sizeof(rx))
 
+/* the handler writes to the message, it is copied from the mailbox */
+#define IPC_CMD_COPY	(1 << 0)
+
+/* host command handler, the message is read with ipc_msg_get() */
+struct ipc_cmd_desc {
+	int (*handler)(uint32_t header);
+	uint32_t size;		/* firmware message size, smaller host
+				 * messages are copied and zero padded
+				 */
+	uint32_t flags;		/* IPC_CMD_ */
+};
+
+static const struct ipc_cmd_desc *ipc_cmd_find(uint32_t cmd);
+
+/*
+ * Validates the message in the mailbox. Messages of handlers that only
+ * read them are used in place, others are copied to comp_data with the
+ * ABI padding of IPC_COPY_CMD.
+ */
 struct sof_ipc_cmd_hdr *mailbox_validate(void)
 {
-	struct sof_ipc_cmd_hdr *hdr = ipc_get()->comp_data;
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_cmd_hdr *box =
+		(struct sof_ipc_cmd_hdr *)mailbox_get_hostbox_base();
+	struct sof_ipc_cmd_hdr *hdr = ipc->comp_data;
+	const struct ipc_cmd_desc *desc;
 
-	/* read component values from the inbox */
-	mailbox_hostbox_read(hdr, SOF_IPC_MSG_MAX_SIZE, 0, sizeof(*hdr));
+#if CONFIG_IPC_STATS
+	ipc->msg_start = platform_timer_get(timer_get());
+#endif
 
-	/* validate component header */
-	if (hdr->size > SOF_IPC_MSG_MAX_SIZE) {
-		trace_ipc_error("ipc: msg too big at 0x%x", hdr->size);
+	/* validate component header in place */
+	dcache_invalidate_region(box, sizeof(*box));
+	if (box->size < sizeof(*box) || box->size > SOF_IPC_MSG_MAX_SIZE) {
+		trace_ipc_error("ipc: msg invalid size 0x%x", box->size);
 		return NULL;
 	}
 
-	/* read rest of component data */
-	mailbox_hostbox_read(hdr + 1, SOF_IPC_MSG_MAX_SIZE - sizeof(*hdr),
-			     sizeof(*hdr), hdr->size - sizeof(*hdr));
+	dcache_invalidate_region(box + 1, box->size - sizeof(*box));
+
+	desc = ipc_cmd_find(box->cmd);
+	if (desc && !(desc->flags & IPC_CMD_COPY) && box->size >= desc->size)
+		return box;
+
+	/* read component data from the inbox */
+	mailbox_hostbox_read(hdr, SOF_IPC_MSG_MAX_SIZE, 0, box->size);
+
+	if (desc && desc->size > hdr->size) {
+		bzero((char *)hdr + hdr->size, desc->size - hdr->size);
+		trace_ipc("ipc: hdr 0x%x rx (%d) > tx (%d)", hdr->cmd,
+			  desc->size, hdr->size);
+	}
 
 	platform_shared_commit(hdr, hdr->size);
 
@@ -336,17 +380,14 @@ error:
 static int ipc_stream_pcm_free(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_stream free_req;
+	const struct sof_ipc_stream *free_req = ipc_msg_get(ipc);
 	struct ipc_comp_dev *pcm_dev;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(free_req, ipc->comp_data);
-
 	/* get the pcm_dev */
-	pcm_dev = ipc_get_comp_by_id(ipc, free_req.comp_id);
+	pcm_dev = ipc_get_comp_by_id(ipc, free_req->comp_id);
 	if (pcm_dev == NULL) {
-		trace_ipc_error("ipc: comp %d not found", free_req.comp_id);
+		trace_ipc_error("ipc: comp %d not found", free_req->comp_id);
 		return -ENODEV;
 	}
 
@@ -354,12 +395,12 @@ static int ipc_stream_pcm_free(uint32_t header)
 	if (!cpu_is_me(pcm_dev->core))
 		return ipc_process_on_core(pcm_dev->core);
 
-	trace_ipc("ipc: comp %d -> free", free_req.comp_id);
+	trace_ipc("ipc: comp %d -> free", free_req->comp_id);
 
 	/* sanity check comp */
 	if (pcm_dev->cd->pipeline == NULL) {
 		trace_ipc_error("ipc: comp %d pipeline not found",
-				free_req.comp_id);
+				free_req->comp_id);
 		return -EINVAL;
 	}
 
@@ -375,17 +416,14 @@ static int ipc_stream_pcm_free(uint32_t header)
 static int ipc_stream_position(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_stream stream;
+	const struct sof_ipc_stream *stream = ipc_msg_get(ipc);
 	struct sof_ipc_stream_posn posn;
 	struct ipc_comp_dev *pcm_dev;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(stream, ipc->comp_data);
-
 	/* get the pcm_dev */
-	pcm_dev = ipc_get_comp_by_id(ipc, stream.comp_id);
+	pcm_dev = ipc_get_comp_by_id(ipc, stream->comp_id);
 	if (pcm_dev == NULL) {
-		trace_ipc_error("ipc: comp %d not found", stream.comp_id);
+		trace_ipc_error("ipc: comp %d not found", stream->comp_id);
 		return -ENODEV;
 	}
 
@@ -393,15 +431,15 @@ static int ipc_stream_position(uint32_t header)
 	if (!cpu_is_me(pcm_dev->core))
 		return ipc_process_on_core(pcm_dev->core);
 
-	trace_ipc("ipc: comp %d -> position", stream.comp_id);
+	trace_ipc("ipc: comp %d -> position", stream->comp_id);
 
 	memset(&posn, 0, sizeof(posn));
 
 	/* set message fields - TODO; get others */
 	posn.rhdr.hdr.cmd = SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_POSITION |
-			    stream.comp_id;
+			    stream->comp_id;
 	posn.rhdr.hdr.size = sizeof(posn);
-	posn.comp_id = stream.comp_id;
+	posn.comp_id = stream->comp_id;
 
 	/* get the stream positions and timestamps */
 	pipeline_get_timestamp(pcm_dev->cd->pipeline, pcm_dev->cd, &posn);
@@ -415,6 +453,116 @@ static int ipc_stream_position(uint32_t header)
 	return 1;
 }
 
+#if CONFIG_XRUN_LIGHT_RECOVERY
+/* get xrun recovery statistics of the stream pipeline */
+static int ipc_stream_xrun_stats(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	const struct sof_ipc_stream_xrun_stats *req = ipc_msg_get(ipc);
+	struct sof_ipc_stream_xrun_stats reply;
+	struct pipeline_xrun_stats *stats;
+	struct ipc_comp_dev *pcm_dev;
+
+	/* get the pcm_dev */
+	pcm_dev = ipc_get_comp_by_id(ipc, req->comp_id);
+	if (!pcm_dev || pcm_dev->type != COMP_TYPE_COMPONENT) {
+		trace_ipc_error("ipc: comp %d not found", req->comp_id);
+		return -ENODEV;
+	}
+
+	/* check core */
+	if (!cpu_is_me(pcm_dev->core))
+		return ipc_process_on_core(pcm_dev->core);
+
+	trace_ipc("ipc: comp %d -> xrun stats", req->comp_id);
+
+	stats = &pcm_dev->cd->pipeline->xrun_stats;
+
+	memset(&reply, 0, sizeof(reply));
+	reply.rhdr.hdr.cmd = header;
+	reply.rhdr.hdr.size = sizeof(reply);
+	reply.comp_id = req->comp_id;
+	reply.flags = req->flags;
+	reply.light = stats->light;
+	reply.full = stats->full;
+	reply.silence_bytes = stats->silence_bytes;
+	reply.last_us = stats->last_us;
+	reply.max_us = stats->max_us;
+	reply.total_us = stats->total_us;
+
+	if (req->flags & SOF_IPC_STREAM_XRUN_STATS_CLEAR) {
+		stats->light = 0;
+		stats->full = 0;
+		stats->silence_bytes = 0;
+		stats->last_us = 0;
+		stats->max_us = 0;
+		stats->total_us = 0;
+	}
+
+	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
+
+	/* write data to the outbox */
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+
+	return 1;
+}
+#endif
+
+#if CONFIG_LATENCY_MARKERS
+static uint32_t ipc_ticks_to_us(uint64_t ticks)
+{
+	return ticks * 1000 / clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+}
+
+/* get latency of the frames entering the graph in a pipeline */
+static int ipc_stream_latency(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	const struct sof_ipc_stream_latency *req = ipc_msg_get(ipc);
+	struct sof_ipc_stream_latency reply;
+	struct pipeline_latency *lat;
+	struct ipc_comp_dev *icd;
+
+	icd = ipc_get_comp_by_id(ipc, req->comp_id);
+	if (!icd || icd->type != COMP_TYPE_COMPONENT) {
+		trace_ipc_error("ipc: comp %d not found", req->comp_id);
+		return -ENODEV;
+	}
+
+	/* check core */
+	if (!cpu_is_me(icd->core))
+		return ipc_process_on_core(icd->core);
+
+	trace_ipc("ipc: comp %d -> latency", req->comp_id);
+
+	lat = &icd->cd->pipeline->latency;
+
+	memset(&reply, 0, sizeof(reply));
+	reply.rhdr.hdr.cmd = header;
+	reply.rhdr.hdr.size = sizeof(reply);
+	reply.comp_id = req->comp_id;
+	reply.flags = req->flags;
+	reply.count = lat->count;
+	reply.lost = lat->lost;
+	if (lat->count) {
+		reply.last_us = ipc_ticks_to_us(lat->last);
+		reply.min_us = ipc_ticks_to_us(lat->min);
+		reply.max_us = ipc_ticks_to_us(lat->max);
+		reply.avg_us = ipc_ticks_to_us(lat->total / lat->count);
+	}
+
+	if (req->flags & SOF_IPC_STREAM_LATENCY_CLEAR)
+		latency_clear(icd->cd->pipeline);
+
+	platform_shared_commit(icd, sizeof(*icd));
+
+	/* write data to the outbox */
+	mailbox_hostbox_write(0, &reply, sizeof(reply));
+
+	return 1;
+}
+#endif
+
 /* send stream position */
 int ipc_stream_send_position(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn)
@@ -425,8 +573,25 @@ int ipc_stream_send_position(struct comp_dev *cdev,
 	posn->comp_id = dev_comp_id(cdev);
 
 	mailbox_stream_write(cdev->pipeline->posn_offset, posn, sizeof(*posn));
+#if CONFIG_IPC_POSN_BATCH
+	return ipc_queue_stream_event(ipc_get(), posn->comp_id,
+				      SOF_IPC_STREAM_EVENT_POSITION);
+#else
 	return ipc_queue_host_message(ipc_get(), posn->rhdr.hdr.cmd, posn,
 				      sizeof(*posn), false);
+#endif
+}
+
+/* update stream position slot, host polls it or reads it on notification */
+void ipc_stream_update_position(struct comp_dev *cdev,
+				struct sof_ipc_stream_posn *posn)
+{
+	posn->rhdr.hdr.cmd = SOF_IPC_GLB_STREAM_MSG | SOF_IPC_STREAM_POSITION |
+		dev_comp_id(cdev);
+	posn->rhdr.hdr.size = sizeof(*posn);
+	posn->comp_id = dev_comp_id(cdev);
+
+	mailbox_stream_write(cdev->pipeline->posn_offset, posn, sizeof(*posn));
 }
 
 /* send component notification */
@@ -443,7 +608,7 @@ int ipc_send_comp_notification(const struct comp_dev *cdev,
 				      sizeof(*event), false);
 }
 
-/* send stream position TODO: send compound message  */
+/* send stream XRUN */
 int ipc_stream_send_xrun(struct comp_dev *cdev,
 	struct sof_ipc_stream_posn *posn)
 {
@@ -454,26 +619,28 @@ int ipc_stream_send_xrun(struct comp_dev *cdev,
 	posn->comp_id = dev_comp_id(cdev);
 
 	mailbox_stream_write(cdev->pipeline->posn_offset, posn, sizeof(*posn));
+#if CONFIG_IPC_POSN_BATCH
+	return ipc_queue_stream_event(ipc_get(), posn->comp_id,
+				      SOF_IPC_STREAM_EVENT_XRUN);
+#else
 	return ipc_queue_host_message(ipc_get(), posn->rhdr.hdr.cmd, posn,
 				      sizeof(*posn), false);
+#endif
 }
 
 static int ipc_stream_trigger(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
+	const struct sof_ipc_stream *stream = ipc_msg_get(ipc);
 	struct ipc_comp_dev *pcm_dev;
-	struct sof_ipc_stream stream;
 	uint32_t ipc_cmd = iCS(header);
 	uint32_t cmd;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(stream, ipc->comp_data);
-
 	/* get the pcm_dev */
-	pcm_dev = ipc_get_comp_by_id(ipc, stream.comp_id);
+	pcm_dev = ipc_get_comp_by_id(ipc, stream->comp_id);
 	if (pcm_dev == NULL) {
-		trace_ipc_error("ipc: comp %d not found", stream.comp_id);
+		trace_ipc_error("ipc: comp %d not found", stream->comp_id);
 		return -ENODEV;
 	}
 
@@ -481,7 +648,7 @@ static int ipc_stream_trigger(uint32_t header)
 	if (!cpu_is_me(pcm_dev->core))
 		return ipc_process_on_core(pcm_dev->core);
 
-	trace_ipc("ipc: comp %d -> trigger cmd 0x%x", stream.comp_id, ipc_cmd);
+	trace_ipc("ipc: comp %d -> trigger cmd 0x%x", stream->comp_id, ipc_cmd);
 
 	switch (ipc_cmd) {
 	case SOF_IPC_STREAM_TRIG_START:
@@ -508,7 +675,7 @@ static int ipc_stream_trigger(uint32_t header)
 	ret = pipeline_trigger(pcm_dev->cd->pipeline, pcm_dev->cd, cmd);
 	if (ret < 0) {
 		trace_ipc_error("ipc: comp %d trigger 0x%x failed %d",
-				stream.comp_id, ipc_cmd, ret);
+				stream->comp_id, ipc_cmd, ret);
 	}
 
 	platform_shared_commit(pcm_dev, sizeof(*pcm_dev));
@@ -516,68 +683,231 @@ static int ipc_stream_trigger(uint32_t header)
 	return ret;
 }
 
-static int ipc_glb_stream_message(uint32_t header)
+/*
+ * DAI IPC Operations.
+ */
+
+static int ipc_dai_config(uint32_t header)
 {
-	uint32_t cmd = iCS(header);
+	struct ipc *ipc = ipc_get();
+	const struct sof_ipc_dai_config *config = ipc_msg_get(ipc);
 
-	switch (cmd) {
-	case SOF_IPC_STREAM_PCM_PARAMS:
-		return ipc_stream_pcm_params(header);
-	case SOF_IPC_STREAM_PCM_FREE:
-		return ipc_stream_pcm_free(header);
-	case SOF_IPC_STREAM_TRIG_START:
-	case SOF_IPC_STREAM_TRIG_STOP:
-	case SOF_IPC_STREAM_TRIG_PAUSE:
-	case SOF_IPC_STREAM_TRIG_RELEASE:
-	case SOF_IPC_STREAM_TRIG_DRAIN:
-	case SOF_IPC_STREAM_TRIG_XRUN:
-		return ipc_stream_trigger(header);
-	case SOF_IPC_STREAM_POSITION:
-		return ipc_stream_position(header);
-	default:
-		trace_ipc_error("ipc: unknown stream cmd 0x%x", cmd);
-		return -EINVAL;
-	}
+	trace_ipc("ipc: dai %d.%d -> config ", config->type,
+		  config->dai_index);
+
+	/* send params to all DAI components who use that physical DAI */
+	return ipc_comp_dai_config(ipc, (struct sof_ipc_dai_config *)config);
 }
 
 /*
- * DAI IPC Operations.
+ * PM IPC Operations.
  */
 
-static int ipc_dai_config(uint32_t header)
+#if CONFIG_HOST_PTABLE
+/*
+ * The PM context is the heap image from mm_pm_context_save() followed by
+ * this IPC state. The topology objects live in the saved heaps, so restore
+ * only has to relink the component list and retake the DMAC and DAI
+ * references held by the host and dai components. The trace buffers and
+ * pipeline tasks are still allocated in the image, restore frees them.
+ */
+struct ipc_pm_state {
+	struct list_item comp_list;
+	void *trace_buf;			/* DMA trace local buffer */
+	struct dma_sg_elem *trace_elems;	/* DMA trace host pages */
+	uint32_t num_refs;
+	int32_t refs[];		/* DMAC then DAI share counts */
+};
+
+static uint32_t ipc_pm_num_refs(void)
 {
-	struct ipc *ipc = ipc_get();
-	struct sof_ipc_dai_config config;
+	const struct dai_info *info = dai_info_get();
+	uint32_t refs = dma_info_get()->num_dmas;
+	int i;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(config, ipc->comp_data);
+	for (i = 0; i < info->num_dai_types; i++)
+		refs += info->dai_type_array[i].num_dais;
 
-	trace_ipc("ipc: dai %d.%d -> config ", config.type,
-		  config.dai_index);
+	return refs;
+}
 
-	/* send params to all DAI components who use that physical DAI */
-	return ipc_comp_dai_config(ipc,
-				   (struct sof_ipc_dai_config *)ipc->comp_data);
+static uint32_t ipc_pm_state_size(void)
+{
+	return ALIGN_UP(sizeof(struct ipc_pm_state) +
+			ipc_pm_num_refs() * sizeof(int32_t),
+			PLATFORM_DCACHE_ALIGN);
 }
 
-static int ipc_glb_dai_message(uint32_t header)
+static void ipc_pm_refs_save(int32_t *refs)
 {
-	uint32_t cmd = iCS(header);
+	const struct dma_info *dmas = dma_info_get();
+	const struct dai_info *dais = dai_info_get();
+	const struct dai_type_info *dti;
+	int i;
+	int j;
+
+	for (i = 0; i < dmas->num_dmas; i++)
+		*refs++ = dmas->dma_array[i].sref;
+
+	for (i = 0; i < dais->num_dai_types; i++) {
+		dti = &dais->dai_type_array[i];
+		for (j = 0; j < dti->num_dais; j++)
+			*refs++ = dti->dai_array[j].sref;
+	}
+}
 
-	switch (cmd) {
-	case SOF_IPC_DAI_CONFIG:
-		return ipc_dai_config(header);
-	case SOF_IPC_DAI_LOOPBACK:
-		//return ipc_comp_set_value(header, COMP_CMD_LOOPBACK);
-	default:
-		trace_ipc_error("ipc: unknown DAI cmd 0x%x", cmd);
-		return -EINVAL;
+static void ipc_pm_refs_restore(const int32_t *refs)
+{
+	const struct dma_info *dmas = dma_info_get();
+	const struct dai_info *dais = dai_info_get();
+	const struct dai_type_info *dti;
+	struct dma *dma;
+	struct dai *dai;
+	int i;
+	int j;
+
+	/* probe again on first use, driver data is not in the image */
+	for (i = 0; i < dmas->num_dmas; i++, refs++) {
+		dma = &dmas->dma_array[i];
+		spin_lock(&dma->lock);
+		if (*refs > dma->sref && (dma->sref || !dma_probe(dma)))
+			dma->sref = *refs;
+		platform_shared_commit(dma, sizeof(*dma));
+		spin_unlock(&dma->lock);
+	}
+
+	for (i = 0; i < dais->num_dai_types; i++) {
+		dti = &dais->dai_type_array[i];
+		for (j = 0; j < dti->num_dais; j++, refs++) {
+			dai = &dti->dai_array[j];
+			spin_lock(&dai->lock);
+			if (*refs > dai->sref && (dai->sref || !dai_probe(dai)))
+				dai->sref = *refs;
+			platform_shared_commit(dai, sizeof(*dai));
+			spin_unlock(&dai->lock);
+		}
 	}
 }
 
-/*
- * PM IPC Operations.
+/* all streams must be reset, resources are taken again on params */
+static int ipc_pm_topology_check(struct ipc *ipc)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type == COMP_TYPE_COMPONENT &&
+		    icd->cd->state > COMP_STATE_READY) {
+			trace_ipc_error("ipc: pm comp %d state %d not reset",
+					icd->id, icd->cd->state);
+			return -EBUSY;
+		}
+	}
+
+	return 0;
+}
+
+/* scheduler data is not in the image, the task is recreated on the next
+ * pipeline prepare. Restored tasks were never registered with this boot's
+ * schedulers and are only given back to the heap.
  */
+static void ipc_pm_pipe_tasks_free(struct ipc *ipc, bool registered)
+{
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type == COMP_TYPE_PIPELINE &&
+		    icd->pipeline->pipe_task) {
+			if (registered)
+				schedule_task_free(icd->pipeline->pipe_task);
+			rfree(icd->pipeline->pipe_task);
+			icd->pipeline->pipe_task = NULL;
+		}
+	}
+}
+
+/* the context has its own host DMA channel, trace keeps running on its own */
+static int ipc_pm_dma_get(struct dma_copy *dc)
+{
+	int ret;
+
+	ret = dma_copy_new(dc);
+	if (ret < 0 && dc->dmac)
+		dma_put(dc->dmac);
+
+	return ret;
+}
+
+static void ipc_pm_dma_put(struct dma_copy *dc)
+{
+	dma_copy_free(dc);
+	dma_put(dc->dmac);
+}
+
+/* parse host pages into system runtime memory, outside of the image */
+static int ipc_pm_host_buffer(struct ipc *ipc, struct sof_ipc_pm_ctx *pm_ctx,
+			      uint32_t direction, struct dma_sg_config *sg)
+{
+	struct dma_sg_elem_array elem_array;
+	uint32_t ring_size;
+	size_t size;
+	int err;
+
+	err = ipc_process_host_buffer(ipc, &pm_ctx->buffer, direction,
+				      &elem_array, &ring_size);
+	if (err < 0)
+		return err;
+
+	size = sizeof(*elem_array.elems) * elem_array.count;
+	dma_sg_init(&sg->elem_array);
+	sg->elem_array.elems = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+				       SOF_MEM_CAPS_RAM, size);
+	if (sg->elem_array.elems) {
+		memcpy_s(sg->elem_array.elems, size, elem_array.elems, size);
+		sg->elem_array.count = elem_array.count;
+	} else {
+		err = -ENOMEM;
+	}
+
+	dma_sg_free(&elem_array);
+
+	return err;
+}
+
+static int ipc_pm_state_copy(struct dma_copy *dc, struct dma_sg_config *sg,
+			     int32_t offset, struct ipc_pm_state *state,
+			     bool to_host)
+{
+	uint32_t size = ipc_pm_state_size();
+	uint32_t done = 0;
+	int ret;
+
+	if (to_host)
+		dcache_writeback_region(state, size);
+
+	while (done < size) {
+		if (to_host)
+			ret = dma_copy_to_host_nowait(dc, sg, offset + done,
+						      (char *)state + done,
+						      size - done);
+		else
+			ret = dma_copy_from_host_nowait(dc, sg, offset + done,
+							(char *)state + done,
+							size - done);
+		if (ret < 0)
+			return ret;
+
+		done += ret;
+	}
+
+	if (!to_host)
+		dcache_invalidate_region(state, size);
+
+	return 0;
+}
 
 static int ipc_pm_context_size(uint32_t header)
 {
@@ -587,26 +917,86 @@ static int ipc_pm_context_size(uint32_t header)
 
 	bzero(&pm_ctx, sizeof(pm_ctx));
 
-	/* TODO: calculate the context and size of host buffers required */
+	pm_ctx.hdr.cmd = header;
+	pm_ctx.hdr.size = sizeof(pm_ctx);
+	pm_ctx.size = mm_pm_context_size() + ipc_pm_state_size();
 
 	/* write the context to the host driver */
-	//mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
+	mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
 
-	return 0;
+	return 1;
 }
 
 static int ipc_pm_context_save(uint32_t header)
 {
-	//struct sof_ipc_pm_ctx *pm_ctx = _ipc->comp_data;
+#if CONFIG_TRACE
+	struct dma_trace_data *dmat = dma_trace_data_get();
+#endif
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_pm_ctx pm_ctx;
+	struct ipc_pm_state *state;
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	int size;
+	int ret;
+
+	IPC_COPY_CMD(pm_ctx, ipc_msg_get(ipc));
 
 	trace_ipc("ipc: pm -> save");
 
-	/* TODO: check we are inactive - all streams are suspended */
+	/* check we are inactive - all streams are reset */
+	ret = ipc_pm_topology_check(ipc);
+	if (ret < 0)
+		return ret;
+
+	ret = ipc_pm_dma_get(&dc);
+	if (ret < 0)
+		return ret;
+
+	state = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+			SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			ipc_pm_state_size());
+	if (!state) {
+		ret = -ENOMEM;
+		goto out_dma;
+	}
+
+	ret = ipc_pm_host_buffer(ipc, &pm_ctx, SOF_IPC_STREAM_CAPTURE, &sg);
+	if (ret < 0)
+		goto out;
+
+	/* the trace buffer must not change between sizing and saving it */
+#if CONFIG_TRACE
+	dma_trace_suspend(dmat);
+	state->trace_buf = dmat->suspended_addr;
+	state->trace_elems = dmat->config.elem_array.elems;
+#endif
+
+	if (pm_ctx.buffer.size < mm_pm_context_size() + ipc_pm_state_size()) {
+		ret = -ENOSPC;
+		goto out_sg;
+	}
+
+	state->comp_list = ipc->comp_list;
+	state->num_refs = ipc_pm_num_refs();
+	ipc_pm_refs_save(state->refs);
+
+	/* now save the context, no allocations from here until D3 */
+	size = mm_pm_context_save(&dc, &sg);
+	if (size < 0) {
+		ret = size;
+		goto out_sg;
+	}
 
-	/* TODO: mask ALL platform interrupts except DMA */
+	ret = ipc_pm_state_copy(&dc, &sg, size, state, true);
+	if (ret < 0)
+		goto out_sg;
 
-	/* TODO now save the context - create SG buffer config using */
-	//mm_pm_context_save(struct dma_sg_config *sg);
+	/* the image is with the host, nothing can fail anymore */
+	ipc_pm_pipe_tasks_free(ipc, true);
+#if CONFIG_TRACE
+	dma_trace_disable(dmat);
+#endif
 
 	/* mask all DSP interrupts */
 	arch_interrupt_disable_mask(0xffffffff);
@@ -620,45 +1010,173 @@ static int ipc_pm_context_save(uint32_t header)
 
 	/* TODO: disable SSP and DMA HW */
 
-	/* TODO: save the context */
-	//reply.entries_no = 0;
-
 	/* write the context to the host driver */
-	//mailbox_hostbox_write(0, pm_ctx, sizeof(*pm_ctx));
+	pm_ctx.size = size + ipc_pm_state_size();
+	mailbox_hostbox_write(0, &pm_ctx, sizeof(pm_ctx));
 
-	ipc_get()->pm_prepare_D3 = 1;
+	ipc->pm_prepare_D3 = 1;
+
+out_sg:
+#if CONFIG_TRACE
+	/* no-op once trace has been disabled */
+	dma_trace_resume(dmat);
+#endif
+	rfree(sg.elem_array.elems);
+out:
+	rfree(state);
+out_dma:
+	ipc_pm_dma_put(&dc);
 
+	return ret < 0 ? ret : 1;
+}
+
+static int ipc_pm_trace_relocate(bool sys)
+{
+#if CONFIG_TRACE
+	return dma_trace_relocate(dma_trace_data_get(), sys);
+#else
 	return 0;
+#endif
 }
 
 static int ipc_pm_context_restore(uint32_t header)
 {
-	//struct sof_ipc_pm_ctx *pm_ctx = _ipc->comp_data;
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_pm_ctx pm_ctx;
+	struct ipc_pm_state *state;
+	struct dma_sg_config sg;
+	struct dma_copy dc;
+	int size;
+	int ret;
+
+	IPC_COPY_CMD(pm_ctx, ipc_msg_get(ipc));
 
 	trace_ipc("ipc: pm -> restore");
 
-	ipc_get()->pm_prepare_D3 = 0;
+	ipc->pm_prepare_D3 = 0;
+
+	/* the context replaces the topology, it is not loaded again */
+	if (!list_is_empty(&ipc->comp_list))
+		return -EBUSY;
+
+	ret = ipc_pm_dma_get(&dc);
+	if (ret < 0)
+		return ret;
+
+	state = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+			SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			ipc_pm_state_size());
+	if (!state) {
+		ret = -ENOMEM;
+		goto out_dma;
+	}
+
+	ret = ipc_pm_host_buffer(ipc, &pm_ctx, SOF_IPC_STREAM_PLAYBACK, &sg);
+	if (ret < 0)
+		goto out;
+
+	/* The trace buffers of this boot would overlap the restored heaps,
+	 * they wait in system runtime memory.
+	 */
+	ret = ipc_pm_trace_relocate(true);
+	if (ret < 0)
+		goto out_sg;
+
+	size = mm_pm_context_restore(&dc, &sg);
+	if (size < 0) {
+		ret = size;
+		goto out_trace;
+	}
+
+	ret = ipc_pm_state_copy(&dc, &sg, size, state, false);
+	if (ret < 0)
+		goto out_trace;
+
+	if (state->num_refs != ipc_pm_num_refs()) {
+		trace_ipc_error("ipc: pm restore %d refs, expected %d",
+				state->num_refs, ipc_pm_num_refs());
+		ret = -EINVAL;
+		goto out_trace;
+	}
+
+	/* relink the restored components to the list head */
+	if (list_is_empty(&state->comp_list)) {
+		list_init(&ipc->comp_list);
+	} else {
+		ipc->comp_list = state->comp_list;
+		ipc->comp_list.next->prev = &ipc->comp_list;
+		ipc->comp_list.prev->next = &ipc->comp_list;
+	}
+
+	ipc_pm_refs_restore(state->refs);
+
+	/* drop what the saving firmware still had allocated */
+	ipc_pm_pipe_tasks_free(ipc, false);
+	rfree(state->trace_buf);
+	rfree(state->trace_elems);
+
+	platform_shared_commit(ipc, sizeof(*ipc));
+
+out_trace:
+	/* back to the heaps, in the free space of the restored ones */
+	ipc_pm_trace_relocate(false);
+out_sg:
+	rfree(sg.elem_array.elems);
+out:
+	rfree(state);
+out_dma:
+	ipc_pm_dma_put(&dc);
+
+	return ret;
+}
 
-	/* restore context placeholder */
-	//mailbox_hostbox_write(0, pm_ctx, sizeof(*pm_ctx));
+#else
+
+static int ipc_pm_context_size(uint32_t header)
+{
+	trace_ipc("ipc: pm -> size");
+
+	return -ENOTSUP;
+}
+
+static int ipc_pm_context_save(uint32_t header)
+{
+	trace_ipc("ipc: pm -> save");
+
+	/* mask all DSP interrupts */
+	arch_interrupt_disable_mask(0xffffffff);
+
+	/* TODO: stop ALL timers */
+	platform_timer_stop(timer_get());
+
+	ipc_get()->pm_prepare_D3 = 1;
 
 	return 0;
 }
 
+static int ipc_pm_context_restore(uint32_t header)
+{
+	trace_ipc("ipc: pm -> restore");
+
+	ipc_get()->pm_prepare_D3 = 0;
+
+	return 0;
+}
+
+#endif
+
 static int ipc_pm_core_enable(uint32_t header)
 {
-	struct sof_ipc_pm_core_config pm_core_config;
+	const struct sof_ipc_pm_core_config *pm_core_config =
+		ipc_msg_get(ipc_get());
 	int i = 0;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(pm_core_config, ipc_get()->comp_data);
-
 	trace_ipc("ipc: pm core mask 0x%x -> enable",
-		  pm_core_config.enable_mask);
+		  pm_core_config->enable_mask);
 
 	for (i = 0; i < PLATFORM_CORE_COUNT; i++) {
 		if (i != PLATFORM_MASTER_CORE_ID) {
-			if (pm_core_config.enable_mask & (1 << i))
+			if (pm_core_config->enable_mask & (1 << i))
 				cpu_enable_core(i);
 			else
 				cpu_disable_core(i);
@@ -670,54 +1188,96 @@ static int ipc_pm_core_enable(uint32_t header)
 
 static int ipc_pm_gate(uint32_t header)
 {
-	struct sof_ipc_pm_gate pm_gate;
-
-	IPC_COPY_CMD(pm_gate, ipc_get()->comp_data);
+	const struct sof_ipc_pm_gate *pm_gate = ipc_msg_get(ipc_get());
 
 	/* pause dma trace firstly if needed */
-	if (pm_gate.flags & SOF_PM_NO_TRACE)
+	if (pm_gate->flags & SOF_PM_NO_TRACE)
 		trace_off();
 
-	if (pm_gate.flags & SOF_PM_PPG)
+	if (pm_gate->flags & SOF_PM_PPG)
 		pm_runtime_disable(PM_RUNTIME_DSP, PLATFORM_MASTER_CORE_ID);
 	else
 		pm_runtime_enable(PM_RUNTIME_DSP, PLATFORM_MASTER_CORE_ID);
 
 	/* resume dma trace if needed */
-	if (!(pm_gate.flags & SOF_PM_NO_TRACE))
+	if (!(pm_gate->flags & SOF_PM_NO_TRACE))
 		trace_on();
 
 	return 0;
 }
 
-static int ipc_glb_pm_message(uint32_t header)
+/*
+ * Debug IPC Operations.
+ */
+#if CONFIG_INTERRUPT_STATS
+static int ipc_irq_stats(uint32_t header)
 {
-	uint32_t cmd = iCS(header);
+	struct sof_ipc_irq_stats *stats = ipc_get()->comp_data;
+	uint32_t size = MIN(MAILBOX_HOSTBOX_SIZE, SOF_IPC_MSG_MAX_SIZE);
+	int ret;
 
-	switch (cmd) {
-	case SOF_IPC_PM_CTX_SAVE:
-		return ipc_pm_context_save(header);
-	case SOF_IPC_PM_CTX_RESTORE:
-		return ipc_pm_context_restore(header);
-	case SOF_IPC_PM_CTX_SIZE:
-		return ipc_pm_context_size(header);
-	case SOF_IPC_PM_CORE_ENABLE:
-		return ipc_pm_core_enable(header);
-	case SOF_IPC_PM_GATE:
-		return ipc_pm_gate(header);
-	case SOF_IPC_PM_CLK_SET:
-	case SOF_IPC_PM_CLK_GET:
-	case SOF_IPC_PM_CLK_REQ:
-	default:
-		trace_ipc_error("ipc: unknown pm cmd 0x%x", cmd);
+	ret = interrupt_stats_info(stats, size);
+	if (ret < 0) {
+		trace_ipc_error("ipc_irq_stats() error: %d", ret);
+		return ret;
+	}
+
+	trace_ipc("ipc_irq_stats() first %u records %u of %u",
+		  stats->first, stats->num_recs, stats->total);
+
+	/* write data to the outbox */
+	mailbox_hostbox_write(0, stats, stats->rhdr.hdr.size);
+
+	return 1;
+}
+#endif
+
+#if CONFIG_IPC_STATS
+static int ipc_ipc_stats(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	struct sof_ipc_ipc_stats *stats = ipc->comp_data;
+	uint32_t type = stats->glb_type >> SOF_GLB_TYPE_SHIFT;
+	int i;
+
+	if (stats->glb_type & ~SOF_GLB_TYPE_MASK) {
+		trace_ipc_error("ipc_ipc_stats() error: type 0x%x",
+				stats->glb_type);
 		return -EINVAL;
 	}
+
+	stats->time = ipc->stats[type];
+	stats->rhdr.hdr.size = sizeof(*stats);
+
+	if (stats->flags & SOF_IPC_STATS_CLEAR)
+		for (i = 0; i < IPC_STATS_TYPES; i++)
+			bzero(&ipc->stats[i], sizeof(ipc->stats[i]));
+
+	platform_shared_commit(ipc, sizeof(*ipc));
+
+	/* write data to the outbox */
+	mailbox_hostbox_write(0, stats, stats->rhdr.hdr.size);
+
+	return 1;
+}
+
+/* mailbox read to reply time of the messages handled by the master core */
+static void ipc_stats_add(struct ipc *ipc, uint32_t cmd)
+{
+	uint32_t time = platform_timer_get(timer_get()) - ipc->msg_start;
+	uint32_t type = iGS(cmd) >> SOF_GLB_TYPE_SHIFT;
+
+	/* entry 0 counts all messages */
+	hist_add(&ipc->stats[0], time);
+	if (type)
+		hist_add(&ipc->stats[type], time);
+
+	ipc->msg_start = 0;
+	platform_shared_commit(ipc, sizeof(*ipc));
 }
+#endif
 
 #if CONFIG_TRACE
-/*
- * Debug IPC Operations.
- */
 static int ipc_dma_trace_config(uint32_t header)
 {
 #if CONFIG_HOST_PTABLE
@@ -731,7 +1291,7 @@ static int ipc_dma_trace_config(uint32_t header)
 	int err;
 
 	/* copy message with ABI safe method */
-	IPC_COPY_CMD(params, ipc->comp_data);
+	IPC_COPY_CMD(params, ipc_msg_get(ipc));
 
 	if (iCS(header) == SOF_IPC_TRACE_DMA_PARAMS_EXT)
 		platform_timer_set_delta(timer, params.timestamp_ns);
@@ -793,29 +1353,6 @@ int ipc_dma_trace_send_position(void)
 	return ipc_queue_host_message(ipc_get(), posn.rhdr.hdr.cmd, &posn,
 				      sizeof(posn), true);
 }
-
-static int ipc_glb_debug_message(uint32_t header)
-{
-	uint32_t cmd = iCS(header);
-
-	trace_ipc("ipc: debug cmd 0x%x", cmd);
-
-	switch (cmd) {
-	case SOF_IPC_TRACE_DMA_PARAMS:
-	case SOF_IPC_TRACE_DMA_PARAMS_EXT:
-		return ipc_dma_trace_config(header);
-	default:
-		trace_ipc_error("ipc: unknown debug cmd 0x%x", cmd);
-		return -EINVAL;
-	}
-}
-#else
-static int ipc_glb_debug_message(uint32_t header)
-{
-	/* traces are disabled - CONFIG_TRACE is not set */
-
-	return -EINVAL;
-}
 #endif
 
 static int ipc_glb_gdb_debug(uint32_t header)
@@ -989,41 +1526,6 @@ static int ipc_probe_info(uint32_t header)
 
 	return ret;
 }
-
-static int ipc_glb_probe(uint32_t header)
-{
-	uint32_t cmd = iCS(header);
-
-	tracev_ipc("ipc: probe cmd 0x%x", cmd);
-
-	switch (cmd) {
-	case SOF_IPC_PROBE_INIT:
-		return ipc_probe_init(header);
-	case SOF_IPC_PROBE_DEINIT:
-		return ipc_probe_deinit(header);
-	case SOF_IPC_PROBE_DMA_ADD:
-		return ipc_probe_dma_add(header);
-	case SOF_IPC_PROBE_DMA_REMOVE:
-		return ipc_probe_dma_remove(header);
-	case SOF_IPC_PROBE_POINT_ADD:
-		return ipc_probe_point_add(header);
-	case SOF_IPC_PROBE_POINT_REMOVE:
-		return ipc_probe_point_remove(header);
-	case SOF_IPC_PROBE_DMA_INFO:
-	case SOF_IPC_PROBE_POINT_INFO:
-		return ipc_probe_info(header);
-	default:
-		trace_ipc_error("ipc: unknown probe cmd 0x%x", cmd);
-		return -EINVAL;
-	}
-}
-#else
-static inline int ipc_glb_probe(uint32_t header)
-{
-	trace_ipc_error("ipc_glb_probe() error: Probes not enabled by Kconfig.");
-
-	return -EINVAL;
-}
 #endif
 
 /*
@@ -1080,47 +1582,45 @@ static int ipc_comp_value(uint32_t header, uint32_t cmd)
 	return ret;
 }
 
-static int ipc_glb_comp_message(uint32_t header)
+static int ipc_comp_set_value(uint32_t header)
 {
-	uint32_t cmd = iCS(header);
+	return ipc_comp_value(header, COMP_CMD_SET_VALUE);
+}
 
-	switch (cmd) {
-	case SOF_IPC_COMP_SET_VALUE:
-		return ipc_comp_value(header, COMP_CMD_SET_VALUE);
-	case SOF_IPC_COMP_GET_VALUE:
-		return ipc_comp_value(header, COMP_CMD_GET_VALUE);
-	case SOF_IPC_COMP_SET_DATA:
-		return ipc_comp_value(header, COMP_CMD_SET_DATA);
-	case SOF_IPC_COMP_GET_DATA:
-		return ipc_comp_value(header, COMP_CMD_GET_DATA);
-	default:
-		trace_ipc_error("ipc: unknown comp cmd 0x%x", cmd);
-		return -EINVAL;
-	}
+static int ipc_comp_get_value(uint32_t header)
+{
+	return ipc_comp_value(header, COMP_CMD_GET_VALUE);
+}
+
+static int ipc_comp_set_data(uint32_t header)
+{
+	return ipc_comp_value(header, COMP_CMD_SET_DATA);
+}
+
+static int ipc_comp_get_data(uint32_t header)
+{
+	return ipc_comp_value(header, COMP_CMD_GET_DATA);
 }
 
 static int ipc_glb_tplg_comp_new(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_comp comp;
+	const struct sof_ipc_comp *comp = ipc_msg_get(ipc);
 	struct sof_ipc_comp_reply reply;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(comp, ipc->comp_data);
-
 	/* check core */
-	if (!cpu_is_me(comp.core))
-		return ipc_process_on_core(comp.core);
+	if (!cpu_is_me(comp->core))
+		return ipc_process_on_core(comp->core);
 
-	trace_ipc("ipc: pipe %d comp %d -> new (type %d)", comp.pipeline_id,
-		  comp.id, comp.type);
+	trace_ipc("ipc: pipe %d comp %d -> new (type %d)", comp->pipeline_id,
+		  comp->id, comp->type);
 
 	/* register component */
-	ret = ipc_comp_new(ipc, (struct sof_ipc_comp *)ipc->comp_data);
+	ret = ipc_comp_new(ipc, (struct sof_ipc_comp *)comp);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d comp %d creation failed %d",
-				comp.pipeline_id, comp.id, ret);
+				comp->pipeline_id, comp->id, ret);
 		return ret;
 	}
 
@@ -1136,26 +1636,23 @@ static int ipc_glb_tplg_comp_new(uint32_t header)
 static int ipc_glb_tplg_buffer_new(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_buffer ipc_buffer;
+	const struct sof_ipc_buffer *ipc_buffer = ipc_msg_get(ipc);
 	struct sof_ipc_comp_reply reply;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(ipc_buffer, ipc->comp_data);
-
 	/* check core */
-	if (!cpu_is_me(ipc_buffer.comp.core))
-		return ipc_process_on_core(ipc_buffer.comp.core);
+	if (!cpu_is_me(ipc_buffer->comp.core))
+		return ipc_process_on_core(ipc_buffer->comp.core);
 
 	trace_ipc("ipc: pipe %d buffer %d -> new (0x%x bytes)",
-		  ipc_buffer.comp.pipeline_id, ipc_buffer.comp.id,
-		  ipc_buffer.size);
+		  ipc_buffer->comp.pipeline_id, ipc_buffer->comp.id,
+		  ipc_buffer->size);
 
-	ret = ipc_buffer_new(ipc, (struct sof_ipc_buffer *)ipc->comp_data);
+	ret = ipc_buffer_new(ipc, (struct sof_ipc_buffer *)ipc_buffer);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d buffer %d creation failed %d",
-				ipc_buffer.comp.pipeline_id,
-				ipc_buffer.comp.id, ret);
+				ipc_buffer->comp.pipeline_id,
+				ipc_buffer->comp.id, ret);
 		return ret;
 	}
 
@@ -1171,24 +1668,20 @@ static int ipc_glb_tplg_buffer_new(uint32_t header)
 static int ipc_glb_tplg_pipe_new(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_pipe_new ipc_pipeline;
+	const struct sof_ipc_pipe_new *ipc_pipeline = ipc_msg_get(ipc);
 	struct sof_ipc_comp_reply reply;
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(ipc_pipeline, ipc->comp_data);
-
 	/* check core */
-	if (!cpu_is_me(ipc_pipeline.core))
-		return ipc_process_on_core(ipc_pipeline.core);
+	if (!cpu_is_me(ipc_pipeline->core))
+		return ipc_process_on_core(ipc_pipeline->core);
 
-	trace_ipc("ipc: pipe %d -> new", ipc_pipeline.pipeline_id);
+	trace_ipc("ipc: pipe %d -> new", ipc_pipeline->pipeline_id);
 
-	ret = ipc_pipeline_new(ipc,
-			       (struct sof_ipc_pipe_new *)ipc->comp_data);
+	ret = ipc_pipeline_new(ipc, (struct sof_ipc_pipe_new *)ipc_pipeline);
 	if (ret < 0) {
 		trace_ipc_error("ipc: pipe %d creation failed %d",
-				ipc_pipeline.pipeline_id, ret);
+				ipc_pipeline->pipeline_id, ret);
 		return ret;
 	}
 
@@ -1204,101 +1697,303 @@ static int ipc_glb_tplg_pipe_new(uint32_t header)
 static int ipc_glb_tplg_pipe_complete(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_pipe_ready ipc_pipeline;
-
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(ipc_pipeline, ipc->comp_data);
+	const struct sof_ipc_pipe_ready *ipc_pipeline = ipc_msg_get(ipc);
 
-	return ipc_pipeline_complete(ipc, ipc_pipeline.comp_id);
+	return ipc_pipeline_complete(ipc, ipc_pipeline->comp_id);
 }
 
 static int ipc_glb_tplg_comp_connect(uint32_t header)
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_pipe_comp_connect connect;
-
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(connect, ipc->comp_data);
+	const struct sof_ipc_pipe_comp_connect *connect = ipc_msg_get(ipc);
 
 	return ipc_comp_connect(ipc,
-			(struct sof_ipc_pipe_comp_connect *)ipc->comp_data);
+				(struct sof_ipc_pipe_comp_connect *)connect);
+}
+
+#if CONFIG_PIPELINE_EDIT
+static int ipc_glb_tplg_comp_edit(uint32_t header)
+{
+	struct ipc *ipc = ipc_get();
+	const struct sof_ipc_pipe_comp_edit *edit = ipc_msg_get(ipc);
+
+	return ipc_comp_edit(ipc, (struct sof_ipc_pipe_comp_edit *)edit);
 }
+#endif
 
 static int ipc_glb_tplg_free(uint32_t header,
 		int (*free_func)(struct ipc *ipc, uint32_t id))
 {
 	struct ipc *ipc = ipc_get();
-	struct sof_ipc_free ipc_free;
+	const struct sof_ipc_free *ipc_free = ipc_msg_get(ipc);
 	int ret;
 
-	/* copy message with ABI safe method */
-	IPC_COPY_CMD(ipc_free, ipc->comp_data);
-
-	trace_ipc("ipc: comp %d -> free", ipc_free.id);
+	trace_ipc("ipc: comp %d -> free", ipc_free->id);
 
 	/* free the object */
-	ret = free_func(ipc, ipc_free.id);
+	ret = free_func(ipc, ipc_free->id);
 
 	if (ret < 0) {
 		trace_ipc_error("ipc: comp %d free failed %d",
-				ipc_free.id, ret);
+				ipc_free->id, ret);
 	}
 
 	return ret;
 }
 
-static int ipc_glb_tplg_message(uint32_t header)
+static int ipc_glb_tplg_comp_free(uint32_t header)
 {
-	uint32_t cmd = iCS(header);
+	return ipc_glb_tplg_free(header, ipc_comp_free);
+}
 
-	switch (cmd) {
-	case SOF_IPC_TPLG_COMP_NEW:
-		return ipc_glb_tplg_comp_new(header);
-	case SOF_IPC_TPLG_COMP_FREE:
-		return ipc_glb_tplg_free(header, ipc_comp_free);
-	case SOF_IPC_TPLG_COMP_CONNECT:
-		return ipc_glb_tplg_comp_connect(header);
-	case SOF_IPC_TPLG_PIPE_NEW:
-		return ipc_glb_tplg_pipe_new(header);
-	case SOF_IPC_TPLG_PIPE_COMPLETE:
-		return ipc_glb_tplg_pipe_complete(header);
-	case SOF_IPC_TPLG_PIPE_FREE:
-		return ipc_glb_tplg_free(header, ipc_pipeline_free);
-	case SOF_IPC_TPLG_BUFFER_NEW:
-		return ipc_glb_tplg_buffer_new(header);
-	case SOF_IPC_TPLG_BUFFER_FREE:
-		return ipc_glb_tplg_free(header, ipc_buffer_free);
-	default:
-		trace_ipc_error("ipc: unknown tplg header 0x%x", header);
-		return -EINVAL;
-	}
+static int ipc_glb_tplg_pipe_free(uint32_t header)
+{
+	return ipc_glb_tplg_free(header, ipc_pipeline_free);
+}
+
+static int ipc_glb_tplg_buffer_free(uint32_t header)
+{
+	return ipc_glb_tplg_free(header, ipc_buffer_free);
 }
 
 #if CONFIG_DEBUG
-static int ipc_glb_test_message(uint32_t header)
+static int ipc_test_ipc_flood(uint32_t header)
 {
-	uint32_t cmd = iCS(header);
+	return 0; /* just return so next IPC can be sent */
+}
+#endif
 
-	switch (cmd) {
-	case SOF_IPC_TEST_IPC_FLOOD:
-		return 0; /* just return so next IPC can be sent */
-	default:
-		trace_ipc_error("ipc: unknown test header 0x%x", header);
-		return -EINVAL;
-	}
+static int ipc_glb_reply(uint32_t header)
+{
+	return 0;
 }
+
+/*
+ * Command tables, indexed by the command number of each global type.
+ */
+
+#define IPC_CMD(cmd)	((cmd) >> SOF_CMD_TYPE_SHIFT)
+
+static const struct ipc_cmd_desc ipc_reply_cmds[] = {
+	[0] = { ipc_glb_reply, sizeof(struct sof_ipc_cmd_hdr), 0 },
+};
+
+static const struct ipc_cmd_desc ipc_tplg_cmds[] = {
+	[IPC_CMD(SOF_IPC_TPLG_COMP_NEW)] = {
+		ipc_glb_tplg_comp_new, sizeof(struct sof_ipc_comp), 0 },
+	[IPC_CMD(SOF_IPC_TPLG_COMP_FREE)] = {
+		ipc_glb_tplg_comp_free, sizeof(struct sof_ipc_free), 0 },
+	[IPC_CMD(SOF_IPC_TPLG_COMP_CONNECT)] = {
+		ipc_glb_tplg_comp_connect,
+		sizeof(struct sof_ipc_pipe_comp_connect), 0 },
+#if CONFIG_PIPELINE_EDIT
+	[IPC_CMD(SOF_IPC_TPLG_COMP_EDIT)] = {
+		ipc_glb_tplg_comp_edit,
+		sizeof(struct sof_ipc_pipe_comp_edit), 0 },
+#endif
+	[IPC_CMD(SOF_IPC_TPLG_PIPE_NEW)] = {
+		ipc_glb_tplg_pipe_new, sizeof(struct sof_ipc_pipe_new), 0 },
+	[IPC_CMD(SOF_IPC_TPLG_PIPE_FREE)] = {
+		ipc_glb_tplg_pipe_free, sizeof(struct sof_ipc_free), 0 },
+	[IPC_CMD(SOF_IPC_TPLG_PIPE_COMPLETE)] = {
+		ipc_glb_tplg_pipe_complete, sizeof(struct sof_ipc_pipe_ready),
+		0 },
+	[IPC_CMD(SOF_IPC_TPLG_BUFFER_NEW)] = {
+		ipc_glb_tplg_buffer_new, sizeof(struct sof_ipc_buffer), 0 },
+	[IPC_CMD(SOF_IPC_TPLG_BUFFER_FREE)] = {
+		ipc_glb_tplg_buffer_free, sizeof(struct sof_ipc_free), 0 },
+};
+
+static const struct ipc_cmd_desc ipc_pm_cmds[] = {
+	[IPC_CMD(SOF_IPC_PM_CTX_SAVE)] = {
+		ipc_pm_context_save, sizeof(struct sof_ipc_pm_ctx), 0 },
+	[IPC_CMD(SOF_IPC_PM_CTX_RESTORE)] = {
+		ipc_pm_context_restore, sizeof(struct sof_ipc_pm_ctx), 0 },
+	[IPC_CMD(SOF_IPC_PM_CTX_SIZE)] = {
+		ipc_pm_context_size, sizeof(struct sof_ipc_pm_ctx), 0 },
+	[IPC_CMD(SOF_IPC_PM_CORE_ENABLE)] = {
+		ipc_pm_core_enable, sizeof(struct sof_ipc_pm_core_config), 0 },
+	[IPC_CMD(SOF_IPC_PM_GATE)] = {
+		ipc_pm_gate, sizeof(struct sof_ipc_pm_gate), 0 },
+};
+
+/* component commands pass the message to the component and reply in it */
+static const struct ipc_cmd_desc ipc_comp_cmds[] = {
+	[IPC_CMD(SOF_IPC_COMP_SET_VALUE)] = {
+		ipc_comp_set_value, sizeof(struct sof_ipc_ctrl_data),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_COMP_GET_VALUE)] = {
+		ipc_comp_get_value, sizeof(struct sof_ipc_ctrl_data),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_COMP_SET_DATA)] = {
+		ipc_comp_set_data, sizeof(struct sof_ipc_ctrl_data),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_COMP_GET_DATA)] = {
+		ipc_comp_get_data, sizeof(struct sof_ipc_ctrl_data),
+		IPC_CMD_COPY },
+};
+
+/* pipeline_params() lets components update the stream parameters */
+static const struct ipc_cmd_desc ipc_stream_cmds[] = {
+	[IPC_CMD(SOF_IPC_STREAM_PCM_PARAMS)] = {
+		ipc_stream_pcm_params, sizeof(struct sof_ipc_pcm_params),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_STREAM_PCM_FREE)] = {
+		ipc_stream_pcm_free, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_TRIG_START)] = {
+		ipc_stream_trigger, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_TRIG_STOP)] = {
+		ipc_stream_trigger, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_TRIG_PAUSE)] = {
+		ipc_stream_trigger, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_TRIG_RELEASE)] = {
+		ipc_stream_trigger, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_TRIG_DRAIN)] = {
+		ipc_stream_trigger, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_TRIG_XRUN)] = {
+		ipc_stream_trigger, sizeof(struct sof_ipc_stream), 0 },
+	[IPC_CMD(SOF_IPC_STREAM_POSITION)] = {
+		ipc_stream_position, sizeof(struct sof_ipc_stream), 0 },
+#if CONFIG_XRUN_LIGHT_RECOVERY
+	[IPC_CMD(SOF_IPC_STREAM_XRUN_STATS)] = {
+		ipc_stream_xrun_stats, sizeof(struct sof_ipc_stream_xrun_stats),
+		0 },
+#endif
+#if CONFIG_LATENCY_MARKERS
+	[IPC_CMD(SOF_IPC_STREAM_LATENCY)] = {
+		ipc_stream_latency, sizeof(struct sof_ipc_stream_latency), 0 },
+#endif
+};
+
+static const struct ipc_cmd_desc ipc_dai_cmds[] = {
+	[IPC_CMD(SOF_IPC_DAI_CONFIG)] = {
+		ipc_dai_config, sizeof(struct sof_ipc_dai_config), 0 },
+};
+
+/* statistics replies are built in the message */
+static const struct ipc_cmd_desc ipc_debug_cmds[] = {
+#if CONFIG_TRACE
+	[IPC_CMD(SOF_IPC_TRACE_DMA_PARAMS)] = {
+		ipc_dma_trace_config, sizeof(struct sof_ipc_dma_trace_params),
+		0 },
+	[IPC_CMD(SOF_IPC_TRACE_DMA_PARAMS_EXT)] = {
+		ipc_dma_trace_config,
+		sizeof(struct sof_ipc_dma_trace_params_ext), 0 },
+#endif
+#if CONFIG_INTERRUPT_STATS
+	[IPC_CMD(SOF_IPC_TRACE_IRQ_STATS)] = {
+		ipc_irq_stats, sizeof(struct sof_ipc_irq_stats),
+		IPC_CMD_COPY },
+#endif
+#if CONFIG_IPC_STATS
+	[IPC_CMD(SOF_IPC_TRACE_IPC_STATS)] = {
+		ipc_ipc_stats, sizeof(struct sof_ipc_ipc_stats),
+		IPC_CMD_COPY },
+#endif
+};
+
+static const struct ipc_cmd_desc ipc_gdb_cmds[] = {
+	[0] = { ipc_glb_gdb_debug, sizeof(struct sof_ipc_cmd_hdr), 0 },
+};
+
+#if CONFIG_DEBUG
+static const struct ipc_cmd_desc ipc_test_cmds[] = {
+	[IPC_CMD(SOF_IPC_TEST_IPC_FLOOD)] = {
+		ipc_test_ipc_flood, sizeof(struct sof_ipc_cmd_hdr), 0 },
+};
+#endif
+
+/* the probe module keeps the probe descriptors of the message */
+#if CONFIG_PROBE
+static const struct ipc_cmd_desc ipc_probe_cmds[] = {
+	[IPC_CMD(SOF_IPC_PROBE_INIT)] = {
+		ipc_probe_init, sizeof(struct sof_ipc_probe_dma_add_params),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_PROBE_DEINIT)] = {
+		ipc_probe_deinit, sizeof(struct sof_ipc_cmd_hdr), 0 },
+	[IPC_CMD(SOF_IPC_PROBE_DMA_ADD)] = {
+		ipc_probe_dma_add, sizeof(struct sof_ipc_probe_dma_add_params),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_PROBE_DMA_INFO)] = {
+		ipc_probe_info, sizeof(struct sof_ipc_probe_info_params),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_PROBE_DMA_REMOVE)] = {
+		ipc_probe_dma_remove,
+		sizeof(struct sof_ipc_probe_dma_remove_params), IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_PROBE_POINT_ADD)] = {
+		ipc_probe_point_add,
+		sizeof(struct sof_ipc_probe_point_add_params), IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_PROBE_POINT_INFO)] = {
+		ipc_probe_info, sizeof(struct sof_ipc_probe_info_params),
+		IPC_CMD_COPY },
+	[IPC_CMD(SOF_IPC_PROBE_POINT_REMOVE)] = {
+		ipc_probe_point_remove,
+		sizeof(struct sof_ipc_probe_point_remove_params),
+		IPC_CMD_COPY },
+};
 #endif
 
+struct ipc_glb_desc {
+	const struct ipc_cmd_desc *cmds;	/* indexed by command number */
+	uint32_t num_cmds;
+};
+
+#define IPC_GLB(type, table) \
+	[(type) >> SOF_GLB_TYPE_SHIFT] = { table, ARRAY_SIZE(table) }
+
+static const struct ipc_glb_desc ipc_glb_cmds[] = {
+	IPC_GLB(SOF_IPC_GLB_REPLY, ipc_reply_cmds),
+	IPC_GLB(SOF_IPC_GLB_TPLG_MSG, ipc_tplg_cmds),
+	IPC_GLB(SOF_IPC_GLB_PM_MSG, ipc_pm_cmds),
+	IPC_GLB(SOF_IPC_GLB_COMP_MSG, ipc_comp_cmds),
+	IPC_GLB(SOF_IPC_GLB_STREAM_MSG, ipc_stream_cmds),
+	IPC_GLB(SOF_IPC_GLB_DAI_MSG, ipc_dai_cmds),
+	IPC_GLB(SOF_IPC_GLB_TRACE_MSG, ipc_debug_cmds),
+	IPC_GLB(SOF_IPC_GLB_GDB_DEBUG, ipc_gdb_cmds),
+#if CONFIG_DEBUG
+	IPC_GLB(SOF_IPC_GLB_TEST, ipc_test_cmds),
+#endif
+#if CONFIG_PROBE
+	IPC_GLB(SOF_IPC_GLB_PROBE, ipc_probe_cmds),
+#endif
+};
+
+/* returns the handler of a command header, NULL for unknown commands */
+static const struct ipc_cmd_desc *ipc_cmd_find(uint32_t cmd)
+{
+	uint32_t type = iGS(cmd) >> SOF_GLB_TYPE_SHIFT;
+	uint32_t index = iCS(cmd) >> SOF_CMD_TYPE_SHIFT;
+	const struct ipc_glb_desc *glb;
+
+	if (type >= ARRAY_SIZE(ipc_glb_cmds))
+		return NULL;
+
+	glb = &ipc_glb_cmds[type];
+	if (index >= glb->num_cmds || !glb->cmds[index].handler)
+		return NULL;
+
+	return &glb->cmds[index];
+}
+
+
 /*
  * Global IPC Operations.
  */
 
 void ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
 {
+	struct ipc *ipc = ipc_get();
+	const struct ipc_cmd_desc *desc;
 	struct sof_ipc_reply reply;
 	uint32_t type = 0;
 	int ret;
 
+#if CONFIG_IPC_STATS
+	/* messages not read by mailbox_validate() start here */
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID && !ipc->msg_start)
+		ipc->msg_start = platform_timer_get(timer_get());
+#endif
+
 	if (hdr == NULL) {
 		trace_ipc_error("ipc: invalid IPC header.");
 		ret = -EINVAL;
@@ -1306,50 +2001,18 @@ void ipc_cmd(struct sof_ipc_cmd_hdr *hdr)
 	}
 
 	type = iGS(hdr->cmd);
+	ipc->msg = hdr;
 
-	switch (type) {
-	case SOF_IPC_GLB_REPLY:
-		ret = 0;
-		break;
-	case SOF_IPC_GLB_COMPOUND:
-		ret = -EINVAL;	/* TODO */
-		break;
-	case SOF_IPC_GLB_TPLG_MSG:
-		ret = ipc_glb_tplg_message(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_PM_MSG:
-		ret = ipc_glb_pm_message(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_COMP_MSG:
-		ret = ipc_glb_comp_message(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_STREAM_MSG:
-		ret = ipc_glb_stream_message(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_DAI_MSG:
-		ret = ipc_glb_dai_message(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_TRACE_MSG:
-		ret = ipc_glb_debug_message(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_GDB_DEBUG:
-		ret = ipc_glb_gdb_debug(hdr->cmd);
-		break;
-	case SOF_IPC_GLB_PROBE:
-		ret = ipc_glb_probe(hdr->cmd);
-		break;
-#if CONFIG_DEBUG
-	case SOF_IPC_GLB_TEST:
-		ret = ipc_glb_test_message(hdr->cmd);
-		break;
-#endif
-	default:
-		trace_ipc_error("ipc: unknown command type %u", type);
+	desc = ipc_cmd_find(hdr->cmd);
+	if (desc) {
+		ret = desc->handler(hdr->cmd);
+	} else {
+		trace_ipc_error("ipc: unknown command 0x%x", hdr->cmd);
 		ret = -EINVAL;
-		break;
 	}
 
-	platform_shared_commit(hdr, hdr->size);
+	if ((void *)hdr == ipc->comp_data)
+		platform_shared_commit(hdr, hdr->size);
 
 out:
 	tracev_ipc("ipc: last request %d returned %d", type, ret);
@@ -1363,6 +2026,11 @@ out:
 		reply.hdr.size = sizeof(reply);
 		mailbox_hostbox_write(0, &reply, sizeof(reply));
 	}
+
+#if CONFIG_IPC_STATS
+	if (cpu_get_id() == PLATFORM_MASTER_CORE_ID)
+		ipc_stats_add(ipc, hdr ? hdr->cmd : 0);
+#endif
 }
 
 /* locks held by caller */
@@ -1511,6 +2179,76 @@ out:
 	return ret;
 }
 
+#if CONFIG_IPC_POSN_BATCH
+/* Adds stream event to the pending batched notification. Only the first
+ * event after the host took the previous batch needs a new message, later
+ * events just extend or update the queued one.
+ */
+static int ipc_queue_stream_event(struct ipc *ipc, uint32_t comp_id,
+				  uint32_t event)
+{
+	struct sof_ipc_stream_posn_batch *batch;
+	struct ipc_msg *msg;
+	uint32_t flags;
+	uint32_t i;
+	int ret = 0;
+
+	spin_lock_irq(&ipc->lock, flags);
+
+	msg = ipc->posn_batch;
+	if (!msg) {
+		msg = msg_get_empty(ipc);
+		if (!msg) {
+			trace_ipc_error("ipc_queue_stream_event() error: no empty msg for comp %d",
+					comp_id);
+			ret = -EBUSY;
+			goto out;
+		}
+
+		batch = (struct sof_ipc_stream_posn_batch *)msg->tx_data;
+		bzero(batch, sizeof(*batch));
+		batch->rhdr.hdr.cmd = SOF_IPC_GLB_STREAM_MSG |
+				      SOF_IPC_STREAM_POSITION_BATCH;
+		batch->rhdr.hdr.size = sizeof(*batch);
+
+		msg->header = batch->rhdr.hdr.cmd;
+		msg->tx_size = sizeof(*batch);
+		list_item_append(&msg->list, &ipc->msg_list);
+		ipc->posn_batch = msg;
+	}
+
+	batch = (struct sof_ipc_stream_posn_batch *)msg->tx_data;
+
+	/* stream already listed, host will read its latest slot */
+	for (i = 0; i < batch->num_elems; i++) {
+		if (batch->elems[i].comp_id == comp_id) {
+			batch->elems[i].events |= event;
+			goto commit;
+		}
+	}
+
+	if (batch->num_elems >= SOF_IPC_STREAM_POSN_BATCH_MAX) {
+		trace_ipc_error("ipc_queue_stream_event() error: batch full, comp %d",
+				comp_id);
+		ret = -ENOSPC;
+		goto commit;
+	}
+
+	batch->elems[i].comp_id = comp_id;
+	batch->elems[i].events = event;
+	batch->num_elems++;
+	batch->rhdr.hdr.size += sizeof(batch->elems[i]);
+	msg->tx_size = batch->rhdr.hdr.size;
+
+commit:
+	platform_shared_commit(msg, sizeof(*msg));
+
+out:
+	spin_unlock_irq(&ipc->lock, flags);
+	return ret;
+}
+#endif
+
 void ipc_schedule_process(struct ipc *ipc)
 {
 	schedule_task(&ipc->ipc_task, 0, 100);
@@ -19,6 +19,7 @@
 #include <sof/platform.h>
 #include <sof/sof.h>
 #include <sof/spinlock.h>
+#include <sof/string.h>
 #include <ipc/dai.h>
 #include <ipc/header.h>
 #include <ipc/stream.h>
@@ -38,12 +39,26 @@
 int ipc_process_on_core(uint32_t core)
 {
 	struct idc_msg msg = { .header = IDC_MSG_IPC, .core = core, };
+	struct ipc *ipc = ipc_get();
 	int ret;
 
 	/* check if requested core is enabled */
 	if (!cpu_is_core_enabled(core))
 		return -EINVAL;
 
+	/* the other core reads the message from comp_data and its reply
+	 * overwrites the mailbox, so a message read in place is copied first
+	 */
+	if (ipc->msg != ipc->comp_data) {
+		ret = memcpy_s(ipc->comp_data, SOF_IPC_MSG_MAX_SIZE, ipc->msg,
+			       ipc->msg->size);
+		assert(!ret);
+
+		platform_shared_commit(ipc->comp_data, ipc->msg->size);
+		ipc->msg = ipc->comp_data;
+		platform_shared_commit(ipc, sizeof(*ipc));
+	}
+
 	/* send IDC message */
 	ret = idc_send_msg(&msg, IDC_BLOCKING);
 	if (ret < 0)
@@ -402,6 +417,53 @@ int ipc_comp_connect(struct ipc *ipc,
 }
 
 
+#if CONFIG_PIPELINE_EDIT
+int ipc_comp_edit(struct ipc *ipc, struct sof_ipc_pipe_comp_edit *edit)
+{
+	struct ipc_comp_dev *icd;
+	struct ipc_comp_dev *icd_source;
+	struct ipc_comp_dev *icd_sink;
+
+	icd = ipc_get_comp_by_id(ipc, edit->comp_id);
+	if (!icd || icd->type != COMP_TYPE_COMPONENT) {
+		trace_ipc_error("ipc_comp_edit() error: no component %u",
+				edit->comp_id);
+		return -EINVAL;
+	}
+
+	if (!cpu_is_me(icd->core))
+		return ipc_process_on_core(icd->core);
+
+	switch (edit->op) {
+	case SOF_IPC_COMP_EDIT_INSERT:
+		icd_source = ipc_get_comp_by_id(ipc, edit->source_id);
+		icd_sink = ipc_get_comp_by_id(ipc, edit->sink_id);
+		if (!icd_source || icd_source->type != COMP_TYPE_BUFFER ||
+		    !icd_sink || icd_sink->type != COMP_TYPE_BUFFER ||
+		    icd_source->core != icd->core ||
+		    icd_sink->core != icd->core) {
+			trace_ipc_error("ipc_comp_edit() error: invalid buffers %u and %u",
+					edit->source_id, edit->sink_id);
+			return -EINVAL;
+		}
+
+		trace_ipc("ipc: comp %d -> insert between buffers %d and %d",
+			  edit->comp_id, edit->source_id, edit->sink_id);
+
+		return pipeline_edit_insert(icd->cd, icd_source->cb,
+					    icd_sink->cb);
+	case SOF_IPC_COMP_EDIT_REMOVE:
+		trace_ipc("ipc: comp %d -> remove", edit->comp_id);
+
+		return pipeline_edit_remove(icd->cd);
+	default:
+		trace_ipc_error("ipc_comp_edit() error: invalid op %u",
+				edit->op);
+		return -EINVAL;
+	}
+}
+#endif
+
 int ipc_pipeline_new(struct ipc *ipc,
 	struct sof_ipc_pipe_new *pipe_desc)
 {
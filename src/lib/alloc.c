@@ -5,12 +5,15 @@
 // Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
 //         Keyon Jie <yang.jie@linux.intel.com>
 
+#include <sof/audio/buffer_cache.h>
 #include <sof/debug/panic.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/cache.h>
 #include <sof/lib/cpu.h>
 #include <sof/lib/dma.h>
 #include <sof/lib/memory.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
 #include <sof/spinlock.h>
 #include <sof/string.h>
 #include <ipc/topology.h>
@@ -852,11 +855,16 @@ void *_balloc(uint32_t flags, uint32_t caps, size_t bytes, uint32_t alignment)
 	void *ptr = NULL;
 	uint32_t lock_flags;
 
-	spin_lock_irq(&memmap->lock, lock_flags);
+	/* buffers kept in the buffer cache go back to the heap when it is
+	 * short of memory, the cache takes the heap lock to free them
+	 */
+	do {
+		spin_lock_irq(&memmap->lock, lock_flags);
 
-	ptr = _balloc_unlocked(flags, caps, bytes, alignment);
+		ptr = _balloc_unlocked(flags, caps, bytes, alignment);
 
-	spin_unlock_irq(&memmap->lock, lock_flags);
+		spin_unlock_irq(&memmap->lock, lock_flags);
+	} while (!ptr && buffer_cache_trim(bytes));
 
 	return ptr;
 }
@@ -937,44 +945,522 @@ void *_brealloc(void *ptr, uint32_t flags, uint32_t caps, size_t bytes,
 	if (!bytes)
 		return new_ptr;
 
-	spin_lock_irq(&memmap->lock, lock_flags);
+	do {
+		spin_lock_irq(&memmap->lock, lock_flags);
 
-	new_ptr = _balloc_unlocked(flags, caps, bytes, alignment);
+		new_ptr = _balloc_unlocked(flags, caps, bytes, alignment);
 
-	if (new_ptr && ptr)
-		memcpy_s(new_ptr, bytes, ptr, bytes);
+		if (new_ptr && ptr)
+			memcpy_s(new_ptr, bytes, ptr, bytes);
 
-	if (new_ptr)
-		_rfree_unlocked(ptr);
+		if (new_ptr)
+			_rfree_unlocked(ptr);
 
-	spin_unlock_irq(&memmap->lock, lock_flags);
+		spin_unlock_irq(&memmap->lock, lock_flags);
+	} while (!new_ptr && buffer_cache_trim(bytes));
 
 	return new_ptr;
 }
 
-/* TODO: all mm_pm_...() routines to be implemented for IMR storage */
-uint32_t mm_pm_context_size(void)
+/*
+ * PM context image of the runtime and buffer heaps.
+ *
+ * The image starts with a header followed by one record per block map: the
+ * map allocation state and block headers, then the contents of every used
+ * block. Block contents are stored as runs of 32 bit words, each run is a
+ * count of zero words followed by a count of literal words and the literal
+ * words themselves, so idle buffers and zeroed objects cost only a few
+ * bytes. The image is staged through a page sized bounce buffer allocated
+ * from the system runtime zone, which is not part of the image.
+ */
+
+#define MM_PM_CTX_MAGIC		0x4d505043	/* "CPPM" */
+#define MM_PM_CTX_STAGE_SIZE	HOST_PAGE_SIZE
+
+struct mm_pm_ctx_hdr {
+	uint32_t magic;
+	uint32_t size;		/* image size in bytes incl. this header */
+	uint32_t num_heaps;
+	uint32_t num_maps;
+};
+
+struct mm_pm_ctx_heap {
+	struct mm_info info;
+};
+
+struct mm_pm_ctx_map {
+	uint32_t base;
+	uint16_t block_size;
+	uint16_t count;
+	uint16_t free_count;
+	uint16_t first_free;
+};
+
+struct mm_pm_ctx_run {
+	uint16_t zeros;		/* zero words preceding the literals */
+	uint16_t words;		/* literal words following this record */
+};
+
+/* image stream, counts the image size only when dc is NULL */
+struct mm_pm_stream {
+	struct dma_copy *dc;
+	struct dma_sg_config *sg;
+	uint8_t *stage;
+	uint32_t fill;		/* bytes staged */
+	uint32_t pos;		/* read position in staged bytes */
+	uint32_t offset;	/* host buffer offset of the stage */
+	uint32_t size;		/* image bytes streamed so far */
+};
+
+static int mm_pm_flush(struct mm_pm_stream *s)
+{
+	uint32_t done = 0;
+	int ret;
+
+	if (!s->dc || !s->fill)
+		return 0;
+
+	dcache_writeback_region(s->stage, s->fill);
+
+	while (done < s->fill) {
+		ret = dma_copy_to_host_nowait(s->dc, s->sg, s->offset,
+					      s->stage + done, s->fill - done);
+		if (ret < 0)
+			return ret;
+
+		done += ret;
+		s->offset += ret;
+	}
+
+	s->fill = 0;
+
+	return 0;
+}
+
+static int mm_pm_write(struct mm_pm_stream *s, const void *data,
+		       uint32_t bytes)
+{
+	const uint8_t *src = data;
+	uint32_t chunk;
+	int ret;
+
+	s->size += bytes;
+	if (!s->dc)
+		return 0;
+
+	while (bytes) {
+		chunk = MIN(bytes, MM_PM_CTX_STAGE_SIZE - s->fill);
+		memcpy_s(s->stage + s->fill, MM_PM_CTX_STAGE_SIZE - s->fill,
+			 src, chunk);
+		s->fill += chunk;
+		src += chunk;
+		bytes -= chunk;
+
+		if (s->fill == MM_PM_CTX_STAGE_SIZE) {
+			ret = mm_pm_flush(s);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int mm_pm_read(struct mm_pm_stream *s, void *data, uint32_t bytes)
+{
+	uint8_t *dst = data;
+	uint32_t chunk;
+	int ret;
+
+	while (bytes) {
+		if (s->pos == s->fill) {
+			ret = dma_copy_from_host_nowait(s->dc, s->sg,
+							s->offset, s->stage,
+							MM_PM_CTX_STAGE_SIZE);
+			if (ret < 0)
+				return ret;
+
+			dcache_invalidate_region(s->stage, ret);
+			s->offset += ret;
+			s->fill = ret;
+			s->pos = 0;
+		}
+
+		chunk = MIN(bytes, s->fill - s->pos);
+		memcpy_s(dst, bytes, s->stage + s->pos, chunk);
+		s->pos += chunk;
+		dst += chunk;
+		bytes -= chunk;
+	}
+
+	s->size += (uint32_t)(dst - (uint8_t *)data);
+
+	return 0;
+}
+
+/* write used block contents as zero and literal word runs */
+static int mm_pm_save_block(struct mm_pm_stream *s, const uint32_t *words,
+			    uint32_t num_words)
+{
+	struct mm_pm_ctx_run run;
+	uint32_t i = 0;
+	int ret;
+
+	while (i < num_words) {
+		run.zeros = 0;
+		while (i < num_words && !words[i]) {
+			run.zeros++;
+			i++;
+		}
+
+		run.words = 0;
+		while (i + run.words < num_words && words[i + run.words])
+			run.words++;
+
+		ret = mm_pm_write(s, &run, sizeof(run));
+		if (ret < 0)
+			return ret;
+
+		ret = mm_pm_write(s, words + i, run.words * sizeof(*words));
+		if (ret < 0)
+			return ret;
+
+		i += run.words;
+	}
+
+	return 0;
+}
+
+static int mm_pm_restore_block(struct mm_pm_stream *s, uint32_t *words,
+			       uint32_t num_words)
+{
+	struct mm_pm_ctx_run run;
+	uint32_t i = 0;
+	int ret;
+
+	while (i < num_words) {
+		ret = mm_pm_read(s, &run, sizeof(run));
+		if (ret < 0)
+			return ret;
+
+		if (run.zeros + run.words > num_words - i)
+			return -EINVAL;
+
+		bzero(words + i, run.zeros * sizeof(*words));
+		i += run.zeros;
+
+		ret = mm_pm_read(s, words + i, run.words * sizeof(*words));
+		if (ret < 0)
+			return ret;
+
+		i += run.words;
+	}
+
+	return 0;
+}
+
+static int mm_pm_save_map(struct mm_pm_stream *s, struct block_map *map)
+{
+	struct mm_pm_ctx_map ctx_map;
+	uint32_t words = map->block_size / sizeof(uint32_t);
+	int ret;
+	int i;
+
+	ctx_map.base = map->base;
+	ctx_map.block_size = map->block_size;
+	ctx_map.count = map->count;
+	ctx_map.free_count = map->free_count;
+	ctx_map.first_free = map->first_free;
+	ret = mm_pm_write(s, &ctx_map, sizeof(ctx_map));
+	if (ret < 0)
+		return ret;
+
+	ret = mm_pm_write(s, map->block, sizeof(*map->block) * map->count);
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < map->count; i++) {
+		if (!map->block[i].used)
+			continue;
+
+		ret = mm_pm_save_block(s, (uint32_t *)(map->base +
+				       i * map->block_size), words);
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int mm_pm_restore_map(struct mm_pm_stream *s, struct block_map *map)
+{
+	struct mm_pm_ctx_map ctx_map;
+	uint32_t words = map->block_size / sizeof(uint32_t);
+	int ret;
+	int i;
+
+	ret = mm_pm_read(s, &ctx_map, sizeof(ctx_map));
+	if (ret < 0)
+		return ret;
+
+	/* image must come from the same firmware build */
+	if (ctx_map.base != map->base ||
+	    ctx_map.block_size != map->block_size ||
+	    ctx_map.count != map->count) {
+		trace_mem_error("mm_pm_restore_map() error: map 0x%x mismatch",
+				ctx_map.base);
+		return -EINVAL;
+	}
+
+	ret = mm_pm_read(s, map->block, sizeof(*map->block) * map->count);
+	if (ret < 0)
+		return ret;
+
+	map->free_count = ctx_map.free_count;
+	map->first_free = ctx_map.first_free;
+
+	for (i = 0; i < map->count; i++) {
+		if (!map->block[i].used)
+			continue;
+
+		ret = mm_pm_restore_block(s, (uint32_t *)(map->base +
+					  i * map->block_size), words);
+		if (ret < 0)
+			return ret;
+	}
+
+	dcache_writeback_region((void *)map->base,
+				map->count * map->block_size);
+	platform_shared_commit(map->block, sizeof(*map->block) * map->count);
+	platform_shared_commit(map, sizeof(*map));
+
+	return 0;
+}
+
+static int mm_pm_save_heaps(struct mm_pm_stream *s, struct mm_heap *heap,
+			    int count)
 {
+	struct mm_pm_ctx_heap ctx_heap;
+	int ret;
+	int i;
+	int j;
+
+	for (i = 0; i < count; i++, heap++) {
+		ctx_heap.info = heap->info;
+		ret = mm_pm_write(s, &ctx_heap, sizeof(ctx_heap));
+		if (ret < 0)
+			return ret;
+
+		for (j = 0; j < heap->blocks; j++) {
+			ret = mm_pm_save_map(s, &heap->map[j]);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int mm_pm_restore_heaps(struct mm_pm_stream *s, struct mm_heap *heap,
+			       int count)
+{
+	struct mm_pm_ctx_heap ctx_heap;
+	int ret;
+	int i;
+	int j;
+
+	for (i = 0; i < count; i++, heap++) {
+		ret = mm_pm_read(s, &ctx_heap, sizeof(ctx_heap));
+		if (ret < 0)
+			return ret;
+
+		for (j = 0; j < heap->blocks; j++) {
+			ret = mm_pm_restore_map(s, &heap->map[j]);
+			if (ret < 0)
+				return ret;
+		}
+
+		heap->info = ctx_heap.info;
+		platform_shared_commit(heap, sizeof(*heap));
+	}
+
 	return 0;
 }
 
+static uint32_t mm_pm_num_maps(struct mm_heap *heap, int count)
+{
+	uint32_t maps = 0;
+	int i;
+
+	for (i = 0; i < count; i++)
+		maps += heap[i].blocks;
+
+	return maps;
+}
+
+static void mm_pm_hdr_init(struct mm_pm_ctx_hdr *hdr, uint32_t size)
+{
+	struct mm *memmap = memmap_get();
+
+	hdr->magic = MM_PM_CTX_MAGIC;
+	hdr->size = size;
+	hdr->num_heaps = PLATFORM_HEAP_RUNTIME + PLATFORM_HEAP_BUFFER;
+	hdr->num_maps = mm_pm_num_maps(memmap->runtime,
+				       PLATFORM_HEAP_RUNTIME) +
+			mm_pm_num_maps(memmap->buffer, PLATFORM_HEAP_BUFFER);
+}
+
+/* stream the image, the memory map lock must be held */
+static int mm_pm_save(struct mm_pm_stream *s, uint32_t size)
+{
+	struct mm *memmap = memmap_get();
+	struct mm_pm_ctx_hdr hdr;
+	int ret;
+
+	mm_pm_hdr_init(&hdr, size);
+
+	ret = mm_pm_write(s, &hdr, sizeof(hdr));
+	if (ret < 0)
+		return ret;
+
+	ret = mm_pm_save_heaps(s, memmap->runtime, PLATFORM_HEAP_RUNTIME);
+	if (ret < 0)
+		return ret;
+
+	ret = mm_pm_save_heaps(s, memmap->buffer, PLATFORM_HEAP_BUFFER);
+	if (ret < 0)
+		return ret;
+
+	return mm_pm_flush(s);
+}
+
+uint32_t mm_pm_context_size(void)
+{
+	struct mm *memmap = memmap_get();
+	struct mm_pm_stream s = { .dc = NULL };
+	uint32_t flags;
+
+	spin_lock_irq(&memmap->lock, flags);
+	mm_pm_save(&s, 0);
+	spin_unlock_irq(&memmap->lock, flags);
+
+	return s.size;
+}
+
 /*
  * Save the DSP memories that are in use the system and modules.
  * All pipeline and modules must be disabled before calling this functions.
  * No allocations are permitted after calling this and before calling restore.
+ * Returns the number of image bytes written.
  */
 int mm_pm_context_save(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	return -ENOTSUP;
+	struct mm *memmap = memmap_get();
+	struct mm_pm_stream size = { .dc = NULL };
+	struct mm_pm_stream s = { .dc = dc, .sg = sg };
+	int ret;
+
+	s.stage = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+			  SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			  MM_PM_CTX_STAGE_SIZE);
+	if (!s.stage)
+		return -ENOMEM;
+
+	/* The lock keeps the heaps as sized until the image is with the host.
+	 * Interrupts stay on during the DMA, nothing allocates from them
+	 * while the pipelines are reset.
+	 */
+	spin_lock(&memmap->lock);
+
+	mm_pm_save(&size, 0);
+	ret = mm_pm_save(&s, size.size);
+
+	spin_unlock(&memmap->lock);
+
+	rfree(s.stage);
+
+	if (ret < 0) {
+		trace_mem_error("mm_pm_context_save() error: %d", ret);
+		return ret;
+	}
+
+	trace_mem_init("mm_pm_context_save() %d bytes", s.size);
+
+	return s.size;
 }
 
 /*
  * Restore the DSP memories to modules and the system.
  * This must be called immediately after booting before any pipeline work.
+ * Returns the number of image bytes consumed.
  */
 int mm_pm_context_restore(struct dma_copy *dc, struct dma_sg_config *sg)
 {
-	return -ENOTSUP;
+	struct mm *memmap = memmap_get();
+	struct mm_pm_stream s = { .dc = dc, .sg = sg };
+	struct mm_pm_ctx_hdr expected;
+	struct mm_pm_ctx_hdr hdr;
+	int ret;
+	int i;
+
+	s.stage = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+			  SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			  MM_PM_CTX_STAGE_SIZE);
+	if (!s.stage)
+		return -ENOMEM;
+
+	/* as in save, interrupts stay on during the DMA */
+	spin_lock(&memmap->lock);
+
+	/* restored blocks would overlap anything allocated since boot */
+	for (i = 0; i < PLATFORM_HEAP_RUNTIME; i++)
+		if (memmap->runtime[i].info.used) {
+			ret = -EBUSY;
+			goto out;
+		}
+
+	for (i = 0; i < PLATFORM_HEAP_BUFFER; i++)
+		if (memmap->buffer[i].info.used) {
+			ret = -EBUSY;
+			goto out;
+		}
+
+	ret = mm_pm_read(&s, &hdr, sizeof(hdr));
+	if (ret < 0)
+		goto out;
+
+	mm_pm_hdr_init(&expected, hdr.size);
+	if (hdr.magic != expected.magic ||
+	    hdr.num_heaps != expected.num_heaps ||
+	    hdr.num_maps != expected.num_maps) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	ret = mm_pm_restore_heaps(&s, memmap->runtime, PLATFORM_HEAP_RUNTIME);
+	if (ret < 0)
+		goto out;
+
+	ret = mm_pm_restore_heaps(&s, memmap->buffer, PLATFORM_HEAP_BUFFER);
+	if (ret < 0)
+		goto out;
+
+	if (s.size != hdr.size)
+		ret = -EINVAL;
+
+out:
+	spin_unlock(&memmap->lock);
+
+	rfree(s.stage);
+
+	if (ret < 0) {
+		trace_mem_error("mm_pm_context_restore() error: %d", ret);
+		return ret;
+	}
+
+	trace_mem_init("mm_pm_context_restore() %d bytes", s.size);
+
+	return s.size;
 }
 
 void free_heap(enum mem_zone zone)
@@ -1045,6 +1531,7 @@ void heap_trace_all(int force)
 		heap_trace(memmap->buffer, PLATFORM_HEAP_BUFFER);
 		trace_mem_init("heap: runtime status");
 		heap_trace(memmap->runtime, PLATFORM_HEAP_RUNTIME);
+		buffer_cache_trace();
 	}
 
 	memmap->heap_trace_updated = 0;
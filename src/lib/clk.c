@@ -15,6 +15,8 @@
 #include <sof/spinlock.h>
 #include <sof/trace/trace.h>
 #include <user/trace.h>
+#include <config.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* clock tracing */
@@ -105,6 +107,76 @@ uint64_t clock_ms_to_ticks(int clock, uint64_t ms)
 	return ticks;
 }
 
+#if CONFIG_CLOCK_GOVERNOR
+static inline uint32_t clock_gov_hz(uint64_t load_hz, uint32_t margin)
+{
+	uint64_t hz = load_hz * (100 + margin) / 100;
+
+	return hz > UINT32_MAX ? UINT32_MAX : hz;
+}
+
+void clock_gov_update(int clock, uint64_t load_hz, bool immediate)
+{
+	struct clock_info *clk_info = clocks_get() + clock;
+	uint32_t cur_idx = clk_info->current_freq_idx;
+	uint32_t idx = cur_idx;
+	uint32_t up_idx;
+	uint32_t down_idx;
+	uint32_t hz;
+
+	/* lowest level that meets the load plus headroom */
+	hz = clock_gov_hz(load_hz, CONFIG_CLOCK_GOVERNOR_HEADROOM);
+	up_idx = clock_get_nearest_freq_idx(clk_info->freqs,
+					    clk_info->freqs_num, hz);
+
+	/* a lower level must also cover the hysteresis */
+	hz = clock_gov_hz(load_hz, CONFIG_CLOCK_GOVERNOR_HEADROOM +
+			  CONFIG_CLOCK_GOVERNOR_HYSTERESIS);
+	down_idx = clock_get_nearest_freq_idx(clk_info->freqs,
+					      clk_info->freqs_num, hz);
+
+	if (up_idx > cur_idx) {
+		/* scale up at once */
+		idx = up_idx;
+		clk_info->gov_down_count = 0;
+	} else if (down_idx < cur_idx) {
+		/* scale down only when the load stays low */
+		if (immediate || ++clk_info->gov_down_count >=
+		    CONFIG_CLOCK_GOVERNOR_DOWN_WINDOWS) {
+			idx = down_idx;
+			clk_info->gov_down_count = 0;
+		}
+	} else {
+		clk_info->gov_down_count = 0;
+	}
+
+	platform_shared_commit(clk_info, sizeof(*clk_info));
+
+	if (idx == cur_idx)
+		return;
+
+	trace_clk("clock_gov_update() clock %d load %u Hz freq %u Hz",
+		  clock, clock_gov_hz(load_hz, 0),
+		  clk_info->freqs[idx].freq);
+
+	clock_set_freq(clock, clk_info->freqs[idx].freq);
+}
+
+void clock_gov_boost(int clock)
+{
+	struct clock_info *clk_info = clocks_get() + clock;
+	uint32_t max_idx = clk_info->freqs_num - 1;
+
+	clk_info->gov_down_count = 0;
+
+	platform_shared_commit(clk_info, sizeof(*clk_info));
+
+	/* load of a new task is not known until it has run */
+	if (clk_info->current_freq_idx != max_idx)
+		clock_set_freq(clock, clk_info->freqs[max_idx].freq);
+}
+#endif
+
 void platform_timer_set_delta(struct timer *timer, uint64_t ns)
 {
 	struct clock_info *clk_info = clocks_get() + PLATFORM_DEFAULT_CLOCK;
@@ -13,6 +13,22 @@
 #define TWO_Q27         Q_CONVERT_FLOAT(2.0, 27)	  /* Use Q5.27 */
 #define MINUS_TWO_Q27   Q_CONVERT_FLOAT(-2.0, 27)	  /* Use Q5.27 */
 #define LOG10_DIV20_Q27 Q_CONVERT_FLOAT(0.1151292546, 27) /* Use Q5.27 */
+#define DB_PER_LOG2_Q28 Q_CONVERT_FLOAT(6.0205999133, 28) /* Use Q4.28 */
+#define LOG2_PER_DB_Q31 Q_CONVERT_FLOAT(0.1660964047, 31) /* Use Q1.31 */
+#define LIN2DB_MIN_Q24  Q_CONVERT_FLOAT(-127.0, 24)	  /* Use Q8.24 */
+
+/* Least squares fits of log2(1 + t) and 2^t for t in 0 .. 1, the errors
+ * are below 0.01 dB in the conversions. Coefficients are Q2.30.
+ */
+#define LOG2_C1	Q_CONVERT_FLOAT(1.4386380259, 30)
+#define LOG2_C2	Q_CONVERT_FLOAT(-0.6777432665, 30)
+#define LOG2_C3	Q_CONVERT_FLOAT(0.3218797068, 30)
+#define LOG2_C4	Q_CONVERT_FLOAT(-0.0828606982, 30)
+#define EXP2_C1	Q_CONVERT_FLOAT(0.6930175129, 30)
+#define EXP2_C2	Q_CONVERT_FLOAT(0.2414486597, 30)
+#define EXP2_C3	Q_CONVERT_FLOAT(0.0519479527, 30)
+#define EXP2_C4	Q_CONVERT_FLOAT(0.0135816641, 30)
+#define ONE_Q30	Q_CONVERT_FLOAT(1.0, 30)
 
 /* Exponent function for small values of x. This function calculates
  * fairly accurately exponent for x in range -2.0 .. +2.0. The iteration
@@ -115,3 +131,82 @@ int32_t exp_fixed(int32_t x)
 
 	return y;
 }
+
+/* Horner evaluation of c1 * t + c2 * t^2 + c3 * t^3 + c4 * t^4 with t
+ * and the coefficients in Q2.30.
+ */
+static inline int32_t poly4_q30(int32_t t, int32_t c1, int32_t c2, int32_t c3,
+				int32_t c4)
+{
+	int32_t y;
+
+	y = (int32_t)Q_MULTSR_32X32((int64_t)c4, t, 30, 30, 30) + c3;
+	y = (int32_t)Q_MULTSR_32X32((int64_t)y, t, 30, 30, 30) + c2;
+	y = (int32_t)Q_MULTSR_32X32((int64_t)y, t, 30, 30, 30) + c1;
+	return (int32_t)Q_MULTSR_32X32((int64_t)y, t, 30, 30, 30);
+}
+
+/* Linear to decibels conversion for block rate level detectors. The
+ * argument is normalized to m * 2^-n with m in 1 .. 2 and log2(m) is
+ * approximated with a polynomial, so the cost does not depend on the
+ * value like with the exp() iteration.
+ *
+ * Input is Q1.31, values of zero or less return -127 dB
+ * Output is Q8.24, -127.0 .. 0.0
+ */
+int32_t lin2db_fixed(int32_t lin)
+{
+	int32_t log2_q26;
+	int32_t t;
+	int64_t db;
+	int n;
+
+	if (lin <= 0)
+		return LIN2DB_MIN_Q24;
+
+	/* lin << n is 0.5 .. 1 in Q1.31, t is 2 * (lin << n) - 1 in Q2.30 */
+	n = __builtin_clz(lin) - 1;
+	t = (lin << n) - ONE_Q30;
+
+	/* log2(lin) = log2(1 + t) - 1 - n, Q6.26 */
+	log2_q26 = Q_SHIFT_RND(poly4_q30(t, LOG2_C1, LOG2_C2, LOG2_C3, LOG2_C4),
+			       30, 26) - ((1 + n) << 26);
+
+	/* Q6.26 x Q4.28 -> Q8.24 */
+	db = Q_MULTSR_32X32((int64_t)log2_q26, DB_PER_LOG2_Q28, 26, 28, 24);
+	return db < LIN2DB_MIN_Q24 ? LIN2DB_MIN_Q24 : (int32_t)db;
+}
+
+/* Decibels to linear conversion with the same ranges as db2lin_fixed() but
+ * as 2^(db * log2(10) / 20) with a polynomial for the fractional power of
+ * two. It is fast enough to be run for every processed block in gain
+ * computers.
+ *
+ * Input is Q8.24 (max 128.0)
+ * output is Q12.20 (max 2048.0)
+ */
+int32_t db2lin_fast_fixed(int32_t db)
+{
+	int32_t frac;
+	int32_t y;
+	int64_t arg;
+	int i;
+
+	if (db < Q_CONVERT_FLOAT(-100.0, 24))
+		return 0;
+
+	/* Q8.24 x Q1.31 -> Q8.24, integer and fractional power of two */
+	arg = Q_MULTSR_32X32((int64_t)db, LOG2_PER_DB_Q31, 24, 31, 24);
+	i = (int)(arg >> 24);
+	frac = (int32_t)(arg & 0xffffff) << 6;
+
+	if (i > 10)
+		return INT32_MAX;
+
+	/* 2^frac is 1 .. 2 in Q2.30, shift to Q12.20 with 2^i */
+	y = ONE_Q30 + poly4_q30(frac, EXP2_C1, EXP2_C2, EXP2_C3, EXP2_C4);
+	if (i >= 10)
+		return y;
+
+	return ((y >> (9 - i)) + 1) >> 1;
+}
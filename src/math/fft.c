@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/lib/alloc.h>
+#include <sof/math/fft.h>
+#include <sof/math/numbers.h>
+#include <sof/math/trig.h>
+#include <ipc/topology.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Twiddle factor exp(-j*2*pi*k/n) as Q1.31. The angle is kept within
+ * 0 .. 2*pi that is the valid input range of sin_fixed().
+ */
+static void fft_twiddle(struct icomplex32 *w, uint32_t k, uint32_t n)
+{
+	int32_t angle = (int32_t)(((int64_t)PI_MUL2_Q4_28 * k) / n);
+	int32_t angle_cos = angle + PI_DIV2_Q4_28;
+
+	if (angle_cos >= PI_MUL2_Q4_28)
+		angle_cos -= PI_MUL2_Q4_28;
+
+	w->real = sin_fixed(angle_cos);
+	w->imag = -sin_fixed(angle);
+}
+
+static struct icomplex32 *fft_twiddles_new(uint32_t n)
+{
+	struct icomplex32 *w;
+	uint32_t k;
+
+	w = rballoc(0, SOF_MEM_CAPS_RAM, sizeof(*w) * MAX(n / 2, 1));
+	if (!w)
+		return NULL;
+
+	for (k = 0; k < n / 2; k++)
+		fft_twiddle(&w[k], k, n);
+
+	return w;
+}
+
+struct fft_plan *fft_plan_new(uint32_t size)
+{
+	struct fft_plan *plan;
+	uint32_t i;
+
+	/* size must be a power of two */
+	if (size < 2 || size > FFT_SIZE_MAX || (size & (size - 1)))
+		return NULL;
+
+	plan = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       sizeof(*plan));
+	if (!plan)
+		return NULL;
+
+	plan->size = size;
+	plan->len = ffs(size) - 1;
+
+	plan->bit_reverse_idx = rballoc(0, SOF_MEM_CAPS_RAM,
+					sizeof(uint16_t) * size);
+	plan->twiddle = fft_twiddles_new(size);
+	if (!plan->bit_reverse_idx || !plan->twiddle) {
+		fft_plan_free(plan);
+		return NULL;
+	}
+
+	/* reversed index of i is the reversed index of i / 2 shifted right,
+	 * with the low bit of i moved to the top
+	 */
+	plan->bit_reverse_idx[0] = 0;
+	for (i = 1; i < size; i++)
+		plan->bit_reverse_idx[i] =
+			(plan->bit_reverse_idx[i >> 1] >> 1) |
+			((i & 1) << (plan->len - 1));
+
+	return plan;
+}
+
+void fft_plan_free(struct fft_plan *plan)
+{
+	if (!plan)
+		return;
+
+	rfree(plan->bit_reverse_idx);
+	rfree(plan->twiddle);
+	rfree(plan);
+}
+
+static void fft_conjugate(struct icomplex32 *buf, uint32_t size)
+{
+	uint32_t i;
+
+	for (i = 0; i < size; i++)
+		buf[i].imag = sat_int32(-(int64_t)buf[i].imag);
+}
+
+void fft_execute_32(const struct fft_plan *plan, struct icomplex32 *buf,
+		    bool ifft)
+{
+	struct icomplex32 tmp;
+	uint32_t size = plan->size;
+	uint32_t i;
+	uint32_t j;
+
+	/* inverse transform as conj(fft(conj(x))) */
+	if (ifft)
+		fft_conjugate(buf, size);
+
+	for (i = 1; i < size; i++) {
+		j = plan->bit_reverse_idx[i];
+		if (i < j) {
+			tmp = buf[i];
+			buf[i] = buf[j];
+			buf[j] = tmp;
+		}
+	}
+
+	fft_butterflies_32(plan, buf);
+
+	if (ifft)
+		fft_conjugate(buf, size);
+}
+
+struct fft_real_plan *fft_real_plan_new(uint32_t size)
+{
+	struct fft_real_plan *plan;
+
+	if (size < 4)
+		return NULL;
+
+	plan = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+		       sizeof(*plan));
+	if (!plan)
+		return NULL;
+
+	plan->size = size;
+	plan->plan = fft_plan_new(size / 2);
+	plan->twiddle = fft_twiddles_new(size);
+	if (!plan->plan || !plan->twiddle) {
+		fft_real_plan_free(plan);
+		return NULL;
+	}
+
+	return plan;
+}
+
+void fft_real_plan_free(struct fft_real_plan *plan)
+{
+	if (!plan)
+		return;
+
+	fft_plan_free(plan->plan);
+	rfree(plan->twiddle);
+	rfree(plan);
+}
+
+/* The even and odd samples are transformed as one complex sequence
+ * z = x[2n] + j * x[2n + 1] of size / 2 points and separated with
+ * Fe = (Z[k] + conj(Z[M - k])) / 2, Fo = -j * (Z[k] - conj(Z[M - k])) / 2,
+ * X[k] = Fe + W^k * Fo and X[M - k] = conj(Fe - W^k * Fo), M = size / 2.
+ */
+void fft_real_execute_32(const struct fft_real_plan *plan, const int32_t *in,
+			 struct icomplex32 *out)
+{
+	struct icomplex32 fe;
+	struct icomplex32 fo;
+	struct icomplex32 wfo;
+	struct icomplex32 a;
+	struct icomplex32 b;
+	uint32_t m = plan->size / 2;
+	uint32_t k;
+
+	for (k = 0; k < m; k++) {
+		out[k].real = in[2 * k];
+		out[k].imag = in[2 * k + 1];
+	}
+
+	fft_execute_32(plan->plan, out, false);
+
+	for (k = 1; k <= m / 2; k++) {
+		a = out[k];
+		b = out[m - k];
+
+		fe.real = fft_half_sum(a.real, b.real);
+		fe.imag = fft_half_diff(a.imag, b.imag);
+		fo.real = fft_half_sum(a.imag, b.imag);
+		fo.imag = fft_half_diff(b.real, a.real);
+		fft_cmul(&wfo, &plan->twiddle[k], &fo);
+
+		out[m - k].real = fft_half_diff(fe.real, wfo.real);
+		out[m - k].imag = fft_half_diff(wfo.imag, fe.imag);
+		out[k].real = fft_half_sum(fe.real, wfo.real);
+		out[k].imag = fft_half_sum(fe.imag, wfo.imag);
+	}
+
+	/* DC and Nyquist bins are real */
+	a = out[0];
+	out[0].real = fft_half_sum(a.real, a.imag);
+	out[0].imag = 0;
+	out[m].real = fft_half_diff(a.real, a.imag);
+	out[m].imag = 0;
+}
+
+/* Inverse of the split above, Fe = (X[k] + conj(X[M - k])) / 2 and
+ * Fo = (X[k] - conj(X[M - k])) * conj(W^k) / 2 give Z[k] = Fe + j * Fo and
+ * Z[M - k] = conj(Fe) + j * conj(Fo). The inverse of Z is the even and odd
+ * samples interleaved, that is the real output in place.
+ */
+void fft_real_inverse_32(const struct fft_real_plan *plan,
+			 const struct icomplex32 *in, int32_t *out)
+{
+	struct icomplex32 *z = (struct icomplex32 *)out;
+	struct icomplex32 fe;
+	struct icomplex32 fo;
+	struct icomplex32 d;
+	uint32_t m = plan->size / 2;
+	uint32_t k;
+
+	z[0].real = fft_half_sum(in[0].real, in[m].real);
+	z[0].imag = fft_half_diff(in[0].real, in[m].real);
+
+	for (k = 1; k <= m / 2; k++) {
+		fe.real = fft_half_sum(in[k].real, in[m - k].real);
+		fe.imag = fft_half_diff(in[k].imag, in[m - k].imag);
+		d.real = fft_half_diff(in[k].real, in[m - k].real);
+		d.imag = fft_half_sum(in[k].imag, in[m - k].imag);
+		fft_cmul_conj(&fo, &plan->twiddle[k], &d);
+
+		z[m - k].real = sat_int32((int64_t)fe.real + fo.imag);
+		z[m - k].imag = sat_int32((int64_t)fo.real - fe.imag);
+		z[k].real = sat_int32((int64_t)fe.real - fo.imag);
+		z[k].imag = sat_int32((int64_t)fe.imag + fo.real);
+	}
+
+	fft_execute_32(plan->plan, z, true);
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/math/fft_config.h>
+
+#if FFT_GENERIC
+
+#include <sof/audio/format.h>
+#include <sof/math/fft.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* First radix-2 pass of odd log2 sizes, all twiddle factors are one */
+static void fft_radix2_pass(struct icomplex32 *buf, uint32_t size)
+{
+	struct icomplex32 a;
+	struct icomplex32 b;
+	uint32_t k;
+
+	for (k = 0; k < size; k += 2) {
+		a = buf[k];
+		b = buf[k + 1];
+		buf[k].real = fft_half_sum(a.real, b.real);
+		buf[k].imag = fft_half_sum(a.imag, b.imag);
+		buf[k + 1].real = fft_half_diff(a.real, b.real);
+		buf[k + 1].imag = fft_half_diff(a.imag, b.imag);
+	}
+}
+
+/* Two radix-2 stages of half sizes h and 2h merged into one pass over
+ * x0..x3 at stride h. The second stage twiddle of x1 and x3 is
+ * W(4h)^(j + h) = -j * W(4h)^j so three complex products are needed for
+ * four points. With w2 and w4 NULL the twiddle factors are one.
+ */
+static inline void fft_radix4_butterfly(struct icomplex32 *x, uint32_t h,
+					const struct icomplex32 *w2,
+					const struct icomplex32 *w4)
+{
+	struct icomplex32 a;
+	struct icomplex32 b;
+	struct icomplex32 c;
+	struct icomplex32 d;
+	struct icomplex32 t1;
+	struct icomplex32 t3;
+
+	if (w2) {
+		fft_cmul(&t1, w2, &x[h]);
+		fft_cmul(&t3, w2, &x[3 * h]);
+	} else {
+		t1 = x[h];
+		t3 = x[3 * h];
+	}
+
+	a.real = fft_half_sum(x[0].real, t1.real);
+	a.imag = fft_half_sum(x[0].imag, t1.imag);
+	b.real = fft_half_diff(x[0].real, t1.real);
+	b.imag = fft_half_diff(x[0].imag, t1.imag);
+	c.real = fft_half_sum(x[2 * h].real, t3.real);
+	c.imag = fft_half_sum(x[2 * h].imag, t3.imag);
+	d.real = fft_half_diff(x[2 * h].real, t3.real);
+	d.imag = fft_half_diff(x[2 * h].imag, t3.imag);
+
+	if (w4) {
+		fft_cmul(&t1, w4, &c);
+		fft_cmul(&t3, w4, &d);
+	} else {
+		t1 = c;
+		t3 = d;
+	}
+
+	/* -j * W(4h)^j * d */
+	d.real = t3.imag;
+	d.imag = sat_int32(-(int64_t)t3.real);
+
+	x[0].real = fft_half_sum(a.real, t1.real);
+	x[0].imag = fft_half_sum(a.imag, t1.imag);
+	x[2 * h].real = fft_half_diff(a.real, t1.real);
+	x[2 * h].imag = fft_half_diff(a.imag, t1.imag);
+	x[h].real = fft_half_sum(b.real, d.real);
+	x[h].imag = fft_half_sum(b.imag, d.imag);
+	x[3 * h].real = fft_half_diff(b.real, d.real);
+	x[3 * h].imag = fft_half_diff(b.imag, d.imag);
+}
+
+void fft_butterflies_32(const struct fft_plan *plan, struct icomplex32 *buf)
+{
+	const struct icomplex32 *w2;
+	const struct icomplex32 *w4;
+	uint32_t size = plan->size;
+	uint32_t step;
+	uint32_t h = 1;
+	uint32_t j;
+	uint32_t k;
+
+	if (plan->len & 1) {
+		fft_radix2_pass(buf, size);
+		h = 2;
+	}
+
+	for (; h < size; h <<= 2) {
+		/* twiddle index step of the second stage, size / (4h) */
+		step = size / (4 * h);
+
+		for (k = 0; k < size; k += 4 * h)
+			fft_radix4_butterfly(buf + k, h, NULL, NULL);
+
+		for (j = 1; j < h; j++) {
+			w2 = &plan->twiddle[2 * j * step];
+			w4 = &plan->twiddle[j * step];
+			for (k = j; k < size; k += 4 * h)
+				fft_radix4_butterfly(buf + k, h, w2, w4);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/math/fft_config.h>
+
+#if FFT_HIFI3
+
+#include <sof/math/fft.h>
+#include <xtensa/tie/xt_hifi3.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Complex values are kept as real in the high and imaginary in the low
+ * half of a register. They are loaded and stored as two 32 bit words so
+ * that the order does not depend on the 64 bit memory layout.
+ */
+static inline ae_f32x2 fft_load(const struct icomplex32 *x)
+{
+	ae_int32x2 re = AE_L32_I((const ae_int32 *)&x->real, 0);
+	ae_int32x2 im = AE_L32_I((const ae_int32 *)&x->imag, 0);
+
+	return AE_SEL32_LL(re, im);
+}
+
+static inline void fft_store(struct icomplex32 *x, ae_f32x2 v)
+{
+	AE_S32_L_I(AE_SEL32_HH(v, v), (ae_int32 *)&x->real, 0);
+	AE_S32_L_I(v, (ae_int32 *)&x->imag, 0);
+}
+
+/* w * x with rounding and saturation */
+static inline ae_f32x2 fft_cmul_hifi3(ae_f32x2 w, ae_f32x2 x)
+{
+	/* (wr * xr, wr * xi) and (wi * xi, wi * xr) */
+	ae_f32x2 p1 = AE_MULFP32X2RS(x, AE_SEL32_HH(w, w));
+	ae_f32x2 p2 = AE_MULFP32X2RS(AE_SEL32_LH(x, x), AE_SEL32_LL(w, w));
+
+	return AE_SEL32_HL(AE_SUB32S(p1, p2), AE_ADD32S(p1, p2));
+}
+
+/* (a + b) / 2 and (a - b) / 2 */
+static inline void fft_half_sum_diff(ae_f32x2 a, ae_f32x2 b, ae_f32x2 *sum,
+				     ae_f32x2 *diff)
+{
+	a = AE_SRAI32(a, 1);
+	b = AE_SRAI32(b, 1);
+	*sum = AE_ADD32S(a, b);
+	*diff = AE_SUB32S(a, b);
+}
+
+static void fft_radix2_pass(struct icomplex32 *buf, uint32_t size)
+{
+	ae_f32x2 sum;
+	ae_f32x2 diff;
+	uint32_t k;
+
+	for (k = 0; k < size; k += 2) {
+		fft_half_sum_diff(fft_load(&buf[k]), fft_load(&buf[k + 1]),
+				  &sum, &diff);
+		fft_store(&buf[k], sum);
+		fft_store(&buf[k + 1], diff);
+	}
+}
+
+/* Same merged radix-2 stages as the generic version */
+static inline void fft_radix4_butterfly(struct icomplex32 *x, uint32_t h,
+					const struct icomplex32 *w2,
+					const struct icomplex32 *w4)
+{
+	ae_f32x2 x0 = fft_load(&x[0]);
+	ae_f32x2 x1 = fft_load(&x[h]);
+	ae_f32x2 x2 = fft_load(&x[2 * h]);
+	ae_f32x2 x3 = fft_load(&x[3 * h]);
+	ae_f32x2 a;
+	ae_f32x2 b;
+	ae_f32x2 c;
+	ae_f32x2 d;
+	ae_f32x2 w;
+
+	if (w2) {
+		w = fft_load(w2);
+		x1 = fft_cmul_hifi3(w, x1);
+		x3 = fft_cmul_hifi3(w, x3);
+	}
+
+	fft_half_sum_diff(x0, x1, &a, &b);
+	fft_half_sum_diff(x2, x3, &c, &d);
+
+	if (w4) {
+		w = fft_load(w4);
+		c = fft_cmul_hifi3(w, c);
+		d = fft_cmul_hifi3(w, d);
+	}
+
+	/* -j * d is (d.imag, -d.real) */
+	d = AE_SEL32_LH(d, AE_NEG32S(d));
+
+	fft_half_sum_diff(a, c, &x0, &x2);
+	fft_half_sum_diff(b, d, &x1, &x3);
+
+	fft_store(&x[0], x0);
+	fft_store(&x[h], x1);
+	fft_store(&x[2 * h], x2);
+	fft_store(&x[3 * h], x3);
+}
+
+void fft_butterflies_32(const struct fft_plan *plan, struct icomplex32 *buf)
+{
+	const struct icomplex32 *w2;
+	const struct icomplex32 *w4;
+	uint32_t size = plan->size;
+	uint32_t step;
+	uint32_t h = 1;
+	uint32_t j;
+	uint32_t k;
+
+	if (plan->len & 1) {
+		fft_radix2_pass(buf, size);
+		h = 2;
+	}
+
+	for (; h < size; h <<= 2) {
+		/* twiddle index step of the second stage, size / (4h) */
+		step = size / (4 * h);
+
+		for (k = 0; k < size; k += 4 * h)
+			fft_radix4_butterfly(buf + k, h, NULL, NULL);
+
+		for (j = 1; j < h; j++) {
+			w2 = &plan->twiddle[2 * j * step];
+			w4 = &plan->twiddle[j * step];
+			for (k = j; k < size; k += 4 * h)
+				fft_radix4_butterfly(buf + k, h, w2, w4);
+		}
+	}
+}
+
+#endif
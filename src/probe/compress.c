@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/probe/compress.h>
+#include <errno.h>
+#include <stdint.h>
+
+static inline int32_t probe_sample_get(const void *buf,
+				       uint32_t container_bytes, uint32_t idx)
+{
+	if (container_bytes == sizeof(int16_t))
+		return ((const int16_t *)buf)[idx];
+
+	return ((const int32_t *)buf)[idx];
+}
+
+static inline void probe_sample_set(void *buf, uint32_t container_bytes,
+				    uint32_t idx, uint32_t sample)
+{
+	if (container_bytes == sizeof(int16_t))
+		((int16_t *)buf)[idx] = (int16_t)sample;
+	else
+		((int32_t *)buf)[idx] = (int32_t)sample;
+}
+
+/* difference to previous sample of the same channel, zigzag mapped */
+static inline uint32_t probe_delta(const void *src, uint32_t container_bytes,
+				   uint32_t channels, uint32_t idx)
+{
+	uint32_t cur = probe_sample_get(src, container_bytes, idx);
+	uint32_t prev = 0;
+	int32_t delta;
+
+	if (idx >= channels)
+		prev = probe_sample_get(src, container_bytes, idx - channels);
+
+	delta = (int32_t)(cur - prev);
+
+	return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static inline int probe_layout_valid(uint32_t container_bytes,
+				     uint32_t channels)
+{
+	return channels &&
+	       (container_bytes == sizeof(int16_t) ||
+		container_bytes == sizeof(int32_t));
+}
+
+int probe_compress(uint32_t *dst, uint32_t dst_bytes, const void *src,
+		   uint32_t src_bytes, uint32_t container_bytes,
+		   uint32_t channels)
+{
+	uint32_t max_words = dst_bytes / sizeof(uint32_t);
+	uint32_t samples;
+	uint32_t count;
+	uint32_t words;
+	uint32_t bits;
+	uint32_t max;
+	uint32_t acc_bits;
+	uint32_t out = 0;
+	uint32_t i;
+	uint32_t j;
+	uint64_t acc;
+
+	if (!probe_layout_valid(container_bytes, channels) ||
+	    src_bytes % (container_bytes * channels))
+		return -EINVAL;
+
+	samples = src_bytes / container_bytes;
+
+	for (i = 0; i < samples; i += count) {
+		count = samples - i;
+		if (count > PROBE_COMPRESS_BLOCK)
+			count = PROBE_COMPRESS_BLOCK;
+
+		/* block width is set by its largest value */
+		max = 0;
+		for (j = 0; j < count; j++)
+			max |= probe_delta(src, container_bytes, channels,
+					   i + j);
+
+		for (bits = 0; bits < 32 && (max >> bits); bits++)
+			;
+
+		words = (count * bits + 31) / 32;
+		if (out + 1 + words > max_words)
+			return -ENOSPC;
+
+		dst[out++] = PROBE_COMPRESS_HDR(bits, count);
+
+		acc = 0;
+		acc_bits = 0;
+		for (j = 0; j < count; j++) {
+			acc |= (uint64_t)probe_delta(src, container_bytes,
+						     channels, i + j) <<
+			       acc_bits;
+			acc_bits += bits;
+			if (acc_bits >= 32) {
+				dst[out++] = (uint32_t)acc;
+				acc >>= 32;
+				acc_bits -= 32;
+			}
+		}
+
+		if (acc_bits)
+			dst[out++] = (uint32_t)acc;
+	}
+
+	return out * sizeof(uint32_t);
+}
+
+int probe_decompress(void *dst, uint32_t dst_bytes, const uint32_t *src,
+		     uint32_t src_bytes, uint32_t container_bytes,
+		     uint32_t channels)
+{
+	uint32_t src_words = src_bytes / sizeof(uint32_t);
+	uint32_t dst_samples = dst_bytes / container_bytes;
+	uint32_t in = 0;
+	uint32_t out = 0;
+	uint32_t count;
+	uint32_t words;
+	uint32_t bits;
+	uint32_t mask;
+	uint32_t prev;
+	uint32_t acc_bits;
+	uint32_t hdr;
+	uint32_t z;
+	uint32_t j;
+	uint64_t acc;
+
+	if (!probe_layout_valid(container_bytes, channels))
+		return -EINVAL;
+
+	while (in < src_words) {
+		hdr = src[in++];
+		bits = PROBE_COMPRESS_HDR_BITS(hdr);
+		count = PROBE_COMPRESS_HDR_COUNT(hdr);
+
+		if (bits > 32 || !count || count > PROBE_COMPRESS_BLOCK)
+			return -EINVAL;
+
+		words = (count * bits + 31) / 32;
+		if (in + words > src_words)
+			return -EINVAL;
+
+		/* size query only */
+		if (!dst) {
+			in += words;
+			out += count;
+			continue;
+		}
+
+		if (out + count > dst_samples)
+			return -ENOSPC;
+
+		mask = bits == 32 ? UINT32_MAX : (1u << bits) - 1;
+		acc = 0;
+		acc_bits = 0;
+		for (j = 0; j < count; j++, out++) {
+			if (acc_bits < bits) {
+				acc |= (uint64_t)src[in++] << acc_bits;
+				acc_bits += 32;
+			}
+
+			z = (uint32_t)acc & mask;
+			acc >>= bits;
+			acc_bits -= bits;
+
+			prev = 0;
+			if (out >= channels)
+				prev = probe_sample_get(dst, container_bytes,
+							out - channels);
+
+			probe_sample_set(dst, container_bytes, out,
+					 prev + ((z >> 1) ^ -(z & 1)));
+		}
+	}
+
+	return out * container_bytes;
+}
@@ -4,9 +4,34 @@
 //
 // Author: Artur Kloniecki <arturx.kloniecki@linux.intel.com>
 
+#include <sof/audio/buffer.h>
+#include <sof/common.h>
+#include <sof/drivers/ipc.h>
+#include <sof/drivers/timer.h>
+#include <sof/lib/alloc.h>
+#include <sof/lib/cache.h>
+#include <sof/lib/clk.h>
+#include <sof/lib/dma.h>
+#include <sof/lib/memory.h>
+#include <sof/lib/notifier.h>
+#include <sof/math/numbers.h>
+#include <sof/platform.h>
+#if CONFIG_PROBE_COMPRESSION
+#include <sof/probe/compress.h>
+#endif
 #include <sof/probe/probe.h>
+#include <sof/schedule/ll_schedule.h>
+#include <sof/schedule/schedule.h>
+#include <sof/schedule/task.h>
+#include <sof/spinlock.h>
+#include <sof/string.h>
 #include <sof/trace/trace.h>
+#include <ipc/topology.h>
 #include <user/trace.h>
+#include <config.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #define trace_probe(__e, ...) \
 	trace_event(TRACE_CLASS_PROBE, __e, ##__VA_ARGS__)
@@ -15,42 +40,901 @@
 #define trace_probe_error(__e, ...) \
 	trace_error(TRACE_CLASS_PROBE, __e, ##__VA_ARGS__)
 
+#define PROBE_DMA_INVALID	0xFFFFFFFF
+#define PROBE_POINT_INVALID	0xFFFFFFFF
+
+/* local ring buffer of each probe DMA */
+#define PROBE_BUFFER_LOCAL_SIZE	8192
+#define DMA_ELEM_SIZE		32
+
+/* extraction DMA copy period in us */
+#define PROBE_DMA_PERIOD	1000
+
+/* largest payload compressed in one go, bigger ones are sent raw */
+#define PROBE_COMPRESS_SIZE	2048
+
+/* local DMA ring buffer */
+struct probe_dma_buf {
+	char *addr;
+	char *end_addr;
+	char *w_ptr;
+	char *r_ptr;
+	uint32_t size;
+	uint32_t avail;
+};
+
+struct probe_dma_ext {
+	uint32_t stream_tag;
+	uint32_t dma_buffer_size;
+	struct dma_sg_config config;
+	struct probe_dma_buf dmapb;
+	struct dma_copy dc;
+};
+
+struct probe_pdata {
+	struct probe_dma_ext ext_dma;
+	struct probe_dma_ext inject_dma[CONFIG_PROBE_DMA_MAX];
+	struct probe_point probe_points[CONFIG_PROBE_POINTS_MAX];
+	struct task dmap_work;
+	spinlock_t lock;		/* ext_dma ring buffer lock */
+	uint32_t ext_dropped;		/* packets dropped on full ring */
+	uint64_t ticks_per_ms;		/* for packet timestamps */
+#if CONFIG_PROBE_COMPRESSION
+	uint32_t *compress_buf;
+#endif
+};
+
+static struct probe_pdata *_probe;
+
+static int probe_dma_buffer_init(struct probe_dma_buf *buffer, uint32_t size,
+				 uint32_t align)
+{
+	buffer->addr = rballoc_align(0, SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+				     size, align);
+	if (!buffer->addr) {
+		trace_probe_error("probe_dma_buffer_init() error: alloc failed");
+		return -ENOMEM;
+	}
+
+	bzero(buffer->addr, size);
+	dcache_writeback_region(buffer->addr, size);
+
+	buffer->size = size;
+	buffer->w_ptr = buffer->addr;
+	buffer->r_ptr = buffer->addr;
+	buffer->end_addr = buffer->addr + size;
+	buffer->avail = 0;
+
+	return 0;
+}
+
+static int probe_dma_init(struct probe_dma_ext *dma, uint32_t direction)
+{
+	struct dma_sg_config config;
+	const uint32_t elem_size = sizeof(uint64_t) * DMA_ELEM_SIZE;
+	const uint32_t elem_num = PROBE_BUFFER_LOCAL_SIZE / elem_size;
+	uint32_t addr_align;
+	int err;
+
+	/* request host DMA in requested direction with shared access */
+	dma->dc.dmac = dma_get(direction, 0, DMA_DEV_HOST, DMA_ACCESS_SHARED);
+	if (!dma->dc.dmac) {
+		trace_probe_error("probe_dma_init() error: dma->dc.dmac = NULL");
+		return -ENODEV;
+	}
+
+	err = dma_get_attribute(dma->dc.dmac, DMA_ATTR_BUFFER_ADDRESS_ALIGNMENT,
+				&addr_align);
+	if (err < 0)
+		goto err_dma;
+
+	err = probe_dma_buffer_init(&dma->dmapb, PROBE_BUFFER_LOCAL_SIZE,
+				    addr_align);
+	if (err < 0)
+		goto err_dma;
+
+	err = dma_copy_set_stream_tag(&dma->dc, dma->stream_tag);
+	if (err < 0)
+		goto err_buf;
+
+	config.direction = direction;
+	config.src_width = sizeof(uint32_t);
+	config.dest_width = sizeof(uint32_t);
+	config.cyclic = 0;
+	config.irq_disabled = false;
+
+	err = dma_sg_alloc(&config.elem_array, SOF_MEM_ZONE_RUNTIME,
+			   config.direction, elem_num, elem_size,
+			   (uintptr_t)dma->dmapb.addr, 0);
+	if (err < 0)
+		goto err_chan;
+
+	err = dma_set_config(dma->dc.chan, &config);
+	if (err < 0)
+		goto err_sg;
+
+	dma->config = config;
+
+	return 0;
+
+err_sg:
+	dma_sg_free(&config.elem_array);
+err_chan:
+	dma_copy_free(&dma->dc);
+err_buf:
+	rfree(dma->dmapb.addr);
+	dma->dmapb.addr = NULL;
+err_dma:
+	dma_put(dma->dc.dmac);
+	return err;
+}
+
+static void probe_dma_deinit(struct probe_dma_ext *dma)
+{
+	dma_stop(dma->dc.chan);
+	dma_sg_free(&dma->config.elem_array);
+	dma_copy_free(&dma->dc);
+	dma_put(dma->dc.dmac);
+	rfree(dma->dmapb.addr);
+	dma->dmapb.addr = NULL;
+	dma->stream_tag = PROBE_DMA_INVALID;
+}
+
+/* copies extraction ring buffer contents to host */
+static enum task_state probe_task(void *data)
+{
+	struct probe_pdata *probe = data;
+	struct probe_dma_buf *buffer = &probe->ext_dma.dmapb;
+	uint32_t copy_align;
+	uint32_t flags;
+	uint32_t avail;
+	int err;
+
+	avail = buffer->avail;
+	if (!avail)
+		return SOF_TASK_STATE_RESCHEDULE;
+
+	err = dma_get_attribute(probe->ext_dma.dc.dmac,
+				DMA_ATTR_COPY_ALIGNMENT, &copy_align);
+	if (err < 0) {
+		trace_probe_error("probe_task() error: dma_get_attribute() failed");
+		return SOF_TASK_STATE_COMPLETED;
+	}
+
+	/* copy up to the end of the ring, remainder goes next period */
+	if (buffer->r_ptr + avail > buffer->end_addr)
+		avail = buffer->end_addr - buffer->r_ptr;
+
+	avail = ALIGN_DOWN(avail, copy_align);
+	if (!avail)
+		return SOF_TASK_STATE_RESCHEDULE;
+
+	dcache_writeback_region(buffer->r_ptr, avail);
+
+	err = dma_copy_to_host_nowait(&probe->ext_dma.dc,
+				      &probe->ext_dma.config, 0,
+				      buffer->r_ptr, avail);
+	if (err < 0) {
+		trace_probe_error("probe_task() error: dma_copy_to_host_nowait() failed");
+		return SOF_TASK_STATE_RESCHEDULE;
+	}
+
+	spin_lock_irq(&probe->lock, flags);
+
+	buffer->r_ptr += avail;
+	if (buffer->r_ptr >= buffer->end_addr)
+		buffer->r_ptr -= buffer->size;
+	buffer->avail -= avail;
+
+	spin_unlock_irq(&probe->lock, flags);
+
+	return SOF_TASK_STATE_RESCHEDULE;
+}
+
 int probe_init(struct probe_dma *probe_dma)
 {
+	uint32_t i;
+	int err;
+
+	trace_probe("probe_init()");
+
+	if (_probe) {
+		trace_probe_error("probe_init() error: Probes already initialized.");
+		return -EINVAL;
+	}
+
+	/* alloc probes main struct */
+	_probe = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+			 sizeof(*_probe));
+	if (!_probe) {
+		trace_probe_error("probe_init() error: Alloc failed.");
+		return -ENOMEM;
+	}
+
+	spinlock_init(&_probe->lock);
+	_probe->ticks_per_ms = clock_ms_to_ticks(PLATFORM_DEFAULT_CLOCK, 1);
+
+	/* setup extraction dma if requested */
+	if (probe_dma) {
+		tracev_probe("\tstream_tag = %u, dma_buffer_size = %u",
+			     probe_dma->stream_tag, probe_dma->dma_buffer_size);
+
+		_probe->ext_dma.stream_tag = probe_dma->stream_tag;
+		_probe->ext_dma.dma_buffer_size = probe_dma->dma_buffer_size;
+
+		err = probe_dma_init(&_probe->ext_dma, DMA_DIR_LMEM_TO_HMEM);
+		if (err < 0) {
+			trace_probe_error("probe_init() error: probe_dma_init() failed");
+			goto err_free;
+		}
+
+		err = dma_start(_probe->ext_dma.dc.chan);
+		if (err < 0) {
+			trace_probe_error("probe_init() error: failed to start extraction dma");
+			probe_dma_deinit(&_probe->ext_dma);
+			goto err_free;
+		}
+
+#if CONFIG_PROBE_COMPRESSION
+		_probe->compress_buf = rballoc(0, SOF_MEM_CAPS_RAM,
+					       PROBE_COMPRESS_SIZE);
+		if (!_probe->compress_buf)
+			trace_probe_error("probe_init() error: compression disabled, alloc failed");
+#endif
+
+		schedule_task_init_ll(&_probe->dmap_work, SOF_SCHEDULE_LL_TIMER,
+				      SOF_TASK_PRI_LOW, probe_task, _probe,
+				      0, 0);
+	} else {
+		tracev_probe("\tno extraction DMA setup");
+
+		_probe->ext_dma.stream_tag = PROBE_DMA_INVALID;
+	}
+
+	/* initialize injection DMAs as invalid */
+	for (i = 0; i < CONFIG_PROBE_DMA_MAX; i++)
+		_probe->inject_dma[i].stream_tag = PROBE_DMA_INVALID;
+
+	/* initialize probe points as invalid */
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++)
+		_probe->probe_points[i].stream_tag = PROBE_POINT_INVALID;
+
 	return 0;
+
+err_free:
+	rfree(_probe);
+	_probe = NULL;
+	return err;
 }
 
 int probe_deinit(void)
 {
+	uint32_t i;
+
+	trace_probe("probe_deinit()");
+
+	if (!_probe) {
+		trace_probe_error("probe_deinit() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	/* probe DMAs and points must be removed first */
+	for (i = 0; i < CONFIG_PROBE_DMA_MAX; i++) {
+		if (_probe->inject_dma[i].stream_tag != PROBE_DMA_INVALID) {
+			trace_probe_error("probe_deinit() error: Cannot deinitialize with injection DMAs attached.");
+			return -EINVAL;
+		}
+	}
+
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++) {
+		if (_probe->probe_points[i].stream_tag != PROBE_POINT_INVALID) {
+			trace_probe_error("probe_deinit() error: Cannot deinitialize with probe points active.");
+			return -EINVAL;
+		}
+	}
+
+	if (_probe->ext_dma.stream_tag != PROBE_DMA_INVALID) {
+		tracev_probe("probe_deinit() Freeing task and extraction DMA.");
+		schedule_task_free(&_probe->dmap_work);
+		probe_dma_deinit(&_probe->ext_dma);
+	}
+
+	if (_probe->ext_dropped)
+		trace_probe("probe_deinit() %u extraction packets dropped",
+			    _probe->ext_dropped);
+
+#if CONFIG_PROBE_COMPRESSION
+	rfree(_probe->compress_buf);
+#endif
+	rfree(_probe);
+	_probe = NULL;
+
 	return 0;
 }
 
+static struct probe_dma_ext *probe_inject_dma_get(uint32_t stream_tag)
+{
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_PROBE_DMA_MAX; i++)
+		if (_probe->inject_dma[i].stream_tag == stream_tag)
+			return &_probe->inject_dma[i];
+
+	return NULL;
+}
+
 int probe_dma_add(uint32_t count, struct probe_dma *probe_dma)
 {
+	struct probe_dma_ext *dma;
+	uint32_t i;
+	int err;
+
+	trace_probe("probe_dma_add() count = %u", count);
+
+	if (!_probe) {
+		trace_probe_error("probe_dma_add() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++) {
+		tracev_probe("\tprobe_dma[%u] stream_tag = %u, dma_buffer_size = %u",
+			     i, probe_dma[i].stream_tag,
+			     probe_dma[i].dma_buffer_size);
+
+		if (probe_dma[i].stream_tag == PROBE_DMA_INVALID ||
+		    probe_inject_dma_get(probe_dma[i].stream_tag)) {
+			trace_probe_error("probe_dma_add() error: Probe DMA with stream_tag = %u already attached.",
+					  probe_dma[i].stream_tag);
+			return -EINVAL;
+		}
+
+		dma = probe_inject_dma_get(PROBE_DMA_INVALID);
+		if (!dma) {
+			trace_probe_error("probe_dma_add() error: Exceeded maximum number of DMAs attached = "
+					  META_QUOTE(CONFIG_PROBE_DMA_MAX));
+			return -EINVAL;
+		}
+
+		dma->stream_tag = probe_dma[i].stream_tag;
+		dma->dma_buffer_size = probe_dma[i].dma_buffer_size;
+
+		err = probe_dma_init(dma, DMA_DIR_HMEM_TO_LMEM);
+		if (err < 0) {
+			trace_probe_error("probe_dma_add() error: probe_dma_init() failed");
+			dma->stream_tag = PROBE_DMA_INVALID;
+			return err;
+		}
+
+		err = dma_start(dma->dc.chan);
+		if (err < 0) {
+			trace_probe_error("probe_dma_add() error: failed to start dma");
+			probe_dma_deinit(dma);
+			return err;
+		}
+	}
+
 	return 0;
 }
 
-int probe_dma_info(struct sof_ipc_probe_info_params *data, uint32_t max_size)
+/* true if any probe point is attached through given injection DMA */
+static bool probe_dma_in_use(uint32_t stream_tag)
 {
-	return 0;
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++)
+		if (_probe->probe_points[i].stream_tag == stream_tag &&
+		    _probe->probe_points[i].purpose == PROBE_PURPOSE_INJECTION)
+			return true;
+
+	return false;
 }
 
 int probe_dma_remove(uint32_t count, uint32_t *stream_tag)
 {
+	struct probe_dma_ext *dma;
+	uint32_t i;
+
+	trace_probe("probe_dma_remove() count = %u", count);
+
+	if (!_probe) {
+		trace_probe_error("probe_dma_remove() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++) {
+		tracev_probe("\tstream_tag[%u] = %u", i, stream_tag[i]);
+
+		dma = stream_tag[i] == PROBE_DMA_INVALID ? NULL :
+		      probe_inject_dma_get(stream_tag[i]);
+		if (!dma) {
+			trace_probe_error("probe_dma_remove() error: DMA with stream_tag = %u not found.",
+					  stream_tag[i]);
+			return -EINVAL;
+		}
+
+		if (probe_dma_in_use(stream_tag[i])) {
+			trace_probe_error("probe_dma_remove() error: DMA with stream_tag = %u still in use.",
+					  stream_tag[i]);
+			return -EINVAL;
+		}
+
+		probe_dma_deinit(dma);
+	}
+
+	return 0;
+}
+
+int probe_dma_info(struct sof_ipc_probe_info_params *data, uint32_t max_size)
+{
+	uint32_t i = 0;
+	uint32_t j = 0;
+
+	tracev_probe("probe_dma_info()");
+
+	if (!_probe) {
+		trace_probe_error("probe_dma_info() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	data->rhdr.hdr.size = sizeof(*data);
+
+	/* search all injection DMAs */
+	for (i = 0; i < CONFIG_PROBE_DMA_MAX; i++) {
+		if (_probe->inject_dma[i].stream_tag == PROBE_DMA_INVALID)
+			continue;
+
+		if (data->rhdr.hdr.size + sizeof(struct probe_dma) > max_size)
+			return -EINVAL;
+
+		data->probe_dma[j].stream_tag =
+			_probe->inject_dma[i].stream_tag;
+		data->probe_dma[j].dma_buffer_size =
+			_probe->inject_dma[i].dma_buffer_size;
+		data->rhdr.hdr.size += sizeof(struct probe_dma);
+		j++;
+	}
+
+	data->num_elems = j;
+
 	return 0;
 }
 
+/* encode stream format as described in ipc/probe.h */
+static uint32_t probe_gen_format(const struct audio_stream *stream)
+{
+	static const uint32_t rates[] = {
+		8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100,
+		48000, 64000, 88200, 96000, 128000, 176400, 192000
+	};
+	uint32_t sample_size;
+	uint32_t container_size;
+	uint32_t float_fmt = 0;
+	uint32_t rate;
+
+	switch (stream->frame_fmt) {
+	case SOF_IPC_FRAME_S16_LE:
+		sample_size = 2;
+		container_size = 2;
+		break;
+	case SOF_IPC_FRAME_S24_4LE:
+		sample_size = 3;
+		container_size = 4;
+		break;
+	case SOF_IPC_FRAME_FLOAT:
+		float_fmt = 1;
+		/* fallthrough */
+	default:
+		sample_size = 4;
+		container_size = 4;
+		break;
+	}
+
+	for (rate = 0; rate < ARRAY_SIZE(rates); rate++)
+		if (rates[rate] == stream->rate)
+			break;
+
+	return (1 << PROBE_SHIFT_FMT_TYPE) |
+	       (rate << PROBE_SHIFT_SAMPLE_RATE) |
+	       ((stream->channels - 1) << PROBE_SHIFT_NB_CHANNELS) |
+	       ((sample_size - 1) << PROBE_SHIFT_SAMPLE_SIZE) |
+	       ((container_size - 1) << PROBE_SHIFT_CONTAINER_SIZE) |
+	       (float_fmt << PROBE_SHIFT_SAMPLE_FMT) |
+	       (1 << PROBE_SHIFT_INTERLEAVING_ST);
+}
+
+/* copy to extraction ring buffer, caller checked for free space */
+static void probe_ext_write(struct probe_dma_buf *buffer, const void *data,
+			    uint32_t bytes)
+{
+	uint32_t head = MIN(bytes, (uint32_t)(buffer->end_addr -
+					      buffer->w_ptr));
+	int ret;
+
+	ret = memcpy_s(buffer->w_ptr, buffer->end_addr - buffer->w_ptr,
+		       data, head);
+	assert(!ret);
+
+	if (bytes > head) {
+		ret = memcpy_s(buffer->addr, buffer->size,
+			       (const char *)data + head, bytes - head);
+		assert(!ret);
+	}
+
+	buffer->w_ptr += bytes;
+	if (buffer->w_ptr >= buffer->end_addr)
+		buffer->w_ptr -= buffer->size;
+}
+
+/*
+ * Pack one contiguous chunk of buffer data into a probe data packet. The
+ * packet is either queued whole or dropped, so the audio path never waits
+ * for the host and the extraction stream always stays parseable.
+ */
+static void probe_ext_packet(struct comp_buffer *buffer, const void *data,
+			     uint32_t bytes)
+{
+	struct probe_dma_buf *dmapb = &_probe->ext_dma.dmapb;
+	struct audio_stream *stream = &buffer->stream;
+	struct probe_data_packet header;
+	const void *payload = data;
+	uint64_t timestamp;
+	uint32_t flags;
+#if CONFIG_PROBE_COMPRESSION
+	int size;
+#endif
+
+	header.sync_word = PROBE_EXTRACT_SYNC_WORD;
+	header.buffer_id = buffer->id;
+	header.format = probe_gen_format(stream);
+	header.data_size_bytes = bytes;
+
+#if CONFIG_PROBE_COMPRESSION
+	/* sent raw if it doesn't get smaller or layout is unsupported */
+	if (_probe->compress_buf && bytes <= PROBE_COMPRESS_SIZE) {
+		size = probe_compress(_probe->compress_buf, bytes, data, bytes,
+				      audio_stream_sample_bytes(stream),
+				      stream->channels);
+		if (size > 0) {
+			header.format |= PROBE_MASK_COMPRESSED;
+			header.data_size_bytes = size;
+			payload = _probe->compress_buf;
+		}
+	}
+#endif
+
+	timestamp = platform_timer_get(timer_get()) * 1000 /
+		    _probe->ticks_per_ms;
+	header.timestamp_low = (uint32_t)timestamp;
+	header.timestamp_high = (uint32_t)(timestamp >> 32);
+	header.checksum = 0;
+	header.checksum = crc32(0, &header, sizeof(header));
+
+	spin_lock_irq(&_probe->lock, flags);
+
+	if (dmapb->size - dmapb->avail <
+	    sizeof(header) + header.data_size_bytes) {
+		if (!_probe->ext_dropped++)
+			trace_probe_error("probe_ext_packet() error: extraction buffer full, dropping packets");
+		spin_unlock_irq(&_probe->lock, flags);
+		return;
+	}
+
+	probe_ext_write(dmapb, &header, sizeof(header));
+	probe_ext_write(dmapb, payload, header.data_size_bytes);
+	dmapb->avail += sizeof(header) + header.data_size_bytes;
+
+	spin_unlock_irq(&_probe->lock, flags);
+}
+
+static void probe_extract(struct comp_buffer *buffer, char *begin,
+			  uint32_t bytes)
+{
+	uint32_t head = MIN(bytes, (uint32_t)((char *)buffer->stream.end_addr -
+					      begin));
+
+	/* one packet per contiguous chunk of the circular buffer */
+	probe_ext_packet(buffer, begin, head);
+	if (bytes > head)
+		probe_ext_packet(buffer, buffer->stream.addr, bytes - head);
+}
+
+/* overwrite produced data with data provided by host, if any */
+static void probe_inject(struct comp_buffer *buffer, char *begin,
+			 uint32_t bytes, uint32_t stream_tag)
+{
+	struct probe_dma_ext *dma = probe_inject_dma_get(stream_tag);
+	struct probe_dma_buf *dmapb;
+	uint32_t avail;
+	uint32_t free;
+	uint32_t copied = 0;
+	uint32_t chunk;
+	char *w_ptr = begin;
+	int ret;
+
+	if (!dma)
+		return;
+
+	dmapb = &dma->dmapb;
+
+	if (dma_get_data_size(dma->dc.chan, &avail, &free) < 0)
+		return;
+
+	/* don't stall the audio path, take what's there */
+	bytes = MIN(bytes, avail);
+
+	while (copied < bytes) {
+		chunk = MIN(bytes - copied, (uint32_t)(dmapb->end_addr -
+						       dmapb->r_ptr));
+		chunk = MIN(chunk, (uint32_t)((char *)buffer->stream.end_addr -
+					      w_ptr));
+
+		dcache_invalidate_region(dmapb->r_ptr, chunk);
+		ret = memcpy_s(w_ptr, chunk, dmapb->r_ptr, chunk);
+		if (ret < 0) {
+			trace_probe_error("probe_inject() error: copy failed, ret = %d",
+					  ret);
+			break;
+		}
+
+		dmapb->r_ptr += chunk;
+		if (dmapb->r_ptr >= dmapb->end_addr)
+			dmapb->r_ptr -= dmapb->size;
+
+		w_ptr = audio_stream_wrap(&buffer->stream, w_ptr + chunk);
+		copied += chunk;
+	}
+
+	if (copied)
+		dma_copy(dma->dc.chan, copied, 0);
+}
+
+static void probe_cb_produce(void *arg, enum notify_id type, void *data)
+{
+	struct buffer_cb_transact *cb_data = data;
+	struct comp_buffer *buffer = cb_data->buffer;
+	struct probe_point *point;
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++) {
+		point = &_probe->probe_points[i];
+
+		if (point->stream_tag == PROBE_POINT_INVALID ||
+		    point->buffer_id != buffer->id)
+			continue;
+
+		if (point->purpose == PROBE_PURPOSE_INJECTION)
+			probe_inject(buffer, cb_data->transaction_begin_address,
+				     cb_data->transaction_amount,
+				     point->stream_tag);
+		else
+			probe_extract(buffer,
+				      cb_data->transaction_begin_address,
+				      cb_data->transaction_amount);
+	}
+}
+
+static void probe_cb_free(void *arg, enum notify_id type, void *data)
+{
+	struct buffer_cb_free *cb_data = data;
+	uint32_t buffer_id = cb_data->buffer->id;
+	uint32_t i;
+
+	trace_probe("probe_cb_free() buffer_id = %u", buffer_id);
+
+	/* buffer_free() drops our notifier handles, only forget the points */
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++)
+		if (_probe->probe_points[i].stream_tag != PROBE_POINT_INVALID &&
+		    _probe->probe_points[i].buffer_id == buffer_id)
+			_probe->probe_points[i].stream_tag =
+				PROBE_POINT_INVALID;
+}
+
+static struct probe_point *probe_point_find(uint32_t buffer_id,
+					    uint32_t purpose)
+{
+	struct probe_point *point;
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++) {
+		point = &_probe->probe_points[i];
+		if (point->stream_tag != PROBE_POINT_INVALID &&
+		    point->buffer_id == buffer_id &&
+		    (!purpose || point->purpose == purpose))
+			return point;
+	}
+
+	return NULL;
+}
+
+static struct probe_point *probe_point_free_get(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++)
+		if (_probe->probe_points[i].stream_tag == PROBE_POINT_INVALID)
+			return &_probe->probe_points[i];
+
+	return NULL;
+}
+
+static uint32_t probe_ext_points(void)
+{
+	uint32_t count = 0;
+	uint32_t i;
+
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++)
+		if (_probe->probe_points[i].stream_tag != PROBE_POINT_INVALID &&
+		    _probe->probe_points[i].purpose == PROBE_PURPOSE_EXTRACTION)
+			count++;
+
+	return count;
+}
+
 int probe_point_add(uint32_t count, struct probe_point *probe)
 {
+	struct ipc_comp_dev *dev;
+	struct probe_point *point;
+	uint32_t stream_tag;
+	uint32_t i;
+	int err;
+
+	trace_probe("probe_point_add() count = %u", count);
+
+	if (!_probe) {
+		trace_probe_error("probe_point_add() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++) {
+		tracev_probe("\tprobe[%u] buffer_id = %u, purpose = %u, stream_tag = %u",
+			     i, probe[i].buffer_id, probe[i].purpose,
+			     probe[i].stream_tag);
+
+		dev = ipc_get_comp_by_id(ipc_get(), probe[i].buffer_id);
+		if (!dev || dev->type != COMP_TYPE_BUFFER) {
+			trace_probe_error("probe_point_add() error: No buffer with id = %u",
+					  probe[i].buffer_id);
+			return -EINVAL;
+		}
+
+		switch (probe[i].purpose) {
+		case PROBE_PURPOSE_EXTRACTION:
+			if (_probe->ext_dma.stream_tag == PROBE_DMA_INVALID) {
+				trace_probe_error("probe_point_add() error: No extraction DMA setup.");
+				return -EINVAL;
+			}
+			stream_tag = _probe->ext_dma.stream_tag;
+			break;
+		case PROBE_PURPOSE_INJECTION:
+			if (probe[i].stream_tag == PROBE_DMA_INVALID ||
+			    !probe_inject_dma_get(probe[i].stream_tag)) {
+				trace_probe_error("probe_point_add() error: No injection DMA with stream_tag = %u",
+						  probe[i].stream_tag);
+				return -EINVAL;
+			}
+			stream_tag = probe[i].stream_tag;
+			break;
+		default:
+			trace_probe_error("probe_point_add() error: Invalid probe purpose = %u",
+					  probe[i].purpose);
+			return -EINVAL;
+		}
+
+		if (probe_point_find(probe[i].buffer_id, probe[i].purpose)) {
+			trace_probe_error("probe_point_add() error: Probe already attached to buffer id = %u",
+					  probe[i].buffer_id);
+			return -EINVAL;
+		}
+
+		point = probe_point_free_get();
+		if (!point) {
+			trace_probe_error("probe_point_add() error: Exceeded maximum number of probe points = "
+					  META_QUOTE(CONFIG_PROBE_POINTS_MAX));
+			return -EINVAL;
+		}
+
+		/* one set of callbacks serves all points of a buffer */
+		if (!probe_point_find(probe[i].buffer_id, 0)) {
+			err = notifier_register(_probe, dev->cb,
+						NOTIFIER_ID_BUFFER_PRODUCE,
+						&probe_cb_produce);
+			if (err < 0)
+				return err;
+
+			err = notifier_register(_probe, dev->cb,
+						NOTIFIER_ID_BUFFER_FREE,
+						&probe_cb_free);
+			if (err < 0) {
+				notifier_unregister(_probe, dev->cb,
+						    NOTIFIER_ID_BUFFER_PRODUCE);
+				return err;
+			}
+		}
+
+		/* start copying to host with first extraction point */
+		if (probe[i].purpose == PROBE_PURPOSE_EXTRACTION &&
+		    !probe_ext_points())
+			schedule_task(&_probe->dmap_work, PROBE_DMA_PERIOD,
+				      PROBE_DMA_PERIOD);
+
+		point->buffer_id = probe[i].buffer_id;
+		point->purpose = probe[i].purpose;
+		point->stream_tag = stream_tag;
+	}
+
 	return 0;
 }
 
 int probe_point_info(struct sof_ipc_probe_info_params *data, uint32_t max_size)
 {
+	uint32_t i = 0;
+	uint32_t j = 0;
+
+	tracev_probe("probe_point_info()");
+
+	if (!_probe) {
+		trace_probe_error("probe_point_info() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	data->rhdr.hdr.size = sizeof(*data);
+
+	/* search all probe points */
+	for (i = 0; i < CONFIG_PROBE_POINTS_MAX; i++) {
+		if (_probe->probe_points[i].stream_tag == PROBE_POINT_INVALID)
+			continue;
+
+		if (data->rhdr.hdr.size + sizeof(struct probe_point) > max_size)
+			return -EINVAL;
+
+		data->probe_point[j] = _probe->probe_points[i];
+		data->rhdr.hdr.size += sizeof(struct probe_point);
+		j++;
+	}
+
+	data->num_elems = j;
+
 	return 0;
 }
 
 int probe_point_remove(uint32_t count, uint32_t *buffer_id)
 {
+	struct ipc_comp_dev *dev;
+	struct probe_point *point;
+	uint32_t i;
+
+	trace_probe("probe_point_remove() count = %u", count);
+
+	if (!_probe) {
+		trace_probe_error("probe_point_remove() error: Not initialized.");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < count; i++) {
+		tracev_probe("\tbuffer_id = %u", buffer_id[i]);
+
+		point = probe_point_find(buffer_id[i], 0);
+		if (!point) {
+			trace_probe_error("probe_point_remove() error: No probe attached to buffer id = %u",
+					  buffer_id[i]);
+			return -EINVAL;
+		}
+
+		/* all points of this buffer go together */
+		while (point) {
+			point->stream_tag = PROBE_POINT_INVALID;
+			point = probe_point_find(buffer_id[i], 0);
+		}
+
+		dev = ipc_get_comp_by_id(ipc_get(), buffer_id[i]);
+		if (dev && dev->type == COMP_TYPE_BUFFER)
+			notifier_unregister_all(_probe, dev->cb);
+	}
+
+	/* no more extraction, stop copying */
+	if (_probe->ext_dma.stream_tag != PROBE_DMA_INVALID &&
+	    !probe_ext_points())
+		schedule_task_cancel(&_probe->dmap_work);
+
 	return 0;
 }
@@ -36,6 +36,10 @@ struct ll_schedule_data {
 	atomic_t num_tasks;			/* number of ll tasks */
 #if CONFIG_PERFORMANCE_COUNTERS
 	struct perf_cnt_data pcd;
+#endif
+#if CONFIG_CLOCK_GOVERNOR
+	uint64_t gov_window_start;		/* governor window start tick */
+	bool gov_eval;				/* evaluate load on next run */
 #endif
 	struct ll_schedule_domain *domain;	/* scheduling domain */
 };
@@ -61,20 +65,102 @@ static bool schedule_ll_is_pending(struct ll_schedule_data *sch)
 	return pending_count > 0;
 }
 
+/* Task period in clock ticks. A multiple of the domain tick is converted
+ * as a whole number of ticks so that rounding does not move the task off
+ * its tick.
+ */
+static uint64_t schedule_ll_period_ticks(struct ll_schedule_domain *domain,
+					 uint64_t period)
+{
+	uint32_t tick = domain->period;
+
+	if (tick && !(period % tick))
+		return period / tick * (domain->ticks_per_ms * tick / 1000);
+
+	return domain->ticks_per_ms * period / 1000;
+}
+
+/* Updates the domain tick from the periods of the tasks of this core */
+static void schedule_ll_period_update(struct ll_schedule_data *sch,
+				      struct task *skip)
+{
+	struct ll_task_pdata *pdata;
+	struct list_item *tlist;
+	struct task *task;
+	uint32_t tick = 0;
+
+	list_for_item(tlist, &sch->tasks) {
+		task = container_of(tlist, struct task, list);
+		pdata = ll_sch_get_pdata(task);
+		if (task != skip)
+			tick = ll_tick_add(tick, pdata->period);
+	}
+
+	domain_set_period(sch->domain, cpu_get_id(), tick);
+}
+
 static void schedule_ll_task_update_start(struct ll_schedule_data *sch,
 					  struct task *task, uint64_t last_tick)
 {
 	struct ll_task_pdata *pdata = ll_sch_get_pdata(task);
 	uint64_t next;
 
-	next = sch->domain->ticks_per_ms * pdata->period / 1000;
+	next = schedule_ll_period_ticks(sch->domain, pdata->period);
 
-	if (sch->domain->synchronous)
-		task->start += next;
-	else
+	task->start += next;
+
+	/* asynchronous tasks do not catch up with missed periods */
+	if (!sch->domain->synchronous && task->start <= last_tick)
 		task->start = next + last_tick;
 }
 
+#if CONFIG_CLOCK_GOVERNOR
+static void schedule_ll_task_cycles(struct task *task, uint64_t start)
+{
+	struct ll_task_pdata *pdata = ll_sch_get_pdata(task);
+
+	pdata->cycles_last = arch_timer_get_system(cpu_timer_get()) - start;
+	if (pdata->cycles_last > pdata->cycles_peak)
+		pdata->cycles_peak = pdata->cycles_last;
+}
+
+/* Sums the peak cost of every task over its period and lets the clock
+ * governor select the cpu frequency. Runs once per window, or on the
+ * next run after a task has been removed.
+ */
+static void schedule_ll_clock_gov(struct ll_schedule_data *sch)
+{
+	uint64_t now = platform_timer_get(timer_get());
+	uint64_t window = sch->domain->ticks_per_ms *
+		CONFIG_CLOCK_GOVERNOR_WINDOW_MS;
+	struct ll_task_pdata *pdata;
+	struct list_item *tlist;
+	struct task *task;
+	uint64_t load = 0;
+
+	if (!sch->gov_eval && now - sch->gov_window_start < window)
+		return;
+
+	list_for_item(tlist, &sch->tasks) {
+		task = container_of(tlist, struct task, list);
+		pdata = ll_sch_get_pdata(task);
+
+		/* cycles per period in us give cycles per second */
+		if (pdata->period)
+			load += (uint64_t)pdata->cycles_peak * 1000000 /
+				pdata->period;
+
+		/* next window starts from the latest cost */
+		pdata->cycles_peak = pdata->cycles_last;
+	}
+
+	clock_gov_update(CLK_CPU(cpu_get_id()), load, sch->gov_eval);
+
+	sch->gov_eval = false;
+	sch->gov_window_start = now;
+}
+#endif
+
 static void schedule_ll_tasks_execute(struct ll_schedule_data *sch,
 				      uint64_t last_tick)
 {
@@ -82,6 +168,9 @@ static void schedule_ll_tasks_execute(struct ll_schedule_data *sch,
 	struct list_item *tlist;
 	struct task *task;
 	int cpu = cpu_get_id();
+#if CONFIG_CLOCK_GOVERNOR
+	uint64_t cycles;
+#endif
 
 	/* check each task in the list for pending */
 	list_for_item_safe(wlist, tlist, &sch->tasks) {
@@ -91,12 +180,22 @@ static void schedule_ll_tasks_execute(struct ll_schedule_data *sch,
 		if (task->state != SOF_TASK_STATE_PENDING)
 			continue;
 
+#if CONFIG_CLOCK_GOVERNOR
+		cycles = arch_timer_get_system(cpu_timer_get());
+#endif
 		task->state = task_run(task);
+#if CONFIG_CLOCK_GOVERNOR
+		schedule_ll_task_cycles(task, cycles);
+#endif
 
 		/* do we need to reschedule this task */
 		if (task->state == SOF_TASK_STATE_COMPLETED) {
 			list_item_del(&task->list);
+			schedule_ll_period_update(sch, NULL);
 			atomic_sub(&sch->domain->total_num_tasks, 1);
+#if CONFIG_CLOCK_GOVERNOR
+			sch->gov_eval = true;
+#endif
 
 			/* don't enable irq, if no more tasks to do */
 			if (!atomic_sub(&sch->num_tasks, 1))
@@ -172,6 +271,10 @@ static void schedule_ll_tasks_run(void *data)
 
 	perf_cnt_stamp(TRACE_CLASS_SCHEDULE_LL, &sch->pcd, true);
 
+#if CONFIG_CLOCK_GOVERNOR
+	schedule_ll_clock_gov(sch);
+#endif
+
 	spin_lock(&sch->domain->lock);
 
 	/* reschedule only if all clients are done */
@@ -199,6 +302,8 @@ static int schedule_ll_domain_set(struct ll_schedule_data *sch,
 
 	spin_lock(&sch->domain->lock);
 
+	schedule_ll_period_update(sch, NULL);
+
 	if (atomic_add(&sch->num_tasks, 1) == 1)
 		sch->domain->registered[core] = true;
 
@@ -208,9 +313,10 @@ static int schedule_ll_domain_set(struct ll_schedule_data *sch,
 		domain_enable(sch->domain, core);
 	}
 
-	trace_ll("num_tasks %d total_num_tasks %d",
+	trace_ll("num_tasks %d total_num_tasks %d tick %u us",
 		 atomic_read(&sch->num_tasks),
-		 atomic_read(&sch->domain->total_num_tasks));
+		 atomic_read(&sch->domain->total_num_tasks),
+		 sch->domain->period);
 
 	platform_shared_commit(sch->domain, sizeof(*sch->domain));
 
@@ -224,6 +330,8 @@ static void schedule_ll_domain_clear(struct ll_schedule_data *sch,
 {
 	spin_lock(&sch->domain->lock);
 
+	schedule_ll_period_update(sch, task);
+
 	if (!atomic_sub(&sch->domain->total_num_tasks, 1)) {
 		domain_clear(sch->domain);
 		sch->domain->last_tick = 0;
@@ -310,6 +418,14 @@ static void schedule_ll_task(void *data, struct task *task, uint64_t start,
 		goto out;
 	}
 
+#if CONFIG_CLOCK_GOVERNOR
+	/* pipeline trigger, run at full speed until the task is measured */
+	pdata->cycles_last = 0;
+	pdata->cycles_peak = 0;
+	clock_gov_boost(CLK_CPU(cpu_get_id()));
+	sch->gov_window_start = platform_timer_get(timer_get());
+#endif
+
 	task->start = sch->domain->ticks_per_ms * start / 1000;
 
 	if (sch->domain->synchronous)
@@ -384,6 +500,9 @@ static void schedule_ll_task_cancel(void *data, struct task *task)
 		/* found it */
 		if (curr_task == task) {
 			schedule_ll_domain_clear(sch, task);
+#if CONFIG_CLOCK_GOVERNOR
+			sch->gov_eval = true;
+#endif
 			break;
 		}
 	}
@@ -392,6 +511,12 @@ static void schedule_ll_task_cancel(void *data, struct task *task)
 	task->state = SOF_TASK_STATE_CANCEL;
 	list_item_del(&task->list);
 
+#if CONFIG_CLOCK_GOVERNOR
+	/* pipeline trigger, no more runs to evaluate the load on */
+	if (sch->gov_eval && list_is_empty(&sch->tasks))
+		schedule_ll_clock_gov(sch);
+#endif
+
 	irq_local_enable(flags);
 }
 
@@ -8,6 +8,8 @@
  * Generic audio task.
  */
 
+#include <sof/audio/buffer_cache.h>
+#include <sof/audio/coef_store.h>
 #include <sof/audio/component.h>
 #include <sof/debug/panic.h>
 #include <sof/drivers/ipc.h>
@@ -95,6 +97,12 @@ int task_main_start(struct sof *sof)
 	/* init default audio components */
 	sys_comp_init(sof);
 
+	/* init coefficient store shared by components */
+	coef_store_init(sof);
+
+	/* init cache of freed buffers */
+	buffer_cache_init(sof);
+
 	/* init self-registered modules */
 	sys_module_init();
 
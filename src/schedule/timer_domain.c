@@ -109,8 +109,9 @@ static void timer_domain_disable(struct ll_schedule_domain *domain, int core)
 static void timer_domain_set(struct ll_schedule_domain *domain, uint64_t start)
 {
 	struct timer_domain *timer_domain = ll_sch_domain_get_pdata(domain);
-	uint64_t ticks_req = domain->ticks_per_ms * timer_domain->timeout /
-			     1000 + start;
+	uint64_t period = domain->period ? domain->period :
+			  timer_domain->timeout;
+	uint64_t ticks_req = domain->ticks_per_ms * period / 1000 + start;
 	uint64_t ticks_set;
 
 	ticks_set = platform_timer_set(timer_domain->timer, ticks_req);
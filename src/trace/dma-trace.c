@@ -22,6 +22,7 @@
 #include <sof/string.h>
 #include <sof/trace/dma-trace.h>
 #include <ipc/topology.h>
+#include <user/trace.h>
 #include <config.h>
 #include <errno.h>
 #include <stddef.h>
@@ -318,6 +319,11 @@ int dma_trace_enable(struct dma_trace_data *d)
 		goto out;
 	}
 
+#if CONFIG_TRACE_COMPACT
+	/* host starts decoding from scratch, begin with a sync record */
+	d->compact_count = 0;
+#endif
+
 	d->enabled = 1;
 	schedule_task(&d->dmat_work, DMA_TRACE_PERIOD, DMA_TRACE_PERIOD);
 
@@ -327,6 +333,136 @@ out:
 	return err;
 }
 
+#if CONFIG_HOST_PTABLE
+/* Moves the local buffer and the host pages to system runtime memory, or
+ * back to the buffer and runtime zones. Tracing goes on where it was.
+ */
+int dma_trace_relocate(struct dma_trace_data *d, bool sys)
+{
+	struct dma_trace_buf *buffer = &d->dmatb;
+	size_t elems_size = sizeof(struct dma_sg_elem) *
+		d->config.elem_array.count;
+	struct dma_sg_elem *elems;
+	unsigned int flags;
+	void *old_elems;
+	void *old_buf;
+	void *buf;
+	int ret;
+
+	/* nothing to move while disabled or suspended */
+	if (!buffer->addr || !elems_size)
+		return 0;
+
+	if (sys) {
+		buf = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0,
+			      SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			      DMA_TRACE_LOCAL_SIZE);
+		elems = rzalloc(SOF_MEM_ZONE_SYS_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				elems_size);
+	} else {
+		buf = rballoc(0, SOF_MEM_CAPS_RAM | SOF_MEM_CAPS_DMA,
+			      DMA_TRACE_LOCAL_SIZE);
+		elems = rzalloc(SOF_MEM_ZONE_RUNTIME, 0, SOF_MEM_CAPS_RAM,
+				elems_size);
+	}
+
+	if (!buf || !elems) {
+		trace_buffer_error("dma_trace_relocate() error: alloc failed");
+		rfree(buf);
+		rfree(elems);
+		return -ENOMEM;
+	}
+
+	spin_lock_irq(&d->lock, flags);
+
+	/* the copy to host reads the buffer without the lock */
+	if (d->copy_in_progress) {
+		spin_unlock_irq(&d->lock, flags);
+		rfree(buf);
+		rfree(elems);
+		return -EBUSY;
+	}
+
+	ret = memcpy_s(buf, DMA_TRACE_LOCAL_SIZE, buffer->addr,
+		       DMA_TRACE_LOCAL_SIZE);
+	assert(!ret);
+	dcache_writeback_region(buf, DMA_TRACE_LOCAL_SIZE);
+
+	ret = memcpy_s(elems, elems_size, d->config.elem_array.elems,
+		       elems_size);
+	assert(!ret);
+
+	old_buf = buffer->addr;
+	old_elems = d->config.elem_array.elems;
+
+	buffer->w_ptr = (char *)buf + ((char *)buffer->w_ptr - (char *)old_buf);
+	buffer->r_ptr = (char *)buf + ((char *)buffer->r_ptr - (char *)old_buf);
+	buffer->addr = buf;
+	buffer->end_addr = (char *)buf + DMA_TRACE_LOCAL_SIZE;
+	d->config.elem_array.elems = elems;
+
+	platform_shared_commit(d, sizeof(*d));
+
+	spin_unlock_irq(&d->lock, flags);
+
+	rfree(old_buf);
+	rfree(old_elems);
+
+	return 0;
+}
+#endif
+
+/* detach the local buffer, new events are dropped until resumed */
+void dma_trace_suspend(struct dma_trace_data *d)
+{
+	unsigned int flags;
+
+	spin_lock_irq(&d->lock, flags);
+
+	if (d->dmatb.addr) {
+		d->suspended_addr = d->dmatb.addr;
+		d->dmatb.addr = NULL;
+	}
+
+	spin_unlock_irq(&d->lock, flags);
+
+	platform_shared_commit(d, sizeof(*d));
+}
+
+/* trace again into the buffers kept by dma_trace_suspend() */
+void dma_trace_resume(struct dma_trace_data *d)
+{
+	unsigned int flags;
+
+	spin_lock_irq(&d->lock, flags);
+
+	if (d->suspended_addr) {
+		d->dmatb.addr = d->suspended_addr;
+		d->suspended_addr = NULL;
+	}
+
+	spin_unlock_irq(&d->lock, flags);
+
+	platform_shared_commit(d, sizeof(*d));
+}
+
+/* stop tracing and release the local and host buffers */
+void dma_trace_disable(struct dma_trace_data *d)
+{
+	dma_trace_off();
+	dma_trace_suspend(d);
+
+	rfree(d->suspended_addr);
+	d->suspended_addr = NULL;
+	d->dmatb.avail = 0;
+
+#if CONFIG_HOST_PTABLE
+	dma_sg_free(&d->config.elem_array);
+#endif
+
+	platform_shared_commit(d, sizeof(*d));
+}
+
 void dma_trace_flush(void *t)
 {
 	struct dma_trace_data *trace_data = dma_trace_data_get();
@@ -436,6 +572,99 @@ static int dtrace_calc_buf_overflow(struct dma_trace_buf *buffer,
 	return overflow;
 }
 
+#if CONFIG_TRACE_COMPACT
+
+/* record size upper bound, sync record is the largest */
+#define DTRACE_COMPACT_MAX_SIZE \
+	(1 + sizeof(uint32_t) + sizeof(struct log_entry_header) + \
+	 _TRACE_EVENT_MAX_ARGUMENT_COUNT * sizeof(uint32_t))
+
+/* sync record is forced after this many compact records */
+#define DTRACE_COMPACT_SYNC_PERIOD	64
+
+static uint32_t dtrace_put_varint(uint8_t *dst, uint32_t val)
+{
+	uint32_t size = 0;
+
+	while (val >= 0x80) {
+		dst[size++] = (val & 0x7f) | 0x80;
+		val >>= 7;
+	}
+	dst[size++] = val;
+
+	return size;
+}
+
+/* re-encode log record as described in user/trace.h */
+static uint32_t dtrace_compact_encode(struct dma_trace_data *d,
+				      const char *e, uint32_t length,
+				      uint8_t *dst)
+{
+	struct log_entry_header header;
+	const uint32_t *params = (const uint32_t *)(e + sizeof(header));
+	uint32_t params_num = (length - sizeof(header)) / sizeof(uint32_t);
+	uint32_t sync = TRACE_COMPACT_SYNC;
+	uint32_t entry;
+	uint32_t size = 0;
+	uint32_t i;
+	uint64_t delta;
+	int ret;
+
+	ret = memcpy_s(&header, sizeof(header), e, sizeof(header));
+	assert(!ret);
+
+	delta = header.timestamp - d->compact_timestamp;
+
+	/* periodic full record, also when delta doesn't fit */
+	if (!d->compact_count || header.timestamp < d->compact_timestamp ||
+	    delta > UINT32_MAX) {
+		dst[size++] = 0;
+		ret = memcpy_s(dst + size, DTRACE_COMPACT_MAX_SIZE - size,
+			       &sync, sizeof(sync));
+		assert(!ret);
+		size += sizeof(sync);
+		ret = memcpy_s(dst + size, DTRACE_COMPACT_MAX_SIZE - size,
+			       e, length);
+		assert(!ret);
+
+		return size + length;
+	}
+
+	entry = (header.log_entry_address - LOG_ENTRY_ELF_BASE) /
+		sizeof(uint32_t);
+
+	size += dtrace_put_varint(dst + size,
+				  ((entry << TRACE_COMPACT_CORE_BITS) |
+				   (header.core_id & TRACE_COMPACT_CORE_MASK)) +
+				  1);
+	size += dtrace_put_varint(dst + size, (uint32_t)delta);
+	size += dtrace_put_varint(dst + size, header.id_0);
+	size += dtrace_put_varint(dst + size, header.id_1);
+
+	/* zigzag keeps small negative values, e.g. error codes, short */
+	for (i = 0; i < params_num; i++)
+		size += dtrace_put_varint(dst + size,
+					  (params[i] << 1) ^
+					  (uint32_t)((int32_t)params[i] >> 31));
+
+	return size;
+}
+
+static void dtrace_compact_commit(struct dma_trace_data *d, const char *e)
+{
+	struct log_entry_header header;
+	int ret;
+
+	ret = memcpy_s(&header, sizeof(header), e, sizeof(header));
+	assert(!ret);
+
+	d->compact_timestamp = header.timestamp;
+	if (++d->compact_count == DTRACE_COMPACT_SYNC_PERIOD)
+		d->compact_count = 0;
+}
+
+#endif /* CONFIG_TRACE_COMPACT */
+
 static void dtrace_add_event(const char *e, uint32_t length)
 {
 	struct dma_trace_data *trace_data = dma_trace_data_get();
@@ -443,6 +672,10 @@ static void dtrace_add_event(const char *e, uint32_t length)
 	uint32_t margin;
 	uint32_t overflow = 0;
 	int ret;
+#if CONFIG_TRACE_COMPACT
+	uint8_t record[DTRACE_COMPACT_MAX_SIZE];
+	const char *log = e;
+#endif
 
 	margin = dtrace_calc_buf_margin(buffer);
 	overflow = dtrace_calc_buf_overflow(buffer, length);
@@ -470,6 +703,13 @@ static void dtrace_add_event(const char *e, uint32_t length)
 		}
 	}
 
+#if CONFIG_TRACE_COMPACT
+	/* encode after the recursion above, delta is to last written record */
+	length = dtrace_compact_encode(trace_data, log, length, record);
+	e = (const char *)record;
+	overflow = dtrace_calc_buf_overflow(buffer, length);
+#endif
+
 	/* checking overflow */
 	if (!overflow) {
 		/* check for buffer wrap */
@@ -500,6 +740,9 @@ static void dtrace_add_event(const char *e, uint32_t length)
 
 		buffer->avail += length;
 		trace_data->messages++;
+#if CONFIG_TRACE_COMPACT
+		dtrace_compact_commit(trace_data, log);
+#endif
 	} else {
 		/* if there is not enough memory for new log, we drop it */
 		trace_data->dropped_entries++;
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/drivers/ipc.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+static struct sof_ipc_buffer test_buf_desc = {
+	.size = 256
+};
+
+static void test_audio_buffer_alias_memory(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *src = buffer_new(&test_buf_desc);
+	struct comp_buffer *snk = buffer_new(&test_buf_desc);
+
+	assert_non_null(src);
+	assert_non_null(snk);
+
+	buffer_alias(src, snk);
+
+	assert_ptr_equal(snk->stream.addr, src->stream.addr);
+	assert_ptr_equal(snk->stream.end_addr, src->stream.end_addr);
+	assert_ptr_equal(snk->alias_prev, src);
+	assert_ptr_equal(src->alias_next, snk);
+	assert_int_equal(snk->stream.free, 256);
+
+	buffer_free(src);
+	assert_null(snk->alias_prev);
+
+	buffer_free(snk);
+}
+
+/* data of the sink is not free for the source */
+static void test_audio_buffer_alias_free_bytes(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *src = buffer_new(&test_buf_desc);
+	struct comp_buffer *snk = buffer_new(&test_buf_desc);
+
+	assert_non_null(src);
+	assert_non_null(snk);
+
+	buffer_alias(src, snk);
+
+	comp_update_buffer_produce(src, 64);
+	assert_int_equal(src->stream.free, 192);
+
+	/* in place component moves the data to the sink */
+	comp_update_buffer_produce(snk, 64);
+	comp_update_buffer_consume(src, 64);
+	assert_ptr_equal(snk->stream.w_ptr, src->stream.r_ptr);
+	assert_int_equal(src->stream.avail, 0);
+	assert_int_equal(src->stream.free, 192);
+	assert_int_equal(snk->stream.avail, 64);
+	assert_int_equal(snk->stream.free, 192);
+
+	comp_update_buffer_produce(src, 100);
+	assert_int_equal(src->stream.free, 92);
+	assert_int_equal(snk->stream.free, 192);
+
+	comp_update_buffer_consume(snk, 64);
+	assert_int_equal(src->stream.free, 156);
+	assert_int_equal(snk->stream.free, 256);
+
+	buffer_free(snk);
+	buffer_free(src);
+}
+
+static void test_audio_buffer_alias_chain(void **state)
+{
+	(void)state;
+
+	struct comp_buffer *a = buffer_new(&test_buf_desc);
+	struct comp_buffer *b = buffer_new(&test_buf_desc);
+	struct comp_buffer *c = buffer_new(&test_buf_desc);
+
+	assert_non_null(a);
+	assert_non_null(b);
+	assert_non_null(c);
+
+	/* aliased upstream first like in capture pipelines */
+	buffer_alias(b, c);
+	buffer_alias(a, b);
+
+	assert_ptr_equal(b->stream.addr, a->stream.addr);
+	assert_ptr_equal(c->stream.addr, a->stream.addr);
+
+	comp_update_buffer_produce(c, 32);
+	comp_update_buffer_produce(b, 16);
+	assert_int_equal(a->stream.free, 208);
+	assert_int_equal(b->stream.free, 208);
+	assert_int_equal(c->stream.free, 224);
+
+	/* b and c get new memory together */
+	assert_int_equal(buffer_unalias(b), 0);
+	assert_null(a->alias_next);
+	assert_ptr_equal(c->stream.addr, b->stream.addr);
+	assert_true(b->stream.addr != a->stream.addr);
+	assert_int_equal(b->stream.avail, 0);
+	assert_int_equal(c->stream.avail, 0);
+
+	assert_int_equal(buffer_unalias(a), 0);
+
+	buffer_free(b);
+	buffer_free(a);
+	buffer_free(c);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_buffer_alias_memory),
+		cmocka_unit_test(test_audio_buffer_alias_free_bytes),
+		cmocka_unit_test(test_audio_buffer_alias_chain),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/buffer.h>
+#include <sof/audio/buffer_cache.h>
+#include <sof/drivers/ipc.h>
+#include <sof/sof.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+static struct sof sof;
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
+
+static struct sof_ipc_buffer test_buf_desc = {
+	.size = 256
+};
+
+/* the heap does not shrink memory, buffer_set_size() keeps the old one */
+void *_brealloc(void *ptr, uint32_t flags, uint32_t caps, size_t bytes,
+		uint32_t alignment)
+{
+	return NULL;
+}
+
+static int setup(void **state)
+{
+	(void)state;
+
+	buffer_cache_init(sof_get());
+	return 0;
+}
+
+/* every test starts with an empty cache */
+static int teardown(void **state)
+{
+	(void)state;
+
+	buffer_cache_trim(UINT32_MAX);
+	assert_int_equal(sof.buffer_cache->count, 0);
+	assert_int_equal(sof.buffer_cache->bytes, 0);
+	return 0;
+}
+
+static void test_audio_buffer_cache_reuse(void **state)
+{
+	(void)state;
+
+	struct buffer_cache *bc = sof.buffer_cache;
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+	struct comp_buffer *old = buf;
+	void *addr = buf->stream.addr;
+	uint32_t hits = bc->hits;
+
+	test_buf_desc.comp.id = 3;
+	comp_update_buffer_produce(buf, 64);
+	buffer_free(buf);
+	assert_int_equal(bc->count, 1);
+	assert_int_equal(bc->bytes, 256);
+
+	/* the same buffer comes back reset */
+	buf = buffer_new(&test_buf_desc);
+	assert_ptr_equal(buf, old);
+	assert_ptr_equal(buf->stream.addr, addr);
+	assert_int_equal(buf->id, 3);
+	assert_int_equal(buf->stream.avail, 0);
+	assert_int_equal(buf->stream.free, 256);
+	assert_true(list_is_empty(&buf->source_list));
+	assert_int_equal(bc->count, 0);
+	assert_int_equal(bc->hits, hits + 1);
+
+	buffer_free(buf);
+	test_buf_desc.comp.id = 0;
+}
+
+/* only the same size and caps are reused */
+static void test_audio_buffer_cache_match(void **state)
+{
+	(void)state;
+
+	struct buffer_cache *bc = sof.buffer_cache;
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+	struct comp_buffer *other;
+	uint32_t misses;
+
+	buffer_free(buf);
+
+	misses = bc->misses;
+	other = buffer_alloc(512, SOF_MEM_CAPS_RAM, PLATFORM_DCACHE_ALIGN);
+	assert_ptr_not_equal(other, buf);
+	buffer_free(other);
+
+	other = buffer_alloc(256, SOF_MEM_CAPS_DMA, PLATFORM_DCACHE_ALIGN);
+	assert_ptr_not_equal(other, buf);
+	buffer_free(other);
+
+	assert_int_equal(bc->misses, misses + 2);
+	assert_int_equal(bc->count, 3);
+	assert_int_equal(bc->bytes, 1024);
+}
+
+/* the cache keeps at most CONFIG_BUFFER_CACHE_SIZE bytes */
+static void test_audio_buffer_cache_limit(void **state)
+{
+	(void)state;
+
+	struct buffer_cache *bc = sof.buffer_cache;
+	struct comp_buffer *buf[4];
+	uint32_t size = CONFIG_BUFFER_CACHE_SIZE / 2;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		buf[i] = buffer_alloc(size, SOF_MEM_CAPS_RAM,
+				      PLATFORM_DCACHE_ALIGN);
+		assert_non_null(buf[i]);
+	}
+
+	for (i = 0; i < 4; i++)
+		buffer_free(buf[i]);
+
+	assert_int_equal(bc->count, 2);
+	assert_int_equal(bc->bytes, CONFIG_BUFFER_CACHE_SIZE);
+	assert_true(bc->peak_bytes >= CONFIG_BUFFER_CACHE_SIZE);
+}
+
+/* trimming gives back the largest buffers first */
+static void test_audio_buffer_cache_trim(void **state)
+{
+	(void)state;
+
+	struct buffer_cache *bc = sof.buffer_cache;
+	struct comp_buffer *small = buffer_alloc(256, SOF_MEM_CAPS_RAM,
+						 PLATFORM_DCACHE_ALIGN);
+	struct comp_buffer *large = buffer_alloc(4096, SOF_MEM_CAPS_RAM,
+						 PLATFORM_DCACHE_ALIGN);
+	uint32_t trimmed = bc->trimmed;
+
+	buffer_free(small);
+	buffer_free(large);
+	assert_int_equal(bc->bytes, 4352);
+
+	assert_int_equal(buffer_cache_trim(1), 4096);
+	assert_int_equal(bc->count, 1);
+	assert_int_equal(bc->bytes, 256);
+	assert_int_equal(bc->trimmed, trimmed + 1);
+
+	assert_ptr_equal(buffer_alloc(256, SOF_MEM_CAPS_RAM,
+				      PLATFORM_DCACHE_ALIGN), small);
+	assert_int_equal(buffer_cache_trim(UINT32_MAX), 0);
+	buffer_free(small);
+}
+
+/* a shrunk buffer is cached by the size of its memory */
+static void test_audio_buffer_cache_shrink(void **state)
+{
+	(void)state;
+
+	struct buffer_cache *bc = sof.buffer_cache;
+	struct comp_buffer *buf = buffer_alloc(1024, SOF_MEM_CAPS_RAM,
+					       PLATFORM_DCACHE_ALIGN);
+	struct comp_buffer *other;
+
+	assert_int_equal(buffer_set_size(buf, 256), 0);
+	assert_int_equal(buf->stream.size, 256);
+	assert_int_equal(buf->alloc_size, 1024);
+
+	buffer_free(buf);
+	assert_int_equal(bc->bytes, 1024);
+
+	other = buffer_alloc(256, SOF_MEM_CAPS_RAM, PLATFORM_DCACHE_ALIGN);
+	assert_ptr_not_equal(other, buf);
+	buffer_free(other);
+
+	other = buffer_alloc(1024, SOF_MEM_CAPS_RAM, PLATFORM_DCACHE_ALIGN);
+	assert_ptr_equal(other, buf);
+	assert_int_equal(other->stream.size, 1024);
+	buffer_free(other);
+
+	assert_int_equal(buffer_cache_trim(UINT32_MAX), 1280);
+}
+
+/* memory of an in place chain is not cached with the buffers using it */
+static void test_audio_buffer_cache_alias(void **state)
+{
+	(void)state;
+
+	struct buffer_cache *bc = sof.buffer_cache;
+	struct comp_buffer *src = buffer_new(&test_buf_desc);
+	struct comp_buffer *snk = buffer_new(&test_buf_desc);
+
+	buffer_alias(src, snk);
+
+	buffer_free(snk);
+	assert_int_equal(bc->count, 0);
+
+	buffer_free(src);
+	assert_int_equal(bc->count, 1);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_teardown(test_audio_buffer_cache_reuse,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_buffer_cache_match,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_buffer_cache_limit,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_buffer_cache_trim,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_buffer_cache_shrink,
+					  teardown),
+		cmocka_unit_test_teardown(test_audio_buffer_cache_alias,
+					  teardown),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup, NULL);
+}
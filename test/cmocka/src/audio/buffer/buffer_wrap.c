@@ -58,11 +58,42 @@ static void test_audio_buffer_write_fill_10_bytes_and_write_5(void **state)
 	buffer_free(buf);
 }
 
+static void test_audio_buffer_set_zero_wrap(void **state)
+{
+	(void)state;
+
+	struct sof_ipc_buffer test_buf_desc = {
+		.size = 10
+	};
+
+	struct comp_buffer *buf = buffer_new(&test_buf_desc);
+
+	assert_non_null(buf);
+
+	uint8_t bytes[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+	memcpy_s(buf->stream.w_ptr, test_buf_desc.size, &bytes, 10);
+	comp_update_buffer_produce(buf, 7);
+	comp_update_buffer_consume(buf, 6);
+
+	/* 3 bytes to the end of the buffer and 2 from the start */
+	audio_stream_set_zero(&buf->stream, 5);
+	comp_update_buffer_produce(buf, 5);
+
+	uint8_t ref[10] = {0, 0, 3, 4, 5, 6, 7, 0, 0, 0};
+
+	assert_int_equal(buf->stream.avail, 6);
+	assert_int_equal(memcmp(buf->stream.addr, &ref, 10), 0);
+
+	buffer_free(buf);
+}
+
 int main(void)
 {
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test
-			(test_audio_buffer_write_fill_10_bytes_and_write_5)
+			(test_audio_buffer_write_fill_10_bytes_and_write_5),
+		cmocka_unit_test(test_audio_buffer_set_zero_wrap)
 	};
 
 	cmocka_set_message_output(CM_OUTPUT_TAP);
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/coef_store.h>
+#include <sof/sof.h>
+#include <sof/string.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+static const int32_t blob_a[] = { 16, 1, 2, 3 };
+static const int32_t blob_b[] = { 16, 1, 2, 4 };
+
+#define SLOT_SIZE	64
+#define INSTANCES	4
+
+static int setup(void **state)
+{
+	(void)state;
+
+	coef_store_init(sof_get());
+	return coef_store_open(SLOT_SIZE);
+}
+
+static int teardown(void **state)
+{
+	(void)state;
+
+	coef_store_close(SLOT_SIZE);
+	return 0;
+}
+
+static void test_audio_coef_store_share(void **state)
+{
+	(void)state;
+
+	int32_t copy[4] = { 16, 1, 2, 3 };
+	int32_t *a1 = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+	int32_t *a2 = coef_store_get(copy, sizeof(copy), SLOT_SIZE);
+
+	assert_non_null(a1);
+	assert_ptr_equal(a1, a2);
+	assert_ptr_not_equal(a1, blob_a);
+	assert_memory_equal(a1, blob_a, sizeof(blob_a));
+	assert_int_equal(coef_store_refs(a1), 2);
+
+	coef_store_put(a2);
+	assert_int_equal(coef_store_refs(a1), 1);
+	coef_store_put(a1);
+}
+
+static void test_audio_coef_store_different(void **state)
+{
+	(void)state;
+
+	int32_t *a = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+	int32_t *b = coef_store_get(blob_b, sizeof(blob_b), SLOT_SIZE);
+	int32_t *c = coef_store_get(blob_a, sizeof(blob_a) - sizeof(int32_t),
+				    SLOT_SIZE);
+
+	assert_ptr_not_equal(a, b);
+	assert_ptr_not_equal(a, c);
+	assert_int_equal(coef_store_refs(a), 1);
+	assert_int_equal(coef_store_refs(b), 1);
+	assert_int_equal(coef_store_refs(c), 1);
+
+	coef_store_put(a);
+	coef_store_put(b);
+	coef_store_put(c);
+}
+
+/* an update gets the new content and puts the old one */
+static void test_audio_coef_store_update(void **state)
+{
+	(void)state;
+
+	int32_t *a1 = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+	int32_t *a2 = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+	int32_t *b;
+
+	b = coef_store_get(blob_b, sizeof(blob_b), SLOT_SIZE);
+	coef_store_put(a2);
+
+	assert_memory_equal(a1, blob_a, sizeof(blob_a));
+	assert_memory_equal(b, blob_b, sizeof(blob_b));
+	assert_int_equal(coef_store_refs(a1), 1);
+
+	/* the last reference frees the slot, a new get copies again */
+	coef_store_put(a1);
+	a1 = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+	assert_int_equal(coef_store_refs(a1), 1);
+
+	coef_store_put(NULL);
+	coef_store_put(a1);
+	coef_store_put(b);
+}
+
+/* a blob received in parts is shared when committed */
+static void test_audio_coef_store_commit(void **state)
+{
+	(void)state;
+
+	int32_t *a = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+	int32_t *slot = coef_store_reserve(SLOT_SIZE);
+	int32_t *b;
+
+	assert_non_null(slot);
+	assert_int_equal(memcpy_s(slot, SLOT_SIZE, blob_a, sizeof(blob_a)), 0);
+	assert_ptr_equal(coef_store_commit(slot, sizeof(blob_a)), a);
+	assert_int_equal(coef_store_refs(a), 2);
+
+	/* the slot was given back and takes the next blob */
+	slot = coef_store_reserve(SLOT_SIZE);
+	assert_int_equal(memcpy_s(slot, SLOT_SIZE, blob_b, sizeof(blob_b)), 0);
+	b = coef_store_commit(slot, sizeof(blob_b));
+	assert_ptr_equal(b, slot);
+	assert_int_equal(coef_store_refs(b), 1);
+
+	coef_store_release(coef_store_reserve(SLOT_SIZE));
+	coef_store_release(NULL);
+
+	coef_store_put(a);
+	coef_store_put(a);
+	coef_store_put(b);
+}
+
+/* the pool has a slot per blob in use and a spare */
+static void test_audio_coef_store_slots(void **state)
+{
+	(void)state;
+
+	int32_t data[INSTANCES][4];
+	int32_t *blob[INSTANCES];
+	int i;
+
+	assert_null(coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE * 2));
+	assert_null(coef_store_get(blob_a, SLOT_SIZE + 1, SLOT_SIZE));
+	assert_int_equal(coef_store_slots(SLOT_SIZE), 1);
+
+	/* instances with the same tuning share one slot */
+	for (i = 0; i < INSTANCES; i++) {
+		assert_int_equal(coef_store_open(SLOT_SIZE), 0);
+		blob[i] = coef_store_get(blob_a, sizeof(blob_a), SLOT_SIZE);
+		assert_non_null(blob[i]);
+	}
+	assert_int_equal(coef_store_slots(SLOT_SIZE), 2);
+
+	for (i = 0; i < INSTANCES; i++) {
+		coef_store_put(blob[i]);
+		coef_store_close(SLOT_SIZE);
+	}
+	assert_int_equal(coef_store_slots(SLOT_SIZE), 1);
+
+	/* instances with their own tuning need a slot each */
+	for (i = 0; i < INSTANCES; i++) {
+		assert_int_equal(memcpy_s(data[i], sizeof(data[i]), blob_a,
+					 sizeof(blob_a)), 0);
+		data[i][3] = i;
+		assert_int_equal(coef_store_open(SLOT_SIZE), 0);
+		blob[i] = coef_store_get(data[i], sizeof(data[i]), SLOT_SIZE);
+		assert_non_null(blob[i]);
+	}
+	assert_int_equal(coef_store_slots(SLOT_SIZE), INSTANCES + 1);
+
+	for (i = 0; i < INSTANCES; i++) {
+		coef_store_put(blob[i]);
+		coef_store_close(SLOT_SIZE);
+	}
+	assert_int_equal(coef_store_slots(SLOT_SIZE), 1);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_coef_store_share),
+		cmocka_unit_test(test_audio_coef_store_different),
+		cmocka_unit_test(test_audio_coef_store_update),
+		cmocka_unit_test(test_audio_coef_store_commit),
+		cmocka_unit_test(test_audio_coef_store_slots),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
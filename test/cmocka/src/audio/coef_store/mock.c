@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/sof.h>
+#include <sof/trace/trace.h>
+
+#include <mock_trace.h>
+
+TRACE_IMPL()
+
+static struct sof sof;
+
+struct sof *sof_get(void)
+{
+	return &sof;
+}
@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <sof/audio/eq_fir/fir.h>
+#include <sof/audio/eq_fir/fir_fft.h>
+#include <sof/common.h>
+#include <user/eq.h>
+
+/* Partition and hop length, as CONFIG_COMP_FIR_FFT_BLOCK defaults to */
+#define TEST_BLOCK		64
+
+/* Samples per test, the first half loud and the second half 80 dB lower */
+#define TEST_SAMPLES		48000
+
+/* Min SNR against the double precision convolution */
+#define TEST_SNR_LOUD		120.0
+#define TEST_SNR_QUIET		65.0
+
+/* Max difference in LSB of the FFT and the direct form outputs */
+#define TEST_TOLERANCE		1024
+
+static const int test_taps[] = {100, 256, 1024};
+
+static uint32_t test_seed;
+
+/* Reproducible random value within +/- 0.5 */
+static double test_rand(void)
+{
+	test_seed = test_seed * 1664525 + 1013904223;
+	return (int32_t)test_seed / 4294967296.0;
+}
+
+/* Decaying random response with the output shift of the EQ blobs */
+static struct sof_eq_fir_coef_data *test_response(int taps)
+{
+	struct sof_eq_fir_coef_data *eq;
+	int i;
+
+	eq = calloc(1, sizeof(*eq) + taps * sizeof(int16_t));
+	assert_non_null(eq);
+
+	eq->length = taps;
+	eq->out_shift = 1;
+	for (i = 0; i < taps; i++)
+		eq->coef[i] = test_rand() * 20000 * exp(-4.0 * i / taps);
+
+	return eq;
+}
+
+static int32_t *test_input(void)
+{
+	int32_t *x = malloc(TEST_SAMPLES * sizeof(int32_t));
+	double scale;
+	int i;
+
+	assert_non_null(x);
+
+	for (i = 0; i < TEST_SAMPLES; i++) {
+		scale = i < TEST_SAMPLES / 2 ? 1.0e9 : 1.0e5;
+		x[i] = test_rand() * scale;
+	}
+
+	return x;
+}
+
+/* Q1.15 coefficients, Q1.31 samples and the output shift */
+static double test_ref(const struct sof_eq_fir_coef_data *eq,
+		       const int32_t *x, int n)
+{
+	double y = 0;
+	int i;
+
+	for (i = 0; i < eq->length && i <= n; i++)
+		y += (double)eq->coef[i] * x[n - i];
+
+	return y / (1 << (15 + eq->out_shift));
+}
+
+static void test_audio_fir_fft_response(void **state)
+{
+	struct sof_eq_fir_coef_data *eq;
+	struct sof_eq_fir_coef_data *eqs[2];
+	struct fir_fft *fft;
+	double err_loud;
+	double err_quiet;
+	double pow_loud;
+	double pow_quiet;
+	double ref;
+	double d;
+	int32_t *x;
+	int32_t bypass;
+	int32_t y;
+	int t;
+	int i;
+
+	for (t = 0; t < ARRAY_SIZE(test_taps); t++) {
+		test_seed = t;
+		eq = test_response(test_taps[t]);
+		x = test_input();
+
+		/* the second channel is in bypass */
+		eqs[0] = eq;
+		eqs[1] = NULL;
+		fft = fir_fft_new(eqs, 2, TEST_BLOCK);
+		assert_non_null(fft);
+
+		err_loud = 0;
+		err_quiet = 0;
+		pow_loud = 0;
+		pow_quiet = 0;
+		for (i = 0; i < TEST_SAMPLES; i++) {
+			y = fir_fft_32(fft, &fft->ch[0], x[i]);
+			bypass = fir_fft_32(fft, &fft->ch[1], x[i]);
+			if (i < TEST_BLOCK)
+				continue;
+
+			/* the bypass channel is only delayed */
+			assert_int_equal(bypass, x[i - TEST_BLOCK]);
+
+			ref = test_ref(eq, x, i - TEST_BLOCK);
+			d = y - ref;
+			if (i < TEST_SAMPLES / 2) {
+				err_loud += d * d;
+				pow_loud += ref * ref;
+			} else if (i > TEST_SAMPLES / 2 + 2 * eq->length) {
+				err_quiet += d * d;
+				pow_quiet += ref * ref;
+			}
+		}
+
+		print_message("taps %d snr %.1f dB, quiet %.1f dB\n",
+			      eq->length, 10 * log10(pow_loud / err_loud),
+			      10 * log10(pow_quiet / err_quiet));
+		assert_true(10 * log10(pow_loud / err_loud) > TEST_SNR_LOUD);
+		assert_true(10 * log10(pow_quiet / err_quiet) > TEST_SNR_QUIET);
+
+		fir_fft_free(fft);
+		free(x);
+		free(eq);
+	}
+}
+
+#if FIR_GENERIC
+/* Prints the time of the direct form and of the FFT convolution for the
+ * same response, the ratio is the speedup of the FFT. The outputs must
+ * match but for the block delay and the rounding.
+ */
+static void test_audio_fir_fft_throughput(void **state)
+{
+	struct sof_eq_fir_coef_data *eq;
+	struct sof_eq_fir_coef_data *eqs[1];
+	struct fir_state_32x16 fir;
+	struct fir_fft *fft;
+	clock_t direct;
+	clock_t conv;
+	int32_t *delay;
+	int32_t *data;
+	int32_t *x;
+	int32_t *yd;
+	int32_t *yf;
+	int t;
+	int i;
+
+	for (t = 0; t < ARRAY_SIZE(test_taps); t++) {
+		test_seed = t;
+		eq = test_response(test_taps[t]);
+		x = test_input();
+		yd = malloc(TEST_SAMPLES * sizeof(int32_t));
+		yf = malloc(TEST_SAMPLES * sizeof(int32_t));
+		assert_non_null(yd);
+		assert_non_null(yf);
+
+		delay = calloc(eq->length, sizeof(int32_t));
+		assert_non_null(delay);
+		data = delay;
+		fir_reset(&fir);
+		assert_int_equal(fir_init_coef(&fir, eq), 0);
+		fir_init_delay(&fir, &data);
+
+		eqs[0] = eq;
+		fft = fir_fft_new(eqs, 1, TEST_BLOCK);
+		assert_non_null(fft);
+
+		direct = clock();
+		for (i = 0; i < TEST_SAMPLES; i++)
+			yd[i] = fir_32x16(&fir, x[i]);
+		direct = clock() - direct;
+
+		conv = clock();
+		for (i = 0; i < TEST_SAMPLES; i++)
+			yf[i] = fir_fft_32(fft, &fft->ch[0], x[i]);
+		conv = clock() - conv;
+
+		print_message("taps %d direct %ld fft %ld clocks, %.1fx\n",
+			      eq->length, (long)direct, (long)conv,
+			      conv ? (double)direct / conv : 0.0);
+
+		for (i = TEST_BLOCK; i < TEST_SAMPLES; i++)
+			assert_true(abs(yf[i] - yd[i - TEST_BLOCK]) <=
+				    TEST_TOLERANCE);
+
+		fir_fft_free(fft);
+		free(yf);
+		free(yd);
+		free(delay);
+		free(x);
+		free(eq);
+	}
+}
+#endif /* FIR_GENERIC */
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_audio_fir_fft_response),
+#if FIR_GENERIC
+		cmocka_unit_test(test_audio_fir_fft_throughput),
+#endif
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/audio/component.h>
+#include <sof/audio/mux.h>
+#include <sof/bit.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+struct test_data {
+	struct comp_dev *dev;
+	struct comp_data *cd;
+};
+
+static int setup_group(void **state)
+{
+	sys_comp_init(sof_get());
+	sys_comp_mux_init();
+
+	return 0;
+}
+
+static int setup_test_case(void **state, uint32_t type)
+{
+	struct test_data *td = malloc(sizeof(struct test_data));
+	struct sof_ipc_comp_process ipc = {
+		.comp = {
+			.hdr = {
+				.size = sizeof(struct sof_ipc_comp_process)
+			},
+			.type = type
+		},
+		.config = {
+			.hdr = {
+				.size = sizeof(struct sof_ipc_comp_config)
+			}
+		}
+	};
+
+	td->dev = comp_new((struct sof_ipc_comp *)&ipc);
+	if (!td->dev)
+		return -EINVAL;
+
+	td->cd = (struct comp_data *)td->dev->private;
+
+#if CONFIG_FORMAT_S16LE
+	td->cd->config.frame_format = SOF_IPC_FRAME_S16_LE;
+#elif CONFIG_FORMAT_S24LE
+	td->cd->config.frame_format = SOF_IPC_FRAME_S24_4LE;
+#else
+	td->cd->config.frame_format = SOF_IPC_FRAME_S32_LE;
+#endif
+
+	*state = td;
+
+	return 0;
+}
+
+static int setup_mux(void **state)
+{
+	return setup_test_case(state, SOF_COMP_MUX);
+}
+
+static int setup_demux(void **state)
+{
+	return setup_test_case(state, SOF_COMP_DEMUX);
+}
+
+static int teardown_test_case(void **state)
+{
+	struct test_data *td = *state;
+
+	comp_free(td->dev);
+	free(td);
+
+	return 0;
+}
+
+static void assert_route(const struct mux_look_up *lookup, int index,
+			 uint8_t stream, uint8_t channel)
+{
+	assert_int_equal(lookup->routes[index].stream, stream);
+	assert_int_equal(lookup->routes[index].channel, channel);
+}
+
+static void test_mux_look_up_copy(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup = &td->cd->lookup[0];
+
+	/* stereo stream 1 swapped onto the sink */
+	td->cd->config.num_channels = 2;
+	td->cd->config.streams[1].num_channels = 2;
+	td->cd->config.streams[1].mask[0] = 0x2;
+	td->cd->config.streams[1].mask[1] = 0x1;
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+	assert_int_equal(lookup->kernel, MUX_KERNEL_COPY);
+	assert_non_null(lookup->func);
+	assert_int_equal(lookup->stream_mask, 0x2);
+	assert_int_equal(lookup->first[0], 0);
+	assert_int_equal(lookup->first[1], 1);
+	assert_int_equal(lookup->first[2], 2);
+	assert_route(lookup, 0, 1, 1);
+	assert_route(lookup, 1, 1, 0);
+}
+
+static void test_mux_look_up_fan_out(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup = &td->cd->lookup[0];
+
+	/* mono stream 0 on all four sink channels */
+	td->cd->config.num_channels = 4;
+	td->cd->config.streams[0].num_channels = 1;
+	td->cd->config.streams[0].mask[0] = 0x1;
+	td->cd->config.streams[0].mask[1] = 0x1;
+	td->cd->config.streams[0].mask[2] = 0x1;
+	td->cd->config.streams[0].mask[3] = 0x1;
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+	assert_int_equal(lookup->kernel, MUX_KERNEL_FAN_OUT);
+	assert_int_equal(lookup->stream_mask, 0x1);
+	assert_int_equal(lookup->first[4], 4);
+	assert_route(lookup, 3, 0, 0);
+}
+
+static void test_mux_look_up_downmix(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup = &td->cd->lookup[0];
+
+	/* stereo stream 0 summed into a mono sink */
+	td->cd->config.num_channels = 1;
+	td->cd->config.streams[0].num_channels = 2;
+	td->cd->config.streams[0].mask[0] = 0x3;
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+	assert_int_equal(lookup->kernel, MUX_KERNEL_DOWNMIX);
+	assert_int_equal(lookup->first[1], 2);
+	assert_route(lookup, 0, 0, 0);
+	assert_route(lookup, 1, 0, 1);
+}
+
+static void test_mux_look_up_mix(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup = &td->cd->lookup[0];
+
+	/* left mixed from two streams, right from one */
+	td->cd->config.num_channels = 2;
+	td->cd->config.streams[0].num_channels = 2;
+	td->cd->config.streams[0].mask[0] = 0x1;
+	td->cd->config.streams[0].mask[1] = 0x2;
+	td->cd->config.streams[2].num_channels = 1;
+	td->cd->config.streams[2].mask[0] = 0x1;
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+	assert_int_equal(lookup->kernel, MUX_KERNEL_MIX);
+	assert_int_equal(lookup->stream_mask, 0x5);
+	assert_int_equal(lookup->src_channels[0], 2);
+	assert_int_equal(lookup->src_channels[2], 1);
+	assert_int_equal(lookup->first[1], 2);
+	assert_int_equal(lookup->first[2], 3);
+	assert_route(lookup, 0, 0, 0);
+	assert_route(lookup, 1, 2, 0);
+	assert_route(lookup, 2, 0, 1);
+}
+
+static void test_mux_look_up_wide(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup = &td->cd->lookup[0];
+	int i;
+
+	/* 16 channel array, channels past the masks pass unchanged */
+	td->cd->config.num_channels = 16;
+	td->cd->config.streams[0].num_channels = 16;
+	for (i = 0; i < MUX_MASK_CHANNELS; i++)
+		td->cd->config.streams[0].mask[i] = BIT(i);
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+	assert_int_equal(lookup->kernel, MUX_KERNEL_COPY);
+	assert_int_equal(lookup->num_channels, 16);
+	assert_int_equal(lookup->first[16], 16);
+
+	for (i = 0; i < 16; i++)
+		assert_route(lookup, i, 0, i);
+}
+
+static void test_demux_look_up(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup;
+	int i;
+
+	/* stereo source split into a mono left and a mono right sink */
+	td->cd->config.num_channels = 2;
+	td->cd->config.streams[0].num_channels = 1;
+	td->cd->config.streams[0].mask[0] = 0x1;
+	td->cd->config.streams[1].num_channels = 1;
+	td->cd->config.streams[1].mask[0] = 0x2;
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+
+	for (i = 0; i < 2; i++) {
+		lookup = &td->cd->lookup[i];
+		assert_int_equal(lookup->kernel, MUX_KERNEL_COPY);
+		assert_int_equal(lookup->num_channels, 1);
+		assert_int_equal(lookup->src_channels[0], 2);
+		assert_int_equal(lookup->first[1], 1);
+		assert_route(lookup, 0, 0, i);
+	}
+}
+
+static void test_demux_look_up_wide(void **state)
+{
+	struct test_data *td = *state;
+	struct mux_look_up *lookup = &td->cd->lookup[0];
+
+	/* 32 channel source, the first sink takes all, the second a pair */
+	td->cd->config.num_channels = 32;
+	td->cd->config.streams[0].num_channels = 32;
+	td->cd->config.streams[0].mask[0] = 0x1;
+	td->cd->config.streams[0].mask[1] = 0x2;
+	td->cd->config.streams[1].num_channels = 2;
+	td->cd->config.streams[1].mask[0] = 0x4;
+	td->cd->config.streams[1].mask[1] = 0x8;
+
+	assert_int_equal(mux_update_look_up_tables(td->dev), 0);
+
+	/* channels up to the masks without a mask bit stay silent */
+	assert_int_equal(lookup->num_channels, 32);
+	assert_int_equal(lookup->src_channels[0], 32);
+	assert_int_equal(lookup->first[2], 2);
+	assert_int_equal(lookup->first[MUX_MASK_CHANNELS], 2);
+	assert_int_equal(lookup->first[32], 34 - MUX_MASK_CHANNELS);
+	assert_route(lookup, 2, 0, MUX_MASK_CHANNELS);
+	assert_route(lookup, 33 - MUX_MASK_CHANNELS, 0, 31);
+
+	lookup = &td->cd->lookup[1];
+	assert_int_equal(lookup->kernel, MUX_KERNEL_COPY);
+	assert_int_equal(lookup->first[2], 2);
+	assert_route(lookup, 0, 0, 2);
+	assert_route(lookup, 1, 0, 3);
+}
+
+#define TEST_CASE(name, setup) \
+	cmocka_unit_test_setup_teardown(name, setup, teardown_test_case)
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		TEST_CASE(test_mux_look_up_copy, setup_mux),
+		TEST_CASE(test_mux_look_up_fan_out, setup_mux),
+		TEST_CASE(test_mux_look_up_downmix, setup_mux),
+		TEST_CASE(test_mux_look_up_mix, setup_mux),
+		TEST_CASE(test_mux_look_up_wide, setup_mux),
+		TEST_CASE(test_demux_look_up, setup_demux),
+		TEST_CASE(test_demux_look_up_wide, setup_demux),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, setup_group, NULL);
+}
@@ -31,6 +31,7 @@ struct sel_test_parameters {
 	uint32_t sink_format;
 	void (*verify)(struct comp_dev *dev, struct audio_stream *sink,
 		       struct audio_stream *source);
+	const uint16_t *ch_map;	/* source channel of each sink channel */
 };
 
 static int setup(void **state)
@@ -39,6 +40,7 @@ static int setup(void **state)
 	struct sel_test_state *sel_state;
 	struct comp_data *cd;
 	uint32_t size = 0;
+	uint32_t ch;
 	void *pbuff;
 
 	/* allocate new state */
@@ -59,6 +61,21 @@ static int setup(void **state)
 	cd->config.out_channels_count = parameters->out_channels;
 	cd->config.sel_channel = parameters->sel_channel;
 
+	/* compiled channel map as set up by prepare */
+	cd->stream_map = NULL;
+	cd->in_channels = parameters->in_channels;
+	cd->out_channels = parameters->out_channels;
+	cd->ch_map = test_calloc(cd->out_channels, sizeof(*cd->ch_map));
+	cd->frame = test_calloc(cd->in_channels + cd->out_channels,
+				sizeof(*cd->frame));
+	for (ch = 0; ch < parameters->out_channels; ch++)
+		if (parameters->ch_map)
+			cd->ch_map[ch] = parameters->ch_map[ch];
+		else if (parameters->out_channels == 1)
+			cd->ch_map[ch] = parameters->sel_channel;
+		else
+			cd->ch_map[ch] = ch;
+
 	cd->sel_func = sel_get_processing_function(sel_state->dev);
 
 	/* allocate new sink buffer */
@@ -94,6 +111,8 @@ static int teardown(void **state)
 	struct comp_data *cd = comp_get_drvdata(sel_state->dev);
 
 	/* free everything */
+	test_free(cd->ch_map);
+	test_free(cd->frame);
 	test_free(cd);
 	test_free(sel_state->dev);
 	test_free(sel_state->sink->addr);
@@ -179,6 +198,28 @@ static void verify_s16le_4ch_to_4ch(struct comp_dev *dev,
 	}
 }
 
+static void verify_s16le_ch_map(struct comp_dev *dev,
+				struct audio_stream *sink,
+				struct audio_stream *source)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const int16_t *src = (int16_t *)source->r_ptr;
+	const int16_t *dst = (int16_t *)sink->w_ptr;
+	uint32_t channel;
+	uint32_t i;
+
+	for (i = 0; i < dev->frames; i++) {
+		for (channel = 0; channel < cd->out_channels; channel++) {
+			if (cd->ch_map[channel] == SEL_CHANNEL_NONE)
+				assert_int_equal(dst[channel], 0);
+			else
+				assert_int_equal(dst[channel],
+						 src[cd->ch_map[channel]]);
+		}
+		src += cd->in_channels;
+		dst += cd->out_channels;
+	}
+}
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
@@ -253,8 +294,39 @@ static void verify_s32le_4ch_to_4ch(struct comp_dev *dev,
 		}
 	}
 }
+
+static void verify_s32le_ch_map(struct comp_dev *dev,
+				struct audio_stream *sink,
+				struct audio_stream *source)
+{
+	struct comp_data *cd = comp_get_drvdata(dev);
+	const int32_t *src = (int32_t *)source->r_ptr;
+	const int32_t *dst = (int32_t *)sink->w_ptr;
+	uint32_t channel;
+	uint32_t i;
+
+	for (i = 0; i < dev->frames; i++) {
+		for (channel = 0; channel < cd->out_channels; channel++) {
+			if (cd->ch_map[channel] == SEL_CHANNEL_NONE)
+				assert_int_equal(dst[channel], 0);
+			else
+				assert_int_equal(dst[channel],
+						 src[cd->ch_map[channel]]);
+		}
+		src += cd->in_channels;
+		dst += cd->out_channels;
+	}
+}
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 
+static const uint16_t map_swap[] = { 1, 0 };
+static const uint16_t map_4to2[] = { 3, 1 };
+static const uint16_t map_8to2[] = { 6, 2 };
+static const uint16_t map_8to3[] = { 7, SEL_CHANNEL_NONE, 0 };
+static const uint16_t map_32to16[] = {
+	31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1
+};
+
 static void test_audio_sel(void **state)
 {
 	struct sel_test_state *sel_state = *state;
@@ -292,6 +364,12 @@ static struct sel_test_parameters parameters[] = {
 	{ 4, 4, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_4ch_to_4ch },
 	{ 2, 1, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_Xch_to_1ch },
 	{ 4, 1, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_Xch_to_1ch },
+	{ 2, 2, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_ch_map, map_swap },
+	{ 4, 2, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_ch_map, map_4to2 },
+	{ 8, 2, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_ch_map, map_8to2 },
+	{ 8, 3, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_ch_map, map_8to3 },
+	{ 16, 1, 9, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_Xch_to_1ch },
+	{ 32, 16, 0, 48, 1, SOF_IPC_FRAME_S16_LE, SOF_IPC_FRAME_S16_LE, verify_s16le_ch_map, map_32to16 },
 #endif /* CONFIG_FORMAT_S16LE */
 #if CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE
 	{ 2, 1, 0, 16, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
@@ -302,6 +380,12 @@ static struct sel_test_parameters parameters[] = {
 	{ 4, 4, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_4ch_to_4ch },
 	{ 2, 1, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
 	{ 4, 1, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
+	{ 2, 2, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_ch_map, map_swap },
+	{ 4, 2, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_ch_map, map_4to2 },
+	{ 8, 2, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_ch_map, map_8to2 },
+	{ 8, 3, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_ch_map, map_8to3 },
+	{ 16, 1, 9, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_Xch_to_1ch },
+	{ 32, 16, 0, 48, 1, SOF_IPC_FRAME_S24_4LE, SOF_IPC_FRAME_S24_4LE, verify_s32le_ch_map, map_32to16 },
 #endif /* CONFIG_FORMAT_S24LE || CONFIG_FORMAT_S32LE */
 };
 
@@ -104,6 +104,8 @@ static int setup(void **state)
 
 	/* set processing function and volume */
 	cd->scale_vol = vol_get_processing_function(vol_state->dev);
+	cd->volume = test_calloc(parameters->channels, sizeof(*cd->volume));
+	cd->max_channels = parameters->channels;
 	set_volume(cd->volume, parameters->volume, parameters->channels);
 
 	/* assigns verification function */
@@ -121,6 +123,7 @@ static int teardown(void **state)
 	struct comp_data *cd = comp_get_drvdata(vol_state->dev);
 
 	/* free everything */
+	test_free(cd->volume);
 	test_free(cd);
 	test_free(vol_state->dev);
 	test_free(vol_state->sink->stream.addr);
@@ -416,6 +419,10 @@ static struct vol_test_parameters parameters[] = {
 		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16 }, /* 2 */
 	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S16_LE,
 		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16 }, /* 3 */
+	{ VOL_MINUS_80DB, 1, 48, 1, SOF_IPC_FRAME_S16_LE,
+		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16 },
+	{ VOL_MAX,       16, 48, 1, SOF_IPC_FRAME_S16_LE,
+		SOF_IPC_FRAME_S16_LE,   verify_s16_to_s16 },
 #endif /* CONFIG_FORMAT_S16LE */
 
 #if CONFIG_FORMAT_S24LE
@@ -425,6 +432,10 @@ static struct vol_test_parameters parameters[] = {
 		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 5 */
 	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S24_4LE,
 		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 }, /* 6 */
+	{ VOL_MINUS_80DB, 1, 48, 1, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 },
+	{ VOL_MAX,       16, 48, 1, SOF_IPC_FRAME_S24_4LE,
+		SOF_IPC_FRAME_S24_4LE, verify_s24_to_s24_s32 },
 #endif /* CONFIG_FORMAT_S24LE */
 
 #if CONFIG_FORMAT_S32LE
@@ -434,6 +445,10 @@ static struct vol_test_parameters parameters[] = {
 		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 8 */
 	{ VOL_MINUS_80DB, 2, 48, 1, SOF_IPC_FRAME_S32_LE,
 		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 }, /* 9 */
+	{ VOL_MINUS_80DB, 1, 48, 1, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 },
+	{ VOL_MAX,       16, 48, 1, SOF_IPC_FRAME_S32_LE,
+		SOF_IPC_FRAME_S32_LE,   verify_s32_to_s24_s32 },
 #endif /* CONFIG_FORMAT_S32LE */
 };
 
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/math/decibels.h>
+
+/* Both approximations are specified to 0.01 dB */
+#define CMP_TOLERANCE_DB 0.01
+
+static void test_math_decibels_lin2db_fixed(void **state)
+{
+	(void)state;
+
+	double lin;
+	double ref;
+	double db;
+	int32_t x;
+
+	/* -120 dBFS to full scale in 0.1 dB steps */
+	for (lin = pow(10, -6); lin < 1.0; lin *= pow(10, 0.005)) {
+		x = (int32_t)(lin * 2147483648.0);
+		ref = 20 * log10(x / 2147483648.0);
+		db = Q_CONVERT_QTOF(lin2db_fixed(x), LIN2DB_FIXED_OUTPUT_QY);
+		if (fabs(db - ref) > CMP_TOLERANCE_DB)
+			printf("%s: %.4f dB for %.4f dB\n", __func__, db, ref);
+
+		assert_true(fabs(db - ref) <= CMP_TOLERANCE_DB);
+	}
+
+	/* zero and negative input are the minimum level */
+	assert_int_equal(lin2db_fixed(0), lin2db_fixed(-1));
+	assert_true(lin2db_fixed(0) <= lin2db_fixed(1));
+}
+
+static void test_math_decibels_db2lin_fast_fixed(void **state)
+{
+	(void)state;
+
+	double ref;
+	double db;
+	double y;
+	int32_t x;
+
+	/* -50 dB to +60 dB in 0.1 dB steps */
+	for (db = -50.0; db <= 60.0; db += 0.1) {
+		x = Q_CONVERT_FLOAT(db, DB2LIN_FIXED_INPUT_QY);
+		ref = Q_CONVERT_QTOF(x, DB2LIN_FIXED_INPUT_QY);
+		y = Q_CONVERT_QTOF(db2lin_fast_fixed(x),
+				   DB2LIN_FIXED_OUTPUT_QY);
+		y = 20 * log10(y);
+		if (fabs(y - ref) > CMP_TOLERANCE_DB)
+			printf("%s: %.4f dB for %.4f dB\n", __func__, y, ref);
+
+		assert_true(fabs(y - ref) <= CMP_TOLERANCE_DB);
+	}
+
+	/* saturation above the output range */
+	assert_int_equal(db2lin_fast_fixed(Q_CONVERT_FLOAT(100.0, 24)),
+			 INT32_MAX);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_decibels_lin2db_fixed),
+		cmocka_unit_test(test_math_decibels_db2lin_fast_fixed),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
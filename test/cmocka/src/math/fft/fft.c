@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <math.h>
+#include <cmocka.h>
+
+#include <sof/audio/format.h>
+#include <sof/common.h>
+#include <sof/math/fft.h>
+
+/* Max error in LSB of the 1/size scaled Q1.31 output */
+#define FFT_TOLERANCE	8.0
+
+static const uint32_t fft_sizes[] = {4, 8, 16, 32, 64, 128, 256, 512, 1024};
+
+static uint32_t fft_seed;
+
+/* Reproducible test signal within +/- 0.5 */
+static int32_t fft_rand(void)
+{
+	fft_seed = fft_seed * 1664525 + 1013904223;
+	return (int32_t)fft_seed >> 2;
+}
+
+/* Reference DFT divided by size */
+static void dft_ref(const struct icomplex32 *x, double *re, double *im,
+		    uint32_t size)
+{
+	double a;
+	uint32_t i;
+	uint32_t k;
+
+	for (k = 0; k < size; k++) {
+		re[k] = 0;
+		im[k] = 0;
+		for (i = 0; i < size; i++) {
+			a = -2 * M_PI * ((uint64_t)i * k % size) / size;
+			re[k] += x[i].real * cos(a) - x[i].imag * sin(a);
+			im[k] += x[i].real * sin(a) + x[i].imag * cos(a);
+		}
+
+		re[k] /= size;
+		im[k] /= size;
+	}
+}
+
+static void test_math_fft_complex(void **state)
+{
+	struct fft_plan *plan;
+	struct icomplex32 *x;
+	struct icomplex32 *y;
+	double *re;
+	double *im;
+	double err;
+	uint32_t size;
+	int i;
+	int k;
+
+	(void)state;
+
+	for (i = 0; i < ARRAY_SIZE(fft_sizes); i++) {
+		size = fft_sizes[i];
+		plan = fft_plan_new(size);
+		x = malloc(size * sizeof(*x));
+		y = malloc(size * sizeof(*y));
+		re = malloc(size * sizeof(*re));
+		im = malloc(size * sizeof(*im));
+		assert_non_null(plan);
+
+		fft_seed = size;
+		for (k = 0; k < size; k++) {
+			x[k].real = fft_rand();
+			x[k].imag = fft_rand();
+			y[k] = x[k];
+		}
+
+		dft_ref(x, re, im, size);
+		fft_execute_32(plan, y, false);
+		for (k = 0; k < size; k++) {
+			err = fabs(y[k].real - re[k]) + fabs(y[k].imag - im[k]);
+			if (err > FFT_TOLERANCE)
+				fail_msg("size %u bin %d error %.1f", size, k,
+					 err);
+		}
+
+		/* The inverse returns the input divided by size */
+		fft_execute_32(plan, y, true);
+		for (k = 0; k < size; k++) {
+			err = fabs(y[k].real - (double)x[k].real / size) +
+			      fabs(y[k].imag - (double)x[k].imag / size);
+			if (err > FFT_TOLERANCE)
+				fail_msg("size %u inverse %d error %.1f", size,
+					 k, err);
+		}
+
+		free(im);
+		free(re);
+		free(y);
+		free(x);
+		fft_plan_free(plan);
+	}
+}
+
+static void test_math_fft_real(void **state)
+{
+	struct fft_real_plan *plan;
+	struct icomplex32 *x;
+	struct icomplex32 *y;
+	int32_t *r;
+	int32_t *t;
+	double *re;
+	double *im;
+	double err;
+	uint32_t size;
+	int i;
+	int k;
+
+	(void)state;
+
+	for (i = 0; i < ARRAY_SIZE(fft_sizes); i++) {
+		size = fft_sizes[i];
+		plan = fft_real_plan_new(size);
+		x = malloc(size * sizeof(*x));
+		y = malloc((size / 2 + 1) * sizeof(*y));
+		r = malloc(size * sizeof(*r));
+		t = malloc(size * sizeof(*t));
+		re = malloc(size * sizeof(*re));
+		im = malloc(size * sizeof(*im));
+		assert_non_null(plan);
+
+		fft_seed = size;
+		for (k = 0; k < size; k++) {
+			r[k] = fft_rand();
+			x[k].real = r[k];
+			x[k].imag = 0;
+		}
+
+		dft_ref(x, re, im, size);
+		fft_real_execute_32(plan, r, y);
+		for (k = 0; k <= size / 2; k++) {
+			err = fabs(y[k].real - re[k]) + fabs(y[k].imag - im[k]);
+			if (err > FFT_TOLERANCE)
+				fail_msg("size %u bin %d error %.1f", size, k,
+					 err);
+		}
+
+		fft_real_inverse_32(plan, y, t);
+		for (k = 0; k < size; k++) {
+			err = fabs(t[k] - (double)r[k] / size);
+			if (err > FFT_TOLERANCE)
+				fail_msg("size %u inverse %d error %.1f", size,
+					 k, err);
+		}
+
+		free(im);
+		free(re);
+		free(t);
+		free(r);
+		free(y);
+		free(x);
+		fft_real_plan_free(plan);
+	}
+}
+
+static void test_math_fft_plan_invalid(void **state)
+{
+	(void)state;
+
+	assert_null(fft_plan_new(0));
+	assert_null(fft_plan_new(24));
+	assert_null(fft_plan_new(2 * FFT_SIZE_MAX));
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_math_fft_complex),
+		cmocka_unit_test(test_math_fft_real),
+		cmocka_unit_test(test_math_fft_plan_invalid),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
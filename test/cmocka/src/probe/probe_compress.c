@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+#include <sof/probe/compress.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define TEST_FRAMES	100
+#define TEST_CHANNELS	2
+#define TEST_SAMPLES	(TEST_FRAMES * TEST_CHANNELS)
+
+/* full scale pseudo random noise */
+static void fill_noise(int32_t *buf, int samples)
+{
+	uint32_t seed = 1;
+	int i;
+
+	for (i = 0; i < samples; i++) {
+		seed = seed * 1664525 + 1013904223;
+		buf[i] = (int32_t)seed;
+	}
+}
+
+static void test_probe_compress_s16_ramp_roundtrip(void **state)
+{
+	int16_t src[TEST_SAMPLES];
+	int16_t out[TEST_SAMPLES];
+	uint32_t packed[TEST_SAMPLES];
+	int size;
+	int i;
+
+	(void)state;
+
+	for (i = 0; i < TEST_SAMPLES; i++)
+		src[i] = (i & 1) ? -i * 3 : i * 5;
+
+	size = probe_compress(packed, sizeof(packed), src, sizeof(src),
+			      sizeof(int16_t), TEST_CHANNELS);
+	assert_true(size > 0);
+	assert_true(size < sizeof(src));
+
+	assert_int_equal(probe_decompress(NULL, 0, packed, size,
+					  sizeof(int16_t), TEST_CHANNELS),
+			 sizeof(src));
+
+	assert_int_equal(probe_decompress(out, sizeof(out), packed, size,
+					  sizeof(int16_t), TEST_CHANNELS),
+			 sizeof(src));
+	assert_memory_equal(src, out, sizeof(src));
+}
+
+static void test_probe_compress_s32_noise_roundtrip(void **state)
+{
+	int32_t src[TEST_SAMPLES];
+	int32_t out[TEST_SAMPLES];
+	uint32_t packed[TEST_SAMPLES * 2];
+	int size;
+
+	(void)state;
+
+	fill_noise(src, TEST_SAMPLES);
+
+	size = probe_compress(packed, sizeof(packed), src, sizeof(src),
+			      sizeof(int32_t), TEST_CHANNELS);
+	assert_true(size > 0);
+
+	assert_int_equal(probe_decompress(out, sizeof(out), packed, size,
+					  sizeof(int32_t), TEST_CHANNELS),
+			 sizeof(src));
+	assert_memory_equal(src, out, sizeof(src));
+}
+
+static void test_probe_compress_silence(void **state)
+{
+	int32_t src[TEST_SAMPLES];
+	int32_t out[TEST_SAMPLES];
+	uint32_t packed[TEST_SAMPLES];
+	int size;
+
+	(void)state;
+
+	memset(src, 0, sizeof(src));
+	memset(out, 0xff, sizeof(out));
+
+	/* zero width blocks are header only */
+	size = probe_compress(packed, sizeof(packed), src, sizeof(src),
+			      sizeof(int32_t), TEST_CHANNELS);
+	assert_int_equal(size, sizeof(uint32_t) *
+			 ((TEST_SAMPLES + PROBE_COMPRESS_BLOCK - 1) /
+			  PROBE_COMPRESS_BLOCK));
+
+	assert_int_equal(probe_decompress(out, sizeof(out), packed, size,
+					  sizeof(int32_t), TEST_CHANNELS),
+			 sizeof(src));
+	assert_memory_equal(src, out, sizeof(src));
+}
+
+static void test_probe_compress_no_space(void **state)
+{
+	int32_t src[TEST_SAMPLES];
+	uint32_t packed[TEST_SAMPLES];
+
+	(void)state;
+
+	fill_noise(src, TEST_SAMPLES);
+
+	/* incompressible data must not overrun a raw sized buffer */
+	assert_int_equal(probe_compress(packed, sizeof(src), src, sizeof(src),
+					sizeof(int32_t), TEST_CHANNELS),
+			 -ENOSPC);
+}
+
+static void test_probe_compress_invalid_layout(void **state)
+{
+	int16_t src[3] = { 0 };
+	uint32_t packed[4];
+
+	(void)state;
+
+	/* partial frame */
+	assert_int_equal(probe_compress(packed, sizeof(packed), src,
+					sizeof(src), sizeof(int16_t), 2),
+			 -EINVAL);
+
+	/* unsupported container */
+	assert_int_equal(probe_compress(packed, sizeof(packed), src,
+					sizeof(src), 3, 1),
+			 -EINVAL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_probe_compress_s16_ramp_roundtrip),
+		cmocka_unit_test(test_probe_compress_s32_noise_roundtrip),
+		cmocka_unit_test(test_probe_compress_silence),
+		cmocka_unit_test(test_probe_compress_no_space),
+		cmocka_unit_test(test_probe_compress_invalid_layout),
+	};
+
+	cmocka_set_message_output(CM_OUTPUT_TAP);
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -11,11 +11,15 @@
 #include <errno.h>
 #include <unistd.h>
 #include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <kernel/abi.h>
 #include <user/trace.h>
 #include "convert.h"
 
 #define CEIL(a, b) ((a+b-1)/b)
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 #define TRACE_MAX_PARAMS_COUNT		4
 #define TRACE_MAX_TEXT_LEN		1024
@@ -23,6 +27,8 @@
 #define TRACE_MAX_IDS_STR		10
 #define TRACE_IDS_MASK			((1 << TRACE_ID_LENGTH) - 1)
 
+#define CONVERT_INPUT_BUF_SIZE		(1024 * 1024)
+
 struct ldc_entry_header {
 	uint32_t level;
 	uint32_t component_class;
@@ -35,9 +41,44 @@ struct ldc_entry_header {
 
 struct ldc_entry {
 	struct ldc_entry_header header;
-	char *file_name;
-	char *text;
-	uint32_t *params;
+	const char *file_name;
+	const char *text;
+};
+
+/* in-memory ldc dictionary, entries are parsed once and hashed by address */
+struct ldc_dict_slot {
+	uint32_t address;
+	struct ldc_entry entry;	/* entry.text == NULL for empty slot */
+};
+
+struct ldc_dict {
+	const uint8_t *data;	/* mmap'ed ldc file */
+	size_t size;
+	const struct snd_sof_logs_header *snd;
+	struct ldc_dict_slot *slots;
+	uint32_t mask;
+	uint32_t count;
+};
+
+#define LDC_DICT_INIT_SLOTS		1024
+
+/* records indexed and formatted in one go by the offline decoder */
+#define DECODE_BATCH_RECORDS		(64 * 1024)
+
+struct decode_record {
+	const struct log_entry_header *dma_log;
+	const struct ldc_entry *entry;
+	uint64_t last_timestamp;
+};
+
+struct decode_job {
+	const struct convert_config *config;
+	const struct decode_record *records;
+	uint32_t count;
+	FILE *out_fd;
+	char *buf;
+	size_t size;
+	pthread_t thread;
 };
 
 static double to_usecs(uint64_t time, double clk)
@@ -110,9 +151,9 @@ static const char * get_component_name(uint32_t component_id) {
 }
 
 /* remove superfluous leading file path and shrink to last 20 chars */
-static char *format_file_name(char *file_name_raw, int full_name)
+static const char *format_file_name(const char *file_name_raw, int full_name)
 {
-		char *name;
+		const char *name;
 		int len;
 
 		/* most/all string should have "src" */
@@ -130,11 +171,14 @@ static char *format_file_name(char *file_name_raw, int full_name)
 }
 
 static void print_entry_params(FILE *out_fd,
+	const struct convert_config *config,
 	const struct log_entry_header *dma_log, const struct ldc_entry *entry,
-	uint64_t last_timestamp, double clock, int use_colors, int raw_output)
+	const uint32_t *params, uint64_t last_timestamp)
 {
 	char ids[TRACE_MAX_IDS_STR];
-	float dt = to_usecs(dma_log->timestamp - last_timestamp, clock);
+	int use_colors = config->use_colors;
+	int raw_output = config->raw_output;
+	float dt = to_usecs(dma_log->timestamp - last_timestamp, config->clock);
 	const char *entry_fmt = raw_output ?
 		"%s%u %u %s%s%s %.6f %.6f (%s:%u) " :
 		"%s%5u %6u %12s%s %-7s %16.6f %16.6f %20s:%-4u\t";
@@ -153,7 +197,7 @@ static void print_entry_params(FILE *out_fd,
 		get_component_name(entry->header.component_class),
 		raw_output && entry->header.has_ids ? "-" : "",
 		entry->header.has_ids ? ids : "",
-		to_usecs(dma_log->timestamp, clock),
+		to_usecs(dma_log->timestamp, config->clock),
 		dt,
 		format_file_name(entry->file_name, raw_output),
 		entry->header.line_idx);
@@ -163,123 +207,227 @@ static void print_entry_params(FILE *out_fd,
 		fprintf(out_fd, "%s", entry->text);
 		break;
 	case 1:
-		fprintf(out_fd, entry->text, entry->params[0]);
+		fprintf(out_fd, entry->text, params[0]);
 		break;
 	case 2:
-		fprintf(out_fd, entry->text, entry->params[0], entry->params[1]);
+		fprintf(out_fd, entry->text, params[0], params[1]);
 		break;
 	case 3:
-		fprintf(out_fd, entry->text, entry->params[0], entry->params[1],
-			entry->params[2]);
+		fprintf(out_fd, entry->text, params[0], params[1], params[2]);
 		break;
 	case 4:
-		fprintf(out_fd, entry->text, entry->params[0], entry->params[1],
-			entry->params[2], entry->params[3]);
+		fprintf(out_fd, entry->text, params[0], params[1], params[2],
+			params[3]);
 		break;
 	}
 	fprintf(out_fd, "%s\n", use_colors ? KNRM : "");
-	fflush(out_fd);
 }
 
-static int fetch_entry(const struct convert_config *config,
-	uint32_t base_address, uint32_t data_offset,
-	const struct log_entry_header *dma_log, uint64_t *last_timestamp)
+/* live sources are flushed per entry, offline dumps are fully buffered */
+static int is_live_input(const struct convert_config *config)
 {
-	struct ldc_entry entry;
-	uint32_t entry_offset;
+	return config->trace || config->input_std || config->serial_fd >= 0;
+}
 
-	int ret;
+static inline uint32_t ldc_dict_hash(uint32_t address)
+{
+	/* entries are word aligned, Fibonacci hashing on the word index */
+	return (address >> 2) * 2654435761u;
+}
 
-	entry.file_name = NULL;
-	entry.text = NULL;
-	entry.params = NULL;
+static int ldc_dict_init(struct ldc_dict *dict, FILE *ldc_fd)
+{
+	struct stat st;
 
-	/* evaluate entry offset in input file */
-	entry_offset = dma_log->log_entry_address - base_address;
+	if (fstat(fileno(ldc_fd), &st) < 0)
+		return -errno;
 
-	/* set file position to beginning of processed entry */
-	fseek(config->ldc_fd, entry_offset + data_offset, SEEK_SET);
+	if (st.st_size < sizeof(*dict->snd)) {
+		fprintf(stderr, "Error: ldc file is too small.\n");
+		return -EINVAL;
+	}
 
-	/* fetching elf header params */
-	ret = fread(&entry.header, sizeof(entry.header), 1, config->ldc_fd);
-	if (!ret) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	dict->size = st.st_size;
+	dict->data = mmap(NULL, dict->size, PROT_READ, MAP_PRIVATE,
+			  fileno(ldc_fd), 0);
+	if (dict->data == MAP_FAILED) {
+		dict->data = NULL;
+		return -errno;
 	}
-	if (entry.header.file_name_len > TRACE_MAX_FILENAME_LEN) {
-		fprintf(stderr, "Error: Invalid filename length or ldc file does not match firmware\n");
-		ret = -EINVAL;
-		goto out;
+
+	dict->snd = (const struct snd_sof_logs_header *)dict->data;
+	dict->mask = LDC_DICT_INIT_SLOTS - 1;
+	dict->count = 0;
+	dict->slots = calloc(LDC_DICT_INIT_SLOTS, sizeof(*dict->slots));
+	if (!dict->slots) {
+		munmap((void *)dict->data, dict->size);
+		dict->data = NULL;
+		return -ENOMEM;
 	}
-	entry.file_name = (char *)malloc(entry.header.file_name_len);
 
-	if (!entry.file_name) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.file_name\n", entry.header.file_name_len);
-		ret = -ENOMEM;
-		goto out;
+	return 0;
+}
+
+static void ldc_dict_free(struct ldc_dict *dict)
+{
+	free(dict->slots);
+	if (dict->data)
+		munmap((void *)dict->data, dict->size);
+}
+
+static struct ldc_dict_slot *ldc_dict_find(struct ldc_dict_slot *slots,
+					   uint32_t mask, uint32_t address)
+{
+	uint32_t i = ldc_dict_hash(address) & mask;
+
+	/* linear probing, table is never more than half full */
+	while (slots[i].entry.text && slots[i].address != address)
+		i = (i + 1) & mask;
+
+	return &slots[i];
+}
+
+static int ldc_dict_grow(struct ldc_dict *dict)
+{
+	uint32_t mask = (dict->mask << 1) | 1;
+	struct ldc_dict_slot *slots;
+	struct ldc_dict_slot *slot;
+	uint32_t i;
+
+	slots = calloc(mask + 1, sizeof(*slots));
+	if (!slots)
+		return -ENOMEM;
+
+	for (i = 0; i <= dict->mask; i++) {
+		if (!dict->slots[i].entry.text)
+			continue;
+		slot = ldc_dict_find(slots, mask, dict->slots[i].address);
+		*slot = dict->slots[i];
 	}
 
-	ret = fread(entry.file_name, sizeof(char), entry.header.file_name_len,
-		config->ldc_fd);
-	if (ret != entry.header.file_name_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+	free(dict->slots);
+	dict->slots = slots;
+	dict->mask = mask;
+
+	return 0;
+}
+
+/* parse entry from the mapped ldc file */
+static int ldc_dict_parse(const struct ldc_dict *dict, uint32_t address,
+			  struct ldc_entry *entry)
+{
+	size_t offset = (size_t)dict->snd->data_offset +
+			(address - dict->snd->base_address);
+	const char *file_name;
+	const char *text;
+
+	if (offset + sizeof(entry->header) > dict->size)
+		goto err_range;
+
+	memcpy(&entry->header, dict->data + offset, sizeof(entry->header));
+	offset += sizeof(entry->header);
+
+	if (entry->header.file_name_len > TRACE_MAX_FILENAME_LEN) {
+		fprintf(stderr, "Error: Invalid filename length or ldc file does not match firmware\n");
+		return -EINVAL;
 	}
 
-	/* fetching text */
-	if (entry.header.text_len > TRACE_MAX_TEXT_LEN) {
+	if (entry->header.text_len > TRACE_MAX_TEXT_LEN) {
 		fprintf(stderr, "Error: Invalid text length. \n");
-		ret = -EINVAL;
-		goto out;
-	}
-	entry.text = (char *)malloc(entry.header.text_len);
-	if (entry.text == NULL) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.text\n", entry.header.text_len);
-		ret = -ENOMEM;
-		goto out;
-	}
-	ret = fread(entry.text, sizeof(char), entry.header.text_len, config->ldc_fd);
-	if (ret != entry.header.text_len) {
-		ret = -ferror(config->ldc_fd);
-		goto out;
+		return -EINVAL;
 	}
 
-	/* fetching entry params from dma dump */
-	if (entry.header.params_num > TRACE_MAX_PARAMS_COUNT) {
+	if (entry->header.params_num > TRACE_MAX_PARAMS_COUNT) {
 		fprintf(stderr, "Error: Invalid number of parameters. \n");
-		ret = -EINVAL;
-		goto out;
+		return -EINVAL;
+	}
+
+	if (offset + entry->header.file_name_len + entry->header.text_len >
+	    dict->size)
+		goto err_range;
+
+	file_name = (const char *)dict->data + offset;
+	text = file_name + entry->header.file_name_len;
+
+	/* strings are used in place, make sure they are terminated */
+	if (!entry->header.file_name_len || !entry->header.text_len ||
+	    file_name[entry->header.file_name_len - 1] ||
+	    text[entry->header.text_len - 1]) {
+		fprintf(stderr, "Error: Unterminated string in ldc entry 0x%x\n",
+			address);
+		return -EINVAL;
 	}
-	entry.params = (uint32_t *)malloc(sizeof(uint32_t) *
-		entry.header.params_num);
-	if (entry.params == NULL) {
-		fprintf(stderr, "error: can't allocate %d byte for "
-			"entry.params\n", (int)(sizeof(uint32_t) *
-			entry.header.params_num));
-		ret = -ENOMEM;
-		goto out;
+
+	entry->file_name = file_name;
+	entry->text = text;
+
+	return 0;
+
+err_range:
+	fprintf(stderr, "Error: ldc entry 0x%x is out of file range\n",
+		address);
+	return -EINVAL;
+}
+
+/* get entry for log_entry_address, parsing it on first use */
+static const struct ldc_entry *ldc_dict_get(struct ldc_dict *dict,
+					    uint32_t address)
+{
+	struct ldc_dict_slot *slot;
+
+	slot = ldc_dict_find(dict->slots, dict->mask, address);
+	if (slot->entry.text)
+		return &slot->entry;
+
+	if ((dict->count + 1) * 2 > dict->mask + 1) {
+		if (ldc_dict_grow(dict) < 0)
+			return NULL;
+		slot = ldc_dict_find(dict->slots, dict->mask, address);
 	}
 
+	if (ldc_dict_parse(dict, address, &slot->entry) < 0)
+		return NULL;
+
+	slot->address = address;
+	dict->count++;
+
+	return &slot->entry;
+}
+
+static inline int entry_address_valid(const struct snd_sof_logs_header *snd,
+				      uint32_t address)
+{
+	return address >= snd->base_address &&
+	       address <= snd->base_address + snd->data_length;
+}
+
+static int fetch_entry(const struct convert_config *config,
+	struct ldc_dict *dict, const struct log_entry_header *dma_log,
+	uint64_t *last_timestamp)
+{
+	const struct ldc_entry *entry;
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	int ret;
+
+	entry = ldc_dict_get(dict, dma_log->log_entry_address);
+	if (!entry)
+		return -EINVAL;
+
+	/* fetching entry params from dma dump */
 	if (config->serial_fd < 0) {
-		ret = fread(entry.params, sizeof(uint32_t),
-			    entry.header.params_num, config->in_fd);
-		if (ret != entry.header.params_num) {
-			ret = -ferror(config->in_fd);
-			goto out;
-		}
+		ret = fread(params, sizeof(uint32_t),
+			    entry->header.params_num, config->in_fd);
+		if (ret != entry->header.params_num)
+			return -ferror(config->in_fd);
 	} else {
-		size_t size = sizeof(uint32_t) * entry.header.params_num;
+		size_t size = sizeof(uint32_t) * entry->header.params_num;
 		uint8_t *n;
 
-		for (n = (uint8_t *)entry.params; size;
+		for (n = (uint8_t *)params; size;
 		     n += ret, size -= ret) {
 			ret = read(config->serial_fd, n, size);
-			if (ret < 0) {
-				ret = -errno;
-				goto out;
-			}
+			if (ret < 0)
+				return -errno;
 			if (ret != size)
 				fprintf(stderr,
 					"Partial read of %u bytes of %lu.\n",
@@ -288,26 +436,20 @@ static int fetch_entry(const struct convert_config *config,
 	}
 
 	/* printing entry content */
-	print_entry_params(config->out_fd, dma_log, &entry, *last_timestamp,
-			   config->clock, config->use_colors, config->raw_output);
+	print_entry_params(config->out_fd, config, dma_log, entry, params,
+			   *last_timestamp);
 	*last_timestamp = dma_log->timestamp;
 
-	/* set f_ldc file position to the beginning */
-	rewind(config->ldc_fd);
+	if (is_live_input(config))
+		fflush(config->out_fd);
 
-	ret = 0;
-out:
-	/* free alocated memory */
-	free(entry.params);
-	free(entry.text);
-	free(entry.file_name);
-
-	return ret;
+	return 0;
 }
 
 static int serial_read(const struct convert_config *config,
-	struct snd_sof_logs_header *snd, uint64_t *last_timestamp)
+	struct ldc_dict *dict, uint64_t *last_timestamp)
 {
+	const struct snd_sof_logs_header *snd = dict->snd;
 	struct log_entry_header dma_log;
 	size_t len;
 	uint8_t *n;
@@ -328,8 +470,7 @@ static int serial_read(const struct convert_config *config,
 	}
 
 	/* Skip all trace_point() values, although this test isn't 100% reliable */
-	while ((dma_log.log_entry_address < snd->base_address) ||
-	       dma_log.log_entry_address > snd->base_address + snd->data_length) {
+	while (!entry_address_valid(snd, dma_log.log_entry_address)) {
 		/*
 		 * 8 characters and a '\n' come from the serial port, append a
 		 * '\0'
@@ -355,14 +496,340 @@ static int serial_read(const struct convert_config *config,
 	}
 
 	/* fetching entry from elf dump */
-	return fetch_entry(config, snd->base_address, snd->data_offset,
-			   &dma_log, last_timestamp);
+	return fetch_entry(config, dict, &dma_log, last_timestamp);
+}
+
+static void *decode_worker(void *arg)
+{
+	struct decode_job *job = arg;
+	const struct decode_record *rec;
+	uint32_t i;
+
+	for (i = 0; i < job->count; i++) {
+		rec = &job->records[i];
+		print_entry_params(job->out_fd, job->config, rec->dma_log,
+				   rec->entry,
+				   (const uint32_t *)(rec->dma_log + 1),
+				   rec->last_timestamp);
+	}
+
+	return NULL;
+}
+
+/*
+ * Format a batch of indexed records. With several jobs each thread formats
+ * a contiguous slice into its own memory stream and the slices are written
+ * out in order, so the output is identical to the serial decode.
+ */
+static int decode_batch(const struct convert_config *config,
+			const struct decode_record *records, uint32_t count)
+{
+	struct decode_job job[CONVERT_MAX_JOBS];
+	uint32_t jobs = config->jobs;
+	uint32_t slice;
+	uint32_t i;
+	int ret = 0;
+
+	if (jobs <= 1 || count < jobs) {
+		job[0].config = config;
+		job[0].records = records;
+		job[0].count = count;
+		job[0].out_fd = config->out_fd;
+		decode_worker(&job[0]);
+		return 0;
+	}
+
+	slice = CEIL(count, jobs);
+	for (i = 0; i < jobs; i++) {
+		job[i].config = config;
+		job[i].records = records + i * slice;
+		job[i].count = i * slice >= count ? 0 :
+			       MIN(slice, count - i * slice);
+		job[i].buf = NULL;
+		job[i].size = 0;
+		job[i].out_fd = open_memstream(&job[i].buf, &job[i].size);
+		if (!job[i].out_fd) {
+			ret = -errno;
+			break;
+		}
+
+		ret = -pthread_create(&job[i].thread, NULL, decode_worker,
+				      &job[i]);
+		if (ret < 0) {
+			fclose(job[i].out_fd);
+			free(job[i].buf);
+			break;
+		}
+	}
+
+	/* join started jobs in order, writing out each slice */
+	jobs = i;
+	for (i = 0; i < jobs; i++) {
+		pthread_join(job[i].thread, NULL);
+		fclose(job[i].out_fd);
+		if (!ret)
+			fwrite(job[i].buf, 1, job[i].size, config->out_fd);
+		free(job[i].buf);
+	}
+
+	return ret;
+}
+
+/* decode regular file mapped in memory, no per entry reads or seeks */
+static int logger_read_mmap(const struct convert_config *config,
+			    struct ldc_dict *dict, const uint8_t *data,
+			    size_t size)
+{
+	const struct log_entry_header *dma_log;
+	const struct ldc_entry *entry;
+	struct decode_record *records;
+	uint64_t last_timestamp = 0;
+	uint32_t count = 0;
+	size_t pos = 0;
+	size_t len;
+	int ret = 0;
+
+	records = malloc(DECODE_BATCH_RECORDS * sizeof(*records));
+	if (!records)
+		return -ENOMEM;
+
+	/* index entries serially, dictionary is read only while formatting */
+	while (pos + sizeof(*dma_log) <= size) {
+		dma_log = (const struct log_entry_header *)(data + pos);
+
+		/* not an entry address, move forward by one DWORD */
+		if (!entry_address_valid(dict->snd,
+					 dma_log->log_entry_address)) {
+			pos += sizeof(uint32_t);
+			continue;
+		}
+
+		entry = ldc_dict_get(dict, dma_log->log_entry_address);
+		if (!entry) {
+			ret = -EINVAL;
+			break;
+		}
+
+		len = sizeof(*dma_log) +
+		      entry->header.params_num * sizeof(uint32_t);
+		if (pos + len > size)
+			break;
+
+		records[count].dma_log = dma_log;
+		records[count].entry = entry;
+		records[count].last_timestamp = last_timestamp;
+		last_timestamp = dma_log->timestamp;
+		pos += len;
+
+		if (++count == DECODE_BATCH_RECORDS) {
+			ret = decode_batch(config, records, count);
+			if (ret < 0)
+				break;
+			count = 0;
+		}
+	}
+
+	if (!ret && count)
+		ret = decode_batch(config, records, count);
+
+	free(records);
+
+	return ret;
+}
+
+/* next input byte, live trace is reopened at end of data */
+static int compact_getc(const struct convert_config *config)
+{
+	int c;
+
+	for (;;) {
+		c = fgetc(config->in_fd);
+		if (c != EOF || !config->trace || ferror(config->in_fd))
+			return c;
+
+		freopen(NULL, "r", config->in_fd);
+	}
+}
+
+static int compact_get_varint(const struct convert_config *config,
+			      uint32_t *val)
+{
+	uint32_t shift;
+	int c;
+
+	*val = 0;
+	for (shift = 0; shift < 35; shift += 7) {
+		c = compact_getc(config);
+		if (c == EOF)
+			return EOF;
+
+		*val |= (uint32_t)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return 0;
+	}
+
+	/* overlong value, stream is corrupted */
+	return -EINVAL;
+}
+
+/*
+ * Skip input up to and including the next sync tag and sync word. When the
+ * zero tag has just been read the sync word is expected right away, anything
+ * else is skipped the same way as corrupted input.
+ */
+static int compact_resync(const struct convert_config *config, int tag_read)
+{
+	/* last 5 bytes read, oldest in the least significant byte */
+	const uint64_t pattern = (uint64_t)TRACE_COMPACT_SYNC << 8;
+	const uint64_t mask = (1ULL << 40) - 1;
+	uint64_t window = tag_read ? 0 : mask;
+	int c;
+
+	/* sync word follows a zero tag and is stored little endian */
+	while (window != pattern) {
+		c = compact_getc(config);
+		if (c == EOF)
+			return EOF;
+
+		window = (window >> 8) | ((uint64_t)c << 32);
+		window &= mask;
+	}
+
+	return 0;
+}
+
+/* full record following a sync word, as written by legacy encoding */
+static int compact_read_sync(const struct convert_config *config,
+	struct ldc_dict *dict, struct log_entry_header *dma_log,
+	uint32_t *params, const struct ldc_entry **entry)
+{
+	if (fread(dma_log, sizeof(*dma_log), 1, config->in_fd) != 1)
+		return EOF;
+
+	if (!entry_address_valid(dict->snd, dma_log->log_entry_address))
+		return -EINVAL;
+
+	*entry = ldc_dict_get(dict, dma_log->log_entry_address);
+	if (!*entry)
+		return -EINVAL;
+
+	if (fread(params, sizeof(uint32_t), (*entry)->header.params_num,
+		  config->in_fd) != (*entry)->header.params_num)
+		return EOF;
+
+	return 0;
+}
+
+static int compact_read_record(const struct convert_config *config,
+	struct ldc_dict *dict, uint32_t tag, struct log_entry_header *dma_log,
+	uint32_t *params, const struct ldc_entry **entry)
+{
+	uint32_t address;
+	uint32_t delta;
+	uint32_t val;
+	uint32_t i;
+	int ret;
+
+	tag--;
+	address = dict->snd->base_address +
+		  (tag >> TRACE_COMPACT_CORE_BITS) * sizeof(uint32_t);
+	if (!entry_address_valid(dict->snd, address))
+		return -EINVAL;
+
+	*entry = ldc_dict_get(dict, address);
+	if (!*entry)
+		return -EINVAL;
+
+	ret = compact_get_varint(config, &delta);
+	if (ret)
+		return ret;
+
+	ret = compact_get_varint(config, &val);
+	if (ret)
+		return ret;
+	dma_log->id_0 = val;
+
+	ret = compact_get_varint(config, &val);
+	if (ret)
+		return ret;
+	dma_log->id_1 = val;
+
+	for (i = 0; i < (*entry)->header.params_num; i++) {
+		ret = compact_get_varint(config, &val);
+		if (ret)
+			return ret;
+
+		/* undo zigzag mapping */
+		params[i] = (val >> 1) ^ -(val & 1);
+	}
+
+	dma_log->core_id = tag & TRACE_COMPACT_CORE_MASK;
+	dma_log->timestamp += delta;
+	dma_log->log_entry_address = address;
+
+	return 0;
+}
+
+/*
+ * Decode CONFIG_TRACE_COMPACT stream, see user/trace.h. Compact records are
+ * relative to the previous one, so after a corrupted or unknown record input
+ * is skipped up to the next sync record.
+ */
+static int logger_read_compact(const struct convert_config *config,
+	struct ldc_dict *dict)
+{
+	struct log_entry_header dma_log;
+	const struct ldc_entry *entry;
+	uint32_t params[TRACE_MAX_PARAMS_COUNT];
+	uint64_t last_timestamp = 0;
+	uint32_t tag;
+	int synced = 0;
+	int ret;
+
+	memset(&dma_log, 0, sizeof(dma_log));
+
+	for (;;) {
+		tag = 0;
+		if (synced)
+			ret = compact_get_varint(config, &tag);
+		else
+			ret = compact_resync(config, 0);
+		if (ret == EOF)
+			return -ferror(config->in_fd);
+
+		if (!ret && !tag) {
+			if (synced)
+				ret = compact_resync(config, 1);
+			if (!ret)
+				ret = compact_read_sync(config, dict, &dma_log,
+							params, &entry);
+		} else if (!ret) {
+			ret = compact_read_record(config, dict, tag, &dma_log,
+						  params, &entry);
+		}
+
+		if (ret == EOF)
+			return -ferror(config->in_fd);
+
+		synced = !ret;
+		if (!synced)
+			continue;
+
+		print_entry_params(config->out_fd, config, &dma_log, entry,
+				   params, last_timestamp);
+		last_timestamp = dma_log.timestamp;
+
+		if (is_live_input(config))
+			fflush(config->out_fd);
+	}
 }
 
 static int logger_read(const struct convert_config *config,
-	struct snd_sof_logs_header *snd)
+	struct ldc_dict *dict)
 {
 	struct log_entry_header dma_log;
+	struct stat st;
+	void *data;
 	int ret = 0;
 	uint64_t last_timestamp = 0;
 
@@ -372,11 +839,26 @@ static int logger_read(const struct convert_config *config,
 	if (config->serial_fd >= 0)
 		/* Wait for CTRL-C */
 		for (;;) {
-			ret = serial_read(config, snd, &last_timestamp);
+			ret = serial_read(config, dict, &last_timestamp);
 			if (ret < 0)
 				return ret;
 		}
 
+	if (config->compact)
+		return logger_read_compact(config, dict);
+
+	/* offline dumps are mapped, live trace and pipes are read */
+	if (!is_live_input(config) && !fstat(fileno(config->in_fd), &st) &&
+	    S_ISREG(st.st_mode) && st.st_size > 0) {
+		data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+			    fileno(config->in_fd), 0);
+		if (data != MAP_FAILED) {
+			ret = logger_read_mmap(config, dict, data, st.st_size);
+			munmap(data, st.st_size);
+			return ret;
+		}
+	}
+
 	while (!ferror(config->in_fd)) {
 		/* getting entry parameters from dma dump */
 		ret = fread(&dma_log, sizeof(dma_log), 1, config->in_fd);
@@ -392,8 +874,8 @@ static int logger_read(const struct convert_config *config,
 		/* checking if received trace address is located in
 		 * entry section in elf file.
 		 */
-		if ((dma_log.log_entry_address < snd->base_address) ||
-			dma_log.log_entry_address > snd->base_address + snd->data_length) {
+		if (!entry_address_valid(dict->snd,
+					 dma_log.log_entry_address)) {
 			/* in case the address is not correct input fd should be
 			 * move forward by one DWORD, not entire struct dma_log
 			 */
@@ -402,8 +884,7 @@ static int logger_read(const struct convert_config *config,
 		}
 
 		/* fetching entry from elf dump */
-		ret = fetch_entry(config, snd->base_address, snd->data_offset,
-				  &dma_log, &last_timestamp);
+		ret = fetch_entry(config, dict, &dma_log, &last_timestamp);
 		if (ret)
 			break;
 	}
@@ -413,6 +894,7 @@ static int logger_read(const struct convert_config *config,
 
 int convert(const struct convert_config *config) {
 	struct snd_sof_logs_header snd;
+	struct ldc_dict dict;
 	int count, ret = 0;
 
 	count = fread(&snd, sizeof(snd), 1, config->ldc_fd);
@@ -426,6 +908,12 @@ int convert(const struct convert_config *config) {
 		return -EINVAL;
 	}
 
+	if (config->jobs < 1 || config->jobs > CONVERT_MAX_JOBS) {
+		fprintf(stderr, "Error: Invalid number of jobs %d, max is %d\n",
+			config->jobs, CONVERT_MAX_JOBS);
+		return -EINVAL;
+	}
+
 	/* fw verification */
 	if (config->version_fd) {
 		struct sof_ipc_fw_version ver;
@@ -477,5 +965,21 @@ int convert(const struct convert_config *config) {
 				SOF_ABI_VERSION_PATCH(snd.version.abi_version));
 		return -EINVAL;
 	}
-	return logger_read(config, &snd);
+
+	ret = ldc_dict_init(&dict, config->ldc_fd);
+	if (ret < 0) {
+		fprintf(stderr, "Error: Unable to map %s, error %d\n",
+			config->ldc_file, -ret);
+		return ret;
+	}
+
+	/* read piped input in large chunks */
+	if (config->in_fd && !config->trace)
+		setvbuf(config->in_fd, NULL, _IOFBF, CONVERT_INPUT_BUF_SIZE);
+
+	ret = logger_read(config, &dict);
+
+	ldc_dict_free(&dict);
+
+	return ret;
 }
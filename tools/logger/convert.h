@@ -17,6 +17,9 @@
 #define KNRM	"\x1B[0m"
 #define KRED	"\x1B[31m"
 
+/* maximum number of parallel decode jobs */
+#define CONVERT_MAX_JOBS	64
+
 struct convert_config {
 	const char *out_file;
 	const char *in_file;
@@ -33,6 +36,8 @@ struct convert_config {
 	int use_colors;
 	int serial_fd;
 	int raw_output;
+	int jobs;	/* parallel decode jobs for offline input */
+	int compact;	/* input is CONFIG_TRACE_COMPACT encoded */
 };
 
 int convert(const struct convert_config *config);
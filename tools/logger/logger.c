@@ -50,6 +50,10 @@ static void usage(void)
 	fprintf(stdout, "%s:\t -r\t\t\tLess formatted output for "
 		"chained log processors\n",
 		APP_NAME);
+	fprintf(stdout, "%s:\t -j jobs\t\tDecode input file with jobs "
+		"parallel threads\n", APP_NAME);
+	fprintf(stdout, "%s:\t -z\t\t\tInput uses compact trace "
+		"encoding\n", APP_NAME);
 	exit(0);
 }
 
@@ -154,8 +158,10 @@ int main(int argc, char *argv[])
 	config.use_colors = 1;
 	config.serial_fd = -EINVAL;
 	config.raw_output = 0;
+	config.jobs = 1;
+	config.compact = 0;
 
-	while ((opt = getopt(argc, argv, "ho:i:l:ps:c:u:tev:r")) != -1) {
+	while ((opt = getopt(argc, argv, "ho:i:l:ps:c:u:tev:rj:z")) != -1) {
 		switch (opt) {
 		case 'o':
 			config.out_file = optarg;
@@ -191,6 +197,12 @@ int main(int argc, char *argv[])
 		case 'r':
 			config.raw_output = 1;
 			break;
+		case 'j':
+			config.jobs = atoi(optarg);
+			break;
+		case 'z':
+			config.compact = 1;
+			break;
 		case 'v':
 			/* enabling checking fw version with ver_file file */
 			config.version_fw = 1;
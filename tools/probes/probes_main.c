@@ -15,6 +15,7 @@
 
 #include <ipc/probe.h>
 #include <sof/math/numbers.h>
+#include <sof/probe/compress.h>
 #include "wave.h"
 
 #include <ctype.h>
@@ -176,6 +177,70 @@ int validate_data_packet(struct probe_data_packet *data_packet)
 	}
 }
 
+int write_packet(struct wave_files *file, struct probe_data_packet *packet)
+{
+	uint32_t data_bytes = packet->data_size_bytes;
+	uint32_t container_size;
+	uint32_t channels;
+	uint32_t *src;
+	void *data;
+	int size;
+
+	if (!(packet->format & PROBE_MASK_COMPRESSED)) {
+		fwrite(packet->data, sizeof(uint32_t),
+		       data_bytes / sizeof(uint32_t), file->fd);
+		file->size += data_bytes;
+		return 0;
+	}
+
+	container_size = ((packet->format & PROBE_MASK_CONTAINER_SIZE) >>
+			  PROBE_SHIFT_CONTAINER_SIZE) + 1;
+	channels = ((packet->format & PROBE_MASK_NB_CHANNELS) >>
+		    PROBE_SHIFT_NB_CHANNELS) + 1;
+
+	/* the payload of the packed packet may be unaligned */
+	src = malloc(data_bytes);
+	if (!src) {
+		fprintf(stderr, "error: unable to allocate %u bytes\n",
+			data_bytes);
+		return -ENOMEM;
+	}
+	memcpy(src, packet->data, data_bytes);
+
+	/* query decompressed size first */
+	size = probe_decompress(NULL, 0, src, data_bytes, container_size,
+				channels);
+	if (size < 0)
+		goto err;
+
+	data = malloc(size);
+	if (!data) {
+		fprintf(stderr, "error: unable to allocate %d bytes\n", size);
+		free(src);
+		return -ENOMEM;
+	}
+
+	size = probe_decompress(data, size, src, data_bytes, container_size,
+				channels);
+	if (size < 0) {
+		free(data);
+		goto err;
+	}
+
+	fwrite(data, 1, size, file->fd);
+	file->size += size;
+	free(data);
+	free(src);
+
+	return 0;
+
+err:
+	free(src);
+	fprintf(stderr, "error: unable to decompress packet for buffer %d, error %d\n",
+		packet->buffer_id, size);
+	return size;
+}
+
 void parse_data(char *file_in)
 {
 	FILE *fd_in;
@@ -266,13 +331,7 @@ void parse_data(char *file_in)
 									 packet->buffer_id,
 									 packet->format);
 
-						fwrite(packet->data,
-						       sizeof(uint32_t),
-						       packet->data_size_bytes /
-						       sizeof(uint32_t),
-						       files[file].fd);
-
-						files[file].size += packet->data_size_bytes;
+						write_packet(&files[file], packet);
 					}
 					state = READY;
 					break;
@@ -0,0 +1,66 @@
+#!/bin/bash
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+# Multi-rate low latency scheduling test. Runs a playback topology in the
+# testbench DMA and DAI simulation with pipeline periods down to 250 us
+# next to simulated 1 ms and 10 ms LL tasks. Every task must run at its
+# own rate on the common LL tick, without xruns and DAI underruns.
+#
+# Usage: ll_period_test.sh <topology> <input.raw> [S16_LE|S24_LE|S32_LE]
+
+TPLG=$1
+FN_IN=$2
+BITS=${3:-S32_LE}
+FN_OUT=/tmp/ll_period_test.raw
+
+# The HOST_ROOT path need to be retrived from SOFT .configure command
+HOST_ROOT=../../testbench/build_testbench
+HOST_EXE=$HOST_ROOT/install/bin/testbench
+HOST_LIB=$HOST_ROOT/sof_ep/install/lib
+TPLG_LIB=$HOST_ROOT/sof_parser/install/lib
+export LD_LIBRARY_PATH=$HOST_LIB:$TPLG_LIB
+
+# pipeline period and the other LL tasks of each case
+TESTS=(
+	"-T 1000"
+	"-T 500 -L 10000"
+	"-T 250 -L 1000 -L 10000"
+	"-T 333 -L 1000"
+)
+
+FAILS=0
+
+# checks the statistics printed at the end of a simulation run
+function check_run {
+	awk '
+	/^Simulation:/ { time = $2 * 1000 }
+	/^Pipeline xruns:/ { if ($3 != 0) { print "xruns " $3; err = 1 } }
+	/underruns/ { if ($(NF - 3) != 0) { print $0; err = 1 } }
+	/^LL task/ {
+		period = $5; runs = $7
+		if (runs < int(time / period) - 1 || runs > time / period) {
+			print "period " period " us: " runs " runs in " \
+				time " us"
+			err = 1
+		}
+	}
+	END { exit err }'
+}
+
+for i in "${!TESTS[@]}"
+do
+	ARGS="-s -r 48000 -R 48000 -b $BITS -i $FN_IN -o $FN_OUT -t $TPLG"
+	ARGS="$ARGS ${TESTS[$i]}"
+	echo "Command: $HOST_EXE $ARGS"
+	if $HOST_EXE $ARGS 2>/dev/null | check_run
+	then
+		echo "PASS: ${TESTS[$i]}"
+	else
+		echo "FAIL: ${TESTS[$i]}"
+		FAILS=$((FAILS + 1))
+	fi
+done
+
+rm -f $FN_OUT
+exit $FAILS
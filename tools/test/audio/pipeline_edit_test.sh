@@ -0,0 +1,63 @@
+#!/bin/bash
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+# Live pipeline edit test. Runs a topology in the testbench DMA and DAI
+# simulation, removes a component from the running pipeline and inserts
+# it again later. The component must process with unity gain, e.g. a
+# volume at 0 dB, so that the crossfades leave the stream unchanged and
+# the output must match the one of a run without edits.
+#
+# Usage: pipeline_edit_test.sh <topology> <input.raw> <comp_id>
+#	[S16_LE|S24_LE|S32_LE]
+
+TPLG=$1
+FN_IN=$2
+COMP=$3
+BITS=${4:-S32_LE}
+FN_REF=/tmp/pipeline_edit_ref.raw
+FN_OUT=/tmp/pipeline_edit_test.raw
+
+# The HOST_ROOT path need to be retrived from SOFT .configure command
+HOST_ROOT=../../testbench/build_testbench
+HOST_EXE=$HOST_ROOT/install/bin/testbench
+HOST_LIB=$HOST_ROOT/sof_ep/install/lib
+TPLG_LIB=$HOST_ROOT/sof_parser/install/lib
+export LD_LIBRARY_PATH=$HOST_LIB:$TPLG_LIB
+
+# removal and insertion times in ms of each case
+TESTS=(
+	"20:60"
+	"20:23"
+	"100:101"
+)
+
+FAILS=0
+
+# both edits must succeed, without xruns
+function check_run {
+	awk '
+	/^Graph edit:/ { edits++; if ($NF != 0) { print $0; err = 1 } }
+	/^Pipeline xruns:/ { if ($3 != 0) { print "xruns " $3; err = 1 } }
+	END { exit err || edits != 2 }'
+}
+
+ARGS="-s -r 48000 -R 48000 -b $BITS -i $FN_IN -t $TPLG"
+$HOST_EXE $ARGS -o $FN_REF >/dev/null 2>&1
+
+for i in "${!TESTS[@]}"
+do
+	EDIT="-E $COMP:${TESTS[$i]}"
+	echo "Command: $HOST_EXE $ARGS -o $FN_OUT $EDIT"
+	if $HOST_EXE $ARGS -o $FN_OUT $EDIT 2>/dev/null | check_run &&
+		cmp -s $FN_REF $FN_OUT
+	then
+		echo "PASS: $EDIT"
+	else
+		echo "FAIL: $EDIT"
+		FAILS=$((FAILS + 1))
+	fi
+done
+
+rm -f $FN_REF $FN_OUT
+exit $FAILS
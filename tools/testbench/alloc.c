@@ -11,11 +11,68 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <malloc.h>
+#include <sof/audio/buffer_cache.h>
 #include <sof/lib/alloc.h>
 #include "testbench/common_test.h"
+#include "testbench/sim.h"
 
 /* testbench mem alloc definition */
 
+/* DMA capable allocations, SG elems only carry 32 bit addresses */
+struct dma_region {
+	struct dma_region *next;
+	char *ptr;
+	size_t bytes;
+};
+
+static struct dma_region *dma_regions;
+
+static void dma_region_add(void *ptr, size_t bytes)
+{
+	struct dma_region *r;
+
+	if (!ptr)
+		return;
+
+	r = malloc(sizeof(*r));
+	if (!r)
+		return;
+
+	r->ptr = ptr;
+	r->bytes = bytes;
+	r->next = dma_regions;
+	dma_regions = r;
+}
+
+static void dma_region_remove(void *ptr)
+{
+	struct dma_region **r;
+	struct dma_region *found;
+
+	for (r = &dma_regions; *r; r = &(*r)->next) {
+		if ((*r)->ptr == ptr) {
+			found = *r;
+			*r = found->next;
+			free(found);
+			return;
+		}
+	}
+}
+
+void *tb_dma_ptr(uint32_t addr, uint32_t bytes)
+{
+	struct dma_region *r;
+	uint32_t offset;
+
+	for (r = dma_regions; r; r = r->next) {
+		offset = addr - (uint32_t)(uintptr_t)r->ptr;
+		if (offset < r->bytes && bytes <= r->bytes - offset)
+			return r->ptr + offset;
+	}
+
+	return NULL;
+}
+
 void *_malloc(enum mem_zone zone, uint32_t flags, uint32_t caps, size_t bytes)
 {
 	return malloc(bytes);
@@ -28,13 +85,19 @@ void *_zalloc(enum mem_zone zone, uint32_t flags, uint32_t caps, size_t bytes)
 
 void rfree(void *ptr)
 {
+	dma_region_remove(ptr);
 	free(ptr);
 }
 
 void *_balloc(uint32_t flags, uint32_t caps, size_t bytes,
 	      uint32_t alignment)
 {
-	return malloc(bytes);
+	void *ptr = malloc(bytes);
+
+	if (caps & SOF_MEM_CAPS_DMA)
+		dma_region_add(ptr, bytes);
+
+	return ptr;
 }
 
 void *_realloc(void *ptr, enum mem_zone zone, uint32_t flags, uint32_t caps,
@@ -46,7 +109,14 @@ void *_realloc(void *ptr, enum mem_zone zone, uint32_t flags, uint32_t caps,
 void *_brealloc(void *ptr, uint32_t flags, uint32_t caps, size_t bytes,
 		uint32_t alignment)
 {
-	return realloc(ptr, bytes);
+	void *new_ptr = realloc(ptr, bytes);
+
+	if (new_ptr && caps & SOF_MEM_CAPS_DMA) {
+		dma_region_remove(ptr);
+		dma_region_add(new_ptr, bytes);
+	}
+
+	return new_ptr;
 }
 
 void heap_trace(struct mm_heap *heap, int size)
@@ -57,4 +127,5 @@ void heap_trace(struct mm_heap *heap, int size)
 void heap_trace_all(int force)
 {
 	heap_trace(NULL, 0);
+	buffer_cache_trace();
 }
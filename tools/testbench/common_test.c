@@ -10,6 +10,8 @@
 #include <sof/string.h>
 #include <math.h>
 #include <sof/sof.h>
+#include <sof/audio/buffer_cache.h>
+#include <sof/audio/coef_store.h>
 #include <sof/schedule/task.h>
 #include <sof/lib/alloc.h>
 #include <sof/lib/notifier.h>
@@ -21,6 +23,7 @@
 #include <sof/lib/wait.h>
 #include <sof/audio/pipeline.h>
 #include "testbench/common_test.h"
+#include "testbench/sim.h"
 #include <tplg_parser/topology.h>
 
 /* testbench helper functions for pipeline setup and trigger */
@@ -32,6 +35,12 @@ int tb_pipeline_setup(struct sof *sof)
 
 	init_system_notify(sof);
 
+	/* init cache of freed buffers */
+	buffer_cache_init(sof);
+
+	/* init store of shared coefficient blobs */
+	coef_store_init(sof);
+
 	/* init IPC */
 	if (ipc_init(sof) < 0) {
 		fprintf(stderr, "error: IPC init\n");
@@ -94,6 +103,7 @@ int tb_pipeline_params(struct ipc *ipc, int nch,
 		       struct testbench_prm *tp)
 {
 	struct ipc_comp_dev *pcm_dev;
+	struct sof_ipc_comp_host *host;
 	struct pipeline *p;
 	struct comp_dev *cd;
 	struct sof_ipc_pcm_params params;
@@ -111,7 +121,6 @@ int tb_pipeline_params(struct ipc *ipc, int nch,
 	params.comp_id = ipc_pipe->comp_id;
 	params.params.buffer_fmt = SOF_IPC_BUFFER_INTERLEAVED;
 	params.params.frame_fmt = find_format(tp->bits_in);
-	params.params.direction = SOF_IPC_STREAM_PLAYBACK;
 	params.params.rate = tp->fs_in;
 	params.params.channels = nch;
 	switch (params.params.frame_fmt) {
@@ -153,6 +162,14 @@ int tb_pipeline_params(struct ipc *ipc, int nch,
 		return -EINVAL;
 	}
 
+	/* simulated host comp carries the stream direction */
+	if (dev_comp_type(cd) == SOF_COMP_HOST) {
+		host = COMP_GET_IPC(cd, sof_ipc_comp_host);
+		params.params.direction = host->direction;
+	} else {
+		params.params.direction = SOF_IPC_STREAM_PLAYBACK;
+	}
+
 	/* pipeline params */
 	ret = pipeline_params(p, cd, &params);
 	if (ret < 0)
@@ -189,39 +206,8 @@ int get_index_by_type(uint32_t comp_type,
 	return -EINVAL;
 }
 
-/* The following definitions are to satisfy libsof linker errors */
-
-struct dai *dai_get(uint32_t type, uint32_t index, uint32_t flags)
-{
-	return NULL;
-}
-
-void dai_put(struct dai *dai)
-{
-}
-
-struct dma *dma_get(uint32_t dir, uint32_t caps, uint32_t dev, uint32_t flags)
-{
-	return NULL;
-}
-
-void dma_put(struct dma *dma)
-{
-}
-
-int dma_sg_alloc(struct dma_sg_elem_array *elem_array,
-		 enum mem_zone zone,
-		 uint32_t direction,
-		 uint32_t buffer_count, uint32_t buffer_bytes,
-		 uintptr_t dma_buffer_addr, uintptr_t external_addr)
-{
-	return 0;
-}
-
-void dma_sg_free(struct dma_sg_elem_array *elem_array)
-{
-}
-
+/* xruns are counted by the DMA and DAI simulation */
 void pipeline_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes)
 {
+	tb_sim_xrun(p, dev, bytes);
 }
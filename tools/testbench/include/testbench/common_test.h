@@ -6,6 +6,7 @@
 #ifndef _COMMON_TEST_H
 #define _COMMON_TEST_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <time.h>
@@ -18,7 +19,10 @@
 #define MAX_LIB_NAME_LEN	256
 
 /* number of widgets types supported in testbench */
-#define NUM_WIDGETS_SUPPORTED	4
+#define NUM_WIDGETS_SUPPORTED	8
+
+/* simulated low latency tasks next to the pipeline */
+#define TB_SIM_LL_TASKS		4
 
 struct testbench_prm {
 	char *tplg_file; /* topology file to use */
@@ -33,6 +37,20 @@ struct testbench_prm {
 	 */
 	uint32_t fs_in;
 	uint32_t fs_out;
+	uint32_t period; /* pipeline period override in us */
+
+	/* DMA and DAI simulation, see testbench/sim.h */
+	bool sim;
+	uint32_t sim_fifo_depth; /* DAI FIFO depth in frames */
+	uint32_t sim_period_count; /* DMA buffer periods */
+	uint32_t sim_bandwidth; /* host DMA bytes per us, 0 for unlimited */
+	uint32_t sim_skip_every; /* skip copies every n periods */
+	uint32_t sim_skip_len; /* number of consecutive copies skipped */
+	uint32_t sim_ll_period[TB_SIM_LL_TASKS]; /* other LL task periods */
+	uint32_t sim_ll_count;
+	uint32_t sim_edit_comp; /* component removed and inserted again */
+	uint32_t sim_edit_remove; /* removal time in ms, 0 for none */
+	uint32_t sim_edit_insert; /* insertion time in ms, 0 for none */
 };
 
 struct shared_lib_table {
@@ -0,0 +1,115 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright(c) 2020 Intel Corporation. All rights reserved.
+ */
+
+/*
+ * Simulated DMA and DAI backend for the testbench.
+ *
+ * In simulation mode the topology host and DAI widgets are instantiated as
+ * the real host and dai components. They are backed by two simulated DMA
+ * controllers (one for host streams, one for DAI links) and by simulated
+ * SSP, HDA and DMIC DAIs. A virtual clock drives the device side of every
+ * channel: the host DMA engine moves data between the stream file and its
+ * ring buffer at a configurable bandwidth, and each DAI consumes or produces
+ * frames at its sample rate through a FIFO of configurable depth. The
+ * pipeline itself is scheduled by the testbench on the LL tick shared
+ * with other simulated LL tasks, once per its own period.
+ */
+
+#ifndef _TESTBENCH_SIM_H
+#define _TESTBENCH_SIM_H
+
+#include <sof/audio/pipeline.h>
+#include <sof/drivers/ipc.h>
+#include <sof/lib/dai.h>
+#include <sof/lib/dma.h>
+#include <ipc/trace.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "testbench/common_test.h"
+
+/* simulation defaults */
+#define TB_SIM_FIFO_DEPTH	16	/* DAI FIFO depth in frames */
+#define TB_SIM_PERIOD_COUNT	2	/* DMA buffer periods */
+#define TB_SIM_DMA_CHANNELS	8	/* channels per simulated DMAC */
+#define TB_SIM_STALL_NS		1000000000ULL /* no progress limit */
+
+/* DAI handshake encodes type, index and direction */
+#define TB_SIM_HANDSHAKE(type, index, dir) \
+	(((type) << 8) | ((index) << 1) | (dir))
+
+/* private data of a simulated DMA channel */
+struct tb_sim_chan {
+	char *ring;		/* DMA buffer resolved from SG elems */
+	uint32_t size;		/* DMA buffer size */
+	uint32_t elem_size;	/* bytes per SG elem (period) */
+	uint32_t width;		/* sample container bytes */
+	uint32_t handshake;	/* DAI handshake for link channels */
+	uint32_t level;		/* bytes produced and not yet consumed */
+	uint32_t dev_pos;	/* device side ring offset */
+	uint32_t preload;	/* initial silence ahead of stream data */
+	bool running;
+	bool xrun;		/* device starved or overran since query */
+	uint64_t start_time;	/* virtual time of dma_start() */
+	uint64_t credit;	/* host engine transfer credit in bytes */
+
+	/* statistics */
+	uint64_t dev_bytes;	/* bytes moved by the device */
+	uint64_t dsp_bytes;	/* bytes moved by dma_copy() */
+	uint64_t irq_last;
+	uint64_t irq_min;
+	uint64_t irq_max;
+	uint32_t irqs;		/* completed SG elems */
+	uint32_t xruns;
+	bool irq_pending;	/* period completed and not yet serviced */
+	uint64_t irq_time;	/* completion time of the pending period */
+	struct sof_ipc_hist irq_latency; /* completion to dma_copy(), us */
+};
+
+/* one direction of a simulated DAI */
+struct tb_sim_dai_dir {
+	bool running;
+	uint64_t start_time;	/* virtual time of the DAI trigger */
+	uint64_t frames;	/* frames clocked since start */
+	uint64_t real_frames;	/* stream frames, preload excluded */
+	uint32_t frame_bytes;
+	char *fifo;
+	char *frame;		/* one frame on its way to or from the FIFO */
+	uint32_t fifo_size;
+	uint32_t fifo_level;
+	uint32_t fifo_rd;
+	bool xrun;		/* FIFO currently starved or full */
+	uint32_t underruns;
+	uint32_t overruns;
+};
+
+/* private data of a simulated DAI */
+struct tb_sim_dai {
+	uint32_t rate;		/* 0 until configured */
+	uint32_t channels;
+	struct tb_sim_dai_dir dir[2];
+};
+
+/* clock */
+uint64_t tb_sim_time(void);
+void tb_sim_chan_service(struct tb_sim_chan *sc);
+
+/* simulated platform */
+int tb_sim_dma_init(struct sof *sof, uint32_t period_count);
+int tb_sim_dai_init(struct sof *sof);
+struct dai *tb_sim_dai_find(uint32_t handshake);
+
+/* DMA buffer bus address translation */
+void *tb_dma_ptr(uint32_t addr, uint32_t bytes);
+
+/* simulation control */
+int tb_sim_init(struct sof *sof, struct testbench_prm *tp);
+int tb_sim_dai_config(struct ipc *ipc, int nch, struct testbench_prm *tp);
+int tb_sim_run(struct pipeline *p);
+void tb_sim_samples(int *n_in, int *n_out);
+void tb_sim_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes);
+void tb_sim_print_stats(void);
+void tb_sim_free(void);
+
+#endif
@@ -0,0 +1,876 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Virtual clock and device side timing model of the simulated DMA and DAIs.
+ *
+ * The clock is advanced one pipeline period at a time. Before each
+ * scheduled copy every running channel catches up with the clock:
+ *  - host channels move data between the stream file and the DMA buffer,
+ *    limited by the configured bandwidth,
+ *  - link channels feed or drain the DAI FIFO one frame at a time at the
+ *    DAI rate, reporting an xrun when the FIFO runs dry or overflows.
+ * A completed SG elem on the device side counts as one DMA period (IRQ).
+ *
+ * The clock is advanced one low latency tick at a time. The tick is the
+ * one the firmware LL scheduler would use for the pipeline and the other
+ * simulated LL tasks, each task runs only on the ticks due for its period.
+ */
+
+#include <sof/audio/component.h>
+#include <sof/debug/hist.h>
+#include <sof/lib/dai.h>
+#include <sof/lib/dma.h>
+#include <sof/math/numbers.h>
+#include <sof/schedule/ll_schedule.h>
+#include <ipc/dai.h>
+#include <ipc/header.h>
+#include <ipc/topology.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testbench/file.h"
+#include "testbench/sim.h"
+
+#define SIM_NS_PER_SEC		1000000000ULL
+#define SIM_LATENCY_MARKS	1024
+
+/* periodic task of the simulated LL domain */
+struct sim_ll_task {
+	uint32_t period;	/* us */
+	uint64_t due;		/* virtual time of the next run */
+	uint32_t runs;
+};
+
+/* host input position at a point in time, for latency measurement */
+struct sim_mark {
+	uint64_t frames;
+	uint64_t time;
+};
+
+static struct tb_sim {
+	struct testbench_prm *tp;
+	uint32_t channels;
+	uint64_t time;		/* virtual time in ns */
+	uint64_t progress_time;	/* last time stream data moved */
+	FILE *in;
+	FILE *out;
+	enum file_format in_format;
+	enum file_format out_format;
+	bool in_eof;
+	bool done;
+	uint64_t in_samples;
+	uint64_t out_samples;
+
+	struct pipeline *p;
+	uint32_t ticks;
+	uint32_t skipped;
+	uint32_t xruns;
+
+	/* LL domain, the pipeline is the first task */
+	uint32_t tick;		/* us */
+	struct sim_ll_task ll[TB_SIM_LL_TASKS + 1];
+	uint32_t ll_count;
+
+	/* host to DAI latency */
+	struct sim_mark marks[SIM_LATENCY_MARKS];
+	uint32_t mark_rd;
+	uint32_t mark_count;
+	uint64_t lat_min;
+	uint64_t lat_max;
+	uint64_t lat_sum;
+	uint32_t lat_count;
+
+	/* live edit, buffers of the edited component */
+	struct ipc *ipc;
+	uint32_t edit_source;
+	uint32_t edit_sink;
+	bool edit_removed;
+	bool edit_inserted;
+} sim;
+
+uint64_t tb_sim_time(void)
+{
+	return sim.time;
+}
+
+static enum file_format sim_file_format(const char *name)
+{
+	const char *ext = strrchr(name, '.');
+
+	return ext && !strcmp(ext, ".txt") ? FILE_TEXT : FILE_RAW;
+}
+
+/* read whole samples from the stream input, returns bytes read */
+static uint32_t sim_file_read(char *dst, uint32_t bytes, uint32_t width)
+{
+	uint32_t n;
+	int32_t v;
+
+	if (sim.in_eof)
+		return 0;
+
+	if (sim.in_format == FILE_RAW) {
+		n = fread(dst, 1, bytes, sim.in);
+		n -= n % width;
+	} else {
+		for (n = 0; n < bytes; n += width) {
+			if (fscanf(sim.in, "%" SCNd32, &v) != 1)
+				break;
+			if (width == sizeof(int16_t))
+				*(int16_t *)(dst + n) = v;
+			else
+				*(int32_t *)(dst + n) = v;
+		}
+	}
+
+	if (n < bytes)
+		sim.in_eof = true;
+
+	sim.in_samples += n / width;
+
+	return n;
+}
+
+static void sim_file_write(const char *src, uint32_t bytes, uint32_t width)
+{
+	uint32_t n;
+
+	if (sim.out_format == FILE_RAW) {
+		fwrite(src, 1, bytes, sim.out);
+	} else {
+		for (n = 0; n < bytes; n += width)
+			fprintf(sim.out, "%" PRId32 "\n",
+				width == sizeof(int16_t) ?
+				*(int16_t *)(src + n) : *(int32_t *)(src + n));
+	}
+
+	sim.out_samples += bytes / width;
+}
+
+/* count DMA periods completed by the device */
+static void sim_chan_progress(struct tb_sim_chan *sc, uint32_t bytes,
+			      uint64_t time)
+{
+	uint64_t elems = sc->dev_bytes / sc->elem_size;
+	uint64_t interval;
+
+	sc->dev_bytes += bytes;
+	sc->dev_pos = (sc->dev_pos + bytes) % sc->size;
+
+	for (; elems < sc->dev_bytes / sc->elem_size; elems++) {
+		interval = time - sc->irq_last;
+		if (sc->irqs) {
+			if (!sc->irq_min || interval < sc->irq_min)
+				sc->irq_min = interval;
+			if (interval > sc->irq_max)
+				sc->irq_max = interval;
+		}
+		sc->irq_last = time;
+		sc->irqs++;
+
+		/* latency is counted from the oldest unserviced period */
+		if (!sc->irq_pending) {
+			sc->irq_pending = true;
+			sc->irq_time = time;
+		}
+	}
+}
+
+/* DSP side service of a DMA channel, the end of the IRQ latency */
+void tb_sim_chan_service(struct tb_sim_chan *sc)
+{
+	if (!sc->irq_pending)
+		return;
+
+	hist_add(&sc->irq_latency, (tb_sim_time() - sc->irq_time) / 1000);
+	sc->irq_pending = false;
+}
+
+static void sim_print_hist(const char *name, const struct sof_ipc_hist *h)
+{
+	int i;
+
+	printf("%s: %u samples, max %u us, log2 bins", name, h->count, h->max);
+	for (i = 0; i < SOF_IPC_HIST_BINS; i++)
+		if (h->bin[i])
+			printf(" [%u]=%u", i ? 1u << i : 0, h->bin[i]);
+	printf("\n");
+}
+
+/* device side access to the DMA buffer, handles the wrap */
+static void sim_ring_copy(struct tb_sim_chan *sc, char *data, uint32_t bytes,
+			  bool to_ring)
+{
+	uint32_t pos = sc->dev_pos;
+	uint32_t chunk;
+
+	while (bytes) {
+		chunk = MIN(bytes, sc->size - pos);
+		if (to_ring)
+			memcpy(sc->ring + pos, data, chunk);
+		else
+			memcpy(data, sc->ring + pos, chunk);
+		data += chunk;
+		bytes -= chunk;
+		pos = (pos + chunk) % sc->size;
+	}
+}
+
+static void sim_host_run(struct dma_chan_data *chan, struct tb_sim_chan *sc,
+			  uint64_t elapsed)
+{
+	uint32_t bandwidth = sim.tp->sim_bandwidth;
+	uint64_t dev_bytes = sc->dev_bytes;
+	uint32_t bytes;
+	uint32_t pos;
+	uint32_t chunk;
+
+	/* bandwidth is in bytes per us */
+	if (bandwidth)
+		sc->credit = MIN(sc->credit + bandwidth * elapsed / 1000,
+				 sc->size);
+	else
+		sc->credit = sc->size;
+
+	if (chan->direction == DMA_DIR_HMEM_TO_LMEM) {
+		bytes = MIN(sc->credit, sc->size - sc->level);
+		bytes -= bytes % sc->width;
+		pos = sc->dev_pos;
+		while (bytes) {
+			chunk = sim_file_read(sc->ring + pos,
+					      MIN(bytes, sc->size - pos),
+					      sc->width);
+			if (!chunk)
+				break;
+			sc->level += chunk;
+			sc->credit -= chunk;
+			sim_chan_progress(sc, chunk, sim.time);
+			sim.progress_time = sim.time;
+			bytes -= chunk;
+			pos = sc->dev_pos;
+		}
+
+		/* remember when host frames entered the DSP */
+		if (sc->dev_bytes != dev_bytes && sim.channels) {
+			if (sim.mark_count == SIM_LATENCY_MARKS) {
+				sim.mark_rd = (sim.mark_rd + 1) %
+					SIM_LATENCY_MARKS;
+				sim.mark_count--;
+			}
+			sim.marks[(sim.mark_rd + sim.mark_count) %
+				  SIM_LATENCY_MARKS] = (struct sim_mark){
+				.frames = sc->dev_bytes /
+					(sc->width * sim.channels),
+				.time = sim.time,
+			};
+			sim.mark_count++;
+		}
+	} else {
+		bytes = MIN(sc->credit, sc->level);
+		bytes -= bytes % sc->width;
+		pos = sc->dev_pos;
+		while (bytes) {
+			chunk = MIN(bytes, sc->size - pos);
+			sim_file_write(sc->ring + pos, chunk, sc->width);
+			sc->level -= chunk;
+			sc->credit -= chunk;
+			sim_chan_progress(sc, chunk, sim.time);
+			sim.progress_time = sim.time;
+			bytes -= chunk;
+			pos = sc->dev_pos;
+		}
+	}
+}
+
+/* all host playback data has been taken by the pipeline */
+static bool sim_host_drained(void)
+{
+	const struct dma_info *info = dma_info_get();
+	struct tb_sim_chan *sc;
+	struct dma *d;
+	int i;
+
+	if (!sim.in_eof)
+		return false;
+
+	for (d = info->dma_array; d < info->dma_array + info->num_dmas; d++)
+		for (i = 0; d->chan && i < d->plat_data.channels; i++) {
+			sc = dma_chan_get_data(&d->chan[i]);
+			if (d->chan[i].direction == DMA_DIR_HMEM_TO_LMEM &&
+			    sc->running && sc->level)
+				return false;
+		}
+
+	return true;
+}
+
+static void sim_fifo_copy(struct tb_sim_dai_dir *sdd, char *data,
+			  bool to_fifo)
+{
+	uint32_t pos;
+
+	if (to_fifo) {
+		pos = (sdd->fifo_rd + sdd->fifo_level) % sdd->fifo_size;
+		memcpy(sdd->fifo + pos, data, sdd->frame_bytes);
+		sdd->fifo_level += sdd->frame_bytes;
+	} else {
+		memcpy(data, sdd->fifo + sdd->fifo_rd, sdd->frame_bytes);
+		sdd->fifo_rd = (sdd->fifo_rd + sdd->frame_bytes) %
+			sdd->fifo_size;
+		sdd->fifo_level -= sdd->frame_bytes;
+	}
+}
+
+/* latency of the last stream frame sent by a playback DAI */
+static void sim_latency_update(struct tb_sim_dai *sd, uint64_t real_frames,
+			       uint64_t time)
+{
+	uint32_t rate = sd->rate ? sd->rate : sim.tp->fs_out;
+	uint64_t in_frame = real_frames * sim.tp->fs_in / rate;
+	uint64_t latency;
+
+	while (sim.mark_count &&
+	       sim.marks[sim.mark_rd].frames < in_frame) {
+		sim.mark_rd = (sim.mark_rd + 1) % SIM_LATENCY_MARKS;
+		sim.mark_count--;
+	}
+
+	if (!sim.mark_count)
+		return;
+
+	latency = time - sim.marks[sim.mark_rd].time;
+	if (!sim.lat_count || latency < sim.lat_min)
+		sim.lat_min = latency;
+	if (latency > sim.lat_max)
+		sim.lat_max = latency;
+	sim.lat_sum += latency;
+	sim.lat_count++;
+}
+
+static int sim_dai_dir_start(struct tb_sim_dai *sd, struct tb_sim_dai_dir *sdd,
+			     struct tb_sim_chan *sc)
+{
+	uint32_t channels = sd->channels ? sd->channels : sim.channels;
+	uint32_t depth = sim.tp->sim_fifo_depth;
+
+	if (sdd->fifo)
+		return 0;
+
+	sdd->frame_bytes = channels * sc->width;
+	sdd->fifo_size = (depth ? depth : TB_SIM_FIFO_DEPTH) *
+		sdd->frame_bytes;
+
+	/* the frame follows the FIFO, any channel count fits */
+	sdd->fifo = calloc(1, sdd->fifo_size + sdd->frame_bytes);
+	if (!sdd->fifo)
+		return -ENOMEM;
+
+	sdd->frame = sdd->fifo + sdd->fifo_size;
+
+	return 0;
+}
+
+static void sim_dai_playback(struct tb_sim_chan *sc, struct tb_sim_dai *sd)
+{
+	struct tb_sim_dai_dir *sdd = &sd->dir[DAI_DIR_PLAYBACK];
+	uint32_t rate = sd->rate ? sd->rate : sim.tp->fs_out;
+	uint64_t real_frames = sdd->real_frames;
+	uint64_t due;
+	uint64_t t = 0;
+	char *frame;
+	uint32_t fb;
+
+	if (!sdd->running || sim_dai_dir_start(sd, sdd, sc) < 0)
+		return;
+
+	frame = sdd->frame;
+	fb = sdd->frame_bytes;
+	due = (sim.time - sdd->start_time) * rate / SIM_NS_PER_SEC;
+
+	for (; sdd->frames < due; sdd->frames++) {
+		t = sdd->start_time +
+			(sdd->frames + 1) * SIM_NS_PER_SEC / rate;
+
+		/* DMA keeps the FIFO topped up from the buffer */
+		while (sdd->fifo_size - sdd->fifo_level >= fb &&
+		       sc->level >= fb) {
+			sim_ring_copy(sc, frame, fb, false);
+			sim_fifo_copy(sdd, frame, true);
+			sc->level -= fb;
+			sim_chan_progress(sc, fb, t);
+		}
+
+		if (!sdd->fifo_level) {
+			/* end of stream rather than an underrun */
+			if (sim_host_drained()) {
+				sim.done = true;
+				break;
+			}
+
+			/* one xrun per starvation, silence until data is back */
+			memset(frame, 0, fb);
+			sim_file_write(frame, fb, sc->width);
+			if (!sdd->xrun) {
+				sdd->xrun = true;
+				sdd->underruns++;
+				sc->xruns++;
+				sc->xrun = true;
+			}
+			continue;
+		}
+
+		sdd->xrun = false;
+		sim_fifo_copy(sdd, frame, false);
+		sim_file_write(frame, fb, sc->width);
+
+		/* initial buffer silence goes out first */
+		if (sc->preload >= fb) {
+			sc->preload -= fb;
+		} else {
+			sdd->real_frames++;
+			sim.progress_time = sim.time;
+		}
+	}
+
+	if (sdd->real_frames != real_frames)
+		sim_latency_update(sd, sdd->real_frames, t);
+}
+
+static void sim_dai_capture(struct tb_sim_chan *sc, struct tb_sim_dai *sd)
+{
+	struct tb_sim_dai_dir *sdd = &sd->dir[DAI_DIR_CAPTURE];
+	uint32_t rate = sd->rate ? sd->rate : sim.tp->fs_in;
+	uint64_t due;
+	uint64_t t;
+	char *frame;
+	uint32_t fb;
+
+	if (!sdd->running || sim_dai_dir_start(sd, sdd, sc) < 0)
+		return;
+
+	frame = sdd->frame;
+	fb = sdd->frame_bytes;
+	due = (sim.time - sdd->start_time) * rate / SIM_NS_PER_SEC;
+
+	for (; sdd->frames < due; sdd->frames++) {
+		t = sdd->start_time +
+			(sdd->frames + 1) * SIM_NS_PER_SEC / rate;
+
+		if (sim_file_read(frame, fb, sc->width) < fb) {
+			sim.done = true;
+			break;
+		}
+
+		if (sdd->fifo_size - sdd->fifo_level < fb) {
+			if (!sdd->xrun) {
+				sdd->xrun = true;
+				sdd->overruns++;
+				sc->xruns++;
+				sc->xrun = true;
+			}
+		} else {
+			sdd->xrun = false;
+			sim_fifo_copy(sdd, frame, true);
+			sdd->real_frames++;
+			sim.progress_time = sim.time;
+		}
+
+		/* DMA drains the FIFO into the buffer */
+		while (sdd->fifo_level >= fb && sc->size - sc->level >= fb) {
+			sim_fifo_copy(sdd, frame, false);
+			sim_ring_copy(sc, frame, fb, true);
+			sc->level += fb;
+			sim_chan_progress(sc, fb, t);
+		}
+	}
+}
+
+static void sim_advance(uint64_t time)
+{
+	const struct dma_info *info = dma_info_get();
+	uint64_t elapsed = time - sim.time;
+	struct dma_chan_data *chan;
+	struct tb_sim_chan *sc;
+	struct dai *dai;
+	struct dma *d;
+	int i;
+
+	sim.time = time;
+
+	for (d = info->dma_array; d < info->dma_array + info->num_dmas; d++) {
+		for (i = 0; d->chan && i < d->plat_data.channels; i++) {
+			chan = &d->chan[i];
+			sc = dma_chan_get_data(chan);
+			if (!sc->running)
+				continue;
+
+			switch (chan->direction) {
+			case DMA_DIR_HMEM_TO_LMEM:
+			case DMA_DIR_LMEM_TO_HMEM:
+				sim_host_run(chan, sc, elapsed);
+				break;
+			case DMA_DIR_MEM_TO_DEV:
+				dai = tb_sim_dai_find(sc->handshake);
+				if (dai)
+					sim_dai_playback(sc,
+							 dai_get_drvdata(dai));
+				break;
+			case DMA_DIR_DEV_TO_MEM:
+				dai = tb_sim_dai_find(sc->handshake);
+				if (dai)
+					sim_dai_capture(sc,
+							dai_get_drvdata(dai));
+				break;
+			default:
+				break;
+			}
+		}
+	}
+}
+
+static const char *sim_dir_name(uint32_t direction)
+{
+	switch (direction) {
+	case DMA_DIR_HMEM_TO_LMEM:
+		return "host playback";
+	case DMA_DIR_LMEM_TO_HMEM:
+		return "host capture";
+	case DMA_DIR_MEM_TO_DEV:
+		return "dai playback";
+	case DMA_DIR_DEV_TO_MEM:
+		return "dai capture";
+	default:
+		return "unknown";
+	}
+}
+
+void tb_sim_print_stats(void)
+{
+#if CONFIG_LATENCY_MARKERS
+	struct pipeline_latency *lat;
+#endif
+	const struct dma_info *info = dma_info_get();
+	struct tb_sim_dai_dir *sdd;
+	struct dma_chan_data *chan;
+	struct tb_sim_chan *sc;
+	struct tb_sim_dai *sd;
+	struct dai *dai;
+	struct dma *d;
+	int i;
+
+	printf("Simulation: %.3f ms virtual time, %u periods scheduled, %u skipped\n",
+	       sim.time / 1e6, sim.ticks, sim.skipped);
+	printf("Pipeline xruns: %u\n", sim.xruns);
+	printf("LL tick: %u us\n", sim.tick);
+	for (i = 0; i < sim.ll_count; i++)
+		printf("LL task %d: period %u us, %u runs\n", i,
+		       sim.ll[i].period, sim.ll[i].runs);
+
+	for (d = info->dma_array; d < info->dma_array + info->num_dmas; d++) {
+		for (i = 0; d->chan && i < d->plat_data.channels; i++) {
+			chan = &d->chan[i];
+			sc = dma_chan_get_data(chan);
+			if (chan->status == COMP_STATE_INIT || !sc->dev_bytes)
+				continue;
+
+			printf("DMA %u.%u %s: buffer %u bytes, %" PRIu64 " bytes, %u periods",
+			       d->plat_data.id, chan->index,
+			       sim_dir_name(chan->direction), sc->size,
+			       sc->dev_bytes, sc->irqs);
+			if (sc->irqs > 1)
+				printf(", period %.1f..%.1f us",
+				       sc->irq_min / 1e3, sc->irq_max / 1e3);
+			printf(", %u xruns\n", sc->xruns);
+			if (sc->irq_latency.count)
+				sim_print_hist("  period to service latency",
+					       &sc->irq_latency);
+
+			if (chan->direction != DMA_DIR_MEM_TO_DEV &&
+			    chan->direction != DMA_DIR_DEV_TO_MEM)
+				continue;
+
+			dai = tb_sim_dai_find(sc->handshake);
+			if (!dai)
+				continue;
+
+			sd = dai_get_drvdata(dai);
+			sdd = &sd->dir[sc->handshake & 1];
+			printf("DAI %u.%u: %u Hz, fifo %u frames, %" PRIu64 " frames, %u underruns, %u overruns\n",
+			       dai->drv->type, dai->index,
+			       sd->rate ? sd->rate : sim.tp->fs_out,
+			       sdd->frame_bytes ?
+			       sdd->fifo_size / sdd->frame_bytes : 0,
+			       sdd->frames, sdd->underruns, sdd->overruns);
+		}
+	}
+
+	if (sim.lat_count)
+		printf("Host to DAI latency: min %.1f us, avg %.1f us, max %.1f us\n",
+		       sim.lat_min / 1e3, sim.lat_sum / 1e3 / sim.lat_count,
+		       sim.lat_max / 1e3);
+
+#if CONFIG_LATENCY_MARKERS
+	/* measured by the firmware with the markers, ticks are ns */
+	lat = sim.p ? &sim.p->latency : NULL;
+	if (lat && lat->count)
+		printf("Graph latency: %u frames, min %.1f us, avg %.1f us, max %.1f us, %u lost\n",
+		       lat->count, lat->min / 1e3,
+		       lat->total / 1e3 / lat->count, lat->max / 1e3,
+		       lat->lost);
+#endif
+}
+
+int tb_sim_init(struct sof *sof, struct testbench_prm *tp)
+{
+	sim.tp = tp;
+	sim.ipc = sof->ipc;
+
+	sim.in = fopen(tp->input_file, "r");
+	if (!sim.in) {
+		fprintf(stderr, "error: opening file %s\n", tp->input_file);
+		return -EINVAL;
+	}
+
+	sim.out = fopen(tp->output_file, "w");
+	if (!sim.out) {
+		fprintf(stderr, "error: opening file %s\n", tp->output_file);
+		fclose(sim.in);
+		return -EINVAL;
+	}
+
+	sim.in_format = sim_file_format(tp->input_file);
+	sim.out_format = sim_file_format(tp->output_file);
+
+	tb_sim_dma_init(sof, tp->sim_period_count);
+	tb_sim_dai_init(sof);
+
+	return 0;
+}
+
+/* send the DAI config the host driver would derive from the topology */
+int tb_sim_dai_config(struct ipc *ipc, int nch, struct testbench_prm *tp)
+{
+	struct sof_ipc_dai_config config;
+	struct sof_ipc_comp_dai *dai;
+	struct ipc_comp_dev *icd;
+	struct list_item *clist;
+	int ret;
+
+	sim.channels = nch;
+
+	list_for_item(clist, &ipc->comp_list) {
+		icd = container_of(clist, struct ipc_comp_dev, list);
+		if (icd->type != COMP_TYPE_COMPONENT ||
+		    dev_comp_type(icd->cd) != SOF_COMP_DAI)
+			continue;
+
+		dai = COMP_GET_IPC(icd->cd, sof_ipc_comp_dai);
+
+		memset(&config, 0, sizeof(config));
+		config.hdr.cmd = SOF_IPC_GLB_DAI_MSG | SOF_IPC_DAI_CONFIG;
+		config.hdr.size = sizeof(config);
+		config.type = dai->type;
+		config.dai_index = dai->dai_index;
+
+		switch (dai->type) {
+		case SOF_DAI_INTEL_SSP:
+			config.ssp.fsync_rate = tp->fs_out;
+			config.ssp.tdm_slots = nch;
+			config.ssp.tx_slots = (1ULL << MIN(nch, 32)) - 1;
+			config.ssp.rx_slots = (1ULL << MIN(nch, 32)) - 1;
+			config.ssp.sample_valid_bits =
+				sample_bytes(dai->config.frame_fmt) * 8;
+			config.ssp.tdm_slot_width =
+				config.ssp.sample_valid_bits;
+			break;
+		case SOF_DAI_INTEL_HDA:
+			config.hda.link_dma_ch = dai->dai_index;
+			break;
+		default:
+			break;
+		}
+
+		ret = ipc_comp_dai_config(ipc, &config);
+		if (ret < 0) {
+			fprintf(stderr, "error: dai %d.%d config\n",
+				dai->type, dai->dai_index);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Runs the tasks due at the current tick. Like in the firmware a task
+ * stays on the multiples of its period and does not catch up with runs
+ * it missed. Returns true if the pipeline is due.
+ */
+static bool sim_ll_run(void)
+{
+	struct sim_ll_task *t;
+	uint64_t period;
+	bool pipe_due = false;
+	uint32_t i;
+
+	for (i = 0; i < sim.ll_count; i++) {
+		t = &sim.ll[i];
+		if (t->due > sim.time)
+			continue;
+
+		period = t->period * 1000ULL;
+		t->due += period;
+		if (t->due <= sim.time)
+			t->due = sim.time + period;
+		t->runs++;
+		if (!i)
+			pipe_due = true;
+	}
+
+	return pipe_due;
+}
+
+#if CONFIG_PIPELINE_EDIT
+/* sends the edit messages the host would send between two periods */
+static void sim_edit(void)
+{
+	struct testbench_prm *tp = sim.tp;
+	struct sof_ipc_pipe_comp_edit edit;
+	struct ipc_comp_dev *icd;
+	struct comp_buffer *buffer;
+	int ret;
+
+	memset(&edit, 0, sizeof(edit));
+	edit.comp_id = tp->sim_edit_comp;
+
+	if (!sim.edit_removed &&
+	    sim.time >= tp->sim_edit_remove * 1000000ULL) {
+		sim.edit_removed = true;
+		icd = ipc_get_comp_by_id(sim.ipc, edit.comp_id);
+		if (!icd || icd->type != COMP_TYPE_COMPONENT ||
+		    list_is_empty(&icd->cd->bsource_list) ||
+		    list_is_empty(&icd->cd->bsink_list)) {
+			fprintf(stderr, "error: no component %u to remove\n",
+				edit.comp_id);
+			return;
+		}
+
+		buffer = list_first_item(&icd->cd->bsource_list,
+					 struct comp_buffer, sink_list);
+		sim.edit_source = buffer->id;
+		buffer = list_first_item(&icd->cd->bsink_list,
+					 struct comp_buffer, source_list);
+		sim.edit_sink = buffer->id;
+
+		edit.op = SOF_IPC_COMP_EDIT_REMOVE;
+		ret = ipc_comp_edit(sim.ipc, &edit);
+		printf("Graph edit: remove comp %u at %.3f ms, ret %d\n",
+		       edit.comp_id, sim.time / 1e6, ret);
+		return;
+	}
+
+	if (!sim.edit_removed || sim.edit_inserted || !tp->sim_edit_insert ||
+	    sim.time < tp->sim_edit_insert * 1000000ULL)
+		return;
+
+	edit.op = SOF_IPC_COMP_EDIT_INSERT;
+	edit.source_id = sim.edit_source;
+	edit.sink_id = sim.edit_sink;
+	ret = ipc_comp_edit(sim.ipc, &edit);
+
+	/* the removal may still wait for the sink buffer to drain */
+	if (ret == -EBUSY)
+		return;
+
+	sim.edit_inserted = true;
+	printf("Graph edit: insert comp %u at %.3f ms, ret %d\n",
+	       edit.comp_id, sim.time / 1e6, ret);
+}
+#endif
+
+int tb_sim_run(struct pipeline *p)
+{
+	struct testbench_prm *tp = sim.tp;
+	struct sim_ll_task *pipe = &sim.ll[0];
+	uint32_t tick;
+	uint32_t i;
+	int ret = 0;
+
+	sim.p = p;
+
+	/* the pipeline and the other tasks share the LL domain */
+	pipe->period = p->ipc_pipe.period;
+	sim.ll_count = tp->sim_ll_count + 1;
+	for (i = 1; i < sim.ll_count; i++)
+		sim.ll[i].period = tp->sim_ll_period[i - 1];
+
+	for (i = 0; i < sim.ll_count; i++) {
+		sim.tick = ll_tick_add(sim.tick, sim.ll[i].period);
+		sim.ll[i].due = sim.ll[i].period * 1000ULL;
+	}
+
+	sim.tick = ll_tick_limit(sim.tick);
+	if (!pipe->period) {
+		fprintf(stderr, "error: pipeline period is 0\n");
+		return -EINVAL;
+	}
+
+	for (tick = 1; ; tick++) {
+		sim_advance(tick * sim.tick * 1000ULL);
+		if (sim.done)
+			break;
+
+		if (sim.time - sim.progress_time > TB_SIM_STALL_NS) {
+			fprintf(stderr, "error: simulation stalled at %.3f ms\n",
+				sim.time / 1e6);
+			ret = -ETIME;
+			break;
+		}
+
+		if (!sim_ll_run())
+			continue;
+
+		/* missed deadlines, e.g. to reproduce an xrun */
+		if (tp->sim_skip_every &&
+		    (pipe->runs - 1) % tp->sim_skip_every >=
+		    tp->sim_skip_every - tp->sim_skip_len) {
+			sim.skipped++;
+			continue;
+		}
+
+#if CONFIG_PIPELINE_EDIT
+		if (tp->sim_edit_remove)
+			sim_edit();
+#endif
+
+		pipeline_schedule_copy(p, 0);
+		sim.ticks++;
+	}
+
+	tb_sim_print_stats();
+
+	return ret;
+}
+
+void tb_sim_samples(int *n_in, int *n_out)
+{
+	*n_in = sim.in_samples;
+	*n_out = sim.out_samples;
+}
+
+void tb_sim_xrun(struct pipeline *p, struct comp_dev *dev, int32_t bytes)
+{
+	sim.xruns++;
+}
+
+void tb_sim_free(void)
+{
+	if (sim.in)
+		fclose(sim.in);
+	if (sim.out)
+		fclose(sim.out);
+	sim.in = NULL;
+	sim.out = NULL;
+}
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Simulated DAIs for the testbench
+ *
+ * Each simulated DAI keeps the rate and channel count of its last config and
+ * a trigger state per direction. Frames are clocked through the DAI FIFO by
+ * the simulation clock in sim.c.
+ */
+
+#include <sof/audio/component.h>
+#include <sof/lib/dai.h>
+#include <ipc/dai.h>
+#include <ipc/stream.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testbench/sim.h"
+
+#define SIM_NUM_SSP	6
+#define SIM_NUM_HDA	8
+#define SIM_NUM_DMIC	2
+
+static int sim_dai_set_config(struct dai *dai,
+			      struct sof_ipc_dai_config *config)
+{
+	struct tb_sim_dai *sd = dai_get_drvdata(dai);
+
+	/* only SSP carries the frame clock in its config */
+	if (config->type == SOF_DAI_INTEL_SSP) {
+		sd->rate = config->ssp.fsync_rate;
+		sd->channels = config->ssp.tdm_slots;
+	}
+
+	return 0;
+}
+
+static int sim_dai_trigger(struct dai *dai, int cmd, int direction)
+{
+	struct tb_sim_dai *sd = dai_get_drvdata(dai);
+	struct tb_sim_dai_dir *sdd = &sd->dir[direction];
+
+	switch (cmd) {
+	case COMP_TRIGGER_START:
+		sdd->start_time = tb_sim_time();
+		sdd->frames = 0;
+		sdd->real_frames = 0;
+		sdd->fifo_level = 0;
+		sdd->fifo_rd = 0;
+		sdd->xrun = false;
+		/* fallthrough */
+	case COMP_TRIGGER_RELEASE:
+		sdd->running = true;
+		break;
+	case COMP_TRIGGER_STOP:
+	case COMP_TRIGGER_PAUSE:
+		sdd->running = false;
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static int sim_dai_pm_context_store(struct dai *dai)
+{
+	return 0;
+}
+
+static int sim_dai_pm_context_restore(struct dai *dai)
+{
+	return 0;
+}
+
+static int sim_dai_get_hw_params(struct dai *dai,
+				 struct sof_ipc_stream_params *params)
+{
+	struct tb_sim_dai *sd = dai_get_drvdata(dai);
+
+	/* 0 means any value is accepted */
+	params->rate = sd->rate;
+	params->channels = sd->channels;
+	params->buffer_fmt = 0;
+	params->frame_fmt = 0;
+
+	return 0;
+}
+
+static int sim_dai_get_handshake(struct dai *dai, int direction,
+				 int stream_id)
+{
+	return dai->plat_data.fifo[direction].handshake;
+}
+
+static int sim_dai_get_fifo(struct dai *dai, int direction, int stream_id)
+{
+	return dai->plat_data.fifo[direction].offset;
+}
+
+static int sim_dai_probe(struct dai *dai)
+{
+	struct tb_sim_dai *sd;
+
+	if (dai_get_drvdata(dai))
+		return -EEXIST;
+
+	sd = calloc(1, sizeof(*sd));
+	if (!sd)
+		return -ENOMEM;
+
+	dai_set_drvdata(dai, sd);
+
+	return 0;
+}
+
+static int sim_dai_remove(struct dai *dai)
+{
+	struct tb_sim_dai *sd = dai_get_drvdata(dai);
+
+	free(sd->dir[DAI_DIR_PLAYBACK].fifo);
+	free(sd->dir[DAI_DIR_CAPTURE].fifo);
+	free(sd);
+	dai_set_drvdata(dai, NULL);
+
+	return 0;
+}
+
+#define SIM_DAI_DRIVER(dai_type, caps, dev)				\
+	{								\
+		.type = dai_type,					\
+		.dma_caps = caps,					\
+		.dma_dev = dev,						\
+		.ops = {						\
+			.set_config		= sim_dai_set_config,	\
+			.trigger		= sim_dai_trigger,	\
+			.pm_context_store	= sim_dai_pm_context_store, \
+			.pm_context_restore	= sim_dai_pm_context_restore, \
+			.get_hw_params		= sim_dai_get_hw_params, \
+			.get_handshake		= sim_dai_get_handshake, \
+			.get_fifo		= sim_dai_get_fifo,	\
+			.probe			= sim_dai_probe,	\
+			.remove			= sim_dai_remove,	\
+		},							\
+	}
+
+static const struct dai_driver sim_ssp_driver =
+	SIM_DAI_DRIVER(SOF_DAI_INTEL_SSP, DMA_CAP_GP_LP | DMA_CAP_GP_HP,
+		       DMA_DEV_SSP);
+static const struct dai_driver sim_hda_driver =
+	SIM_DAI_DRIVER(SOF_DAI_INTEL_HDA, DMA_CAP_HDA, DMA_DEV_HDA);
+static const struct dai_driver sim_dmic_driver =
+	SIM_DAI_DRIVER(SOF_DAI_INTEL_DMIC, DMA_CAP_GP_LP | DMA_CAP_GP_HP,
+		       DMA_DEV_DMIC);
+
+static struct dai sim_ssp[SIM_NUM_SSP];
+static struct dai sim_hda[SIM_NUM_HDA];
+static struct dai sim_dmic[SIM_NUM_DMIC];
+
+static const struct dai_type_info sim_dai_types[] = {
+	{
+		.type		= SOF_DAI_INTEL_SSP,
+		.dai_array	= sim_ssp,
+		.num_dais	= ARRAY_SIZE(sim_ssp),
+	},
+	{
+		.type		= SOF_DAI_INTEL_HDA,
+		.dai_array	= sim_hda,
+		.num_dais	= ARRAY_SIZE(sim_hda),
+	},
+	{
+		.type		= SOF_DAI_INTEL_DMIC,
+		.dai_array	= sim_dmic,
+		.num_dais	= ARRAY_SIZE(sim_dmic),
+	},
+};
+
+static const struct dai_info sim_dai_info = {
+	.dai_type_array	= sim_dai_types,
+	.num_dai_types	= ARRAY_SIZE(sim_dai_types),
+};
+
+static void sim_dai_type_init(struct dai *dais, size_t num_dais,
+			      const struct dai_driver *drv)
+{
+	struct dai_plat_fifo_data *fifo;
+	int dir;
+	int i;
+
+	for (i = 0; i < num_dais; i++) {
+		dais[i].index = i;
+		dais[i].drv = drv;
+		spinlock_init(&dais[i].lock);
+
+		for (dir = DAI_DIR_PLAYBACK; dir <= DAI_DIR_CAPTURE; dir++) {
+			fifo = &dais[i].plat_data.fifo[dir];
+			fifo->handshake = TB_SIM_HANDSHAKE(drv->type, i, dir);
+			fifo->offset = fifo->handshake << 2;
+		}
+	}
+}
+
+struct dai *tb_sim_dai_find(uint32_t handshake)
+{
+	const struct dai_type_info *dti;
+	struct dai *d;
+
+	for (dti = sim_dai_types;
+	     dti < sim_dai_types + ARRAY_SIZE(sim_dai_types); dti++)
+		for (d = dti->dai_array; d < dti->dai_array + dti->num_dais;
+		     d++)
+			if (d->plat_data.fifo[handshake & 1].handshake ==
+			    handshake)
+				return dai_get_drvdata(d) ? d : NULL;
+
+	return NULL;
+}
+
+int tb_sim_dai_init(struct sof *sof)
+{
+	sim_dai_type_init(sim_ssp, ARRAY_SIZE(sim_ssp), &sim_ssp_driver);
+	sim_dai_type_init(sim_hda, ARRAY_SIZE(sim_hda), &sim_hda_driver);
+	sim_dai_type_init(sim_dmic, ARRAY_SIZE(sim_dmic), &sim_dmic_driver);
+
+	sof->dai_info = &sim_dai_info;
+
+	return 0;
+}
@@ -0,0 +1,382 @@
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// Copyright(c) 2020 Intel Corporation. All rights reserved.
+
+/* Simulated DMA controllers for the testbench
+ *
+ * The DSP side of a channel is the regular driver API: dma_copy() runs the
+ * client callback and moves the channel level by the copied bytes, and
+ * dma_get_data_size() reports the level. The device side of each channel
+ * is advanced by the simulation clock in sim.c.
+ */
+
+#include <sof/audio/component.h>
+#include <sof/lib/dma.h>
+#include <sof/lib/notifier.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testbench/sim.h"
+
+static struct dma sim_dma[] = {
+{
+	.plat_data = {
+		.id		= DMA_ID_DMAC0,
+		.dir		= DMA_DIR_HMEM_TO_LMEM | DMA_DIR_LMEM_TO_HMEM,
+		.caps		= DMA_CAP_HDA,
+		.devs		= DMA_DEV_HOST,
+		.channels	= TB_SIM_DMA_CHANNELS,
+	},
+},
+{
+	.plat_data = {
+		.id		= DMA_ID_DMAC1,
+		.dir		= DMA_DIR_MEM_TO_DEV | DMA_DIR_DEV_TO_MEM,
+		.caps		= DMA_CAP_HDA | DMA_CAP_GP_LP | DMA_CAP_GP_HP,
+		.devs		= DMA_DEV_HDA | DMA_DEV_SSP | DMA_DEV_DMIC,
+		.channels	= TB_SIM_DMA_CHANNELS,
+	},
+},
+};
+
+static uint32_t sim_dma_period_count = TB_SIM_PERIOD_COUNT;
+
+static const struct dma_info sim_dma_info = {
+	.dma_array	= sim_dma,
+	.num_dmas	= ARRAY_SIZE(sim_dma),
+};
+
+/* the DSP writes the buffer and the device reads it */
+static bool sim_dma_dsp_produces(struct dma_chan_data *channel)
+{
+	return channel->direction == DMA_DIR_MEM_TO_DEV ||
+	       channel->direction == DMA_DIR_LMEM_TO_HMEM;
+}
+
+static struct dma_chan_data *sim_dma_channel_get(struct dma *dma,
+						 unsigned int req_chan)
+{
+	int i;
+
+	/* honour the requested channel when free, e.g. HDA link DMA */
+	if (req_chan < dma->plat_data.channels &&
+	    dma->chan[req_chan].status == COMP_STATE_INIT)
+		i = req_chan;
+	else
+		for (i = 0; i < dma->plat_data.channels; i++)
+			if (dma->chan[i].status == COMP_STATE_INIT)
+				break;
+
+	if (i == dma->plat_data.channels) {
+		fprintf(stderr, "error: sim dma %d no free channel\n",
+			dma->plat_data.id);
+		return NULL;
+	}
+
+	dma->chan[i].status = COMP_STATE_READY;
+	atomic_add(&dma->num_channels_busy, 1);
+
+	return &dma->chan[i];
+}
+
+static void sim_dma_channel_put(struct dma_chan_data *channel)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	notifier_unregister_all(NULL, channel);
+
+	sc->ring = NULL;
+	sc->running = false;
+	channel->status = COMP_STATE_INIT;
+	atomic_sub(&channel->dma->num_channels_busy, 1);
+}
+
+static int sim_dma_start(struct dma_chan_data *channel)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	if (!sc->ring)
+		return -EINVAL;
+
+	sc->running = true;
+	sc->start_time = tb_sim_time();
+	sc->irq_last = sc->start_time;
+	sc->irq_pending = false;
+	channel->status = COMP_STATE_ACTIVE;
+
+	return 0;
+}
+
+static int sim_dma_stop(struct dma_chan_data *channel)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	sc->running = false;
+	channel->status = COMP_STATE_PREPARE;
+
+	return 0;
+}
+
+static int sim_dma_pause(struct dma_chan_data *channel)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	sc->running = false;
+	channel->status = COMP_STATE_PAUSED;
+
+	return 0;
+}
+
+static int sim_dma_release(struct dma_chan_data *channel)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	sc->running = true;
+	channel->status = COMP_STATE_ACTIVE;
+
+	return 0;
+}
+
+static int sim_dma_copy(struct dma_chan_data *channel, int bytes,
+			uint32_t flags)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+	struct dma_cb_data next = {
+		.channel = channel,
+		.elem = { .size = bytes },
+	};
+
+	if (!bytes)
+		return 0;
+
+	if (sim_dma_dsp_produces(channel) ? bytes > sc->size - sc->level :
+	    bytes > sc->level)
+		return -EINVAL;
+
+	/* client moves the data between its buffer and the DMA buffer */
+	notifier_event(channel, NOTIFIER_ID_DMA_COPY,
+		       NOTIFIER_TARGET_CORE_LOCAL, &next, sizeof(next));
+
+	if (sim_dma_dsp_produces(channel))
+		sc->level += bytes;
+	else
+		sc->level -= bytes;
+
+	sc->dsp_bytes += bytes;
+	tb_sim_chan_service(sc);
+
+	return 0;
+}
+
+static int sim_dma_status(struct dma_chan_data *channel,
+			  struct dma_chan_status *status, uint8_t direction)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	status->state = channel->status;
+	status->flags = 0;
+	status->r_pos = sc->dev_pos;
+	status->w_pos = (sc->dev_pos + sc->level) % sc->size;
+	status->timestamp = (uint32_t)tb_sim_time();
+
+	return 0;
+}
+
+static int sim_dma_set_config(struct dma_chan_data *channel,
+			      struct dma_sg_config *config)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+	struct dma_sg_elem *elem;
+	uint32_t addr;
+	uint32_t i;
+
+	if (!config->elem_array.count) {
+		fprintf(stderr, "error: sim dma %d channel %d no elems\n",
+			channel->dma->plat_data.id, channel->index);
+		return -EINVAL;
+	}
+
+	channel->direction = config->direction;
+	channel->desc_count = config->elem_array.count;
+	channel->is_scheduling_source = config->is_scheduling_source;
+	channel->period = config->period;
+
+	/* local side of the elems must form one contiguous ring */
+	elem = config->elem_array.elems;
+	addr = sim_dma_dsp_produces(channel) ? elem->src : elem->dest;
+	sc->elem_size = elem->size;
+	sc->size = elem->size * config->elem_array.count;
+	for (i = 1; i < config->elem_array.count; i++) {
+		elem = config->elem_array.elems + i;
+		if ((sim_dma_dsp_produces(channel) ? elem->src : elem->dest) !=
+		    addr + i * sc->elem_size) {
+			fprintf(stderr, "error: sim dma %d channel %d non contiguous elems\n",
+				channel->dma->plat_data.id, channel->index);
+			return -EINVAL;
+		}
+	}
+
+	sc->ring = tb_dma_ptr(addr, sc->size);
+	if (!sc->ring) {
+		fprintf(stderr, "error: sim dma %d channel %d unknown buffer 0x%x\n",
+			channel->dma->plat_data.id, channel->index, addr);
+		return -EINVAL;
+	}
+
+	/* host reconfigures before each copy, keep the running position */
+	if (sc->running)
+		return 0;
+
+	sc->width = config->src_width;
+	sc->handshake = config->direction == DMA_DIR_MEM_TO_DEV ?
+		config->dest_dev : config->src_dev;
+	sc->dev_pos = 0;
+	sc->credit = 0;
+	sc->xrun = false;
+
+	/* cyclic playback starts on a full buffer of silence */
+	if (channel->direction == DMA_DIR_MEM_TO_DEV) {
+		memset(sc->ring, 0, sc->size);
+		sc->level = sc->size;
+		sc->preload = sc->size;
+	} else {
+		sc->level = 0;
+		sc->preload = 0;
+	}
+
+	channel->status = COMP_STATE_PREPARE;
+
+	return 0;
+}
+
+static int sim_dma_pm_context_restore(struct dma *dma)
+{
+	return 0;
+}
+
+static int sim_dma_pm_context_store(struct dma *dma)
+{
+	return 0;
+}
+
+static int sim_dma_probe(struct dma *dma)
+{
+	struct tb_sim_chan *chanp;
+	int i;
+
+	if (dma->chan)
+		return -EEXIST;
+
+	dma->chan = calloc(dma->plat_data.channels, sizeof(dma->chan[0]));
+	chanp = calloc(dma->plat_data.channels, sizeof(chanp[0]));
+	if (!dma->chan || !chanp) {
+		free(dma->chan);
+		free(chanp);
+		dma->chan = NULL;
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < dma->plat_data.channels; i++) {
+		dma->chan[i].dma = dma;
+		dma->chan[i].index = i;
+		dma->chan[i].status = COMP_STATE_INIT;
+		dma->chan[i].private = &chanp[i];
+	}
+
+	atomic_init(&dma->num_channels_busy, 0);
+
+	return 0;
+}
+
+static int sim_dma_remove(struct dma *dma)
+{
+	if (!dma->chan)
+		return 0;
+
+	free(dma_chan_get_data(&dma->chan[0]));
+	free(dma->chan);
+	dma->chan = NULL;
+
+	return 0;
+}
+
+static int sim_dma_get_data_size(struct dma_chan_data *channel,
+				 uint32_t *avail, uint32_t *free)
+{
+	struct tb_sim_chan *sc = dma_chan_get_data(channel);
+
+	/* link DMA reports a device xrun once, like dw-dma and hda-dma */
+	if (sc->xrun) {
+		sc->xrun = false;
+		if (channel->direction == DMA_DIR_MEM_TO_DEV ||
+		    channel->direction == DMA_DIR_DEV_TO_MEM)
+			return -ENODATA;
+	}
+
+	*avail = sc->level;
+	*free = sc->size - sc->level;
+
+	return 0;
+}
+
+static int sim_dma_get_attribute(struct dma *dma, uint32_t type,
+				 uint32_t *value)
+{
+	switch (type) {
+	case DMA_ATTR_BUFFER_ALIGNMENT:
+	case DMA_ATTR_COPY_ALIGNMENT:
+		*value = sizeof(uint32_t);
+		break;
+	case DMA_ATTR_BUFFER_ADDRESS_ALIGNMENT:
+		*value = PLATFORM_DCACHE_ALIGN;
+		break;
+	case DMA_ATTR_BUFFER_PERIOD_COUNT:
+		*value = sim_dma_period_count;
+		break;
+	default:
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+static int sim_dma_interrupt(struct dma_chan_data *channel,
+			     enum dma_irq_cmd cmd)
+{
+	return 0;
+}
+
+static const struct dma_ops sim_dma_ops = {
+	.channel_get		= sim_dma_channel_get,
+	.channel_put		= sim_dma_channel_put,
+	.start			= sim_dma_start,
+	.stop			= sim_dma_stop,
+	.pause			= sim_dma_pause,
+	.release		= sim_dma_release,
+	.copy			= sim_dma_copy,
+	.status			= sim_dma_status,
+	.set_config		= sim_dma_set_config,
+	.pm_context_restore	= sim_dma_pm_context_restore,
+	.pm_context_store	= sim_dma_pm_context_store,
+	.probe			= sim_dma_probe,
+	.remove			= sim_dma_remove,
+	.get_data_size		= sim_dma_get_data_size,
+	.get_attribute		= sim_dma_get_attribute,
+	.interrupt		= sim_dma_interrupt,
+};
+
+int tb_sim_dma_init(struct sof *sof, uint32_t period_count)
+{
+	int i;
+
+	if (period_count)
+		sim_dma_period_count = period_count;
+
+	for (i = 0; i < ARRAY_SIZE(sim_dma); i++)
+		sim_dma[i].ops = &sim_dma_ops;
+
+	sof->dma_info = &sim_dma_info;
+
+	return 0;
+}
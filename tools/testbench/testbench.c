@@ -13,6 +13,7 @@
 #include <tplg_parser/topology.h>
 #include "testbench/trace.h"
 #include "testbench/file.h"
+#include "testbench/sim.h"
 
 #define TESTBENCH_NCH 2 /* Stereo */
 
@@ -22,6 +23,10 @@ struct shared_lib_table lib_table[NUM_WIDGETS_SUPPORTED] = {
 	{"vol", "libsof_volume.so", SND_SOC_TPLG_DAPM_PGA, 0, NULL},
 	{"src", "libsof_src.so", SND_SOC_TPLG_DAPM_SRC, 0, NULL},
 	{"asrc", "libsof_asrc.so", SND_SOC_TPLG_DAPM_ASRC, 0, NULL},
+	{"host", "libsof_host.so", SND_SOC_TPLG_DAPM_AIF_IN, 0, NULL},
+	{"dai", "libsof_dai.so", SND_SOC_TPLG_DAPM_DAI_IN, 0, NULL},
+	{"drc", "libsof_drc.so", SND_SOC_TPLG_DAPM_EFFECT, 0, NULL},
+	{"eq_fir", "libsof_eq_fir.so", SND_SOC_TPLG_DAPM_EFFECT, 0, NULL},
 };
 
 /* main firmware context */
@@ -92,6 +97,15 @@ static void print_usage(char *executable)
 	printf("%s -i in.txt -o out.txt -t test.tplg ", executable);
 	printf("-r 48000 -R 96000 ");
 	printf("-b S16_LE -a vol=libsof_volume.so\n");
+	printf("Simulation of host DMA and DAIs with a virtual clock:\n");
+	printf("-s [-F <dai_fifo_frames>] [-P <dma_periods>] ");
+	printf("[-B <host_dma_bytes_per_us>] [-x <period>[:<count>]]\n");
+	printf("-x skips count pipeline copies every period copies\n");
+	printf("-T <period_us> overrides the pipeline period, ");
+	printf("-L <period_us> adds a simulated LL task, up to %d\n",
+	       TB_SIM_LL_TASKS);
+	printf("-E <comp_id>:<remove_ms>[:<insert_ms>] removes the component ");
+	printf("from the running pipeline and inserts it again\n");
 }
 
 /* free components */
@@ -110,7 +124,9 @@ static void free_comps(void)
 			rfree(icd);
 			break;
 		case COMP_TYPE_BUFFER:
-			rfree(icd->cb->stream.addr);
+			/* in place chains share the memory of the first */
+			if (!icd->cb->alias_prev)
+				rfree(icd->cb->stream.addr);
 			rfree(icd->cb);
 			list_item_del(&icd->list);
 			rfree(icd);
@@ -128,7 +144,7 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 {
 	int option = 0;
 
-	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:")) != -1) {
+	while ((option = getopt(argc, argv, "hdi:o:t:b:a:r:R:T:sF:P:B:x:L:E:")) != -1) {
 		switch (option) {
 		/* input sample file */
 		case 'i':
@@ -165,6 +181,62 @@ static void parse_input_args(int argc, char **argv, struct testbench_prm *tp)
 			tp->fs_out = atoi(optarg);
 			break;
 
+		/* pipeline period */
+		case 'T':
+			tp->period = atoi(optarg);
+			break;
+
+		/* simulate host DMA and DAIs */
+		case 's':
+			tp->sim = true;
+			break;
+
+		/* DAI FIFO depth in frames */
+		case 'F':
+			tp->sim_fifo_depth = atoi(optarg);
+			break;
+
+		/* DMA buffer period count */
+		case 'P':
+			tp->sim_period_count = atoi(optarg);
+			break;
+
+		/* host DMA bandwidth */
+		case 'B':
+			tp->sim_bandwidth = atoi(optarg);
+			break;
+
+		/* skipped pipeline copies */
+		case 'x':
+			tp->sim_skip_len = 1;
+			if (sscanf(optarg, "%u:%u", &tp->sim_skip_every,
+				   &tp->sim_skip_len) < 1 ||
+			    tp->sim_skip_len > tp->sim_skip_every) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
+		/* low latency task running next to the pipeline */
+		case 'L':
+			if (tp->sim_ll_count == TB_SIM_LL_TASKS) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			tp->sim_ll_period[tp->sim_ll_count++] = atoi(optarg);
+			break;
+
+		/* live removal and insertion of a component */
+		case 'E':
+			if (sscanf(optarg, "%u:%u:%u", &tp->sim_edit_comp,
+				   &tp->sim_edit_remove,
+				   &tp->sim_edit_insert) < 2 ||
+			    !tp->sim_edit_remove) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+
 		/* enable debug prints */
 		case 'd':
 			debug = 1;
@@ -186,7 +258,7 @@ int main(int argc, char **argv)
 	struct pipeline *p;
 	struct sof_ipc_pipe_new *ipc_pipe;
 	struct comp_dev *cd;
-	struct file_comp_data *frcd, *fwcd;
+	struct file_comp_data *frcd = NULL, *fwcd = NULL;
 	char pipeline[DEBUG_MSG_LEN];
 	clock_t tic, toc;
 	double c_realtime, t_exec;
@@ -196,9 +268,20 @@ int main(int argc, char **argv)
 	/* initialize input and output sample rates, files, etc. */
 	tp.fs_in = 0;
 	tp.fs_out = 0;
+	tp.period = 0;
 	tp.bits_in = 0;
 	tp.input_file = NULL;
 	tp.output_file = NULL;
+	tp.sim = false;
+	tp.sim_fifo_depth = 0;
+	tp.sim_period_count = 0;
+	tp.sim_bandwidth = 0;
+	tp.sim_skip_every = 0;
+	tp.sim_skip_len = 0;
+	tp.sim_ll_count = 0;
+	tp.sim_edit_comp = 0;
+	tp.sim_edit_remove = 0;
+	tp.sim_edit_insert = 0;
 
 	/* command line arguments*/
 	parse_input_args(argc, argv, &tp);
@@ -215,6 +298,12 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
+	/* install simulated DMACs and DAIs */
+	if (tp.sim && tb_sim_init(&sof, &tp) < 0) {
+		fprintf(stderr, "error: simulation init\n");
+		exit(EXIT_FAILURE);
+	}
+
 	/* parse topology file and create pipeline */
 	if (parse_topology(&sof, lib_table, &tp, &fr_id, &fw_id, &sched_id,
 			   pipeline) < 0) {
@@ -223,10 +312,12 @@ int main(int argc, char **argv)
 	}
 
 	/* Get pointers to fileread and filewrite */
-	pcm_dev = ipc_get_comp_by_id(sof.ipc, fw_id);
-	fwcd = comp_get_drvdata(pcm_dev->cd);
-	pcm_dev = ipc_get_comp_by_id(sof.ipc, fr_id);
-	frcd = comp_get_drvdata(pcm_dev->cd);
+	if (!tp.sim) {
+		pcm_dev = ipc_get_comp_by_id(sof.ipc, fw_id);
+		fwcd = comp_get_drvdata(pcm_dev->cd);
+		pcm_dev = ipc_get_comp_by_id(sof.ipc, fr_id);
+		frcd = comp_get_drvdata(pcm_dev->cd);
+	}
 
 	/* Run pipeline until EOF from fileread */
 	pcm_dev = ipc_get_comp_by_id(sof.ipc, sched_id);
@@ -240,6 +331,15 @@ int main(int argc, char **argv)
 	if (!tp.fs_out)
 		tp.fs_out = ipc_pipe->period * ipc_pipe->frames_per_sched;
 
+	if (tp.period)
+		ipc_pipe->period = tp.period;
+
+	/* configure DAIs before the pipeline params */
+	if (tp.sim && tb_sim_dai_config(sof.ipc, TESTBENCH_NCH, &tp) < 0) {
+		fprintf(stderr, "error: dai config\n");
+		exit(EXIT_FAILURE);
+	}
+
 	/* set pipeline params and trigger start */
 	if (tb_pipeline_start(sof.ipc, TESTBENCH_NCH, ipc_pipe, &tp) < 0) {
 		fprintf(stderr, "error: pipeline params\n");
@@ -250,11 +350,17 @@ int main(int argc, char **argv)
 	tb_enable_trace(false); /* reduce trace output */
 	tic = clock();
 
-	while (frcd->fs.reached_eof == 0)
-		pipeline_schedule_copy(p, 0);
+	if (tp.sim) {
+		/* run until the DAI has played out the stream */
+		if (tb_sim_run(p) < 0)
+			printf("warning: simulation did not complete\n");
+	} else {
+		while (frcd->fs.reached_eof == 0)
+			pipeline_schedule_copy(p, 0);
 
-	if (!frcd->fs.reached_eof)
-		printf("warning: possible pipeline xrun\n");
+		if (!frcd->fs.reached_eof)
+			printf("warning: possible pipeline xrun\n");
+	}
 
 	/* reset and free pipeline */
 	toc = clock();
@@ -266,13 +372,19 @@ int main(int argc, char **argv)
 		exit(EXIT_FAILURE);
 	}
 
-	n_in = frcd->fs.n;
-	n_out = fwcd->fs.n;
+	if (tp.sim) {
+		tb_sim_samples(&n_in, &n_out);
+	} else {
+		n_in = frcd->fs.n;
+		n_out = fwcd->fs.n;
+	}
 	t_exec = (double)(toc - tic) / CLOCKS_PER_SEC;
 	c_realtime = (double)n_out / TESTBENCH_NCH / tp.fs_out / t_exec;
 
 	/* free all components/buffers in pipeline */
 	free_comps();
+	if (tp.sim)
+		tb_sim_free();
 
 	/* print test summary */
 	printf("==========================================================\n");
@@ -7,6 +7,8 @@
 //         Rander Wang <rander.wang@intel.com>
 //         Janusz Jankowski <janusz.jankowski@linux.intel.com>
 
+#include <sof/drivers/timer.h>
+#include "testbench/sim.h"
 #include "testbench/timer.h"
 
 void platform_host_timestamp(struct comp_dev *host,
@@ -19,3 +21,15 @@ void platform_dai_timestamp(struct comp_dev *dai,
 			    struct sof_ipc_stream_posn *posn)
 {
 }
+
+/* platform timer runs on the simulation clock, ticks are ns */
+uint64_t platform_timer_get(struct timer *timer)
+{
+	return tb_sim_time();
+}
+
+/* DAI wallclock runs on the simulation clock */
+void platform_dai_wallclock(struct comp_dev *dai, uint64_t *wallclock)
+{
+	*wallclock = tb_sim_time();
+}
@@ -40,6 +40,35 @@ FILE *file;
 char pipeline_string[DEBUG_MSG_LEN];
 
 struct shared_lib_table *lib_table;
+struct testbench_prm *tb_prm;
+
+/* open shared library and register the comp driver it contains */
+static void register_comp_library(int index)
+{
+	char message[DEBUG_MSG_LEN + MAX_LIB_NAME_LEN];
+
+	if (lib_table[index].register_drv)
+		return;
+
+	sprintf(message, "registered comp driver for %s\n",
+		lib_table[index].comp_name);
+	debug_print(message);
+
+	/* open shared library object */
+	sprintf(message, "opening shared lib %s\n",
+		lib_table[index].library_name);
+	debug_print(message);
+
+	lib_table[index].handle = dlopen(lib_table[index].library_name,
+					 RTLD_LAZY);
+	if (!lib_table[index].handle) {
+		fprintf(stderr, "error: %s\n", dlerror());
+		exit(EXIT_FAILURE);
+	}
+
+	/* comp init is executed on lib load */
+	lib_table[index].register_drv = 1;
+}
 
 /*
  * Register component driver
@@ -47,8 +76,25 @@ struct shared_lib_table *lib_table;
  */
 void register_comp(int comp_type)
 {
-	int index;
-	char message[DEBUG_MSG_LEN + MAX_LIB_NAME_LEN];
+	int i;
+
+	/* simulation uses the real host and dai components */
+	if (tb_prm->sim) {
+		switch (comp_type) {
+		case SND_SOC_TPLG_DAPM_AIF_IN:
+		case SND_SOC_TPLG_DAPM_AIF_OUT:
+			register_comp_library(get_index_by_name("host",
+								lib_table));
+			return;
+		case SND_SOC_TPLG_DAPM_DAI_IN:
+		case SND_SOC_TPLG_DAPM_DAI_OUT:
+			register_comp_library(get_index_by_name("dai",
+								lib_table));
+			return;
+		default:
+			break;
+		}
+	}
 
 	/* register file comp driver (no shared library needed) */
 	if (comp_type == SND_SOC_TPLG_DAPM_DAI_IN ||
@@ -61,33 +107,12 @@ void register_comp(int comp_type)
 		return;
 	}
 
-	/* get index of comp in shared library table */
-	index = get_index_by_type(comp_type, lib_table);
-	if (index < 0)
-		return;
-
-	/* register comp driver if not already registered */
-	if (!lib_table[index].register_drv) {
-		sprintf(message, "registered comp driver for %s\n",
-			lib_table[index].comp_name);
-		debug_print(message);
-
-		/* open shared library object */
-		sprintf(message, "opening shared lib %s\n",
-			lib_table[index].library_name);
-		debug_print(message);
-
-		lib_table[index].handle = dlopen(lib_table[index].library_name,
-						 RTLD_LAZY);
-		if (!lib_table[index].handle) {
-			fprintf(stderr, "error: %s\n", dlerror());
-			exit(EXIT_FAILURE);
-		}
-
-		/* comp init is executed on lib load */
-		lib_table[index].register_drv = 1;
-	}
-
+	/* effect widgets are told apart by their process type, which is not
+	 * known yet, register every library of the widget type
+	 */
+	for (i = 0; i < NUM_WIDGETS_SUPPORTED; i++)
+		if (lib_table[i].widget_type == comp_type)
+			register_comp_library(i);
 }
 
 int find_widget(struct comp_info *temp_comp_list, int count, char *name)
@@ -238,11 +263,43 @@ static int load_fileread(void *dev, int comp_id, int pipeline_id,
 	return 0;
 }
 
+/* load host component for simulation */
+static int load_pcm(struct sof *sof, int comp_id, int pipeline_id, int size,
+		    int *fr_id, int *sched_id, struct testbench_prm *tp,
+		    int dir)
+{
+	struct sof_ipc_comp_host host = {0};
+	int ret;
+
+	host.config.frame_fmt = find_format(tp->bits_in);
+
+	ret = tplg_load_pcm(comp_id, pipeline_id, size, dir, &host, file);
+	if (ret < 0)
+		return ret;
+
+	/* use host comp as scheduling comp */
+	*fr_id = *sched_id = comp_id;
+
+	/* create host component */
+	if (ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)&host) < 0) {
+		fprintf(stderr, "error: comp register\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 int load_aif_in_out(void *dev, int comp_id, int pipeline_id,
 		    int size, int *fr_id, int *sched_id, void *tp, int dir)
 {
+	struct testbench_prm *prm = (struct testbench_prm *)tp;
+
+	if (prm->sim)
+		return load_pcm(dev, comp_id, pipeline_id, size, fr_id,
+				sched_id, prm, dir);
+
 	return load_fileread(dev, comp_id, pipeline_id, size, fr_id,
-			     sched_id, (struct testbench_prm *)tp);
+			     sched_id, prm);
 }
 
 /* load filewrite component */
@@ -321,18 +378,44 @@ static int load_filewrite(struct sof *sof, int comp_id, int pipeline_id,
 	return 0;
 }
 
+/* load dai component for simulation */
+static int load_dai(struct sof *sof, int comp_id, int pipeline_id, int size,
+		    int *fw_id)
+{
+	struct sof_ipc_comp_dai comp_dai = {0};
+	int ret;
+
+	ret = tplg_load_dai(comp_id, pipeline_id, size, &comp_dai, file);
+	if (ret < 0)
+		return ret;
+
+	*fw_id = comp_id;
+
+	/* create dai component */
+	if (ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)&comp_dai) < 0) {
+		fprintf(stderr, "error: comp register\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 int load_dai_in_out(void *dev, int comp_id, int pipeline_id,
 		    int size, int *fw_id, void *tp)
 {
-	return load_filewrite(dev, comp_id, pipeline_id, size, fw_id,
-			      (struct testbench_prm *)tp);
+	struct testbench_prm *prm = (struct testbench_prm *)tp;
+
+	if (prm->sim)
+		return load_dai(dev, comp_id, pipeline_id, size, fw_id);
+
+	return load_filewrite(dev, comp_id, pipeline_id, size, fw_id, prm);
 }
 
 /* load pda dapm widget */
 int load_pga(void *dev, int comp_id, int pipeline_id, int size)
 {
 	struct sof *sof = (struct sof *)dev;
-	struct sof_ipc_comp_volume volume;
+	struct sof_ipc_comp_volume volume = {0};
 	int ret = 0;
 
 	ret = tplg_load_pga(comp_id, pipeline_id, size, &volume, file);
@@ -452,6 +535,51 @@ int load_mixer(void *dev, int comp_id, int pipeline_id, int size)
 	return ret;
 }
 
+/* load process dapm widget with the configuration of its bytes control */
+int load_process(void *dev, int comp_id, int pipeline_id, int size,
+		 int num_kcontrols)
+{
+	struct sof *sof = (struct sof *)dev;
+	struct sof_ipc_comp_process process = {0};
+	struct sof_ipc_comp_process *ipc;
+	struct sof_abi_hdr *bytes = NULL;
+	size_t blob_size = 0;
+	int ret = 0;
+
+	ret = tplg_load_process(comp_id, pipeline_id, size, &process, file);
+	if (ret < 0)
+		return ret;
+
+	ret = tplg_load_controls(num_kcontrols, file, &bytes);
+	if (ret < 0)
+		return ret;
+
+	/* the component gets the blob without the ABI header */
+	if (bytes)
+		blob_size = bytes->size;
+
+	ipc = calloc(1, sizeof(*ipc) + blob_size);
+	if (!ipc) {
+		free(bytes);
+		return -ENOMEM;
+	}
+
+	*ipc = process;
+	ipc->size = blob_size;
+	ipc->comp.hdr.size += blob_size;
+	if (blob_size)
+		memcpy(ipc->data, bytes->data, blob_size);
+
+	/* load process component */
+	ret = ipc_comp_new(sof->ipc, (struct sof_ipc_comp *)ipc);
+	if (ret < 0)
+		fprintf(stderr, "error: new process comp\n");
+
+	free(ipc);
+	free(bytes);
+	return ret;
+}
+
 /* parse topology file and set up pipeline */
 int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 		   struct testbench_prm *tp, int *fr_id, int *fw_id,
@@ -473,6 +601,7 @@ int parse_topology(struct sof *sof, struct shared_lib_table *library_table,
 	}
 
 	lib_table = library_table;
+	tb_prm = tp;
 
 	/* file size */
 	fseek(file, 0, SEEK_END);
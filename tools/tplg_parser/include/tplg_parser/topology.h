@@ -12,6 +12,7 @@
 
 #include <sound/asoc.h>
 #include <ipc/dai.h>
+#include <kernel/header.h>
 #include <kernel/tokens.h>
 
 #define SOF_DEV 1
@@ -168,6 +169,28 @@ struct sof_dai_types {
 	enum sof_ipc_dai_type type;
 };
 
+/* Process, the type string selects the component type */
+struct sof_process_types {
+	const char *name;
+	enum sof_comp_type type;
+};
+
+static const struct sof_process_types sof_process[] = {
+	{"EQFIR", SOF_COMP_EQ_FIR},
+	{"EQIIR", SOF_COMP_EQ_IIR},
+	{"DRC", SOF_COMP_DRC},
+};
+
+enum sof_comp_type find_process(const char *name);
+
+int get_token_process_type(void *elem, void *object, uint32_t offset,
+			   uint32_t size);
+static const struct sof_topology_token process_tokens[] = {
+	{SOF_TKN_PROCESS_TYPE, SND_SOC_TPLG_TUPLE_TYPE_STRING,
+	 get_token_process_type,
+	 offsetof(struct sof_ipc_comp_process, type), 0},
+};
+
 int sof_parse_tokens(void *object,
 		     const struct sof_topology_token *tokens,
 		     int count, struct snd_soc_tplg_vendor_array *array,
@@ -199,13 +222,16 @@ int tplg_load_pga(int comp_id, int pipeline_id, int size,
 		  struct sof_ipc_comp_volume *volume, FILE *file);
 int tplg_load_pipeline(int comp_id, int pipeline_id, int size,
 		       struct sof_ipc_pipe_new *pipeline, FILE *file);
-int tplg_load_controls(int num_kcontrols, FILE *file);
+int tplg_load_controls(int num_kcontrols, FILE *file,
+		       struct sof_abi_hdr **bytes);
 int tplg_load_src(int comp_id, int pipeline_id, int size,
 		  struct sof_ipc_comp_src *src, FILE *file);
 int tplg_load_asrc(int comp_id, int pipeline_id, int size,
 		   struct sof_ipc_comp_asrc *asrc, FILE *file);
 int tplg_load_mixer(int comp_id, int pipeline_id, int size,
 		    struct sof_ipc_comp_mixer *mixer, FILE *file);
+int tplg_load_process(int comp_id, int pipeline_id, int size,
+		      struct sof_ipc_comp_process *process, FILE *file);
 int tplg_load_graph(int num_comps, int pipeline_id,
 		    struct comp_info *temp_comp_list, char *pipeline_string,
 		    struct sof_ipc_pipe_comp_connect *connection, FILE *file,
@@ -222,6 +248,8 @@ int load_pipeline(void *dev, int comp_id, int pipeline_id, int size,
 int load_src(void *dev, int comp_id, int pipeline_id, int size, void *params);
 int load_asrc(void *dev, int comp_id, int pipeline_id, int size, void *params);
 int load_mixer(void *dev, int comp_id, int pipeline_id, int size);
+int load_process(void *dev, int comp_id, int pipeline_id, int size,
+		 int num_kcontrols);
 int load_widget(void *dev, int dev_type, struct comp_info *temp_comp_list,
 		int comp_id, int comp_index, int pipeline_id,
 		void *tp, int *fr_id, int *fw_id, int *sched_id, FILE *file);
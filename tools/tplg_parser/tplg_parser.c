@@ -343,9 +343,12 @@ int tplg_load_pipeline(int comp_id, int pipeline_id, int size,
 
 /* load dapm widget kcontrols
  * we don't use controls in the testbench or the fuzzer atm.
- * so just skip to the next dapm widget
+ * so just skip to the next dapm widget. The private data of a bytes
+ * control is returned in bytes when it is not NULL, it is the initial
+ * configuration of process components.
  */
-int tplg_load_controls(int num_kcontrols, FILE *file)
+int tplg_load_controls(int num_kcontrols, FILE *file,
+		       struct sof_abi_hdr **bytes)
 {
 	struct snd_soc_tplg_ctl_hdr *ctl_hdr;
 	struct snd_soc_tplg_mixer_control *mixer_ctl;
@@ -451,8 +454,28 @@ int tplg_load_controls(int num_kcontrols, FILE *file)
 				goto err;
 			}
 
-			/* skip bytes private data */
-			fseek(file, bytes_ctl->priv.size, SEEK_CUR);
+			if (!bytes || *bytes ||
+			    bytes_ctl->priv.size < sizeof(**bytes)) {
+				/* skip bytes private data */
+				fseek(file, bytes_ctl->priv.size, SEEK_CUR);
+				break;
+			}
+
+			/* read bytes private data */
+			*bytes = malloc(bytes_ctl->priv.size);
+			if (!*bytes) {
+				ret = -ENOMEM;
+				goto err;
+			}
+
+			ret = fread(*bytes, bytes_ctl->priv.size, 1, file);
+			if (ret != 1 || (*bytes)->size + sizeof(**bytes) >
+					bytes_ctl->priv.size) {
+				free(*bytes);
+				*bytes = NULL;
+				ret = -EINVAL;
+				goto err;
+			}
 			break;
 		default:
 			printf("info: control type not supported\n");
@@ -661,6 +684,75 @@ int tplg_load_mixer(int comp_id, int pipeline_id, int size,
 	return 0;
 }
 
+/* load process dapm widget, the blob is set by the caller */
+int tplg_load_process(int comp_id, int pipeline_id, int size,
+		      struct sof_ipc_comp_process *process, FILE *file)
+{
+	struct snd_soc_tplg_vendor_array *array = NULL;
+	size_t total_array_size = 0, read_size;
+	int ret = 0;
+
+	/* allocate memory for vendor tuple array */
+	array = (struct snd_soc_tplg_vendor_array *)malloc(size);
+	if (!array) {
+		fprintf(stderr, "error: mem alloc for process vendor array\n");
+		return -EINVAL;
+	}
+
+	/* read vendor tokens */
+	while (total_array_size < size) {
+		read_size = sizeof(struct snd_soc_tplg_vendor_array);
+		ret = fread(array, read_size, 1, file);
+		if (ret != 1) {
+			free(array);
+			return -EINVAL;
+		}
+
+		tplg_read_array(array, file);
+
+		/* parse comp tokens */
+		ret = sof_parse_tokens(&process->config, comp_tokens,
+				       ARRAY_SIZE(comp_tokens), array,
+				       array->size);
+		if (ret != 0) {
+			fprintf(stderr, "error: parse process comp_tokens %d\n",
+				size);
+			free(array);
+			return -EINVAL;
+		}
+
+		/* parse process tokens */
+		ret = sof_parse_tokens(process, process_tokens,
+				       ARRAY_SIZE(process_tokens), array,
+				       array->size);
+		if (ret != 0) {
+			fprintf(stderr, "error: parse process tokens %d\n",
+				size);
+			free(array);
+			return -EINVAL;
+		}
+
+		total_array_size += array->size;
+
+		/* read next array */
+		array = (void *)array + array->size;
+	}
+
+	/* point to the start of array so it gets freed properly */
+	array = (void *)array - size;
+
+	/* configure process */
+	process->comp.hdr.cmd = SOF_IPC_GLB_TPLG_MSG | SOF_IPC_TPLG_COMP_NEW;
+	process->comp.id = comp_id;
+	process->comp.hdr.size = sizeof(struct sof_ipc_comp_process);
+	process->comp.type = process->type;
+	process->comp.pipeline_id = pipeline_id;
+	process->config.hdr.size = sizeof(struct sof_ipc_comp_config);
+
+	free(array);
+	return 0;
+}
+
 /* load pipeline graph DAPM widget*/
 int tplg_load_graph(int num_comps, int pipeline_id,
 		    struct comp_info *temp_comp_list, char *pipeline_string,
@@ -846,6 +938,18 @@ int load_widget(void *dev, int dev_type, struct comp_info *temp_comp_list,
 			return -EINVAL;
 		}
 		break;
+	case(SND_SOC_TPLG_DAPM_EFFECT):
+		/* the kcontrols hold the configuration, they are loaded
+		 * with the widget
+		 */
+		if (load_process(dev, temp_comp_list[comp_index].id,
+				 pipeline_id, widget->priv.size,
+				 widget->num_kcontrols) < 0) {
+			fprintf(stderr, "error: load process\n");
+			return -EINVAL;
+		}
+		free(widget);
+		return 0;
 	/* unsupported widgets */
 	default:
 		fseek(file, widget->priv.size, SEEK_CUR);
@@ -856,7 +960,8 @@ int load_widget(void *dev, int dev_type, struct comp_info *temp_comp_list,
 
 	/* load widget kcontrols */
 	if (widget->num_kcontrols > 0)
-		if (tplg_load_controls(widget->num_kcontrols, file) < 0) {
+		if (tplg_load_controls(widget->num_kcontrols, file,
+				       NULL) < 0) {
 			fprintf(stderr, "error: loading controls\n");
 			return -EINVAL;
 		}
@@ -1041,6 +1146,28 @@ int get_token_comp_format(void *elem, void *object, uint32_t offset,
 	return 0;
 }
 
+enum sof_comp_type find_process(const char *name)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sof_process); i++) {
+		if (strcmp(name, sof_process[i].name) == 0)
+			return sof_process[i].type;
+	}
+
+	return SOF_COMP_NONE;
+}
+
+int get_token_process_type(void *elem, void *object, uint32_t offset,
+			   uint32_t size)
+{
+	struct snd_soc_tplg_vendor_string_elem *velem = elem;
+	uint32_t *val = (uint32_t *)((uint8_t *)object + offset);
+
+	*val = find_process(velem->string);
+	return 0;
+}
+
 int get_token_dai_type(void *elem, void *object, uint32_t offset, uint32_t size)
 {
 	struct snd_soc_tplg_vendor_string_elem *velem = elem;